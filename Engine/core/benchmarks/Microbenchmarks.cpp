@@ -0,0 +1,431 @@
+#include "Constants.h"
+#include "MD5Model.h"
+#include "ObjModel.h"
+#include "TextureCache.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+/// CPU microbenchmarks of the engine hot paths, no Vulkan device is created:
+///   - every benchmark runs its operation in REPETITIONS batches, a batch repeats it until MIN_BATCH_MS passed
+///   - ns/op and items/s are the mean of the batches, the relative standard deviation shows how stable the run was
+///   - --json writes the results, --baseline compares them with a stored file and fails on regressions
+/// The assets are read from the working directory (MODEL_DIR, TEXTURES_DIR), run it from the Bin dir.
+/// Usage: EngineBenchmarks [--filter text] [--json file] [--baseline file] [--threshold percent]
+/// Note: with --filter only the assets and the data of the selected benchmarks are prepared
+namespace {
+constexpr const char* USAGE = "usage: EngineBenchmarks [--filter text] [--json file] [--baseline file] [--threshold percent]";
+constexpr uint32_t REPETITIONS = 10u;
+constexpr double MIN_BATCH_MS = 50.0;
+constexpr double DEFAULT_THRESHOLD_PERCENT = 10.0;
+
+constexpr std::string_view MD5_MESH_FILE{"pinky.md5mesh"};
+constexpr std::string_view MD5_ANIM_FILE{"pinky_idle.md5anim"};
+constexpr std::string_view OBJ_FILE{"Tank.obj"};
+constexpr std::string_view TEXTURE_FILE{"pinky.png"};
+constexpr uint32_t CULLED_INSTANCES_COUNTS[] = {1024u, 16u * 1024u, 256u * 1024u};
+
+/// keeps the compiler from dropping the result of the measured operation
+template <typename T>
+void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/// the benchmarks run are the ones whose name contains the filter
+bool isSelected(std::string_view filter, std::string_view name) {
+    return filter.empty() || name.find(filter) != std::string_view::npos;
+}
+
+/// the assets of a group are loaded if one of its benchmarks is selected
+template <std::size_t N>
+bool isAnySelected(std::string_view filter, const std::array<std::string_view, N>& names) {
+    return std::any_of(names.begin(), names.end(), [filter](std::string_view name) { return isSelected(filter, name); });
+}
+
+struct Benchmark {
+    std::string name;
+    uint64_t itemsPerOp{1u};  // vertices, instances... processed by one operation
+    std::function<void()> op;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations{0u};  // operations per batch
+    double nsPerOp{0.0};
+    double stddevNs{0.0};
+    double itemsPerSecond{0.0};
+
+    double getRelativeStddev() const {
+        return nsPerOp > 0.0 ? stddevNs / nsPerOp : 0.0;
+    }
+};
+
+double runBatch(const Benchmark& benchmark, uint64_t iterations) {
+    const auto startTime = std::chrono::steady_clock::now();
+    for (uint64_t i = 0u; i < iterations; ++i) {
+        benchmark.op();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+Result run(const Benchmark& benchmark) {
+    // warms the caches up and grows the batch until it is long enough for the clock resolution
+    uint64_t iterations = 1u;
+    double batchNs = runBatch(benchmark, iterations);
+    while (batchNs < MIN_BATCH_MS * 1e6) {
+        const double scale = batchNs > 0.0 ? std::min(MIN_BATCH_MS * 1e6 / batchNs * 1.2, 100.0) : 100.0;
+        iterations = std::max(iterations + 1u, static_cast<uint64_t>(static_cast<double>(iterations) * scale));
+        batchNs = runBatch(benchmark, iterations);
+    }
+
+    std::vector<double> nsPerOp(REPETITIONS);
+    for (auto& ns : nsPerOp) {
+        ns = runBatch(benchmark, iterations) / static_cast<double>(iterations);
+    }
+
+    Result result{benchmark.name, iterations};
+    for (const double ns : nsPerOp) {
+        result.nsPerOp += ns;
+    }
+    result.nsPerOp /= static_cast<double>(nsPerOp.size());
+    for (const double ns : nsPerOp) {
+        result.stddevNs += (ns - result.nsPerOp) * (ns - result.nsPerOp);
+    }
+    result.stddevNs = std::sqrt(result.stddevNs / static_cast<double>(nsPerOp.size() - 1u));
+    result.itemsPerSecond = static_cast<double>(benchmark.itemsPerOp) * 1e9 / result.nsPerOp;
+    return result;
+}
+
+std::string readText(std::string_view dir, std::string_view fileName) {
+    std::ifstream file(Utils::formPath(dir, fileName), std::ios::binary);
+    if (!file) {
+        Utils::printLog(ERROR_PARAM, "benchmark asset is missing: ", fileName);
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+void addMD5Benchmarks(std::vector<Benchmark>& benchmarks, std::string_view filter) {
+    constexpr std::array<std::string_view, 4u> NAMES{"md5/parseModel", "md5/parseAnimation", "md5/interpolateSkeleton",
+                                                     "md5/skinVertices"};
+    if (!isAnySelected(filter, NAMES)) {
+        return;
+    }
+    const std::string meshText = readText(Constants::MODEL_DIR, MD5_MESH_FILE);
+    const std::string animText = readText(Constants::MODEL_DIR, MD5_ANIM_FILE);
+
+    // the parsed model is shared by the skinning benchmarks
+    auto model = std::make_shared<md5_animation::Model3D>();
+    std::vector<std::string> textureNames;
+    float radius{0.0f};
+    {
+        std::istringstream meshStream(meshText);
+        MD5Model::parseModel(meshStream, 1.0f, *model, textureNames, radius);
+        md5_animation::ModelAnimation animation;
+        std::istringstream animStream(animText);
+        if (!MD5Model::parseAnimation(animStream, *model, animation) || animation.numFrames < 2) {
+            Utils::printLog(ERROR_PARAM, "couldn't parse ", MD5_ANIM_FILE);
+        }
+        model->animations.push_back(std::move(animation));
+    }
+
+    uint64_t verticesCount = 0u;
+    for (const auto& subset : model->subsets) {
+        verticesCount += subset.vertices.size();
+    }
+    const auto& animation = model->animations[0];
+
+    benchmarks.push_back({std::string{NAMES[0]}, verticesCount, [meshText] {
+                              md5_animation::Model3D parsed;
+                              std::vector<std::string> names;
+                              float parsedRadius{0.0f};
+                              std::istringstream stream(meshText);
+                              MD5Model::parseModel(stream, 1.0f, parsed, names, parsedRadius);
+                              doNotOptimize(parsed);
+                          }});
+    benchmarks.push_back({std::string{NAMES[1]}, static_cast<uint64_t>(animation.numFrames), [animText, model] {
+                              md5_animation::ModelAnimation parsed;
+                              std::istringstream stream(animText);
+                              MD5Model::parseAnimation(stream, *model, parsed);
+                              doNotOptimize(parsed);
+                          }});
+
+    auto skeleton = std::make_shared<std::vector<md5_animation::Joint>>(animation.numJoints);
+    benchmarks.push_back({std::string{NAMES[2]}, static_cast<uint64_t>(animation.numJoints), [model, skeleton] {
+                              const auto& anim = model->animations[0];
+                              MD5Model::interpolateSkeleton(anim, 0u, 1u, 0.37f, 0u, anim.numJoints, *skeleton);
+                              doNotOptimize(skeleton->data());
+                          }});
+    MD5Model::interpolateSkeleton(animation, 0u, 1u, 0.37f, 0u, animation.numJoints, *skeleton);
+    benchmarks.push_back({std::string{NAMES[3]}, verticesCount, [model, skeleton] {
+                              for (auto& subset : model->subsets) {
+                                  MD5Model::skinVertices(subset, *skeleton, 1.0f, true, 0u, subset.vertices.size());
+                                  doNotOptimize(subset.gpuVertices.data());
+                              }
+                          }});
+}
+
+void addCullingBenchmarks(std::vector<Benchmark>& benchmarks, std::string_view filter) {
+    // instances on a square grid around the camera looking along the grid, about a quarter is inside the frustum
+    constexpr float Z_FAR = 1000.0f;
+    const glm::vec3 camPos{0.0f, 2.0f, 0.0f};
+    const glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, Z_FAR) *
+                               glm::lookAt(camPos, glm::vec3{0.0f, 2.0f, -1.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+
+    for (const uint32_t instancesCount : CULLED_INSTANCES_COUNTS) {
+        std::string name = "culling/filterInstances/" + std::to_string(instancesCount);
+        if (!isSelected(filter, name)) {
+            continue;
+        }
+        auto instances = std::make_shared<std::vector<Instance>>(instancesCount);
+        const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(instancesCount))));
+        const float spacing = 2.0f * Z_FAR / static_cast<float>(side);
+        std::mt19937 random(instancesCount);
+        std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+        for (uint32_t i = 0u; i < instancesCount; ++i) {
+            auto& instance = (*instances)[i];
+            instance.posShift = {(static_cast<float>(i % side) + 0.5f) * spacing - Z_FAR, 0.0f,
+                                 (static_cast<float>(i / side) + 0.5f) * spacing - Z_FAR};
+            instance.scale = scale(random);
+        }
+
+        auto activeInstances = std::make_shared<std::vector<Instance>>();
+        auto activeInstancesLowPoly = std::make_shared<std::vector<Instance>>();
+        activeInstances->reserve(instancesCount);
+        activeInstancesLowPoly->reserve(instancesCount);
+        benchmarks.push_back({std::move(name), instancesCount,
+                              [=] {
+                                  I3DModel::filterInstances(*instances, 0u, instances->size(), 1.0f + 0.15f * Z_FAR, viewProj,
+                                                            Z_FAR, camPos, true, *activeInstances, *activeInstancesLowPoly);
+                                  doNotOptimize(activeInstances->data());
+                                  doNotOptimize(activeInstancesLowPoly->data());
+                              }});
+    }
+}
+
+void addObjBenchmarks(std::vector<Benchmark>& benchmarks, std::string_view filter) {
+    constexpr std::array<std::string_view, 2u> NAMES{"obj/parse", "obj/dedupVertices"};
+    if (!isAnySelected(filter, NAMES)) {
+        return;
+    }
+    const std::string absPath = Utils::formPath(Constants::MODEL_DIR, OBJ_FILE);
+    auto attrib = std::make_shared<tinyobj::attrib_t>();
+    auto shapes = std::make_shared<std::vector<tinyobj::shape_t>>();
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    if (!tinyobj::LoadObj(attrib.get(), shapes.get(), &materials, &warn, &err, absPath.c_str(), Constants::MODEL_DIR.data(),
+                          false, false)) {
+        Utils::printLog(ERROR_PARAM, (warn + err));
+    }
+
+    uint64_t indicesCount = 0u;
+    for (const auto& shape : *shapes) {
+        indicesCount += shape.mesh.indices.size();
+    }
+
+    benchmarks.push_back({std::string{NAMES[0]}, indicesCount, [absPath] {
+                              tinyobj::attrib_t parsedAttrib;
+                              std::vector<tinyobj::shape_t> parsedShapes;
+                              std::vector<tinyobj::material_t> parsedMaterials;
+                              std::string parseWarn, parseErr;
+                              tinyobj::LoadObj(&parsedAttrib, &parsedShapes, &parsedMaterials, &parseWarn, &parseErr,
+                                               absPath.c_str(), Constants::MODEL_DIR.data(), false, false);
+                              doNotOptimize(parsedAttrib);
+                          }});
+    // the bump mapping of every shape as ObjModel::load picks it
+    auto is_bumpMappingValid = std::make_shared<std::vector<bool>>();
+    for (const auto& shape : *shapes) {
+        is_bumpMappingValid->push_back(!shape.mesh.material_ids.empty() && !materials.empty() &&
+                                       !materials[shape.mesh.material_ids[0]].bump_texname.empty());
+    }
+    benchmarks.push_back({std::string{NAMES[1]}, indicesCount, [attrib, shapes, is_bumpMappingValid, indicesCount] {
+                              std::unordered_map<I3DModel::Vertex, uint32_t> uniqueVertices;
+                              std::vector<I3DModel::Vertex> vertices;
+                              std::vector<uint32_t> indices;
+                              uniqueVertices.reserve(indicesCount);
+                              vertices.reserve(indicesCount);
+                              indices.reserve(indicesCount);
+                              float radius{0.0f};
+                              for (std::size_t i = 0u; i < shapes->size(); ++i) {
+                                  ObjModel::appendShape(*attrib, (*shapes)[i], (*is_bumpMappingValid)[i], uniqueVertices,
+                                                        vertices, indices, radius);
+                              }
+                              doNotOptimize(vertices.data());
+                          }});
+}
+
+void addTextureBenchmarks(std::vector<Benchmark>& benchmarks, std::string_view filter) {
+    constexpr std::string_view NAME{"texture/decodeAndMips"};
+    if (!isSelected(filter, NAME)) {
+        return;
+    }
+    const std::string source = readText(Constants::TEXTURES_DIR, TEXTURE_FILE);
+    auto sources = std::make_shared<std::vector<std::vector<char>>>(1u, std::vector<char>(source.begin(), source.end()));
+
+    TextureCache::Image image;
+    if (!TextureCache::build(*sources, TextureCache::Settings{}, image)) {
+        Utils::printLog(ERROR_PARAM, "couldn't decode ", TEXTURE_FILE);
+    }
+
+    benchmarks.push_back({std::string{NAME}, static_cast<uint64_t>(image.width) * image.height, [sources] {
+                              TextureCache::Image built;
+                              TextureCache::build(*sources, TextureCache::Settings{}, built);
+                              doNotOptimize(built.levels.data());
+                          }});
+}
+
+void addInstanceBenchmarks(std::vector<Benchmark>& benchmarks, std::string_view filter) {
+    constexpr std::string_view NAME{"instances/packModelMatrix"};
+    if (!isSelected(filter, NAME)) {
+        return;
+    }
+    constexpr uint32_t INSTANCES_COUNT = 64u * 1024u;
+    auto instances = std::make_shared<std::vector<Instance>>(INSTANCES_COUNT);
+    auto matrices = std::make_shared<std::vector<glm::mat4>>(INSTANCES_COUNT);
+    std::mt19937 random(INSTANCES_COUNT);
+    std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+    for (auto& matrix : *matrices) {
+        matrix = glm::rotate(glm::mat4(1.0f), angle(random), glm::vec3{0.0f, 1.0f, 0.0f});
+    }
+
+    benchmarks.push_back({std::string{NAME}, INSTANCES_COUNT, [instances, matrices] {
+                              for (std::size_t i = 0u; i < instances->size(); ++i) {
+                                  (*instances)[i].setModelMatrix((*matrices)[i]);
+                              }
+                              doNotOptimize(instances->data());
+                          }});
+}
+
+void writeJson(const std::string& filePath, const std::vector<Result>& results) {
+    std::ofstream file(filePath);
+    if (!file) {
+        Utils::printLog(ERROR_PARAM, "failed to write benchmark results to ", filePath);
+    }
+
+    // one benchmark per line, readBaseline depends on it
+    file << std::fixed << std::setprecision(3);
+    file << "{\n  \"repetitions\": " << REPETITIONS << ",\n  \"benchmarks\": [";
+    for (std::size_t i = 0u; i < results.size(); ++i) {
+        const Result& result = results[i];
+        file << (i == 0u ? "\n" : ",\n") << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+             << ", \"nsPerOp\": " << result.nsPerOp << ", \"stddevNs\": " << result.stddevNs
+             << ", \"itemsPerSecond\": " << result.itemsPerSecond << "}";
+    }
+    file << "\n  ]\n}\n";
+    Utils::printLog(INFO_PARAM, "benchmark results written to ", filePath);
+}
+
+/// ns/op by the benchmark name of a file written by writeJson
+std::map<std::string, double> readBaseline(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file) {
+        Utils::printLog(ERROR_PARAM, "failed to read benchmark baseline ", filePath);
+    }
+
+    std::map<std::string, double> nsPerOp;
+    std::string line;
+    while (std::getline(file, line)) {
+        const std::size_t namePos = line.find("\"name\": \"");
+        const std::size_t nsPos = line.find("\"nsPerOp\": ");
+        if (namePos == std::string::npos || nsPos == std::string::npos) {
+            continue;
+        }
+        const std::size_t nameStart = namePos + std::strlen("\"name\": \"");
+        const std::string name = line.substr(nameStart, line.find('"', nameStart) - nameStart);
+        nsPerOp[name] = std::strtod(line.c_str() + nsPos + std::strlen("\"nsPerOp\": "), nullptr);
+    }
+    return nsPerOp;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::string jsonPath;
+    std::string baselinePath;
+    double thresholdPercent = DEFAULT_THRESHOLD_PERCENT;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            std::printf("missing value of %s\n%s\n", argv[i], USAGE);
+            return 1;
+        }
+        if (strcmp(argv[i], "--filter") == 0) {
+            filter = argv[i + 1];
+        } else if (strcmp(argv[i], "--json") == 0) {
+            jsonPath = argv[i + 1];
+        } else if (strcmp(argv[i], "--baseline") == 0) {
+            baselinePath = argv[i + 1];
+        } else if (strcmp(argv[i], "--threshold") == 0) {
+            thresholdPercent = std::strtod(argv[i + 1], nullptr);
+        } else {
+            std::printf("unknown option %s\n%s\n", argv[i], USAGE);
+            return 1;
+        }
+    }
+
+    std::vector<Benchmark> benchmarks;
+    addMD5Benchmarks(benchmarks, filter);
+    addCullingBenchmarks(benchmarks, filter);
+    addObjBenchmarks(benchmarks, filter);
+    addTextureBenchmarks(benchmarks, filter);
+    addInstanceBenchmarks(benchmarks, filter);
+
+    const std::map<std::string, double> baseline = baselinePath.empty() ? std::map<std::string, double>{}
+                                                                        : readBaseline(baselinePath);
+    std::vector<Result> results;
+    uint32_t regressionsCount = 0u;
+    std::printf("%-36s %14s %8s %16s %10s\n", "benchmark", "ns/op", "rsd %", "items/s", "baseline");
+    for (const auto& benchmark : benchmarks) {
+        if (!isSelected(filter, benchmark.name)) {
+            continue;
+        }
+        const Result result = run(benchmark);
+        results.push_back(result);
+
+        std::printf("%-36s %14.1f %8.2f %16.0f", result.name.c_str(), result.nsPerOp, 100.0 * result.getRelativeStddev(),
+                    result.itemsPerSecond);
+        const auto it = baseline.find(result.name);
+        if (it != baseline.end() && it->second > 0.0) {
+            // slower than the baseline by more than the threshold and the noise of the run
+            const double changePercent = 100.0 * (result.nsPerOp / it->second - 1.0);
+            const bool is_regression = changePercent > thresholdPercent + 200.0 * result.getRelativeStddev();
+            regressionsCount += is_regression ? 1u : 0u;
+            std::printf(" %+9.1f%%%s", changePercent, is_regression ? " REGRESSION" : "");
+        }
+        std::printf("\n");
+    }
+
+    if (!jsonPath.empty()) {
+        writeJson(jsonPath, results);
+    }
+    if (regressionsCount != 0u) {
+        std::printf("%u benchmark(s) regressed more than %.1f%% against %s\n", regressionsCount, thresholdPercent,
+                    baselinePath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -8,6 +8,7 @@ SET OptimizationFlag=%PerfOptimizationFlag%
 
 %VULKAN_SDK%/Bin/glslc.exe %OptimizationFlag% shadersSRC/gPass.vert -o shaders/vert_gPass.spv
 %VULKAN_SDK%/Bin/glslc.exe %OptimizationFlag% shadersSRC/gPass.frag -o shaders/frag_gPass.spv
+%VULKAN_SDK%/Bin/glslc.exe %OptimizationFlag% shadersSRC/gPass_bindless.frag -o shaders/frag_gPass_bindless.spv
 
 %VULKAN_SDK%/Bin/glslc.exe %OptimizationFlag% shadersSRC/gLigtingSubpass.vert -o shaders/vert_gLigtingSubpass.spv
 %VULKAN_SDK%/Bin/glslc.exe %OptimizationFlag% shadersSRC/gLigtingSubpass.frag -o shaders/frag_gLigtingSubpass.spv
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "IControl.h"
+#include "InputRecording.h"
+
+/// Window controller of the benchmark mode: no window, no surface and no swapchain (the renderer draws into offscreen
+/// images, see VulkanCore::isHeadless), the input is a scripted camera and tank path replayed frame by frame.
+/// The same frame always gets the same buttons, with a fixed time step the whole run is reproducible.
+/// Quits after framesCount frames. No UI is drawn, ImGui only gets a context for the renderer backend.
+/// With an input replay the recorded frames (buttons, mouse and time steps) replace the scripted path, framesCount is the
+/// frames count of the recording; the recording outlives the controller.
+/// Note: not thread safe
+class HeadlessControl : public IControl {
+public:
+    HeadlessControl(std::string_view appName, uint32_t width, uint32_t height, uint32_t framesCount,
+                    const InputRecording* inputReplay = nullptr)
+        : IControl(appName, width, height),
+          m_framesCount(inputReplay ? static_cast<uint32_t>(inputReplay->getFrames().size()) : framesCount),
+          mp_inputReplay(inputReplay) {
+    }
+
+    virtual ~HeadlessControl();
+
+    virtual void init() override;
+
+    /// there is no surface in the headless mode
+    virtual VkSurfaceKHR createSurface(VkInstance&) const override {
+        return VK_NULL_HANDLE;
+    }
+
+    virtual bool isHeadless() const override {
+        return true;
+    }
+
+    virtual WindowQueueMSG processWindowQueueMSGs() override;
+
+    virtual void imGuiNewFrame(VkCommandBuffer) override {
+    }
+
+    uint32_t getFrameIndex() const {
+        return m_frameIndex;
+    }
+
+private:
+    uint32_t m_framesCount{0u};
+    uint32_t m_frameIndex{0u};
+    const InputRecording* mp_inputReplay{nullptr};
+    IControl::WindowQueueMSG m_windowQueueMsg{};
+};
@@ -20,12 +20,14 @@ public:
         uint32_t mouseY = 0;
         bool hmiRenderData = false;
         const UI::States* hmiStates = nullptr;
+        float replayedDeltaTimeMS = -1.0f;  // >= 0: the frame advances by the recorded time step, see InputRecording
 
         void reset() {
             isQuited = false;
             isResized = false;
             width = 0u;
             height = 0u;
+            replayedDeltaTimeMS = -1.0f;
         }
     };
 
@@ -47,6 +49,11 @@ public:
         return "";
     }
 
+    /// no window, surface and swapchain: the frames are rendered offscreen (benchmark mode)
+    virtual bool isHeadless() const {
+        return false;
+    }
+
     inline uint32_t getWidth() const {
         return m_width;
     }
@@ -59,6 +66,11 @@ public:
 
     virtual void imGuiNewFrame(VkCommandBuffer command_buffer) = 0;
 
+    /// renderer statistics shown by the next imGuiNewFrame()
+    void setUIStats(const UI::Stats& stats) {
+        mUi.setStats(stats);
+    }
+
 protected:
     std::string_view m_appName;
     uint32_t m_width;
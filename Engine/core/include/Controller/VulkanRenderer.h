@@ -9,15 +9,24 @@
 #endif
 
 #include <array>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "Camera.h"
+#include "CommandBufferCache.h"
+#include "GpuProfiler.h"
+#include "InputRecording.h"
 #include "Particle.h"
 #include "PipelineCreatorBase.h"
+#include "RenderGraph.h"
+#include "StressScene.h"
+#include "TransientAttachmentAllocator.h"
+#include "UI.h"
 #include "VulkanState.h"
 
-#define TREES_COUNT 250
-
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
 class btBroadphaseInterface;
@@ -56,7 +65,28 @@ public:
         MAX
     };
 
-    VulkanRenderer(std::string_view appName, uint16_t windowWidth, uint16_t windowHeight);
+    /// geometry passes recorded to secondary command buffers, a model batch per recording thread
+    enum SecondaryPasses {
+        SECONDARY_DEPTH = 0,
+        SECONDARY_SHADOWMAP,
+        SECONDARY_GPASS,
+        SECONDARY_SEMI_TRANSPARENT,
+        SECONDARY_MAX
+    };
+
+    /// fullscreen passes reused from CommandBufferCache while their inputs are the same
+    enum CachedPasses {
+        CACHED_SSAO_BLUR = 0,
+        CACHED_GAUSS_X_BLUR,
+        CACHED_GAUSS_Y_BLUR,
+        CACHED_BLOOM,
+        CACHED_FXAA,
+        CACHED_MAX
+    };
+
+    /// headlessFramesCount != 0 or inputReplay: benchmark mode, see HeadlessControl
+    VulkanRenderer(std::string_view appName, uint16_t windowWidth, uint16_t windowHeight, uint32_t headlessFramesCount = 0u,
+                   const StressScene& stressScene = StressScene{}, const InputRecording* inputReplay = nullptr);
     ~VulkanRenderer();
 
     void init();
@@ -64,9 +94,32 @@ public:
     /// @return: false if exitting is requested
     bool renderScene();
 
+    /// the simulation advances by deltaMS every frame instead of the measured frame time, 0 restores the measuring
+    void setFixedTimeStep(float deltaMS) {
+        m_fixedTimeStepMs = deltaMS;
+    }
+
+    /// every simulated frame is added to the recording (outlives the renderer), nullptr stops the recording
+    void setInputRecording(InputRecording* inputRecording) {
+        mp_inputRecording = inputRecording;
+    }
+
+    const GpuProfiler& getGpuProfiler() const {
+        return m_gpuProfiler;
+    }
+
 private:
     void destroyPerFrameResources();
+    /// releases the size dependent resources: swapchain, attachments, framebuffers
     void cleanupSwapChain();
+    /// releases the per image command buffers: primary, recording contexts, command buffer cache and GPU profiler queries
+    void destroyCommandBuffers();
+    /// the descriptor sets of the pipeline creators are released with their pools
+    void destroyDescriptorPools();
+    /// releases the resolution independent state: render passes and ImGui backend
+    void cleanupRenderPasses();
+    /// the offscreen images replacing the swapchain ones in the headless mode
+    void createHeadlessImages(const VkSwapchainCreateInfoKHR& swapchainCreateInfo);
     void recreateSwapChain(uint16_t windowWidth, uint16_t windowHeight, uint16_t offscreenWidth = 0u,
                            uint16_t offscreenHeight = 0u);
 
@@ -81,13 +134,63 @@ private:
     void createDescriptorPool();
     void createFramebuffer();
     void createPipeline();
+    /// qualityIndex enumerates the quality parameters of all the pipeline creators in the order of Pipelines
+    void setQualityLevel(uint32_t qualityIndex, uint32_t level);
+    void fillQualityStats(UI::Stats& uiStats) const;
+    void fillGpuTimingStats(UI::Stats& uiStats) const;
+    void fillMemoryStats(UI::Stats& uiStats) const;
     void recordCommandBuffers(uint32_t currentImage, bool hmiRenderData);
+
+    /// the per frame state the record functions of the frame graph passes read, alive until the graph is executed
+    struct FrameRecording {
+        uint32_t currentImage{0u};
+        const std::array<VkRenderPassBeginInfo, SECONDARY_MAX>* secondaryPassInfos{nullptr};
+        VkRenderPassBeginInfo footprintInfo{};
+        VkRenderPassBeginInfo ssaoBlurInfo{};
+        VkRenderPassBeginInfo gaussXBloomInfo{};
+        VkRenderPassBeginInfo gaussYBloomInfo{};
+        VkRenderPassBeginInfo bloomInfo{};
+        VkRenderPassBeginInfo fxaaInfo{};
+        VkRenderPassBeginInfo uiInfo{};
+        glm::vec4 fxaaWindowSize{0.0f};
+        bool is_clearingFootprint{false};
+        bool is_drawingFootprint{false};
+        bool is_fxaaPassEnabled{false};
+        bool is_uiEnabled{false};
+#if defined(USE_DLSS) && USE_DLSS
+        bool is_dlssPassEnabled{false};
+        sl::FrameToken* dlssFrameToken{nullptr};
+#endif
+    };
+
+    /// resets the graph and declares the passes of a frame with their accesses. Without recording only the accesses are
+    /// declared (the images may not exist yet, the graph must not be executed): the transient attachments take their
+    /// lifetimes from them, see TransientAttachmentAllocator::allocate
+    void addFramePasses(RenderGraph& graph, const FrameRecording* recording);
+
+    /// the workers live as long as the renderer, a worker per core besides the render thread
+    void createRecordingThreads();
+    void destroyRecordingThreads();
+    /// waits for the jobs of recordCommandBuffers and records the batch threadIndex of each
+    void recordingWorker(uint32_t threadIndex);
+    /// records the model batch threadIndex of batchesCount of all the secondary passes
+    void recordSecondaryCommandBuffers(uint32_t currentImage, uint32_t threadIndex, uint32_t batchesCount,
+                                       const std::array<VkRenderPassBeginInfo, SECONDARY_MAX>& renderPassInfos);
+    VkCommandBuffer beginSecondaryCommandBuffer(uint32_t currentImage, uint32_t threadIndex, SecondaryPasses pass,
+                                                const VkRenderPassBeginInfo& renderPassInfo);
+    void executeSecondaryCommandBuffers(uint32_t currentImage, SecondaryPasses pass);
+    /// records the pass into the primary command buffer by a cached secondary one,
+    /// windowSize is the only push constant data of the shaders which take it
+    void drawCachedQuadPass(uint32_t currentImage, CachedPasses pass, Pipelines pipeline,
+                            const VkRenderPassBeginInfo& renderPassInfo, const glm::vec4* windowSize = nullptr);
     void createSemaphores();
     void createDescriptorPoolForImGui();
     void createDepthResources();
     void createColorBufferImage();
     void loadModels();
     void recreateDescriptorSets();
+    /// rewrites the bindings of the existing descriptor sets referencing the attachments reallocated by a resize
+    void updateAttachmentDescriptors();
     void createFSRContext(VkSwapchainCreateInfoKHR swapchainCreateInfo);
     void calculateAdditionalMat();
 #if defined(USE_DLSS) && USE_DLSS
@@ -104,9 +207,14 @@ private:
     VkPhysicalDeviceProperties mDeviceProperties;
     std::array<std::unique_ptr<PipelineCreatorBase>, Pipelines::MAX> m_pipelineCreators{nullptr};
     std::vector<std::unique_ptr<I3DModel>> m_models{};
-    std::array<std::unique_ptr<Particle>, 5u> m_particles;
-    std::vector<I3DModel::InteractionImpactAnimation> m_semiTransparentAnimations{TREES_COUNT};
+    // the bush layers followed by the smoke emitters
+    std::vector<std::unique_ptr<Particle>> m_particles{};
+    std::size_t m_smokeEmittersFrom{0u};
+    std::vector<glm::vec3> m_smokeEmitterPositions{};  // of the emitters which don't follow the tank
     std::vector<std::unique_ptr<I3DModel>> m_semiTransparentModels{};
+    StressScene m_stressScene;
+    // the instanced models with the telemetry slot of their visible instances
+    std::vector<std::pair<const I3DModel*, uint32_t>> m_telemetryModels{};
 
     // Bullet physics state used to drive dynamic transforms (tank + trees).
     btDefaultCollisionConfiguration* m_btCollisionConfig{nullptr};
@@ -119,6 +227,7 @@ private:
     btRigidBody* m_btTankBody{nullptr};
     std::vector<btRigidBody*> m_btTreeBodies{};
     std::vector<TreeFallState>  m_btTreeFallStates{};
+    std::vector<btRigidBody*> m_btDynamicBodies{};  // boxes of the stress scene
     float m_btTreeHalfHeight{60.0f};
 
     std::vector<VkSemaphore> m_presentCompleteSem{};
@@ -128,6 +237,46 @@ private:
 
     // fence per swapchain image tracking
     std::vector<VkFence> m_imagesInFlight;
+    // memory of _swapChain.images in the headless mode, empty otherwise
+    std::vector<VkDeviceMemory> m_headlessImagesMemory{};
+    float m_fixedTimeStepMs{0.0f};
+    InputRecording* mp_inputRecording{nullptr};
+
+    // a pool per swapchain image and recording thread, the pool is reset as a whole before the image is recorded again
+    struct RecordingContext {
+        VkCommandPool cmdPool{nullptr};
+        std::array<VkCommandBuffer, SECONDARY_MAX> cmdBufs{};
+    };
+    std::vector<std::vector<RecordingContext>> m_recordingContexts{};  // [image][thread]
+    std::vector<VkCommandBuffer> m_executedCmdBufs{};                  // the batches of a pass, reused
+    uint32_t m_recordingThreadsCount{1u};                              // the render thread and the workers
+    uint32_t m_recordingBatchesCount{1u};                              // of the last recording, a model per batch at least
+
+    // the frame of the recording workers, the render thread records the batch 0 and waits for the others
+    struct RecordingJob {
+        uint32_t currentImage{0u};
+        uint32_t batchesCount{1u};
+        const std::array<VkRenderPassBeginInfo, SECONDARY_MAX>* renderPassInfos{nullptr};
+    };
+    std::vector<std::thread> m_recordingThreads{};
+    std::mutex m_recordingMutex{};
+    std::condition_variable m_recordingCondition{};  // a new job or the stop
+    std::condition_variable m_recordedCondition{};   // the last batch of the job is recorded
+    RecordingJob m_recordingJob{};                    // guarded by m_recordingMutex
+    uint64_t m_recordingJobIndex{0u};                 // guarded by m_recordingMutex, incremented per job
+    uint32_t m_pendingBatchesCount{0u};               // guarded by m_recordingMutex, the latch of the job
+    std::exception_ptr m_recordingError{};            // guarded by m_recordingMutex, rethrown by the render thread
+    bool m_is_recordingStopped{false};                // guarded by m_recordingMutex
+    double m_recordingTimeMs{0.0};
+    CommandBufferCache m_commandBufferCache;
+    RenderGraph m_renderGraph;  // rebuilt by every recordCommandBuffers
+    bool m_isBloomEnabled{true};
+    bool m_isRenderGraphDumpRequested{false};  // the compiled graph is logged after the next recording
+    // the per-frame attachments aliased by their lifetimes, recreated with the swapchain
+    TransientAttachmentAllocator m_transientAttachments;
+    // GPU times of the render graph passes, the query pools are recreated with the swapchain
+    GpuProfiler m_gpuProfiler;
+    bool m_isGpuTimingsExportRequested{false};
 
     // intermediate buffer being served for transferring data to gpu memory
     Model* mp_modelTransferSpace{nullptr};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GpuProfiler;
+struct StressScene;
+
+/// Frame statistics of the headless benchmark run (see HeadlessControl), written as a JSON report:
+///   - CPU frame time: wall time of VulkanRenderer::renderScene, GPU frame time: the frame scope of GpuProfiler
+///   - mean, p50, p95, p99 and max of both, the first WARMUP_FRAMES frames (pipeline variants, uploads) are left out
+///   - load time (renderer init), peak resident memory of the process and peak device memory of MemoryAllocator
+///   - average GPU time and pipeline statistics of every profiled pass over the last GpuProfiler::HISTORY_SIZE frames
+///   - object counts of the scene, reports of growing stress scenes show where a subsystem stops scaling
+/// Note: not thread safe
+class Benchmark {
+public:
+    static constexpr uint32_t WARMUP_FRAMES = 30u;
+    static constexpr float FIXED_TIME_STEP_MS = 1000.0f / 60.0f;
+
+    explicit Benchmark(double loadTimeMs) : m_loadTimeMs(loadTimeMs) {}
+
+    /// the GPU time is taken when the profiler resolved a new frame (a few frames later than the CPU one)
+    void addFrame(double cpuFrameMs, const GpuProfiler& gpuProfiler);
+
+    /// @return: false if the file isn't writable or the passes lack the pipeline statistics the device supports
+    bool writeReport(const std::string& filePath, const GpuProfiler& gpuProfiler, const std::string& deviceName,
+                     const StressScene& stressScene) const;
+
+private:
+    struct Summary {
+        double meanMs{0.0};
+        double p50Ms{0.0};
+        double p95Ms{0.0};
+        double p99Ms{0.0};
+        double maxMs{0.0};
+    };
+
+    static Summary summarize(std::vector<double> framesMs);
+
+    double m_loadTimeMs{0.0};
+    uint32_t m_framesCount{0u};
+    uint32_t m_gpuResolvedCount{0u};
+    std::vector<double> m_cpuFramesMs{};
+    std::vector<double> m_gpuFramesMs{};
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+/// CPU encoders of the BCn block compressed formats used by TextureCache, no external tools are needed.
+/// Every 4x4 block of texels is encoded on its own:
+///   - BC1: RGB 5:6:5 endpoints + 2 bit indices, 8 bytes, opaque color
+///   - BC3: BC4 alpha block + BC1 color block, 16 bytes, color with smooth alpha
+///   - BC5: two BC4 blocks (red and green), 16 bytes, two channel data such as tangent space normals
+///   - BC7: mode 6 only (one subset, RGBA 7.7.7.7 endpoints with p-bits + 4 bit indices), 16 bytes, color with alpha
+/// Endpoints are taken along the principal axis of the block colors, the indices are the closest palette entries.
+/// Note: quality is below the exhaustive encoders (no partitions, no endpoint refinement) but encoding is fast
+namespace BlockCompressor {
+enum class Format : uint8_t { BC1 = 0, BC3, BC5, BC7 };
+
+static constexpr uint32_t BLOCK_EXTENT = 4u;  // block is 4x4 texels
+
+uint32_t getBlockSize(Format format);
+
+/// bytes of the compressed image, the edge blocks are padded
+uint64_t getCompressedSize(Format format, uint32_t width, uint32_t height);
+
+/// rgba: width * height texels of 4 bytes, out: getCompressedSize(format, width, height) bytes
+/// Note: texels outside of the image in the edge blocks repeat the last column/row
+void compressImage(Format format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out);
+
+/// block: 16 texels of 4 bytes (row by row), out: getBlockSize(format) bytes
+void compressBlock(Format format, const uint8_t* block, uint8_t* out);
+}  // namespace BlockCompressor
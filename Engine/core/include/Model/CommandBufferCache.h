@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Utils.h"
+
+#include <volk.h>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+/// Secondary command buffers of the passes which record the same commands frame after frame (post-processing chain):
+///   - a pass of a swapchain image keeps its recorded buffer together with the hash of its inputs (render pass,
+///     framebuffer, pipeline, descriptor sets, draw counts, dynamic offsets, recorded push constants), see hashInputs
+///   - the buffer is re-recorded only when the hash differs from the recorded one
+///   - per-frame values must come from buffers, anything recorded into the command buffer is a part of the inputs
+/// The buffers are recorded with VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, a pass may be executed several times
+/// by one primary command buffer (blurring iterations).
+/// The draw and bind counts reported by recordFunc are kept with the buffer and added to FrameTelemetry by every get,
+/// a get is followed by one execution of the returned buffer.
+/// Note: descriptor sets written after recording invalidate the buffer, invalidate() must be called then
+///       (a resize keeping the image count does it, a new image count initializes the cache again).
+///       Not thread safe, used on the render thread
+class CommandBufferCache {
+public:
+    struct Stats {
+        uint32_t reusedCount{0u};
+        uint32_t recordedCount{0u};
+    };
+
+    /// the FrameTelemetry counters of the recorded commands
+    struct Counts {
+        uint32_t drawCalls{0u};
+        uint32_t descriptorBinds{0u};
+        uint32_t pipelineBinds{0u};
+    };
+
+    using RecordFunc = std::function<void(VkCommandBuffer, Counts&)>;
+
+    CommandBufferCache() = default;
+    CommandBufferCache(const CommandBufferCache&) = delete;
+    CommandBufferCache& operator=(const CommandBufferCache&) = delete;
+
+    ~CommandBufferCache() {
+        destroy();
+    }
+
+    /// pipelineStatistics: the statistics of the queries active while the buffers are executed, see GpuProfiler
+    void init(VkDevice device, uint32_t queueFamilyIndex, uint32_t imagesCount, uint32_t passesCount,
+              VkQueryPipelineStatisticFlags pipelineStatistics = 0u);
+
+    /// must be called before vkDestroyDevice
+    void destroy();
+
+    /// returns the secondary command buffer of the pass, recordFunc is called to fill it if the inputs differ from
+    /// the recorded ones, the buffer is begun for the first subpass of renderPassInfo and ended by the cache
+    VkCommandBuffer get(uint32_t imageIndex, uint32_t passIndex, uint64_t inputsHash, const VkRenderPassBeginInfo& renderPassInfo,
+                        const RecordFunc& recordFunc);
+
+    /// all the passes are re-recorded by the next get
+    void invalidate();
+
+    const Stats& getStats() const {
+        return m_stats;
+    }
+
+    void resetStats() {
+        m_stats = Stats{};
+    }
+
+    template <typename... Inputs>
+    static uint64_t hashInputs(const Inputs&... inputs) {
+        static_assert((std::is_trivially_copyable_v<Inputs> && ...), "inputs are hashed as raw bytes");
+        uint64_t hash = Utils::HASH_OFFSET_BASIS;
+        ((hash = Utils::hashBytes(hash, &inputs, sizeof(Inputs))), ...);
+        return hash;
+    }
+
+private:
+    struct Entry {
+        VkCommandBuffer cmdBuf{nullptr};
+        uint64_t inputsHash{0u};
+        Counts counts{};
+        bool is_recorded{false};
+    };
+
+    static void countExecution(const Counts& counts);
+
+    VkDevice m_device{nullptr};
+    VkCommandPool m_cmdPool{nullptr};
+    uint32_t m_passesCount{0u};
+    VkQueryPipelineStatisticFlags m_pipelineStatistics{0u};
+    std::vector<Entry> m_entries{};  // imageIndex * m_passesCount + passIndex
+    Stats m_stats{};
+};
@@ -10,6 +10,14 @@ namespace Constants {
 #endif
 	static constexpr std::string_view TEXTURES_DIR{ "textures" };
 	static constexpr std::string_view SHADERS_DIR{ "shaders" };
+	static constexpr std::string_view SHADERS_ARCHIVE{ "shaders.pak" };  // in SHADERS_DIR
 	static constexpr std::string_view MODEL_DIR = "models";
-	static constexpr std::string_view PIPELINE_CACHE_FILE{ "pipeline_data.cache" };
+	static constexpr std::string_view PIPELINE_CACHE_DIR{ "pipeline_cache" };
+	static constexpr std::string_view TEXTURE_CACHE_DIR{ "texture_cache" };
+	static constexpr std::string_view GPU_TIMINGS_FILE{ "gpu_timings.csv" };
+	static constexpr std::string_view CPU_TRACE_FILE{ "cpu_trace.json" };
+	static constexpr std::string_view BENCHMARK_REPORT_FILE{ "benchmark_report.json" };
+	static constexpr std::string_view TELEMETRY_FILE{ "frame_telemetry.csv" };
+	static constexpr std::string_view INPUT_RECORDING_FILE{ "input_recording.bin" };
+	static constexpr std::string_view LOG_FILE{ "engine.log" };
 }
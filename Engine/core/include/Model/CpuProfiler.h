@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Scoped CPU profiler writing Chrome trace JSON (chrome://tracing, ui.perfetto.dev):
+///   - PROFILE_SCOPE("name") records the enclosing block as a complete event of the calling thread, the name must be
+///     a literal (only the pointer is stored)
+///   - every thread writes into its own event buffer (single writer, no locks), a buffer is taken from the pool at the
+///     first event of the thread and returned when the thread exits, so short lived std::async workers reuse them
+///   - events are recorded only while a capture runs, otherwise a scope costs one relaxed atomic load
+///   - requestCapture arms a capture of the next frames (PROFILE_BEGIN_FRAME / PROFILE_END_FRAME of the main loop),
+///     the trace is written when the last captured frame ends
+/// Without USE_PROFILING the macros expand to nothing and no scope costs anything.
+/// Note: thread safe, events of the threads still running when a capture ends may be missing from its trace
+class CpuProfiler {
+public:
+    static constexpr uint32_t MAX_THREAD_EVENTS = 64u * 1024u;  // per thread and capture, the rest is dropped
+
+    class Scope {
+    public:
+        explicit Scope(const char* name)
+            : m_name(s_isCapturing.load(std::memory_order_relaxed) ? name : nullptr),
+              m_startTime(m_name ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+
+        ~Scope() {
+            if (m_name) {
+                CpuProfiler::getInstance().record(m_name, m_startTime, std::chrono::steady_clock::now());
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_name;
+        std::chrono::steady_clock::time_point m_startTime;
+    };
+
+private:
+    CpuProfiler();
+
+public:
+    static CpuProfiler& getInstance() {
+        static CpuProfiler cpuProfiler;
+        return cpuProfiler;
+    }
+
+    CpuProfiler(const CpuProfiler&) = delete;
+    CpuProfiler& operator=(const CpuProfiler&) = delete;
+
+    /// the trace of framesCount frames starting after skippedFrames frames is written into filePath
+    void requestCapture(uint32_t framesCount, std::string filePath, uint32_t skippedFrames = 0u);
+
+    bool isCapturing() const {
+        return s_isCapturing.load(std::memory_order_relaxed);
+    }
+
+    void beginFrame();
+    void endFrame();
+
+    /// the name of the calling thread in the trace (a literal), the others are "worker"
+    void setThreadName(const char* name);
+
+    void record(const char* name, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime);
+
+private:
+    struct Event {
+        const char* name{nullptr};
+        int64_t startNs{0};  // since m_epoch
+        int64_t durationNs{0};
+    };
+
+    struct ThreadBuffer {
+        std::unique_ptr<Event[]> events;     // allocated by the first captured event
+        std::atomic<uint32_t> eventsCount{0u};
+        std::atomic<uint32_t> captureIndex{0u};  // of the events, older ones are dropped by the owner thread
+        // guarded by m_buffersMutex
+        uint32_t threadId{0u};  // of the current owner
+        const char* threadName{"worker"};
+        bool is_owned{false};
+    };
+
+    friend struct ThreadBufferOwner;
+
+    ThreadBuffer* acquireBuffer();
+    void releaseBuffer(ThreadBuffer* buffer);
+    bool writeTrace() const;
+
+    static inline std::atomic<bool> s_isCapturing{false};
+
+    const std::chrono::steady_clock::time_point m_epoch;
+    std::atomic<uint32_t> m_captureIndex{0u};
+    mutable std::mutex m_buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;  // never freed, the pool of the thread buffers
+    uint32_t m_nextThreadId{1u};
+
+    // the frame state of the main loop thread
+    uint32_t m_skippedFrames{0u};
+    uint32_t m_remainingFrames{0u};
+    bool m_isCaptureRequested{false};
+    std::string m_filePath;
+    int64_t m_captureStartNs{0};
+    std::chrono::steady_clock::time_point m_frameStartTime{};
+};
+
+#if defined(USE_PROFILING) && USE_PROFILING
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) CpuProfiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD_NAME(name) CpuProfiler::getInstance().setThreadName(name)
+#define PROFILE_BEGIN_FRAME() CpuProfiler::getInstance().beginFrame()
+#define PROFILE_END_FRAME() CpuProfiler::getInstance().endFrame()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_BEGIN_FRAME()
+#define PROFILE_END_FRAME()
+#endif
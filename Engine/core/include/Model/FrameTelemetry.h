@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Per-frame telemetry of the render loop, the last HISTORY_SIZE frames are kept in a ring buffer:
+///   - CPU times of the loop phases (PhaseScope), the frame time is measured from beginFrame to endFrame
+///   - counters: draw calls, descriptor set and pipeline binds of the recorded command buffers (a reused cached pass
+///     adds the counts of its recording, see CommandBufferCache), queue submits, uploaded bytes (staging copies and host
+///     visible buffer writes) and skinned vertices
+///   - visible instances of the registered models per LOD, set by the render thread after the culling
+///   - every thread counts into its own block of monotonic counters, a single writer has no read-modify-write contention,
+///     endFrame sums the blocks and stores the difference to the sum of the previous frame
+///   - exportCsv writes a row per frame, the columns are named as in the thresholds
+///   - a threshold "<mean|p50|p95|p99|max> <column> <'<'|'<='|'>'|'>='> <value>" (e.g. "p95 frameMs < 16.6") is checked
+///     against the history without the first SKIPPED_FRAMES frames of loading hitches
+/// Note: count is thread safe, the rest is called by the render loop thread
+class FrameTelemetry {
+public:
+    static constexpr uint32_t HISTORY_SIZE = 1024u;
+    static constexpr uint32_t MAX_MODELS = 16u;
+    static constexpr uint32_t SKIPPED_FRAMES = 30u;
+
+    enum Phase : uint32_t {
+        PHASE_FRAME = 0,
+        PHASE_PHYSICS,
+        PHASE_UPDATE,     // animations and culling of the models
+        PHASE_STREAMING,  // texture streaming requests and updates
+        PHASE_RECORDING,
+        PHASE_SUBMIT,     // pending uploads, queue submit and present
+        PHASES_MAX
+    };
+
+    enum Counter : uint32_t {
+        DRAW_CALLS = 0,
+        DESCRIPTOR_BINDS,
+        PIPELINE_BINDS,
+        QUEUE_SUBMITS,
+        UPLOADED_BYTES,
+        SKINNED_VERTICES,
+        COUNTERS_MAX
+    };
+
+    struct FrameRecord {
+        uint64_t frameIndex{0u};
+        std::array<float, PHASES_MAX> phasesMs{};
+        std::array<uint64_t, COUNTERS_MAX> counters{};
+        std::array<uint32_t, MAX_MODELS> visibleInstances{};
+        std::array<uint32_t, MAX_MODELS> visibleLowPolyInstances{};
+    };
+
+    /// adds the elapsed time of the scope to the phase of the current frame
+    class PhaseScope {
+    public:
+        explicit PhaseScope(Phase phase) : m_phase(phase), m_startTime(std::chrono::steady_clock::now()) {}
+
+        ~PhaseScope() {
+            FrameTelemetry::getInstance().addPhaseTime(m_phase, std::chrono::steady_clock::now() - m_startTime);
+        }
+
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+
+    private:
+        Phase m_phase;
+        std::chrono::steady_clock::time_point m_startTime;
+    };
+
+private:
+    FrameTelemetry() = default;
+
+public:
+    static FrameTelemetry& getInstance() {
+        static FrameTelemetry frameTelemetry;
+        return frameTelemetry;
+    }
+
+    FrameTelemetry(const FrameTelemetry&) = delete;
+    FrameTelemetry& operator=(const FrameTelemetry&) = delete;
+
+    /// from any thread
+    static void count(Counter counter, uint64_t value = 1u);
+
+    void beginFrame();
+    void endFrame();
+
+    void addPhaseTime(Phase phase, std::chrono::steady_clock::duration duration) {
+        m_phasesTime[phase] += duration;
+    }
+
+    /// @return: the slot of the visible instances columns, models beyond MAX_MODELS share the last one
+    uint32_t registerModel(std::string name);
+    /// models sharing the slot add up
+    void addVisibleInstances(uint32_t modelSlot, std::size_t instancesCount, std::size_t lowPolyInstancesCount);
+
+    /// @return: false if the expression can't be parsed, the column is looked up by checkThresholds
+    bool addThreshold(std::string_view expression);
+
+    bool hasThresholds() const {
+        return !m_thresholds.empty();
+    }
+
+    /// logs the result of every threshold, @return: true if all of them pass
+    bool checkThresholds() const;
+
+    /// the history, a row per frame (oldest first)
+    bool exportCsv(const std::string& filePath) const;
+
+private:
+    struct ThreadCounters {
+        std::array<std::atomic<uint64_t>, COUNTERS_MAX> values{};  // monotonic, written by the owner thread only
+        bool is_owned{false};                                       // guarded by m_countersMutex
+    };
+
+    enum class Statistic { MEAN, P50, P95, P99, MAX };
+
+    struct Threshold {
+        std::string expression;
+        Statistic statistic{Statistic::MEAN};
+        std::string column;
+        bool is_less{true};
+        bool is_orEqual{false};
+        double value{0.0};
+    };
+
+    friend struct ThreadCountersOwner;
+
+    ThreadCounters* acquireCounters();
+    void releaseCounters(ThreadCounters* counters);
+
+    std::vector<std::string> getColumnNames() const;
+    static double getColumnValue(const FrameRecord& record, uint32_t column);
+    uint32_t getHistorySize() const {
+        return m_framesCount < HISTORY_SIZE ? static_cast<uint32_t>(m_framesCount) : HISTORY_SIZE;
+    }
+
+    std::mutex m_countersMutex;
+    std::vector<std::unique_ptr<ThreadCounters>> m_threadCounters;  // never freed, the blocks of exited threads are reused
+    std::array<uint64_t, COUNTERS_MAX> m_previousTotals{};
+
+    // the frame state of the render loop thread
+    std::chrono::steady_clock::time_point m_frameStartTime{};
+    std::array<std::chrono::steady_clock::duration, PHASES_MAX> m_phasesTime{};
+    FrameRecord m_currentRecord{};
+    std::vector<std::string> m_modelNames{};
+    std::vector<FrameRecord> m_history = std::vector<FrameRecord>(HISTORY_SIZE);
+    uint64_t m_framesCount{0u};
+    std::vector<Threshold> m_thresholds{};
+};
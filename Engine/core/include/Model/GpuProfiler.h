@@ -0,0 +1,173 @@
+#pragma once
+
+#include <volk.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// GPU time of the passes measured by timestamp queries:
+///   - a query pool per frame (swapchain image), its command buffer resets the queries and writes the scope timestamps
+///   - the results of a frame are read when its command buffer is recorded again: the fence of the previous submission
+///     is signaled by then, nothing waits for the GPU (a frame with unavailable results is dropped)
+///   - ticks are masked by timestampValidBits of the queue family and converted by timestampPeriod
+///   - every scope keeps a rolling history of HISTORY_SIZE resolved frames, see exportCsv
+/// Scopes nest (subpasses inside their render pass), the frame itself is the root scope. Timestamps inside a render pass
+/// have the subpass granularity, tile based GPUs report them approximately.
+/// Without timestampComputeAndGraphics or timestampValidBits the profiler is disabled and the calls do nothing.
+/// Pipeline statistics (initialized with is_pipelineStatisticsSupported and enabled) are queried for the children of
+/// the frame scope only, the queries of a type can't nest. The scope must then begin and end outside a render pass and
+/// the secondary command buffers it executes must inherit PIPELINE_STATISTICS.
+/// Note: not thread safe, the scopes are written into the primary command buffer on the render thread
+class GpuProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES = 64u;  // per frame, the frame scope included
+    static constexpr uint32_t HISTORY_SIZE = 256u;
+    static constexpr float NOT_RECORDED = -1.0f;  // history value of a frame without the scope
+
+    using ScopeHandle = uint32_t;
+    static constexpr ScopeHandle INVALID_SCOPE = UINT32_MAX;
+
+    // the results are written in the order of the bits
+    static constexpr VkQueryPipelineStatisticFlags PIPELINE_STATISTICS =
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_CONTROL_SHADER_PATCHES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT;
+
+    struct PipelineStatistics {
+        uint64_t inputVertices{0u};
+        uint64_t inputPrimitives{0u};
+        uint64_t vertexInvocations{0u};
+        uint64_t clippingPrimitives{0u};  // primitives output by the clipping stage
+        uint64_t fragmentInvocations{0u};
+        uint64_t tessControlPatches{0u};
+        uint64_t tessEvaluationInvocations{0u};
+
+        /// fragment shader invocations per pixel
+        float getOverdraw(uint64_t pixelsCount) const {
+            return pixelsCount != 0u ? static_cast<float>(fragmentInvocations) / static_cast<float>(pixelsCount) : 0.0f;
+        }
+
+        /// vertex shader invocations per primitive (average cache miss ratio): 3 for unshared triangles, ~0.5 is
+        /// the optimum of a regular triangle grid. Devices which shade every index report no reuse
+        float getACMR() const {
+            return inputPrimitives != 0u ? static_cast<float>(vertexInvocations) / static_cast<float>(inputPrimitives) : 0.0f;
+        }
+
+        /// share of the assembled vertices served by the post-transform cache
+        float getVertexReuse() const {
+            return inputVertices != 0u && vertexInvocations <= inputVertices
+                       ? 1.0f - static_cast<float>(vertexInvocations) / static_cast<float>(inputVertices)
+                       : 0.0f;
+        }
+    };
+
+    struct ScopeStats {
+        std::string name;
+        std::string path;  // names of the parent scopes and the scope separated by '/', identifies the scope
+        uint32_t level{0u};
+        float lastMs{NOT_RECORDED};  // of the last resolved frame
+        float averageMs{0.0f};       // over the recorded frames of the history
+        float maxMs{0.0f};
+        std::array<float, HISTORY_SIZE> history{};  // ring buffer, see getHistoryStart
+        bool has_statistics{false};                  // statistics of the last resolved frame
+        PipelineStatistics statistics{};
+    };
+
+    GpuProfiler() = default;
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    ~GpuProfiler() {
+        destroy();
+    }
+
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t framesCount,
+              bool is_pipelineStatisticsSupported = false);
+
+    /// must be called before vkDestroyDevice, the history is kept
+    void destroy();
+
+    bool isSupported() const {
+        return m_isSupported;
+    }
+
+    /// the flags the secondary command buffers must inherit, 0 if pipeline statistics are not supported
+    VkQueryPipelineStatisticFlags getPipelineStatisticsFlags() const {
+        return m_isPipelineStatisticsSupported ? PIPELINE_STATISTICS : 0u;
+    }
+
+    bool isPipelineStatisticsSupported() const {
+        return m_isPipelineStatisticsSupported;
+    }
+
+    /// the queries cost GPU time, they are disabled by default, takes effect from the next frame
+    void setPipelineStatisticsEnabled(bool is_enabled) {
+        m_isPipelineStatisticsEnabled = is_enabled;
+    }
+
+    /// resolves the previous submission of the frame, resets its queries and begins the frame scope,
+    /// must be recorded outside a render pass
+    void beginFrame(VkCommandBuffer cmdBuf, uint32_t frameIndex);
+    void endFrame(VkCommandBuffer cmdBuf);
+
+    ScopeHandle beginScope(VkCommandBuffer cmdBuf, std::string_view name);
+    void endScope(VkCommandBuffer cmdBuf, ScopeHandle scope);
+
+    /// the frame scope comes first, the rest in the order of their first appearance. The stats don't move (at most
+    /// MAX_SCOPES distinct scopes), their names stay valid while the profiler lives
+    const std::vector<ScopeStats>& getScopeStats() const {
+        return m_scopeStats;
+    }
+
+    /// index of the oldest frame in the histories
+    uint32_t getHistoryStart() const {
+        return m_resolvedCount < HISTORY_SIZE ? 0u : m_resolvedCount % HISTORY_SIZE;
+    }
+
+    uint32_t getHistorySize() const {
+        return m_resolvedCount < HISTORY_SIZE ? m_resolvedCount : HISTORY_SIZE;
+    }
+
+    /// frames resolved so far, lastMs of the stats belongs to the last one
+    uint32_t getResolvedCount() const {
+        return m_resolvedCount;
+    }
+
+    /// the history of all the scopes, a row per resolved frame (oldest first) and a column per scope path (ms)
+    bool exportCsv(const std::string& filePath) const;
+
+private:
+    struct Scope {
+        uint32_t statsIndex{0u};
+        uint32_t firstQuery{0u};  // begin, the end is the next one
+        uint32_t statisticsQuery{UINT32_MAX};
+    };
+
+    struct Frame {
+        VkQueryPool queryPool{nullptr};
+        VkQueryPool statisticsPool{nullptr};  // MAX_SCOPES pipeline statistics queries
+        std::vector<Scope> scopes;            // recorded into the last command buffer of the frame
+        uint32_t statisticsCount{0u};
+        bool is_statisticsEnabled{false};     // fixed for the frame when it begins
+    };
+
+    void resolveFrame(Frame& frame);
+    void resolveStatistics(const Frame& frame);
+    uint32_t findScopeStats(std::string_view name);
+
+    VkDevice m_device{nullptr};
+    bool m_isSupported{false};
+    bool m_isPipelineStatisticsSupported{false};
+    bool m_isPipelineStatisticsEnabled{false};
+    float m_timestampPeriod{1.0f};  // ns per tick
+    uint64_t m_timestampMask{UINT64_MAX};
+    std::vector<Frame> m_frames{};
+    Frame* mp_currentFrame{nullptr};          // recorded between beginFrame and endFrame
+    std::vector<uint32_t> m_openScopes{};     // stats indices of the scopes begun and not ended yet
+    std::vector<ScopeStats> m_scopeStats{};
+    uint32_t m_resolvedCount{0u};
+};
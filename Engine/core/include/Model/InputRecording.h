@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "IControl.h"
+#include "StressScene.h"
+
+/// Input of a session frame by frame (--record), replayed by HeadlessControl for reproducible performance runs (--replay):
+///   - a Frame per simulated frame: the buttons and the mouse of WindowQueueMSG and the time step the frame advanced by,
+///     the frames returning early on a resize or a resolution change don't simulate and aren't recorded
+///   - the header keeps the window size and the stress scene, its seed places the trees, bushes and smoke the same way
+///   - the replay advances the simulation by the recorded time steps instead of the measured ones: the animations, the
+///     tree falls and Bullet (fixed internal substeps accumulated from the same time steps) repeat the recorded session
+/// File layout: FileHeader, Frame per frame.
+/// Note: the UI states (hmiStates) aren't recorded, the replay runs with the default ones
+class InputRecording {
+public:
+    struct Frame {
+        float deltaTimeMS{0.0f};
+        uint16_t mouseX{0u};
+        uint16_t mouseY{0u};
+        uint8_t buttonFlag{0u};
+        uint8_t padding[3]{};  // keeps the file bytes defined
+    };
+
+    static constexpr uint32_t FORMAT_VERSION = 1u;
+
+    InputRecording() = default;
+    InputRecording(uint32_t width, uint32_t height, const StressScene& stressScene)
+        : m_width(width), m_height(height), m_stressScene(stressScene) {
+    }
+
+    void addFrame(const IControl::WindowQueueMSG& windowQueueMSG, float deltaTimeMS);
+
+    bool save(const std::string& filePath) const;
+
+    /// @return: false if the file can't be read or is of another format version, the recording is left empty then
+    bool load(const std::string& filePath);
+
+    const std::vector<Frame>& getFrames() const {
+        return m_frames;
+    }
+
+    uint32_t getWidth() const {
+        return m_width;
+    }
+
+    uint32_t getHeight() const {
+        return m_height;
+    }
+
+    const StressScene& getStressScene() const {
+        return m_stressScene;
+    }
+
+private:
+    struct FileHeader {
+        char identifier[8]{'I', 'N', 'P', 'U', 'T', 'R', 'E', 'C'};
+        uint32_t version{FORMAT_VERSION};
+        uint32_t width{0u};
+        uint32_t height{0u};
+        uint32_t framesCount{0u};
+        StressScene stressScene{};
+    };
+
+    uint32_t m_width{0u};
+    uint32_t m_height{0u};
+    StressScene m_stressScene{};
+    std::vector<Frame> m_frames{};
+};
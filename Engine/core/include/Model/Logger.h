@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// the messages below the level are compiled out (0: debug, 1: info, 2: warning, 3: critical only)
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL 0
+#endif
+
+/// Asynchronous logger behind Utils::printLog, the terminal and file I/O is done by a background thread:
+///   - a message is formatted by the logging thread and copied into its own ring buffer (single producer, single
+///     consumer, no lock), a thread flooding its ring drains the rings itself instead of dropping messages
+///   - a background thread drains the rings every DRAIN_PERIOD, orders the messages by time and writes them to the
+///     console and the optional log file, the file is rotated at maxFileBytes into filesCount files (path.1 is the newest)
+///   - filtering: the levels below LOG_COMPILED_LEVEL are compiled out, the ones below setLevel are skipped before
+///     formatting
+///   - rate limiting: a thread passes up to RATE_LIMIT_BURST equal messages per RATE_LIMIT_WINDOW, the suppressed repeats
+///     are counted and reported by the next passed one, the ones no passed repeat follows get a "repeated N times" line
+///     when another message takes their slot over, by flush, setLevel, a critical message and the shutdown
+///   - a critical message skips the rate limiting and is flushed before log returns, printLog throws after it
+/// Note: thread safe, the messages of the static destructors running after the logger go to the console directly
+class Logger {
+public:
+    enum class Level : uint8_t { DEBUG = 0, INFO, WARNING, CRITICAL, OFF };
+
+    template <Level level>
+    using LevelTag = std::integral_constant<Level, level>;
+
+    static constexpr Level COMPILED_LEVEL = static_cast<Level>(LOG_COMPILED_LEVEL);
+    static constexpr uint32_t RING_SIZE = 64u * 1024u;            // bytes per thread
+    static constexpr uint32_t MAX_MESSAGE_SIZE = RING_SIZE / 8u;  // longer messages are truncated
+    static constexpr uint32_t RATE_LIMIT_BURST = 10u;
+    static constexpr std::chrono::milliseconds RATE_LIMIT_WINDOW{1000};
+    static constexpr std::chrono::milliseconds DRAIN_PERIOD{20};
+    static constexpr uint64_t DEFAULT_FILE_SIZE = 16ull * 1024ull * 1024ull;
+    static constexpr uint32_t DEFAULT_FILES_COUNT = 3u;
+
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static Logger& getInstance() {
+        static Logger logger;
+        return logger;
+    }
+
+    static bool isEnabled(Level level) {
+        return level >= COMPILED_LEVEL && level >= s_level.load(std::memory_order_relaxed);
+    }
+
+    /// runtime filter, INFO by default, the logged messages are flushed first
+    static void setLevel(Level level);
+
+    /// "debug", "info", "warning", "critical" or "off", @return: false for another name
+    static bool parseLevel(std::string_view name, Level& outLevel);
+
+    /// from any thread, the text is copied
+    static void log(Level level, std::string_view text);
+
+    /// the messages logged before the call are written when it returns
+    static void flush();
+
+    /// the text of the arguments in a buffer of the calling thread, valid until its next call
+    template <class... Args>
+    static std::string_view format(const Args&... args) {
+        thread_local std::ostringstream stream;
+        // rewinding keeps the allocated buffer, the view is cut at the end of this message
+        stream.seekp(0);
+        (stream << ... << args);
+        return stream.view().substr(0u, static_cast<size_t>(stream.tellp()));
+    }
+
+    /// the messages go to the file too, the previous file of the path becomes path.1, @return: false if it isn't writable
+    bool setFile(const std::string& filePath, uint64_t maxFileBytes = DEFAULT_FILE_SIZE,
+                 uint32_t filesCount = DEFAULT_FILES_COUNT);
+
+private:
+    struct ThreadRing;
+    struct Record;
+
+    Logger();
+
+    void write(Level level, std::string_view text);
+    /// copies the message into the ring of the calling thread
+    void push(ThreadRing& ring, Level level, int64_t timeNs, uint32_t suppressedCount, bool is_repeatsReport,
+              std::string_view text);
+    ThreadRing* acquireRing();
+    void releaseRing(ThreadRing* ring);
+    /// the consumer side of the rings, guarded by m_drainMutex, is_reportingRepeats: the pending suppressed repeats
+    /// are reported too
+    void drain(bool is_reportingRepeats = false);
+    void writeToSinks(const std::string& text);
+    void rotateFile();
+    void run();
+
+    friend struct ThreadRingOwner;
+
+    static inline std::atomic<Level> s_level{Level::INFO};
+    static inline std::atomic<bool> s_is_destroyed{false};
+
+    const std::chrono::steady_clock::time_point m_startTime{std::chrono::steady_clock::now()};
+
+    std::mutex m_ringsMutex;
+    std::vector<std::unique_ptr<ThreadRing>> m_rings;  // never freed, the rings of exited threads are reused
+
+    std::mutex m_drainMutex;
+    std::vector<Record> m_records;  // drained in a pass, reused
+    std::string m_output;           // written in a pass, reused
+    std::unique_ptr<std::ofstream> m_file;
+    std::string m_filePath;
+    uint64_t m_fileBytes{0u};
+    uint64_t m_maxFileBytes{DEFAULT_FILE_SIZE};
+    uint32_t m_filesCount{DEFAULT_FILES_COUNT};
+
+    std::mutex m_threadMutex;
+    std::condition_variable m_threadCondition;
+    bool m_is_stopping{false};  // guarded by m_threadMutex
+    std::thread m_thread;
+};
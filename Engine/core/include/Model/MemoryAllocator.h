@@ -0,0 +1,205 @@
+#pragma once
+
+#include <volk.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/// GPU memory sub-allocator used by Utils::VulkanCreateBuffer / Utils::VulkanCreateImage.
+/// Instead of one vkAllocateMemory per resource (the driver limit maxMemoryAllocationCount may be as low as 4096)
+/// device memory is taken from big blocks, grouped by memory type and resource kind:
+///   - TLSF pool (two-level segregated fit, O(1) alloc/free) for long-lived resources: textures, meshes, kernels ...
+///   - linear arena for transient resources: size dependent attachments which are destroyed all together on resize
+///   - dedicated vkAllocateMemory for huge resources (8000x8000 shadow and footprint maps) or if the driver prefers it
+/// Every allocation is tagged by a Category, the live and peak bytes are accounted per heap and category. Memory allocated
+/// by its owner (aliased transient attachments, exported buffers) is accounted by registerMemory/unregisterMemory.
+/// A heap growing over BUDGET_WARNING_RATIO of its budget (VK_EXT_memory_budget, the heap size without it) is logged.
+/// Host visible buffers are sub-allocated as well: a block is mapped once by its first host visible allocation and stays
+/// mapped until it is freed, the callers write through getMappedData() instead of vkMapMemory.
+/// Note: a VkDeviceMemory can't be mapped twice, don't call vkMapMemory on the memory of the allocator
+class MemoryAllocator {
+public:
+    enum class Usage : uint8_t {
+        AUTO = 0,    // derived from the resource: attachments -> TRANSIENT, huge -> DEDICATED, rest -> LONG_LIVED
+        LONG_LIVED,  // TLSF pool
+        TRANSIENT,   // linear arena, the whole arena is reset once all its allocations are released
+        DEDICATED    // own VkDeviceMemory
+    };
+
+    enum class Strategy : uint8_t { TLSF = 0, LINEAR, DEDICATED };
+
+    enum class Category : uint8_t {
+        AUTO = 0,    // derived from the resource usage flags, see getBufferCategory/getImageCategory
+        ATTACHMENT,  // render targets, the swapchain images of the headless mode
+        TEXTURE,
+        MESH,        // vertices and indices
+        INSTANCE,    // host visible per swapchain image instance buffers
+        STAGING,
+        UNIFORM,
+        OTHER,       // storage buffers
+        MAX
+    };
+
+    struct Allocation {
+        VkDeviceMemory memory{nullptr};
+        VkDeviceSize offset{0u};
+        VkDeviceSize size{0u};
+        uint32_t memoryTypeIndex{0u};
+        uint32_t blockId{0u};
+        uint32_t nodeId{0u};  // TLSF node, unused by other strategies
+        Strategy strategy{Strategy::DEDICATED};
+        Category category{Category::OTHER};
+        void* mappedData{nullptr};  // the block mapping + offset, host visible buffers only
+    };
+
+    struct Stats {
+        uint32_t blockCount{0u};
+        uint32_t allocationCount{0u};
+        uint32_t dedicatedCount{0u};
+        VkDeviceSize blockBytes{0u};      // reserved by pools and arenas
+        VkDeviceSize usedBytes{0u};       // handed out from pools and arenas
+        VkDeviceSize dedicatedBytes{0u};  // dedicated allocations
+        VkDeviceSize externalBytes{0u};   // registered by the owners of the memory
+        VkDeviceSize peakBytes{0u};       // peak of blockBytes + dedicatedBytes + externalBytes
+    };
+
+    struct CategoryStats {
+        uint32_t count{0u};
+        VkDeviceSize liveBytes{0u};  // of the resources, the unused space of the blocks is not attributed
+        VkDeviceSize peakBytes{0u};
+    };
+
+    struct HeapStats {
+        VkDeviceSize size{0u};
+        bool is_deviceLocal{false};
+        VkDeviceSize liveBytes{0u};    // taken from the driver: blocks, dedicated and registered memory
+        VkDeviceSize peakBytes{0u};
+        VkDeviceSize budgetBytes{0u};  // VK_EXT_memory_budget, the heap size without it
+        VkDeviceSize usageBytes{0u};   // by the process as seen by the OS, liveBytes without VK_EXT_memory_budget
+        std::array<CategoryStats, static_cast<size_t>(Category::MAX)> categories{};
+    };
+
+    /// block that could be emptied by moving its allocations into other blocks of the same pool
+    struct DefragCandidate {
+        uint64_t resource{0u};  // VkBuffer/VkImage handle
+        uint32_t memoryTypeIndex{0u};
+        uint32_t blockId{0u};
+        VkDeviceSize size{0u};
+        float blockOccupancy{0.0f};
+    };
+
+    static constexpr VkDeviceSize BLOCK_SIZE = 64ull * 1024ull * 1024ull;
+    static constexpr VkDeviceSize DEDICATED_THRESHOLD = BLOCK_SIZE / 2ull;
+    static constexpr float BUDGET_WARNING_RATIO = 0.9f;
+
+private:
+    MemoryAllocator() = default;
+
+public:
+    static MemoryAllocator& getInstance() {
+        static MemoryAllocator allocator;
+        return allocator;
+    }
+
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+    /// must be called right after the logical device creation
+    /// is_memoryBudgetEnabled: VK_EXT_memory_budget is enabled on the device, see getDeviceLocalBudget()
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, bool is_memoryBudgetEnabled = false);
+
+    /// releases all blocks, must be called before vkDestroyDevice
+    void destroy();
+
+    bool isInitialized() const {
+        return m_device != nullptr;
+    }
+
+    /// allocates memory and binds it to the buffer
+    VkResult allocateBuffer(VkBuffer buffer, VkBufferUsageFlags bufferUsage, VkMemoryPropertyFlags properties, Usage usage,
+                            Category category, Allocation& outAllocation);
+
+    /// allocates memory and binds it to the image, attachments are treated as transient by Usage::AUTO
+    VkResult allocateImage(VkImage image, VkImageTiling tiling, VkImageUsageFlags imageUsage, VkMemoryPropertyFlags properties,
+                           Usage usage, Category category, Allocation& outAllocation);
+
+    /// accounts the memory allocated by the caller by vkAllocateMemory, unregisterMemory before vkFreeMemory
+    void registerMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex, Category category);
+    /// returns false if the memory was not registered
+    bool unregisterMemory(VkDeviceMemory memory);
+
+    static Category getBufferCategory(VkBufferUsageFlags bufferUsage, VkMemoryPropertyFlags properties);
+    static Category getImageCategory(VkImageUsageFlags imageUsage);
+    static const char* getCategoryName(Category category);
+
+    /// returns false if the resource is unknown to the allocator (memory was allocated outside of it)
+    bool freeBuffer(VkBuffer buffer);
+    bool freeImage(VkImage image);
+
+    /// persistent mapping of a host visible buffer, valid until the buffer is freed, nullptr for other buffers
+    void* getMappedData(VkBuffer buffer) const;
+
+    /// budget and usage of the device local heaps as seen by the OS (other processes included),
+    /// returns false if VK_EXT_memory_budget is not enabled
+    bool getDeviceLocalBudget(VkDeviceSize& outBudget, VkDeviceSize& outUsage) const;
+
+    Stats getStats(uint32_t memoryTypeIndex) const;
+    Stats getTotalStats() const;
+    /// per heap, the budget is queried on every call
+    std::vector<HeapStats> getHeapStats() const;
+    /// per memory type, heap and category
+    void printStats() const;
+
+    /// defragmentation hooks: the allocator can't move resources by itself (buffers/images can't be rebound),
+    /// the owner recreates every returned resource and releases the old one, afterwards releaseEmptyBlocks() gives
+    /// memory back to the driver
+    std::vector<DefragCandidate> getDefragCandidates(float maxBlockOccupancy = 0.25f) const;
+    VkDeviceSize releaseEmptyBlocks();
+
+private:
+    class TlsfBlock;
+    class LinearBlock;
+
+    struct Pool {
+        std::vector<std::unique_ptr<TlsfBlock>> tlsfBlocks;
+        std::vector<std::unique_ptr<LinearBlock>> linearBlocks;
+    };
+
+    /// linear resources (buffers, linear images) and optimal images live in separate pools,
+    /// thus bufferImageGranularity never has to be taken into account
+    enum PoolKind : uint8_t { LINEAR_RESOURCES = 0, OPTIMAL_IMAGES, POOL_KIND_MAX };
+
+    VkResult allocate(const VkMemoryRequirements& memRequirements, VkMemoryPropertyFlags properties, Usage usage,
+                      PoolKind kind, const VkMemoryDedicatedAllocateInfo& dedicatedInfo, bool isDedicatedPreferred,
+                      Allocation& outAllocation);
+    VkResult allocateDedicated(const VkMemoryRequirements& memRequirements, uint32_t memoryTypeIndex,
+                               const VkMemoryDedicatedAllocateInfo& dedicatedInfo, Allocation& outAllocation);
+    bool free(uint64_t resource);
+    /// maps the block of the allocation on its first use, @return: nullptr if vkMapMemory fails
+    void* map(const Allocation& allocation, PoolKind kind);
+    uint32_t findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const;
+    void updatePeak(uint32_t memoryTypeIndex);
+    /// the heap accounting of the memory taken from or given back to the driver, the growth checks the budget
+    void addHeapBytes(uint32_t memoryTypeIndex, VkDeviceSize size);
+    void removeHeapBytes(uint32_t memoryTypeIndex, VkDeviceSize size);
+    void addCategoryBytes(const Allocation& allocation);
+    void removeCategoryBytes(const Allocation& allocation);
+    void queryBudget(std::vector<HeapStats>& heapStats) const;
+    void checkBudget(uint32_t heapIndex);
+
+    VkDevice m_device{nullptr};
+    VkPhysicalDevice m_physicalDevice{nullptr};
+    bool m_is_memoryBudgetEnabled{false};
+    VkPhysicalDeviceMemoryProperties m_memProperties{};
+    std::array<std::array<Pool, POOL_KIND_MAX>, VK_MAX_MEMORY_TYPES> m_pools{};
+    std::array<Stats, VK_MAX_MEMORY_TYPES> m_stats{};
+    std::array<HeapStats, VK_MAX_MEMORY_HEAPS> m_heapStats{};
+    std::array<bool, VK_MAX_MEMORY_HEAPS> m_is_overBudget{};  // the warning is logged once per crossing
+    std::unordered_map<uint64_t, std::pair<Allocation, PoolKind>> m_allocations{};
+    std::unordered_map<uint64_t, Allocation> m_externalMemories{};
+    uint32_t m_nextBlockId{1u};
+    mutable std::mutex m_mutex;
+};
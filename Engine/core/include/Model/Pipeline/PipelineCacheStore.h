@@ -0,0 +1,69 @@
+#pragma once
+
+#include <volk.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// On-disk store of the VkPipelineCache data:
+///   - a file per device, driver (pipelineCacheUUID, driverVersion) and engine shaders hash, so another GPU, driver or
+///     shaders set never gets a foreign cache and switching back finds its own file
+///   - the file header, the data checksum and the Vulkan cache header (VkPipelineCacheHeaderVersionOne) are validated on load
+///   - save writes a temporary file and renames it, a crash mid-write leaves the previous file intact
+///   - the least recently written files of the other keys are removed once the directory grows above maxBytes
+/// Note: not thread safe, used by Pipeliner on the render thread
+class PipelineCacheStore {
+public:
+    struct Stats {
+        bool is_loaded{false};   // the driver got the data of the previous run
+        uint64_t loadedBytes{0u};
+        uint64_t savedBytes{0u};
+        uint64_t prunedFilesCount{0u};
+        double loadTimeMs{0.0};
+        double saveTimeMs{0.0};
+    };
+
+    static constexpr uint32_t FORMAT_VERSION = 1u;
+    static constexpr uint64_t MAX_BYTES = 64ull * 1024ull * 1024ull;  // 0 disables pruning
+
+    explicit PipelineCacheStore(std::string_view cacheDir, uint64_t maxBytes = MAX_BYTES)
+        : m_cacheDir(cacheDir), m_maxBytes(maxBytes) {}
+
+    /// must be called before load/save, shadersHash identifies the shaders set (see hashShaders)
+    void init(const VkPhysicalDeviceProperties& properties, uint64_t shadersHash);
+
+    /// returns false if there is no file of the current key or it doesn't pass the validation, outData is empty then
+    bool load(std::vector<char>& outData);
+
+    bool save(const std::vector<char>& data);
+
+    const Stats& getStats() const {
+        return m_stats;
+    }
+
+    /// hash of the names and the content of all the SPIR-V files and shader archives of the directory
+    static uint64_t hashShaders(std::string_view shadersDir);
+
+private:
+    struct FileHeader {
+        char identifier[8]{'P', 'I', 'P', 'E', 'C', 'A', 'C', 'H'};
+        uint32_t version{FORMAT_VERSION};
+        uint32_t vendorID{0u};
+        uint32_t deviceID{0u};
+        uint32_t driverVersion{0u};
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE]{};
+        uint64_t shadersHash{0u};
+        uint64_t dataSize{0u};
+        uint64_t dataHash{0u};  // checksum of the data
+    };
+
+    bool isCompatible(const std::vector<char>& data) const;
+    void prune();
+
+    std::string m_cacheDir;
+    uint64_t m_maxBytes{MAX_BYTES};
+    std::string m_filePath{};
+    FileHeader m_header{};
+    Stats m_stats{};
+};
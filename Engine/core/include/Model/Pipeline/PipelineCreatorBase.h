@@ -5,13 +5,25 @@
 
 #include <cassert>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 class PipelineCreatorBase {
 public:
     using descriptor_set_layout_ptr = std::unique_ptr<VkDescriptorSetLayout, std::function<void(VkDescriptorSetLayout* p)>>;
 
+    /// quality knob of the shaders: a specialization constant, so the driver folds the loops and branches depending on it.
+    /// Every combination of the levels is a variant of the pipeline, compiled on demand or prewarmed in background
+    struct QualityParameter {
+        std::string_view name{};
+        uint32_t constantId{0u};
+        std::vector<uint32_t> levels{};  // values of the constant, from the lowest quality to the highest
+        uint32_t level{0u};              // index of the requested value
+    };
+
     PipelineCreatorBase(const VulkanState& vkState, VkRenderPass& renderPass, std::string_view vertShader,
                         std::string_view fragShader, uint32_t subpass = 0u, VkPushConstantRange pushConstantRange = {0u, 0u, 0u})
         : m_vkState(vkState),
@@ -25,6 +37,7 @@ public:
     }
 
     virtual ~PipelineCreatorBase() {
+        waitVariants();
         destroyDescriptorPool();
         // setLayout must be deleted before destroying the samplers since they are integrated
         m_descriptorSetLayout.reset();
@@ -34,10 +47,16 @@ public:
             vkDestroySampler(m_vkState._core.getDevice(), m_samplerCommonPostEffect, nullptr);
     };
 
-    virtual void recreate() final;
+    /// recreates the pipelines of all the creators: the descriptions are made one by one (descriptor set layouts and
+    /// other resources of the creators are not thread safe), then the pipelines are compiled in parallel
+    static void recreate(const std::vector<PipelineCreatorBase*>& pipelineCreators);
+
     virtual void destroyDescriptorPool() final;
     virtual void createDescriptorPool() = 0;
     virtual void recreateDescriptors() = 0;
+    /// a resize keeping the swapchain image count keeps the pool and the sets, it reallocates the attachments only:
+    /// the bindings referencing them are written again, the creators without such bindings have nothing to do
+    virtual void updateAttachmentDescriptors() {}
     virtual const VkDescriptorSet* getDescriptorSet(uint32_t descriptorSetsIndex, uint32_t materialId = 0u) const = 0;
 
     inline const Pipeliner::pipeline_ptr& getPipeline() const {
@@ -48,13 +67,44 @@ public:
         return m_pushConstantRange.size != 0u;
     }
 
+    /// must be declared before the first recreation, defaultLevel is the index of the initial value in levels
+    void declareQualityParameter(std::string_view name, uint32_t constantId, std::vector<uint32_t> levels, uint32_t defaultLevel);
+
+    inline const std::vector<QualityParameter>& getQualityParameters() const {
+        return m_qualityParameters;
+    }
+
+    /// the current pipeline is used until the variant of the new level is compiled, see updateVariants()
+    void setQualityLevel(size_t parameterIndex, uint32_t level);
+
+    /// true while the requested variant is compiled in background
+    bool isVariantPending() const;
+
+    /// compiles in background the variants of every level of each parameter, the other parameters keep their levels
+    void prewarmVariants();
+
+    /// takes the compiled variants and switches to the requested one,
+    /// must be called on the render thread before recording, the replaced pipeline is kept for the frames in flight
+    void updateVariants();
+
+    /// blocks until the background compilations are complete, they use the shared pipeline cache
+    void waitVariants();
+
     const VkSampler* getOrCreateDepthSampler();
 
     const VkSampler* getOrCreateCommonSampler();
 
 private:
     virtual void createDescriptorSetLayout() = 0;
-    virtual void createPipeline() = 0;
+    /// customizes the description of the pipeline, it's filled by the defaults and the common states of the creator
+    virtual void describePipeline(Pipeliner::Description& description) = 0;
+
+    Pipeliner::Description prepareRecreation();
+
+    using variant_key = std::vector<uint32_t>;  // values of the quality parameters
+
+    variant_key getRequestedVariant() const;
+    void compileVariant(const variant_key& variant);
 
 protected:
     const VulkanState& m_vkState;
@@ -63,11 +113,18 @@ protected:
     std::string_view m_vertShader{};
     std::string_view m_fragShader{};
     descriptor_set_layout_ptr m_descriptorSetLayout{nullptr};
+    std::vector<VkDescriptorSetLayoutBinding> m_layoutBindings{};  // of m_descriptorSetLayout, to validate the shaders
     uint32_t m_subpassAmount{0u};
     VkPushConstantRange m_pushConstantRange{0u, 0u, 0u};
     Pipeliner::pipeline_ptr m_pipeline{nullptr};
 
 private:
+    std::vector<QualityParameter> m_qualityParameters{};
+    Pipeliner::Description m_description{};  // of the last recreation, the variants differ by the constants only
+    variant_key m_activeVariant{};
+    std::map<variant_key, Pipeliner::pipeline_ptr> m_variants{};  // compiled, not active
+    std::map<variant_key, std::future<Pipeliner::pipeline_ptr>> m_pendingVariants{};
+
     VkSampler m_samplerDepthCompare{nullptr}; // use getOrCreateDepthSampler() to get and init (on demand)
     VkSampler m_samplerCommonPostEffect{nullptr}; // blur ...
 };
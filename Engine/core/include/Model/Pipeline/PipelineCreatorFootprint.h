@@ -25,7 +25,7 @@ public:
     }
 
 private:
-    void createPipeline() override;
+    void describePipeline(Pipeliner::Description& description) override;
     void createDescriptorSetLayout() override;
     uint32_t createDescriptorWithId(std::weak_ptr<TextureFactory::Texture>, VkSampler, uint32_t materialId);
 
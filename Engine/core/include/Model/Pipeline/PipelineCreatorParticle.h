@@ -36,7 +36,7 @@ public:
     }
 
 private:
-    void createPipeline() override;
+    void describePipeline(Pipeliner::Description& description) override;
     void createDescriptorSetLayout() override;
     uint32_t createDescriptorWithId(std::weak_ptr<TextureFactory::Texture> particleTexture, VkSampler particleSampler,
                                     std::weak_ptr<TextureFactory::Texture> gradientTexture, VkSampler gradientSampler,
@@ -9,31 +9,29 @@ public:
 
     PipelineCreatorQuad(const VulkanState& vkState, VkRenderPass& renderPass, std::string_view vertShader,
                         std::string_view fragShader, bool isDepthNeeded = false, bool isGPassNeeded = false,
-                        uint32_t subpass = 0u, VkPushConstantRange pushConstantRange = {0u, 0u, 0u}, bool isWindowSizeTarget = false)
+                        uint32_t subpass = 0u, VkPushConstantRange pushConstantRange = {0u, 0u, 0u})
         : PipelineCreatorBase(vkState, renderPass, vertShader, fragShader, subpass, pushConstantRange),
           m_blend(BLEND::NONE),
           m_isDepthNeeded(isDepthNeeded),
           m_isGPassNeeded(isGPassNeeded),
-          m_isWindowSizeTarget(isWindowSizeTarget),
           m_colorBuffer(&vkState._colorBuffer) {
         assert(m_colorBuffer);
     }
 
     PipelineCreatorQuad(const VulkanState& vkState, VkRenderPass& renderPass, std::string_view vertShader,
                         std::string_view fragShader, VulkanState::ColorBuffer* colorBuffer, BLEND blend = BLEND::NONE,
-                        bool isDepthNeeded = false, VkPushConstantRange pushConstantRange = {0u, 0u, 0u},
-                        bool isWindowSizeTarget = false)
+                        bool isDepthNeeded = false, VkPushConstantRange pushConstantRange = {0u, 0u, 0u})
         : PipelineCreatorBase(vkState, renderPass, vertShader, fragShader, 0u, pushConstantRange),
           m_blend(blend),
           m_isDepthNeeded(isDepthNeeded),
           m_isGPassNeeded(false),
-          m_isWindowSizeTarget(isWindowSizeTarget),
           m_colorBuffer(colorBuffer) {
         assert(m_colorBuffer);
     }
 
     void createDescriptorPool() override;
     void recreateDescriptors() override;
+    void updateAttachmentDescriptors() override;
 
     const VkDescriptorSet* getDescriptorSet(uint32_t descriptorSetsIndex, uint32_t materialId = 0u) const override {
         assert(descriptorSetsIndex < m_descriptorSets.size());
@@ -41,17 +39,18 @@ public:
     }
 
 protected:
-    void createPipeline() override;
+    void describePipeline(Pipeliner::Description& description) override;
 
 private:
     void createDescriptorSetLayout() override;
     uint32_t getInputBindingsAmount() const;
+    /// writes the bindings of the allocated sets, the view projection UBO is skipped by isAttachmentsOnly
+    void writeDescriptors(bool isAttachmentsOnly);
 
 private:
     BLEND m_blend{BLEND::NONE};
     bool m_isDepthNeeded{false};
     bool m_isGPassNeeded{false};
-    bool m_isWindowSizeTarget{false};
 
 protected:
     descriptorSets m_descriptorSets{};
@@ -22,10 +22,13 @@ public:
 
     void createDescriptorPool() override;
     void recreateDescriptors() override;
+    void updateAttachmentDescriptors() override;
 
 private:
-    void createPipeline() override;
+    void describePipeline(Pipeliner::Description& description) override;
     void createDescriptorSetLayout() override;
+    /// writes the bindings of the allocated sets, the noise texture and the UBOs are skipped by isAttachmentsOnly
+    void writeDescriptors(bool isAttachmentsOnly);
 
 private:
     UBOSemiSpheraKernel m_ubo;
@@ -16,6 +16,6 @@ public:
     void createDescriptorPool() override;
 
 private:
-    void createPipeline() override;
+    void describePipeline(Pipeliner::Description& description) override;
     void createDescriptorSetLayout() override;
 };
@@ -21,7 +21,7 @@ public:
     }
 
 private:
-    void createPipeline() override;
+    void describePipeline(Pipeliner::Description& description) override;
     void createDescriptorSetLayout() override;
 
 protected:
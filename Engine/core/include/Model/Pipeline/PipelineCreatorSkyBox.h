@@ -11,5 +11,5 @@ public:
     }
 
 private:
-    void createPipeline() override;
+    void describePipeline(Pipeliner::Description& description) override;
 };
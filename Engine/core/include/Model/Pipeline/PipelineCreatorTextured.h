@@ -6,6 +6,15 @@
 
 class PipelineCreatorTextured : public PipelineCreatorBase {
 public:
+    /// entry of the materials storage buffer of the bindless mode (std430)
+    struct BindlessMaterial {
+        uint32_t textureIndex{0u};  // in the sampled images array
+        uint32_t layersCount{1u};   // diffuse, bump (optional)
+        uint32_t padding[2]{};
+    };
+
+    static constexpr uint32_t MAX_BINDLESS_MATERIALS = 1024u;
+
     PipelineCreatorTextured(const VulkanState& vkState, VkRenderPass& renderPass, std::string_view vertShader,
                             std::string_view fragShader, uint32_t subpass = 0u,
                             VkPushConstantRange pushConstantRange = {0u, 0u, 0u})
@@ -22,8 +31,22 @@ public:
         m_isTessellated = !m_tessCtrlShader.empty() && !m_tessEvalShader.empty();
     }
 
+    ~PipelineCreatorTextured() override;
+
+    /// bindless mode: the textures of all the materials are in one sampled images array and the materials in one storage
+    /// buffer, a draw binds one descriptor set per frame and pushes the material index (createDescriptor() result).
+    /// Must be called before the first recreation, falls back to a descriptor set per material if the device doesn't
+    /// support descriptor indexing or fragShader is not shipped
+    void requestBindless(std::string_view fragShader);
+
+    /// valid after the descriptor pool or the pipeline is created
+    bool isBindless() const {
+        return m_isBindless;
+    }
+
     void createDescriptorPool() override;
     void recreateDescriptors() override;
+    void updateAttachmentDescriptors() override;
     const VkDescriptorSet* getDescriptorSet(uint32_t descriptorSetsIndex, uint32_t materialId = 0u) const override;
 
     virtual uint32_t createDescriptor(std::weak_ptr<TextureFactory::Texture>, VkSampler);
@@ -35,9 +58,14 @@ public:
 
 private:
     void createDescriptorSetLayout() override;
-    void createPipeline() override;
+    void describePipeline(Pipeliner::Description& description) override;
     uint32_t createDescriptorWithId(std::weak_ptr<TextureFactory::Texture>, VkSampler, uint32_t materialId);
 
+    void resolveBindless();
+    uint32_t createBindlessMaterial(std::weak_ptr<TextureFactory::Texture>, VkSampler);
+    void allocateBindlessSets();
+    void writeBindlessTexture(uint32_t textureIndex);
+
 protected:
     uint32_t m_maxObjectsCount{0u};
     uint32_t m_curMaterialId{0u};
@@ -45,4 +73,15 @@ protected:
     std::string_view m_tessEvalShader{};
     bool m_isTessellated{false};
     std::unordered_map<uint32_t, I3DModel::Material> m_descriptorSets{};
+
+private:
+    std::string_view m_bindlessFragShader{};
+    bool m_isBindlessResolved{false};
+    bool m_isBindless{false};
+    std::vector<I3DModel::Material> m_bindlessTextures{};  // the descriptor sets are shared, see m_bindlessSets
+    std::vector<VkDescriptorSet> m_bindlessSets{};         // per swapchain image
+    uint32_t m_bindlessMaterialsCount{0u};
+    VkBuffer m_materialsBuffer{nullptr};
+    VkDeviceMemory m_materialsBufferMemory{nullptr};
+    BindlessMaterial* m_materials{nullptr};  // mapped m_materialsBuffer
 };
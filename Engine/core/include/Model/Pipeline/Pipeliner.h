@@ -1,7 +1,11 @@
 #pragma once
 
 #include <volk.h>
+#include <array>
+#include "Constants.h"
+#include "PipelineCacheStore.h"
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,12 +25,68 @@ public:
 
     static constexpr uint8_t MAX_COLOR_ATTACHMENTS = 4u;  // TO DO make it flexible
 
+    /// 32 bit value of a specialization constant (int, uint or bool) of any stage,
+    /// ids which a shader doesn't declare are ignored by the driver, the ones no stage declares are logged
+    struct SpecializationConstant {
+        uint32_t constantId{0u};
+        uint32_t value{0u};
+    };
+
+    /// Everything needed to compile one pipeline, a copy of getDefaultDescription() customized by the pipeline creator.
+    /// It owns all the data it refers to (the pointers of the create infos are set on compilation only),
+    /// so descriptions of different pipelines are independent and can be compiled concurrently.
+    /// Viewport and scissor are dynamic states set by the size of the render pass on recording,
+    /// the pipelines don't depend on the resolution and survive swapchain resizes
+    struct Description {
+        std::string_view vertShader{};
+        std::string_view fragShader{};
+        std::string_view tessCtrlShader{};  // tessellation is enabled if both tessellation shaders are set
+        std::string_view tessEvalShader{};
+        VkDescriptorSetLayout descriptorSetLayout{nullptr};
+        VkRenderPass renderPass{nullptr};
+        uint32_t subpass{0u};
+        VkPushConstantRange pushConstantRange{0u, 0u, 0u};
+        /// bindings of descriptorSetLayout, the shaders are validated against them
+        std::vector<VkDescriptorSetLayoutBinding> layoutBindings{};
+        /// variant of the shaders, the driver folds the constants on compilation
+        std::vector<SpecializationConstant> specializationConstants{};
+
+        std::vector<VkVertexInputBindingDescription> vertexBindings{};
+        std::vector<VkVertexInputAttributeDescription> vertexAttributes{};
+        VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
+        VkPipelineRasterizationStateCreateInfo rasterizationInfo{};
+        VkPipelineMultisampleStateCreateInfo multisampleInfo{};
+        VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
+        VkPipelineColorBlendStateCreateInfo colorBlendInfo{};  // attachmentCount of blendAttachments are used
+        std::array<VkPipelineColorBlendAttachmentState, MAX_COLOR_ATTACHMENTS> blendAttachments{};
+        VkPipelineTessellationStateCreateInfo tessInfo{};
+    };
+
+    /// creation statistics of the last createPipeLines
+    struct Stats {
+        uint32_t pipelinesCount{0u};
+        uint32_t cacheHitsCount{0u};  // pipelines found in the cache by the driver (creation feedback)
+        uint32_t threadsCount{0u};
+        double compileTimeMs{0.0};
+    };
+
 private:
     Pipeliner();
 
     friend void deletePipeLine(PipeLine* p);
 
     bool createCache();
+    std::vector<char> getCacheData() const;
+
+    /// doesn't touch the state of Pipeliner, safe to call from several threads with different caches
+    pipeline_ptr compilePipeLine(const Description& description, VkDevice device, VkPipelineCache cache,
+                                 VkPipelineCreationFeedback& outFeedback) const;
+
+    /// logs the resources of the shaders missing in the layout or declared with another type, count or stages
+    void validateLayout(const Description& description, const PipeLine& pipeline) const;
+
+    /// logs the specialization constants none of the shaders declares: the .spv files are older than their sources
+    void validateSpecialization(const Description& description, const PipeLine& pipeline) const;
 
 public:
     static Pipeliner& getInstance() {
@@ -34,78 +94,42 @@ public:
         return pipeliner;
     }
 
-    bool saveCache();
-
-    /// Restores the shared color-blend-attachments array to its pristine default state (all channels
-    /// writable, standard alpha blend). Must be called once per pipeline-(re)creation cycle, BEFORE any
-    /// individual PipelineCreator::createPipeline() runs, since several creators (Particle, SemiTransparent)
-    /// mutate specific attachment slots (e.g. restrict colorWriteMask to R|G for motion vectors) in place on
-    /// this singleton's shared array, and those mutations otherwise persist into the next cycle.
-    void resetColorBlendAttachments();
-
-    /// you can customize states of pipeline by get desired and change before invoking createPipeLine
-    pipeline_ptr createPipeLine(std::string_view vertShader, std::string_view fragShader, uint32_t width, uint32_t height,
-                                VkDescriptorSetLayout descriptorSetLayout, VkRenderPass renderPass, VkDevice device,
-                                uint32_t subpass = 0u, VkPushConstantRange pushConstantRange = {0u, 0u, 0u});
-
-    pipeline_ptr createPipeLine(std::string_view vertShader, std::string_view fragShader, std::string_view tessCtrlShader,
-                                std::string_view tessEvalShader, uint32_t width, uint32_t height,
-                                VkDescriptorSetLayout descriptorSetLayout, VkRenderPass renderPass, VkDevice device,
-                                uint32_t subpass = 0u, VkPushConstantRange pushConstantRange = {0u, 0u, 0u});
+    /// the pipeline cache file is picked by the device and the shaders, must be called before creating pipelines
+    void init(VkDevice device, VkPhysicalDevice physicalDevice);
 
-    /// get and customize states your way (just before invoking createPipeLine)
+    bool saveCache();
 
-    inline VkPipelineVertexInputStateCreateInfo& getVertexInputInfo() {
-        return m_vertexInputInfo;
-    };
+    /// default states of a pipeline: triangle list of I3DModel::Vertex, back face culling, depth test and write,
+    /// alpha blending of MAX_COLOR_ATTACHMENTS attachments
+    /// Note: the creators replacing vertexAttributes only keep the vertex and instance bindings of I3DModel::Vertex
+    inline const Description& getDefaultDescription() const {
+        return m_defaultDescription;
+    }
 
-    inline VkPipelineInputAssemblyStateCreateInfo& getInputAssemblyInfo() {
-        return m_pipelineIACreateInfo;
-    };
+    pipeline_ptr createPipeLine(const Description& description, VkDevice device);
 
-    inline VkPipelineRasterizationStateCreateInfo& getRasterizationInfo() {
-        return m_rastCreateInfo;
-    };
+    /// compiles the pipelines in parallel, result i is the pipeline of descriptions[i]
+    /// every thread compiles against its own cache seeded by the shared one, the caches are merged into it at the end
+    std::vector<pipeline_ptr> createPipeLines(const std::vector<Description>& descriptions, VkDevice device);
 
-    inline VkPipelineMultisampleStateCreateInfo& getMultisampleInfo() {
-        return m_pipelineMSCreateInfo;
-    };
+    /// compiles the pipeline on a worker thread against the shared cache, the renderer goes on with the frames meanwhile.
+    /// Note: must be complete before the next createPipeLines or saveCache, they need exclusive access to the cache
+    std::future<pipeline_ptr> createPipeLineAsync(Description description, VkDevice device);
 
-    inline VkPipelineDepthStencilStateCreateInfo& getDepthStencilInfo() {
-        return m_depthStencil;
-    };
-
-    inline VkPipelineColorBlendStateCreateInfo& getColorBlendInfo() {
-        return m_blendCreateInfo;
-    };
+    inline const Stats& getStats() const {
+        return m_stats;
+    }
 
-    inline VkPipelineTessellationStateCreateInfo& getTessInfo() {
-        return m_tessInfo;
-    };
+    inline const PipelineCacheStore::Stats& getCacheStats() const {
+        return m_cacheStore.getStats();
+    }
 
 private:
     VkDevice m_device{nullptr};
     VkPipelineCache m_pipeline_cache{nullptr};
-
-    VkPipelineShaderStageCreateInfo m_shaderStageCreateInfo[4]{};
-    VkPipelineVertexInputStateCreateInfo m_vertexInputInfo{};
-    VkPipelineInputAssemblyStateCreateInfo m_pipelineIACreateInfo{};
-    VkViewport m_vp{};
-    VkRect2D m_scissor{};
-    VkPipelineViewportStateCreateInfo m_vpCreateInfo{};
-    VkPipelineRasterizationStateCreateInfo m_rastCreateInfo{};
-    VkPipelineMultisampleStateCreateInfo m_pipelineMSCreateInfo{};
-    VkPipelineColorBlendStateCreateInfo m_blendCreateInfo{};
-    VkPipelineDepthStencilStateCreateInfo m_depthStencil{};
-    VkPipelineTessellationStateCreateInfo m_tessInfo{};
-    std::vector<VkPipelineColorBlendAttachmentState> m_blendAttachments;
+    PipelineCacheStore m_cacheStore{Constants::PIPELINE_CACHE_DIR};
+    Stats m_stats{};
 
     /// persistent default configuration
-    inline static VkPipelineVertexInputStateCreateInfo _vertexInputInfo{};
-    inline static VkPipelineInputAssemblyStateCreateInfo _pipelineIACreateInfo{};
-    inline static VkPipelineRasterizationStateCreateInfo _rastCreateInfo{};
-    inline static VkPipelineMultisampleStateCreateInfo _pipelineMSCreateInfo{};
-    inline static VkPipelineColorBlendStateCreateInfo _blendCreateInfo{};
-    inline static VkPipelineDepthStencilStateCreateInfo _depthStencil{};
-    inline static VkPipelineTessellationStateCreateInfo _tessInfo{};
-};
\ No newline at end of file
+    Description m_defaultDescription{};
+};
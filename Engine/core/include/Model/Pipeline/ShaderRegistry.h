@@ -0,0 +1,113 @@
+#pragma once
+
+#include <volk.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// Shader modules shared by all the pipelines:
+///   - a SPIR-V blob is read once, from the packed archive (Constants::SHADERS_ARCHIVE) if there is one or from its .spv file,
+///     a .spv file newer than the archive (recompiled since the packing) shadows its archived copy
+///   - modules are keyed by the content hash, identical shaders of different files (e.g. the fullscreen quad vertex shader
+///     of the post effects) share one VkShaderModule
+///   - modules are reference counted by the pipelines and destroyed with the last one, the pipelines recreated on swapchain
+///     resize are compiled before the old ones are released and get the modules back without reading the SPIR-V again
+///   - the SPIR-V is reflected (stage, descriptor bindings, push constants, specialization constants) to validate the
+///     pipeline descriptions against it
+/// Note: thread safe, the pipeline compile workers acquire modules concurrently
+class ShaderRegistry {
+public:
+    struct Binding {
+        uint32_t set{0u};
+        uint32_t binding{0u};
+        VkDescriptorType type{VK_DESCRIPTOR_TYPE_MAX_ENUM};
+        uint32_t count{1u};  // 0 for runtime arrays
+    };
+
+    struct Reflection {
+        VkShaderStageFlagBits stage{VK_SHADER_STAGE_ALL};
+        std::vector<Binding> bindings{};
+        std::vector<uint32_t> specializationConstantIds{};  // constant_id of the specialization constants
+        bool is_pushConstantUsed{false};
+    };
+
+    struct Stats {
+        uint32_t modulesCount{0u};   // alive VkShaderModules
+        uint32_t loadedCount{0u};    // SPIR-V blobs read from disk
+        uint32_t reusedCount{0u};    // acquisitions served by an existing module
+    };
+
+    static constexpr uint32_t ARCHIVE_VERSION = 1u;
+
+private:
+    ShaderRegistry() = default;
+
+    struct Module {
+        VkShaderModule module{nullptr};
+        Reflection reflection{};
+        uint32_t refCount{0u};
+    };
+
+    struct ArchiveHeader {
+        char identifier[8]{'S', 'P', 'V', 'A', 'R', 'C', 'H', '\0'};
+        uint32_t version{ARCHIVE_VERSION};
+        uint32_t entriesCount{0u};
+    };
+
+    struct ArchiveEntry {
+        char fileName[64]{};
+        uint64_t byteOffset{0u};
+        uint64_t byteLength{0u};
+    };
+
+public:
+    ShaderRegistry(const ShaderRegistry&) = delete;
+    ShaderRegistry& operator=(const ShaderRegistry&) = delete;
+
+    static ShaderRegistry& getInstance() {
+        static ShaderRegistry shaderRegistry;
+        return shaderRegistry;
+    }
+
+    /// reads the index of the shaders archive if it exists
+    void init(VkDevice device);
+
+    /// all the modules must be released by now, must be called before vkDestroyDevice
+    void destroy();
+
+    /// returns a module of the shader file (relative to Constants::SHADERS_DIR), release it by release()
+    VkShaderModule acquire(std::string_view fileName);
+
+    /// the module is destroyed if no pipeline uses it anymore
+    void release(VkShaderModule module);
+
+    /// valid while the module is acquired
+    const Reflection& getReflection(VkShaderModule module);
+
+    Stats getStats();
+
+    /// true if the shader can be read and is valid SPIR-V, optional shaders are checked by it before their pipelines
+    /// are described, outReflection tells what the shader expects from them
+    bool isLoadable(std::string_view fileName, Reflection& outReflection) const;
+
+    /// parses the SPIR-V, returns false if it is not a valid module
+    static bool reflect(const uint32_t* code, size_t wordsCount, Reflection& outReflection);
+
+    /// packs all the .spv files of the directory into one archive, run the game with --pack-shaders
+    static bool packArchive(std::string_view shadersDir, const std::string& archivePath);
+
+private:
+    bool readCode(const std::string& fileName, std::vector<uint32_t>& outCode) const;
+
+    VkDevice m_device{nullptr};
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, Module> m_modules{};             // content hash -> module
+    std::unordered_map<VkShaderModule, uint64_t> m_moduleHashes{};
+    std::unordered_map<std::string, uint64_t> m_fileHashes{};    // file name -> content hash, the file is read once
+    std::unordered_map<std::string, ArchiveEntry> m_archiveEntries{};
+    std::string m_archivePath{};
+    Stats m_stats{};
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <volk.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class GpuProfiler;
+
+/// Frame graph of the passes recorded into one command buffer:
+///   - every pass declares the images and buffers it reads and writes, the declaration order defines which write a read sees
+///   - passes which are disabled or whose outputs are not read by a live pass are culled, a pass is live if it writes
+///     an output resource (swapchain image, persistent buffers) or has side effects
+///   - the live passes are scheduled topologically, independent passes keep the declaration order
+///   - barriers and layout transitions are derived from the tracked state of the resources and batched per stage pair
+/// Accesses of render pass attachments are marked as synchronized: the render pass dependencies order them already,
+/// only a layout which differs from the render pass initialLayout gets a barrier then.
+/// The graph is rebuilt every frame (reset, import, addPass, compile, execute), the handles are valid until reset.
+/// Note: not thread safe, used on the render thread
+class RenderGraph {
+public:
+    using ResourceHandle = uint32_t;
+    using RecordFunc = std::function<void(VkCommandBuffer)>;
+
+    struct ResourceAccess {
+        ResourceHandle resource{0u};
+        bool is_write{false};
+        VkPipelineStageFlags stageMask{VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+        VkAccessFlags accessMask{0u};
+        // images only: required when the pass starts, VK_IMAGE_LAYOUT_UNDEFINED discards the content (no transition)
+        VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+        // images only: the layout the pass leaves the image in (render pass finalLayout), VK_IMAGE_LAYOUT_UNDEFINED keeps layout
+        VkImageLayout finalLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+        bool is_synchronized{false};  // ordered by the pass itself (render pass dependencies)
+    };
+
+    struct PassInfo {
+        std::string name;
+        bool is_culled{false};
+        uint32_t barriersCount{0u};  // before the pass
+        double recordTimeMs{0.0};    // CPU time of the last execute
+    };
+
+    void reset();
+
+    /// image may be null in a graph which is never compiled (accesses only, see getPassRange),
+    /// layout is the current layout, exportLayout is the layout the image is left in by execute (the next frame imports it),
+    /// VK_IMAGE_LAYOUT_UNDEFINED leaves the last one
+    ResourceHandle importImage(std::string_view name, VkImage image, VkImageAspectFlags aspectMask, VkImageLayout layout,
+                               VkImageLayout exportLayout = VK_IMAGE_LAYOUT_UNDEFINED, bool is_output = false);
+    ResourceHandle importBuffer(std::string_view name, VkBuffer buffer, bool is_output = false);
+
+    void addPass(std::string_view name, std::vector<ResourceAccess> accesses, RecordFunc recordFunc, bool is_enabled = true,
+                 bool has_side_effects = false);
+
+    /// culls, schedules and derives the barriers of the passes added since reset
+    void compile();
+
+    /// records the scheduled passes and their barriers, every pass with its barriers is a scope of the profiler
+    void execute(VkCommandBuffer cmdBuf, GpuProfiler* profiler = nullptr);
+
+    /// the declaration indices of the first and the last pass accessing the resource, the disabled passes included,
+    /// @return: false if no pass accesses it
+    /// Note: the schedule keeps the declaration order (a read sees the writes declared before it), the range bounds the
+    /// recorded lifetime of the resource in every frame
+    bool getPassRange(std::string_view resourceName, uint32_t& outFirstPass, uint32_t& outLastPass) const;
+
+    /// scheduled passes with their accesses, barriers and record times, then the culled ones
+    std::string dump() const;
+
+    const std::vector<PassInfo>& getPassInfos() const {
+        return m_passInfos;
+    }
+
+private:
+    struct Resource {
+        std::string name;
+        VkImage image{nullptr};
+        VkBuffer buffer{nullptr};
+        VkImageAspectFlags aspectMask{0u};
+        VkImageLayout initialLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+        VkImageLayout exportLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+        bool is_output{false};
+    };
+
+    // the state tracked during compile
+    struct ResourceState {
+        VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+        VkPipelineStageFlags writeStages{0u};
+        VkAccessFlags writeAccess{0u};
+        VkPipelineStageFlags readStages{0u};  // since the last write
+        VkAccessFlags readAccess{0u};
+    };
+
+    // barriers with the same stage masks are recorded by one vkCmdPipelineBarrier
+    struct BarrierBatch {
+        VkPipelineStageFlags srcStageMask{0u};
+        VkPipelineStageFlags dstStageMask{0u};
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    };
+
+    struct Pass {
+        std::vector<ResourceAccess> accesses;
+        RecordFunc recordFunc;
+        bool is_enabled{true};
+        bool has_side_effects{false};
+        std::vector<uint32_t> dependencies;  // indices of the passes which must be recorded before
+        std::vector<BarrierBatch> barriers;  // before the pass
+    };
+
+    void addBarrier(std::vector<BarrierBatch>& batches, const Resource& resource, VkImageLayout oldLayout,
+                    VkImageLayout newLayout, VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+                    VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask);
+    void recordBarriers(VkCommandBuffer cmdBuf, const std::vector<BarrierBatch>& batches) const;
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    std::vector<PassInfo> m_passInfos;  // of m_passes
+    std::vector<uint32_t> m_schedule;   // indices of the live passes in the recording order
+    std::vector<BarrierBatch> m_exportBarriers;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/// Object counts of the scene, the defaults give the regular one:
+///   - trees: trunks with a kinematic physics body each, the first crownsCount trees get the animated crown
+///   - bushes: three billboard layers spread over the terrain
+///   - smoke emitters: the first two follow the exhaust pipes of the tank, the others stand at random places
+///   - physics bodies: dynamic boxes dropped on the terrain, they are simulated but not drawn
+/// The counts are set by "key = value" lines of a config file ('#' starts a comment) or "key=value" arguments, the keys
+/// are the names of the fields without "Count". The placement is drawn by std::mt19937 from seed, so the same config
+/// gives the same scene. The instance buffers of the models grow with the counts.
+/// Note: the counts are clamped to MAX_COUNT, a scene keeps at least one tree and one crown
+struct StressScene {
+    static constexpr uint32_t MAX_COUNT = 256u * 1024u;
+
+    uint32_t treesCount{250u};
+    uint32_t crownsCount{250u};
+    uint32_t largeBushesCount{5000u};
+    uint32_t smallBushesCount{20000u};
+    uint32_t mediumBushesCount{2000u};
+    uint32_t smokeEmittersCount{2u};
+    uint32_t smokeParticlesCount{250u};  // per emitter
+    uint32_t physicsBodiesCount{0u};
+    uint32_t seed{1u};
+
+    /// "key=value" or "key = value", @return: false for an unknown key or a value which is not a number
+    bool parse(std::string_view assignment);
+
+    bool loadFile(const std::string& filePath);
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <volk.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// On-disk cache of ready to upload textures (KTX2-like container), the first run builds it from the PNG/JPG sources:
+///   - the mip chain is generated offline by the box filter, in linear space for sRGB formats
+///   - the levels are optionally block compressed by BlockCompressor (BC1/BC3/BC5/BC7)
+///   - a file is keyed by the hash of the source files content and of the settings, so edited sources are rebuilt
+/// Later runs read the file only: no image decoding, no runtime mip blits and 4-8 times less VRAM with compression.
+/// File layout: FileHeader, LevelIndex per mip level, the levels data (all the layers of one level one after another).
+/// Note: thread safe, the decode threads of TextureFactory use it concurrently
+class TextureCache {
+public:
+    enum class Compression : uint8_t { NONE = 0, BC1, BC3, BC5, BC7 };
+
+    struct Settings {
+        bool is_miplevelsEnabling{true};
+        bool is_flippingVertically{true};
+        Compression compression{Compression::NONE};
+    };
+
+    struct Image {
+        VkFormat format{VK_FORMAT_UNDEFINED};
+        uint32_t width{0u};
+        uint32_t height{0u};
+        uint32_t layersCount{0u};
+        uint32_t levelsCount{0u};                    // full mip chain of the cached image
+        uint32_t firstLevel{0u};                     // mip level of levels[0], the levels above it are not loaded
+        uint64_t key{0u};                            // cache file of the image, see load(key, ...)
+        std::vector<std::vector<uint8_t>> levels{};  // mip level firstLevel first
+    };
+
+    static constexpr uint32_t FORMAT_VERSION = 1u;
+
+    explicit TextureCache(std::string_view cacheDir) : m_cacheDir(cacheDir) {}
+
+    /// reads the cached image of the source files (one per layer), builds and stores it if there is none
+    /// returns false if the sources can not be read or decoded
+    /// firstLevel skips the biggest levels (texture streaming loads the small mip tail first), it is clamped to the last level
+    bool load(const std::vector<std::string>& filePaths, const Settings& settings, Image& outImage,
+              uint32_t firstLevel = 0u) const;
+
+    /// reads the levels from firstLevel of the image cached before, the sources are not touched
+    /// returns false if the cache file is gone or outdated
+    bool load(uint64_t key, uint32_t firstLevel, Image& outImage) const;
+
+    static VkFormat getFormat(Compression compression);
+
+    /// bytes of one layer of a mip level
+    static uint64_t getLevelSize(Compression compression, uint32_t width, uint32_t height);
+
+    /// full mip chain down to 1x1
+    static uint32_t getMipLevels(uint32_t width, uint32_t height);
+
+    /// block: 4x4 texels of 4 bytes, out: getLevelSize(compression, 1, 1) bytes, compression is other than NONE
+    static void compressBlock(Compression compression, const uint8_t* block, uint8_t* out);
+
+    /// decodes the sources (one per layer), generates the mip chain and compresses the levels, no file is touched
+    /// returns false if a source can not be decoded or the layers differ in size
+    static bool build(const std::vector<std::vector<char>>& sources, const Settings& settings, Image& outImage);
+
+private:
+    struct FileHeader {
+        char identifier[8]{'T', 'E', 'X', 'C', 'A', 'C', 'H', 'E'};
+        uint32_t version{FORMAT_VERSION};
+        uint32_t format{VK_FORMAT_UNDEFINED};
+        uint32_t width{0u};
+        uint32_t height{0u};
+        uint32_t layersCount{0u};
+        uint32_t levelsCount{0u};
+        uint64_t key{0u};
+    };
+
+    struct LevelIndex {
+        uint64_t byteOffset{0u};
+        uint64_t byteLength{0u};
+    };
+
+    std::string getCachePath(uint64_t key) const;
+    bool read(const std::string& filePath, uint64_t key, uint32_t firstLevel, Image& outImage) const;
+    void write(const std::string& filePath, uint64_t key, const Image& image) const;
+
+    std::string m_cacheDir;
+};
@@ -1,42 +1,205 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
+#include "Constants.h"
+#include "TextureCache.h"
+#include "UploadManager.h"
 #include "VulkanState.h"
 
 class TextureFactory {
 public:
+    /// combined image sampler which samples the texture, it is rewritten when the streamed image is replaced
+    struct DescriptorBinding {
+        VkDescriptorSet descriptorSet{nullptr};
+        uint32_t binding{0u};
+        uint32_t descriptorSetsIndex{0u};  // swapchain image which the set belongs to
+        VkSampler sampler{nullptr};
+        uint32_t viewGeneration{0u};  // generation of the view written into the set
+        uint32_t arrayElement{0u};    // element of the bindless textures array
+    };
+
     struct Texture {
+        static constexpr uint32_t NOT_REQUESTED_MIP = UINT32_MAX;
+
         VkImage m_textureImage{nullptr};
         VkDeviceMemory m_textureImageMemory{nullptr};
         VkImageView m_textureImageView{nullptr};
-        uint32_t mipLevels{0u};
-        uint32_t width{0u};
+        VkFormat format{VK_FORMAT_UNDEFINED};
+        uint32_t mipLevels{0u};  // full mip chain, the image holds the levels from residentMip only
+        uint32_t width{0u};      // level 0 size, the image is smaller if residentMip is not 0
         uint32_t height{0u};
+        uint32_t layersCount{1u};
+        /// Note: asynchronous textures show the placeholder until their pixels are decoded and uploadToken is complete
+        bool is_decoded{true};
+        UploadManager::Token uploadToken{0u};
+
+        /// texture streaming: the levels above residentMip are on disk only, requestedMip is the finest level wanted by the
+        /// draws of the current frame (see requestScreenSize)
+        uint32_t residentMip{0u};
+        uint32_t requestedMip{NOT_REQUESTED_MIP};
+        /// incremented whenever the streamed image (and its view) is replaced
+        uint32_t viewGeneration{0u};
+        std::vector<DescriptorBinding> descriptorBindings{};
+
+        /// the descriptor sets which sample the texture must be tracked: the streamed texture gets a new view whenever its
+        /// resident levels change, the tracked bindings are rewritten with it (every descriptor write of a texture is followed
+        /// by this call)
+        void trackDescriptor(VkDescriptorSet descriptorSet, uint32_t binding, uint32_t descriptorSetsIndex, VkSampler sampler,
+                             uint32_t arrayElement = 0u) {
+            descriptorBindings.push_back({descriptorSet, binding, descriptorSetsIndex, sampler, viewGeneration, arrayElement});
+        }
+    };
+
+    struct StreamingStats {
+        VkDeviceSize residentBytes{0u};   // levels of the streamed textures in VRAM
+        VkDeviceSize requestedBytes{0u};  // levels wanted by the draws
+        VkDeviceSize budgetBytes{0u};
+        uint32_t texturesCount{0u};
+        uint32_t streamingCount{0u};  // textures whose levels are being loaded or evicted
     };
 
+    static constexpr VkDeviceSize UPLOAD_BYTES_PER_FRAME = 32ull * 1024ull * 1024ull;  // at least one texture per frame
+    static constexpr uint32_t STREAMING_TAIL_EXTENT = 128u;  // levels up to this size are loaded at creation, bigger are streamed
+    static constexpr uint32_t STREAMING_JOBS_MAX = 4u;       // textures being streamed at once
+    static constexpr uint64_t STREAMING_UNUSED_FRAMES = 300u;  // textures not drawn for so long want their mip tail only
+    static constexpr VkDeviceSize STREAMING_BUDGET = 512ull * 1024ull * 1024ull;  // default VRAM budget of streamed textures
+    /// VK_EXT_memory_budget: part of the heap budget left for the rest of the engine
+    static constexpr VkDeviceSize MEMORY_BUDGET_HEADROOM = 256ull * 1024ull * 1024ull;
+
     TextureFactory(const VulkanState& vulkanState) noexcept(true);
 
     void init();
 
     ~TextureFactory();
 
+    /// <param name="is_flippingVertically"> keep it in 'true' by default since texture applies from top to bottom in
+    /// Vulkan</param>
+    /// <param name="is_compressionEnabling"> block compression of the cached texture if the device supports it, disable it
+    /// for data which needs the full precision (height maps)</param>
     std::weak_ptr<Texture> createCubeTexture(const std::array<std::string_view, 6>& textureFileNames,
                                              bool is_flippingVertically = true);
     std::weak_ptr<Texture> create2DTexture(std::string_view pTextureFileName, bool is_miplevelsEnabling = true,
-                                           bool is_flippingVertically = true);
+                                           bool is_flippingVertically = true, bool is_compressionEnabling = true);
     std::weak_ptr<Texture> create2DArrayTexture(std::vector<std::string>&& textureFileNames, bool is_miplevelsEnabling = true,
-                                                bool is_flippingVertically = true);
+                                                bool is_flippingVertically = true, bool is_compressionEnabling = true);
+    /// asynchronous variants return the texture right away: its image has the final size, format and mip chain but is
+    /// filled by the placeholder color, the texture cache is read (built) by the worker pool and uploaded by update()
+    std::weak_ptr<Texture> createCubeTextureAsync(const std::array<std::string_view, 6>& textureFileNames,
+                                                  bool is_flippingVertically = true);
+    std::weak_ptr<Texture> create2DTextureAsync(std::string_view pTextureFileName, bool is_miplevelsEnabling = true,
+                                                bool is_flippingVertically = true, bool is_compressionEnabling = true);
+    std::weak_ptr<Texture> create2DArrayTextureAsync(std::vector<std::string>&& textureFileNames,
+                                                     bool is_miplevelsEnabling = true, bool is_flippingVertically = true,
+                                                     bool is_compressionEnabling = true);
     VkSampler getTextureSampler(uint32_t mipLevels);
 
+    /// hands decoded images over to the upload batch, swaps the streamed images and decides which levels to stream,
+    /// called by the render thread once per frame before the command buffer of descriptorSetsIndex is recorded
+    /// Note: only the descriptor sets of descriptorSetsIndex are rewritten, the previous frame which used them is complete
+    void update(uint32_t descriptorSetsIndex);
+
+    bool isResident(const Texture& texture) const;
+
+    uint32_t pendingTexturesCount() const;
+
+    /// texture streaming: screenSize is the height of the textured surface on the screen in viewport heights,
+    /// the finest of the requested levels of the frame is streamed in
+    void requestScreenSize(Texture& texture, float screenSize) const;
+
+    void setViewportHeight(uint32_t viewportHeight) {
+        m_viewportHeight = viewportHeight;
+    }
+
+    /// VRAM budget of the streamed textures, it is lowered by VK_EXT_memory_budget when the heaps are short of memory
+    void setStreamingBudget(VkDeviceSize budget) {
+        m_streamingBudget = budget;
+    }
+
+    const StreamingStats& getStreamingStats() const {
+        return m_streamingStats;
+    }
+
+    /// descriptor sets are recreated along with the swapchain, the new ones are tracked again
+    void resetDescriptorBindings();
+
 private:
-    /// <param name="is_flippingVertically"> keep it in 'true' by default since texture applies from top to bottom in
-    /// Vulkan</param>
+    struct DecodeJob {
+        std::weak_ptr<Texture> texture;
+        std::vector<std::string> filePaths;
+        TextureCache::Settings settings{};
+        TextureCache::Image image{};
+        bool is_loaded{false};
+        uint32_t firstLevel{0u};
+        uint64_t cacheKey{0u};  // streamed levels are read from the cache file, the sources are not hashed again
+        bool is_streaming{false};
+    };
+
+    struct StreamedTexture {
+        std::weak_ptr<Texture> texture;
+        std::vector<std::string> filePaths;
+        TextureCache::Settings settings{};
+        VkImageViewType viewType{VK_IMAGE_VIEW_TYPE_2D};
+        uint64_t cacheKey{0u};
+        std::vector<VkDeviceSize> levelsSize{};  // bytes of the image holding the levels from the index one
+        uint32_t tailMip{0u};
+        uint32_t finestMip{0u};  // raised if the levels can't be loaded, the texture stays as it is then
+        uint32_t wantedMip{0u};
+        uint32_t targetMip{0u};  // residentMip or the level being streamed
+        uint64_t lastUsedFrame{0u};
+    };
+
+    /// image of the streamed levels, it replaces the texture image once its upload is complete
+    struct PendingImage {
+        std::weak_ptr<Texture> texture;
+        VkImage image{nullptr};
+        VkDeviceMemory imageMemory{nullptr};
+        VkImageView imageView{nullptr};
+        uint32_t residentMip{0u};
+        UploadManager::Token uploadToken{0u};
+    };
+
+    /// replaced image, it is destroyed once the frames in flight which may sample it are complete
+    struct RetiredImage {
+        VkImage image{nullptr};
+        VkDeviceMemory imageMemory{nullptr};
+        VkImageView imageView{nullptr};
+        uint64_t frameIndex{0u};
+    };
+
+    std::weak_ptr<Texture> createTexture(std::string&& id, std::vector<std::string>&& filePaths, VkImageViewType viewType,
+                                         bool is_miplevelsEnabling, bool is_flippingVertically, bool is_compressionEnabling,
+                                         bool is_async);
+    /// reads the file headers: size of the image and channels which define the compression
+    TextureCache::Settings getCacheSettings(const std::vector<std::string>& textureFileNames, bool is_miplevelsEnabling,
+                                            bool is_flippingVertically, bool is_compressionEnabling, uint32_t& outWidth,
+                                            uint32_t& outHeight) const;
+    /// creates the image with the final format and the levels from firstLevel and fills it by the placeholder color
+    void createPlaceholder(TextureFactory::Texture& outTexture, uint32_t layersCount, const TextureCache::Settings& settings,
+                           uint32_t width, uint32_t height, uint32_t firstLevel);
+    void decodeWorker();
+
     VkResult loadImages(TextureFactory::Texture& outTexture, const std::vector<std::string>& textureFileNames, VkDevice device,
-                        VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool cmdBufPool,
-                        bool is_miplevelsEnabling = true, bool is_flippingVertically = true);
+                        VkPhysicalDevice physicalDevice, const TextureCache::Settings& settings, uint32_t firstLevel,
+                        uint64_t& outCacheKey);
+
+    void uploadDecodedImages();
+    void swapStreamedImages();
+    void updateDescriptors(uint32_t descriptorSetsIndex);
+    void releaseRetiredImages(bool is_forced);
+    void updateStreaming();
+    /// the least recently used texture (or the one finer than wanted) drops its top levels, returns the released bytes
+    VkDeviceSize evictLeastRecentlyUsed(const StreamedTexture* keptTexture);
+    void streamLevels(StreamedTexture& streamed, uint32_t firstLevel);
+    VkDeviceSize getStreamingBudget(VkDeviceSize residentBytes) const;
 
 private:
     const VulkanState& m_vkState;
@@ -44,4 +207,22 @@ private:
     std::unordered_map<uint32_t, VkSampler> m_samplers{};
     VkPhysicalDeviceProperties m_properties{};
     std::function<void(TextureFactory::Texture* p)> mTextureDeleter{nullptr};
+    const TextureCache m_textureCache{Constants::TEXTURE_CACHE_DIR};
+
+    std::vector<std::thread> m_decodeThreads{};
+    mutable std::mutex m_decodeMutex{};
+    std::condition_variable m_decodeCondition{};
+    std::deque<DecodeJob> m_decodeJobs{};     // guarded by m_decodeMutex
+    std::deque<DecodeJob> m_decodedJobs{};    // guarded by m_decodeMutex
+    uint32_t m_decodingJobsCount{0u};         // guarded by m_decodeMutex
+    bool m_is_decodeStopped{false};           // guarded by m_decodeMutex
+
+    // texture streaming, render thread only
+    std::unordered_map<const Texture*, StreamedTexture> m_streamedTextures{};
+    std::vector<PendingImage> m_pendingImages{};
+    std::vector<RetiredImage> m_retiredImages{};
+    StreamingStats m_streamingStats{};
+    VkDeviceSize m_streamingBudget{STREAMING_BUDGET};
+    uint32_t m_viewportHeight{1u};
+    uint64_t m_frameIndex{0u};
 };
\ No newline at end of file
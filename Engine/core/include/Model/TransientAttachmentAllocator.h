@@ -0,0 +1,95 @@
+#pragma once
+
+#include <volk.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class RenderGraph;
+
+/// Memory of the size dependent attachments which are alive only within a frame:
+///   - the lifetime of an attachment is the range of the frame graph passes accessing the resource of its name, from
+///     the first to the last of them (RenderGraph::getPassRange)
+///   - attachments of a group whose lifetimes don't overlap share the memory (aliasing), the groups are never aliased with
+///     each other (a group per swapchain image, the frames in flight overlap on GPU)
+///   - attachments used only inside a render pass (VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, e.g. subpass inputs) get
+///     VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT memory if the device has it (tile based GPUs), nothing is committed then
+/// The content of an aliased attachment is undefined at its first use: the render pass must start it with
+/// VK_IMAGE_LAYOUT_UNDEFINED initial layout (or clear it), the execution dependency on the previous user of the memory is
+/// given by the external dependencies of the render passes.
+/// Note: the images are owned by the allocator, don't release them by Utils::VulkanDestroyImage. Not thread safe
+class TransientAttachmentAllocator {
+public:
+    using Handle = uint32_t;
+
+    struct AttachmentInfo {
+        std::string name;
+        uint32_t width{0u};
+        uint32_t height{0u};
+        VkFormat format{VK_FORMAT_UNDEFINED};
+        VkImageUsageFlags usage{0u};
+        uint32_t group{0u};
+    };
+
+    struct Stats {
+        VkDeviceSize requestedBytes{0u};  // sum of the attachment sizes
+        VkDeviceSize allocatedBytes{0u};  // committed memory, lazily allocated memory excluded
+        VkDeviceSize lazyBytes{0u};       // sizes of the lazily allocated attachments
+        uint32_t attachmentsCount{0u};
+        uint32_t aliasedCount{0u};  // attachments placed onto the memory of another one
+        uint32_t lazyCount{0u};
+    };
+
+    TransientAttachmentAllocator() = default;
+    TransientAttachmentAllocator(const TransientAttachmentAllocator&) = delete;
+    TransientAttachmentAllocator& operator=(const TransientAttachmentAllocator&) = delete;
+
+    ~TransientAttachmentAllocator() {
+        destroy();
+    }
+
+    void init(VkDevice device, VkPhysicalDevice physicalDevice);
+
+    /// releases the images and their memory, must be called before vkDestroyDevice
+    void destroy();
+
+    /// creates the image, its memory is bound by the next allocate()
+    Handle addAttachment(const AttachmentInfo& info);
+
+    /// takes the lifetimes from the accesses of frameGraph and binds the memory of the attachments added since the previous call
+    void allocate(const RenderGraph& frameGraph);
+
+    VkImage getImage(Handle handle) const {
+        return m_attachments[handle].image;
+    }
+
+    /// the memory may be shared by other attachments
+    VkDeviceMemory getMemory(Handle handle) const {
+        return m_attachments[handle].memory;
+    }
+
+    const Stats& getStats() const {
+        return m_stats;
+    }
+
+private:
+    struct Attachment {
+        std::string name;
+        VkImage image{nullptr};
+        VkDeviceMemory memory{nullptr};
+        VkImageUsageFlags usage{0u};
+        VkMemoryRequirements memRequirements{};
+        uint32_t group{0u};
+        uint32_t firstPass{0u};
+        uint32_t lastPass{0u};
+    };
+
+    uint32_t findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const;
+
+    VkDevice m_device{nullptr};
+    VkPhysicalDeviceMemoryProperties m_memProperties{};
+    std::vector<Attachment> m_attachments{};
+    std::vector<VkDeviceMemory> m_memories{};
+    uint32_t m_allocatedCount{0u};  // attachments with bound memory, the rest is pending
+    Stats m_stats{};
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <volk.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// Batched asynchronous uploads of buffers and images, replaces one-off command buffers with vkQueueWaitIdle.
+///   - staging data is written into one persistently mapped ring buffer
+///   - copies, layout transitions and mip blits of many resources are recorded into one command buffer per batch
+///   - a batch is submitted by flush() and signals a timeline semaphore, callers get a token instead of blocking
+///   - the ring space of a batch is reclaimed once its token is signaled
+/// If the device exposes a dedicated transfer queue family the copies run there and the resources are handed over
+/// to the graphics queue family (queue family ownership transfer), blits and transitions always run on the graphics queue.
+/// Note: not thread safe, used by the render thread only since the graphics queue is submitted from there as well
+class UploadManager {
+public:
+    using Token = uint64_t;
+
+    static constexpr VkDeviceSize STAGING_RING_SIZE = 64ull * 1024ull * 1024ull;
+
+private:
+    UploadManager() = default;
+
+public:
+    static UploadManager& getInstance() {
+        static UploadManager uploadManager;
+        return uploadManager;
+    }
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    /// transferQueue is nullptr if there is no dedicated transfer queue family
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t graphicsFamily, VkQueue graphicsQueue,
+              uint32_t transferFamily, VkQueue transferQueue);
+
+    /// unsubmitted commands are dropped (their resources may be released already), must be called before vkDestroyDevice
+    void destroy();
+
+    bool isInitialized() const {
+        return m_device != nullptr;
+    }
+
+    /// copies data into the staging ring and records its copy into dstBuffer
+    Token uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0u);
+
+    /// uploads the first mip level of every layer (layerSize bytes each), generates the rest of mip chain
+    /// and leaves the image in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    /// Note: oldLayout other than VK_IMAGE_LAYOUT_UNDEFINED means the image content is replaced while it may be still read
+    ///       by the frames in flight, such an upload is recorded on the graphics queue after all the previous work
+    Token uploadImage(VkImage image, VkFormat format, uint32_t width, uint32_t height, const std::vector<const void*>& layers,
+                      VkDeviceSize layerSize, uint32_t mipLevels = 1u, VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+    /// uploads the whole precomputed mip chain (TextureCache), levels[i] holds all the layers of mip level i one after another
+    /// and leaves the image in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, see uploadImage for oldLayout
+    Token uploadImageLevels(VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t layersCount,
+                            const std::vector<std::pair<const void*, VkDeviceSize>>& levels,
+                            VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+    /// fills every mip level and layer by one repeated texel block (blockExtent x blockExtent texels of blockSize bytes,
+    /// 4x4 for block compressed formats) and leaves the image in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    /// Note: vkCmdClearColorImage does not accept compressed formats, the copies read a few staged rows of blocks instead
+    Token fillImage(VkImage image, VkFormat format, uint32_t width, uint32_t height, const void* block, uint32_t blockSize,
+                    uint32_t blockExtent, uint32_t mipLevels = 1u, uint32_t layersCount = 1u);
+
+    /// graphics command buffer of the open batch for recording of custom upload commands (see Utils::VulkanTransitionImageLayout)
+    /// Note: resources referenced by the commands must stay alive until the token of the batch is complete
+    VkCommandBuffer getCommandBuffer();
+
+    /// token which will be signaled by the open batch (or by the last submitted one if nothing is recorded)
+    Token getCurrentToken() const;
+
+    /// submits the open batch, the commands submitted to the graphics queue later on see its results
+    Token flush();
+
+    bool isComplete(Token token) const;
+
+    /// flushes the open batch if the token belongs to it
+    void wait(Token token);
+
+    void waitIdle();
+
+private:
+    struct Batch {
+        Token token{0u};
+        VkCommandBuffer graphicsCmd{nullptr};
+        VkCommandBuffer transferCmd{nullptr};  // only with a dedicated transfer queue
+        VkDeviceSize ringEnd{0u};
+        std::vector<std::pair<VkBuffer, VkDeviceMemory>> oversizedStaging;  // data not fitting into the ring
+    };
+
+    struct StagingRegion {
+        VkBuffer buffer{nullptr};
+        VkDeviceSize offset{0u};
+        char* data{nullptr};
+    };
+
+    Batch& openBatch();
+    /// transition into VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copies and ownership transfer to the graphics queue family
+    void recordImageCopy(VkImage image, VkFormat format, VkBuffer stagingBuffer, const std::vector<VkBufferImageCopy>& regions,
+                         uint32_t mipLevels, uint32_t layersCount, VkImageLayout oldLayout);
+    VkCommandBuffer getTransferCommandBuffer();
+    VkCommandBuffer beginCommandBuffer(VkCommandPool cmdPool);
+    StagingRegion allocateStaging(VkDeviceSize size, VkDeviceSize alignment);
+    StagingRegion allocateDedicatedStaging(VkDeviceSize size);
+    void retireCompleted();
+    void releaseBatch(Batch& batch);
+
+    bool hasTransferQueue() const {
+        return m_transferQueue != nullptr;
+    }
+
+    VkDevice m_device{nullptr};
+    VkPhysicalDevice m_physicalDevice{nullptr};
+    VkQueue m_graphicsQueue{nullptr};
+    VkQueue m_transferQueue{nullptr};
+    uint32_t m_graphicsFamily{0u};
+    uint32_t m_transferFamily{0u};
+    VkCommandPool m_graphicsCmdPool{nullptr};
+    VkCommandPool m_transferCmdPool{nullptr};
+    VkSemaphore m_timeline{nullptr};          // signaled by the graphics part of a batch
+    VkSemaphore m_transferTimeline{nullptr};  // signaled by the transfer part of a batch
+
+    VkBuffer m_ringBuffer{nullptr};
+    VkDeviceMemory m_ringMemory{nullptr};
+    char* m_ringData{nullptr};
+    VkDeviceSize m_ringHead{0u};  // virtual offsets, physical one is offset % STAGING_RING_SIZE
+    VkDeviceSize m_ringTail{0u};
+    VkDeviceSize m_copyAlignment{16u};
+
+    std::unique_ptr<Batch> m_openBatch{nullptr};
+    std::deque<Batch> m_inFlight{};
+    Token m_nextToken{1u};
+    Token m_submittedToken{0u};
+};
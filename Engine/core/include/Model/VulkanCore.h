@@ -41,8 +41,11 @@ public:
         UNKNOWN = 0xFFFF 
     };
 
+    static constexpr uint32_t MAX_BINDLESS_TEXTURES = 512u;
+
     enum Queue_family {
         GFX_QUEUE_FAMILY = 0,
+        TRANSFER_QUEUE_FAMILY,  // dedicated (DMA) transfer queue for uploads, optional
 #if defined(USE_FSR) && USE_FSR
         FSR_PRESENT_QUEUE_FAMILY,
         FSR_IMAGE_ACQUIRE_QUEUE_FAMILY,
@@ -76,6 +79,12 @@ public:
         return m_surface;
     }
 
+    /// no surface and swapchain, the renderer creates offscreen images in place of the swapchain ones.
+    /// VK_KHR_swapchain is still enabled on the device for VK_IMAGE_LAYOUT_PRESENT_SRC_KHR of the final passes
+    bool isHeadless() const {
+        return m_winController->isHeadless();
+    }
+
     int getQueueFamily() const {
         return m_queues.at(Queue_family::GFX_QUEUE_FAMILY).familyIndex;
     }
@@ -115,6 +124,24 @@ public:
         return m_isDlssSupported;
     }
 
+    bool isTextureCompressionBCSupported() const {
+        return m_isTextureCompressionBCSupported;
+    }
+
+    bool isMemoryBudgetSupported() const {
+        return m_isMemoryBudgetSupported;
+    }
+
+    /// bindless materials: runtime sized, partially bound sampled image arrays of at least MAX_BINDLESS_TEXTURES
+    bool isDescriptorIndexingSupported() const {
+        return m_isDescriptorIndexingSupported;
+    }
+
+    /// pipeline statistics queries which stay active across the executed secondary command buffers
+    bool isPipelineStatisticsQuerySupported() const {
+        return m_isPipelineStatisticsQuerySupported;
+    }
+
 private:
     void createInstance();
 #if defined(USE_DLSS) && USE_DLSS
@@ -133,6 +160,10 @@ private:
     Utils::VulkanPhysicalDevices m_physDevices{};
     VkDevice m_device = nullptr;
     bool m_isDlssSupported = false;
+    bool m_isTextureCompressionBCSupported = false;
+    bool m_isMemoryBudgetSupported = false;
+    bool m_isDescriptorIndexingSupported = false;
+    bool m_isPipelineStatisticsQuerySupported = false;
 #if defined(_DEBUG)
     VkDebugReportCallbackEXT m_callback = nullptr;
 #endif
@@ -140,6 +171,7 @@ private:
     int m_gfxDevIndex = -1;
 
     std::map<Queue_family, Queue> m_queues{{GFX_QUEUE_FAMILY, {-1, 0, nullptr}},
+                                           {TRANSFER_QUEUE_FAMILY, {-1, 0, nullptr}},
 #if defined(USE_FSR) && USE_FSR
                                            {FSR_PRESENT_QUEUE_FAMILY, {-1, 0, nullptr}},
                                            {FSR_IMAGE_ACQUIRE_QUEUE_FAMILY, {-1, 0, nullptr}},
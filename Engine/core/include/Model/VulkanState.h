@@ -5,6 +5,7 @@
 
 #include <array>
 #include <vector>
+#include "HeadlessControl.h"
 #include "VulkanCore.h"
 
 #ifdef _WIN32
@@ -103,7 +104,10 @@ struct VulkanState {
         std::vector<VkDeviceMemory> buffersMemory{};
     };
 
-    VulkanState(std::string_view appName, uint16_t windowWidth, uint16_t windowHeight, uint16_t offscreenWidth = 0u, uint16_t offscreenHeight = 0u);
+    /// headlessFramesCount != 0: no window, the frames are rendered offscreen by the scripted HeadlessControl
+    /// inputReplay: HeadlessControl replays the recording instead of the scripted path
+    VulkanState(std::string_view appName, uint16_t windowWidth, uint16_t windowHeight, uint16_t offscreenWidth = 0u,
+                uint16_t offscreenHeight = 0u, uint32_t headlessFramesCount = 0u, const InputRecording* inputReplay = nullptr);
 
     uint16_t _windowWidth{0u};
     uint16_t _windowHeight{0u};
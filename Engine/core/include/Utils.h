@@ -11,6 +11,9 @@
 #include <windows.h>
 #endif
 
+#include "Logger.h"
+#include "MemoryAllocator.h"
+#include "UploadManager.h"
 #include "VertexData.h"
 
 namespace Utils {
@@ -25,22 +28,22 @@ struct VulkanPhysicalDevices {
     std::vector<std::vector<VkPresentModeKHR> > m_presentModes;
 };
 
-template <class... Args>
-void printLog(bool isCritical, Args... args) {
-    std::stringstream output;
-    /// before c++17 int dummy[sizeof...(Args)] = { (output << args, 0)... };
-    (output << ... << args) << "\n";
-
-    const std::string& msg = output.str();
-    std::cout << msg;
-
-    if (isCritical) {
+/// the arguments are formatted only if the level passes the filters of Logger, a critical message throws after it is written
+template <Logger::Level level, class... Args>
+void printLog(Logger::LevelTag<level>, const Args&... args) {
+    if constexpr (level == Logger::Level::CRITICAL) {
+        const std::string msg{Logger::format(args...)};
+        Logger::log(level, msg);
 #ifdef _WIN32
         MessageBoxA(NULL, msg.c_str(), NULL, 0);
 #elif __linux__
         /// TO DO
 #endif
         throw std::runtime_error(msg.c_str());
+    } else if constexpr (level >= Logger::COMPILED_LEVEL) {
+        if (Logger::isEnabled(level)) {
+            Logger::log(level, Logger::format(args...));
+        }
     }
 }
 
@@ -49,6 +52,10 @@ void printErrorF(const char* pFileName, size_t line, const char* pFuncName, cons
 
 std::string formPath(std::string_view dir, std::string_view fileName);
 
+/// FNV-1a, the first call takes HASH_OFFSET_BASIS, the next ones continue the hash of the previous data
+static constexpr uint64_t HASH_OFFSET_BASIS = 14695981039346656037ull;
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size);
+
 void VulkanCheckValidationLayerSupport();
 
 void VulkanEnumExtProps(std::vector<VkExtensionProperties>& ExtProps);
@@ -58,34 +65,44 @@ void VulkanGetPhysicalDevices(VkInstance inst, VkSurfaceKHR Surface, VulkanPhysi
 size_t VulkanFindMemoryType(VkPhysicalDevice physicalDevice, const VkMemoryRequirements& memRequirements,
                             VkMemoryPropertyFlags properties);
 
+/// Note: bufferMemory may be shared with other resources (see MemoryAllocator), release it by VulkanDestroyBuffer only
 void VulkanCreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage,
-                        VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+                        VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+                        MemoryAllocator::Usage memoryUsage = MemoryAllocator::Usage::AUTO,
+                        MemoryAllocator::Category category = MemoryAllocator::Category::AUTO);
+
+void VulkanDestroyBuffer(VkDevice device, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 
 void VulkanCreateExternalBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage,
                         VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 
-void VulkanCopyBuffer(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkBuffer srcBuffer, VkBuffer dstBuffer,
-                      VkDeviceSize size);
-
-void VulkanCopyBufferToImage(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkBuffer buffer, VkImage image,
-                             uint32_t width, uint32_t height, uint32_t layersCount = 1U);
+/// Note: the commands below are recorded into the open upload batch and executed on UploadManager::flush(),
+///       source buffers must stay alive until the batch is complete (UploadManager::uploadBuffer/uploadImage take care of it)
+void VulkanCopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 
-VkShaderModule VulkanCreateShaderModule(VkDevice device, std::string_view fileName);
+void VulkanCopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layersCount = 1U);
 
+/// Note: imageMemory may be shared with other resources (see MemoryAllocator), release it by VulkanDestroyImage only
 VkResult VulkanCreateImage(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t width, uint32_t height, VkFormat format,
                            VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image,
-                           VkDeviceMemory& imageMemory, uint32_t mipLevels = 1U, uint32_t arrayLayers = 1U);
+                           VkDeviceMemory& imageMemory, uint32_t mipLevels = 1U, uint32_t arrayLayers = 1U,
+                           MemoryAllocator::Usage memoryUsage = MemoryAllocator::Usage::AUTO,
+                           MemoryAllocator::Category category = MemoryAllocator::Category::AUTO);
+
+void VulkanDestroyImage(VkDevice device, VkImage& image, VkDeviceMemory& imageMemory);
+
+void VulkanGenerateMipmaps(VkImage image, VkFormat imageFormat, int16_t texWidth, int16_t texHeight, uint8_t mipLevels,
+                           uint8_t layersAmount = 1u);
 
-void VulkanGenerateMipmaps(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkImage image, VkFormat imageFormat,
-                           int16_t texWidth, int16_t texHeight, uint8_t mipLevels, uint8_t layersAmount = 1u);
+/// viewport and scissor of the whole render area, the pipelines take them as dynamic states
+void VulkanSetViewport(VkCommandBuffer commandBuffer, const VkExtent2D& extent);
 
 void VulkanImageMemoryBarrier(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout,
                               VkImageLayout newLayout, VkImageAspectFlags aspectMask, uint32_t mipLevels, uint32_t layersCount,
                               VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags sourceStage,
                               VkPipelineStageFlags destinationStage);
 
-void VulkanTransitionImageLayout(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkImage image, VkFormat format,
-                                 VkImageLayout oldLayout, VkImageLayout newLayout,
+void VulkanTransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
                                  VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, uint32_t mipLevels = 1U,
                                  uint32_t layersCount = 1U);
 
@@ -96,22 +113,28 @@ VkResult VulkanCreateImageView(VkDevice device, VkImage image, VkFormat format,
 bool VulkanFindSupportedFormat(VkPhysicalDevice physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling,
                                VkFormatFeatureFlags features, VkFormat& ret_format);
 
+/// Note: geometry is uploaded asynchronously, the returned token is complete once the buffer content is on the GPU
 template <class T>
-void createGeneralBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool cmdBufPool, VkQueue queue,
-                         const std::vector<uint32_t>& indices, const std::vector<T>& vertices, VkDeviceSize& verticesBufferOffset,
-                         VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory);
+UploadManager::Token createGeneralBuffer(VkDevice device, VkPhysicalDevice physicalDevice, const std::vector<uint32_t>& indices,
+                                         const std::vector<T>& vertices, VkDeviceSize& verticesBufferOffset,
+                                         VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory);
 
 template <class T>
-void createGeneral3in1Buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool cmdBufPool, VkQueue queue,
-                         const std::vector<uint32_t>& indices, const std::vector<T>& vertices,
-                         const std::vector<Instance>& instances, VkDeviceSize& verticesBufferOffset,
-                         VkDeviceSize& instancesBufferOffset, VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory);
+UploadManager::Token createGeneral3in1Buffer(VkDevice device, VkPhysicalDevice physicalDevice,
+                                             const std::vector<uint32_t>& indices, const std::vector<T>& vertices,
+                                             const std::vector<Instance>& instances, VkDeviceSize& verticesBufferOffset,
+                                             VkDeviceSize& instancesBufferOffset, VkBuffer& generalBuffer,
+                                             VkDeviceMemory& generalBufferMemory);
 }  // namespace Utils
 
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 #define ARRAY_SIZE_IN_ELEMENTS(a) (sizeof(a) / sizeof(a[0]))
-#define INFO_PARAM false, "\nin file: ", __FILE__, " at line: ", __LINE__, " from function: ", __FUNCTION__, " \n "
-#define ERROR_PARAM true, "\nin file: ", __FILE__, " at line: ", __LINE__, " from function: ", __FUNCTION__, " \n "
+#define LOG_PARAM(level) \
+    Logger::LevelTag<level>{}, "\nin file: ", __FILE__, " at line: ", __LINE__, " from function: ", __FUNCTION__, " \n "
+#define DEBUG_PARAM LOG_PARAM(Logger::Level::DEBUG)
+#define INFO_PARAM LOG_PARAM(Logger::Level::INFO)
+#define WARNING_PARAM LOG_PARAM(Logger::Level::WARNING)
+#define ERROR_PARAM LOG_PARAM(Logger::Level::CRITICAL)
 #ifdef _WIN32
 #define INFO_FORMAT(msg, ...) Utils::printInfoF(__FILE__, __LINE__, __FUNCTION__, msg, __VA_ARGS__)
 #define ERROR_FORMAT(msg, ...) Utils::printErrorF(__FILE__, __LINE__, __FUNCTION__, msg, __VA_ARGS__)
@@ -180,17 +180,9 @@ public:
 
     virtual ~I3DModel() {
         std::ignore = vkDeviceWaitIdle(m_vkState._core.getDevice());
-        if (m_generalBuffer)
-            vkDestroyBuffer(m_vkState._core.getDevice(), m_generalBuffer, nullptr);
-        if (m_generalBufferMemory)
-            vkFreeMemory(m_vkState._core.getDevice(), m_generalBufferMemory, nullptr);
-        for (auto& buf : m_instancesBuffer) {
-            if (buf)
-                vkDestroyBuffer(m_vkState._core.getDevice(), buf, nullptr);
-        }   
-        for (auto& mem : m_instancesBufferMemory) {
-            if (mem)
-                vkFreeMemory(m_vkState._core.getDevice(), mem, nullptr);
+        Utils::VulkanDestroyBuffer(m_vkState._core.getDevice(), m_generalBuffer, m_generalBufferMemory);
+        for (size_t i = 0u; i < m_instancesBuffer.size(); ++i) {
+            Utils::VulkanDestroyBuffer(m_vkState._core.getDevice(), m_instancesBuffer[i], m_instancesBufferMemory[i]);
         }
     }
 
@@ -210,6 +202,15 @@ public:
         return m_radius;
     }
 
+    /// the instances left by the culling of the last update (the high-poly ones if the model has the low-poly mesh)
+    virtual std::size_t getVisibleInstancesCount() const {
+        return m_activeInstances.size();
+    }
+
+    std::size_t getVisibleLowPolyInstancesCount() const {
+        return m_lowPolyMesh ? m_lowPolyMesh->getVisibleInstancesCount() : 0u;
+    }
+
     /** Note: 
     *   - param 'viewProj', 'camPos' and 'z_far'
     *   are actual for models with many instances
@@ -222,13 +223,25 @@ public:
         // actual for animated models
     }
 
+    /// texture streaming: requests the mip levels of the model textures by the screen size of the closest visible instance,
+    /// models of unknown size (radius is 0) request the finest levels
+    void requestTextureLevels(const glm::mat4& viewProj, const glm::vec3& camPos);
+
+    /// frustum culling of the instances [indexFrom, indexTo) by their bounding spheres (biasValue * scale), the visible ones
+    /// closer than LOD_TRESHOLD * z_far go to activeInstances, the farther ones to activeInstancesLowPoly if has_lowPolyMesh
+    /// Note: needs no device, sortInstances runs it on ACTIVE_POOL_THREADS chunks
+    static void filterInstances(const std::vector<Instance>& instances, std::size_t indexFrom, std::size_t indexTo,
+                                float biasValue, const glm::mat4& viewProj, float z_far, const glm::vec3& camPos,
+                                bool has_lowPolyMesh, std::vector<Instance>& activeInstances,
+                                std::vector<Instance>& activeInstancesLowPoly);
+
 protected:
     void sortInstances(uint32_t currentImage, const glm::mat4& viewProj, const glm::vec3& camPos, float z_far);
 
-private:
-    void filterInstances(std::size_t indexFrom, std::size_t indexTo, float biasValue, const glm::mat4& viewProj,
-                         float z_far, const glm::vec3& camPos, std::vector<Instance>& activeInstances, 
-                         std::vector<Instance>& activeInstancesLowPoly);
+    /// the host visible instances buffer of the swapchain image is recreated when instancesCount doesn't fit it, the
+    /// capacity grows by half at least, so instances added at runtime don't recreate it every frame
+    /// Note: the buffer must not be in use by the GPU, the fence of the image was waited for by the update
+    void reserveInstancesBuffer(uint32_t currentImage, std::size_t instancesCount);
 
 protected:
     const VulkanState& m_vkState;
@@ -247,6 +260,8 @@ protected:
     std::vector<Instance> m_activeInstances{};
     std::vector<VkBuffer> m_instancesBuffer{};
     std::vector<VkDeviceMemory> m_instancesBufferMemory{};
+    std::vector<std::size_t> m_instancesBufferCapacity{};  // in instances, per swapchain image
+    std::vector<std::weak_ptr<TextureFactory::Texture>> m_textures{};  // textures sampled by the model
 
 private:
     std::vector<std::vector<Instance>> m_activeInstancesTemp{ACTIVE_POOL_THREADS};
@@ -2,6 +2,9 @@
 
 #include "I3DModel.h"
 
+#include <istream>
+#include <mutex>
+
 // due to synchronization with CUDA to get the new amount of instances, it is not efficient at least for small amount of instances
 #define SORT_INSTANCES_ON_CUDA 0
 
@@ -30,17 +33,9 @@ public:
     }
     virtual ~MD5Model() {
         std::ignore = vkDeviceWaitIdle(m_vkState._core.getDevice());
-        for (auto& buf : m_CUDAandCPUaccessibleBufs) {
-            if (buf != nullptr) {
-                vkDestroyBuffer(m_vkState._core.getDevice(), buf, nullptr);
-                buf = VK_NULL_HANDLE;
-            }
-        }
-        for (auto& mem : m_CUDAandCPUaccessibleMems) {
-            if (mem != nullptr) {
-                vkFreeMemory(m_vkState._core.getDevice(), mem, nullptr);
-                mem = VK_NULL_HANDLE;
-            }
+        for (uint32_t i = 0u; i < AnimationType::ANIMATION_TYPE_SIZE; ++i) {
+            Utils::VulkanDestroyBuffer(m_vkState._core.getDevice(), m_CUDAandCPUaccessibleBufs[i],
+                                       m_CUDAandCPUaccessibleMems[i]);
         }
 
         // m_generalBuffer/m_generalBufferMemory are referenced by m_CUDAandCPUaccessibleBufs/m_CUDAandCPUaccessibleMems, 
@@ -62,10 +57,32 @@ public:
                 const glm::mat4& viewProj = glm::mat4(1.0f), float z_far = 1.0f,
                 const glm::vec3& camPos = glm::vec3(0.0f)) override;
 
+    /// the instances sorted on CUDA never reach m_activeInstances
+    std::size_t getVisibleInstancesCount() const override {
+        return mActiveInstancesAmount;
+    }
+
+    /// the CPU side of the model without any device (loading, skinning), also used by the microbenchmarks
+    /// parses the .md5mesh text: skeleton, subsets with the bind pose vertices scaled by vertexMagnitudeMultiplier and
+    /// the joint space normals of the weights. outTextureNames: shader texture of every subset (empty if none),
+    /// outRadius: the farthest bind pose vertex before the scaling
+    static void parseModel(std::istream& fileIn, float vertexMagnitudeMultiplier, md5_animation::Model3D& outModel,
+                           std::vector<std::string>& outTextureNames, float& outRadius);
+    /// parses the .md5anim text and builds the skeleton of every frame, false if its joints don't match the model ones
+    static bool parseAnimation(std::istream& fileIn, const md5_animation::Model3D& model,
+                               md5_animation::ModelAnimation& outAnimation);
+    /// joints [indexFrom, indexTo) of the skeleton interpolated between two frames
+    static void interpolateSkeleton(const md5_animation::ModelAnimation& animation, std::size_t frame0, std::size_t frame1,
+                                    float interpolation, std::size_t indexFrom, std::size_t indexTo,
+                                    std::vector<md5_animation::Joint>& outSkeleton);
+    /// positions and normals of the subset vertices [indexFrom, indexTo) posed by the skeleton
+    static void skinVertices(md5_animation::ModelSubset& subset, const std::vector<md5_animation::Joint>& skeleton,
+                             float vertexMagnitudeMultiplier, bool is_swapYZNeeded, std::size_t indexFrom, std::size_t indexTo);
+
 private:
     bool loadMD5Anim();
     bool loadMD5Model(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices);
-    inline void swapYandZ(glm::vec3& vertexData);
+    static inline void swapYandZ(glm::vec3& vertexData);
     void updateAnimationChunk(std::size_t subsetId, std::size_t indexFrom, std::size_t indexTo);
     void calculateInterpolatedSkeleton(std::size_t animationID, std::size_t frame0, std::size_t frame1, float interpolation,
                                        std::size_t indexFrom, std::size_t indexTo);
@@ -96,6 +113,8 @@ private:
     VkSemaphore mVkCudaSyncObject{nullptr};  // for synchronization with CUDA
     bool mIsCudaCalculationRequested{false};
     mutable uint64_t mWaitCudaSignalValue{1};  // wait for CUDA signal value
+    mutable std::mutex mCudaSignalMutex;
+    mutable uint32_t mLastWaitedDescriptorSetIndex{UINT32_MAX};
     // CPU accessible buffer and CUDA\GPU accessible buffer
     VkBuffer m_CUDAandCPUaccessibleBufs[AnimationType::ANIMATION_TYPE_SIZE]{nullptr};
     VkDeviceMemory m_CUDAandCPUaccessibleMems[AnimationType::ANIMATION_TYPE_SIZE]{nullptr};
@@ -2,6 +2,9 @@
 
 #include "I3DModel.h"
 
+#include <tiny_obj_loader.h>
+#include <unordered_map>
+
 class ObjModel : public I3DModel {
 public:
     ObjModel(const VulkanState& vulkanState, TextureFactory& textureFactory, std::string_view path,
@@ -21,6 +24,13 @@ public:
                                 uint32_t dynamicOffset) const override;
     void drawFootprints(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex = 0U, uint32_t dynamicOffset = 0U) const override;
 
+    /// appends the triangles of the shape, equal vertices are stored once (OBJ indexes the attributes separately), tangents
+    /// and bitangents are accumulated if is_bumpMappingValid, outRadius grows to the farthest added vertex
+    /// Note: needs no device, used by load and the microbenchmarks
+    static void appendShape(const tinyobj::attrib_t& attrib, const tinyobj::shape_t& shape, bool is_bumpMappingValid,
+                            std::unordered_map<Vertex, uint32_t>& uniqueVertices, std::vector<Vertex>& vertices,
+                            std::vector<uint32_t>& indices, float& outRadius);
+
 private:
     void load(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
     void filterInstances(std::size_t indexFrom, std::size_t indexTo, float biasValue, const glm::mat4& viewProj,
@@ -90,16 +90,18 @@ public:
 
     ~Particle();
 
-    // for filling z plane with particles (bushes, wind cloud etc) which perpendicular to z-plane
+    // for filling z plane with particles (bushes, wind cloud etc) which perpendicular to z-plane,
+    // seed of the random placement
     Particle(const VulkanState& vulkanState, TextureFactory& textureFactory, std::string_view textureFileName,
              PipelineCreatorParticle* pipelineCreator, uint32_t instancesAmount, float zFar = 0.0f,
-             const glm::vec3& scale = glm::vec3(1.0f)) noexcept(true);
+             const glm::vec3& scale = glm::vec3(1.0f), uint32_t seed = 0u) noexcept(true);
 
-    // for effects like fire, smoke etc, parallel to user face
+    // for effects like fire, smoke etc, parallel to user face, seed of the random lifetimes and speeds
     Particle(const VulkanState& vulkanState, TextureFactory& textureFactory, std::string_view particleTextureFileName,
              std::string_view particleGradientTextureFileName, PipelineCreatorParticle* pipelineCreator, uint32_t instancesAmount,
              const glm::vec3& positionOrigin = glm::vec3(0.0f), const glm::vec3& velocity = glm::vec3(0.0f),
-             const glm::vec3& minScale = glm::vec3(1.0f), const glm::vec3& maxScale = glm::vec3(1.0f)) noexcept(true);
+             const glm::vec3& minScale = glm::vec3(1.0f), const glm::vec3& maxScale = glm::vec3(1.0f),
+             uint32_t seed = 0u) noexcept(true);
 
     void update(uint32_t currentImage, float deltaMS = 0.0f, const glm::vec4& offsetPosition = glm::vec4(0.0f),
                 const glm::vec4& velocity = glm::vec4(0.0f));
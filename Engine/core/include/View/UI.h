@@ -14,11 +14,87 @@ class UI {
 public:
     struct States {
         std::pair<const char*, bool> gpuAnimationEnabled{"favor animation calculation on GPU", true};
-        std::pair<const char*, bool> placeHolder1{"placeHolder1", true};
-        std::pair<const char*, bool> placeHolder2{"placeHolder2", true};
+        std::pair<const char*, bool> bloomEnabled{"bloom", true};
+        std::pair<const char*, bool> pipelineStatisticsEnabled{"pipeline statistics", false};
         bool resolutionChanged = false;
         int16_t nextWidth = 0;
         int16_t nextHeight = 0;
+        bool qualityChanged = false;     // qualityLevel of the parameter qualityIndex (see Stats::qualityParameters)
+        uint32_t qualityIndex = 0u;
+        uint32_t qualityLevel = 0u;
+        bool renderGraphDumpRequested = false;  // the compiled render graph of the next frame is logged
+        bool gpuTimingsExportRequested = false;  // the GPU timings history is written to Constants::GPU_TIMINGS_FILE
+        bool cpuTraceCaptureRequested = false;   // the CPU scopes of the next frame are written to Constants::CPU_TRACE_FILE
+        bool telemetryExportRequested = false;   // the frame telemetry history is written to Constants::TELEMETRY_FILE
+    };
+
+    struct QualityParameter {
+        const char* name = nullptr;
+        uint32_t level = 0u;
+        uint32_t levelsCount = 1u;
+        uint32_t value = 0u;          // of the current level
+        bool is_compiling = false;    // the variant of the level is compiled in background, the previous one is drawn
+    };
+
+    static constexpr uint32_t MAX_QUALITY_PARAMETERS = 8u;
+
+    struct GpuScope {
+        const char* name = nullptr;
+        uint32_t level = 0u;       // nesting level, the frame is 0
+        float lastMs = 0.0f;       // negative if the last resolved frame didn't record the scope
+        float averageMs = 0.0f;
+        float maxMs = 0.0f;
+        bool has_statistics = false;  // pipeline statistics of the last resolved frame, the passes only
+        uint64_t inputVertices = 0u;
+        uint64_t inputPrimitives = 0u;
+        uint64_t vertexInvocations = 0u;
+        uint64_t tessControlPatches = 0u;
+        uint64_t tessEvaluationInvocations = 0u;
+        uint64_t clippingPrimitives = 0u;
+        uint64_t fragmentInvocations = 0u;
+        float overdraw = 0.0f;     // fragments per offscreen pixel
+        float acmr = 0.0f;         // vertex shader invocations per primitive
+        float vertexReuse = 0.0f;  // share of the vertices served by the post-transform cache
+    };
+
+    static constexpr uint32_t MAX_GPU_SCOPES = 32u;
+    static constexpr uint32_t GPU_HISTORY_SIZE = 256u;
+
+    static constexpr uint32_t MAX_MEMORY_HEAPS = 16u;
+    static constexpr uint32_t MAX_MEMORY_CATEGORIES = 8u;
+
+    struct MemoryHeap {
+        bool is_deviceLocal = false;
+        uint64_t liveBytes = 0u;
+        uint64_t peakBytes = 0u;
+        uint64_t budgetBytes = 0u;
+        uint64_t usageBytes = 0u;  // by the process, other processes share the budget
+        bool is_overBudget = false;  // over MemoryAllocator::BUDGET_WARNING_RATIO of the budget
+        std::array<uint64_t, MAX_MEMORY_CATEGORIES> categoryLiveBytes{};
+        std::array<uint64_t, MAX_MEMORY_CATEGORIES> categoryPeakBytes{};
+    };
+
+    struct Stats {
+        uint64_t textureResidentBytes = 0u;
+        uint64_t textureRequestedBytes = 0u;
+        uint64_t textureBudgetBytes = 0u;
+        uint32_t streamingTexturesCount = 0u;
+        std::array<QualityParameter, MAX_QUALITY_PARAMETERS> qualityParameters{};
+        uint32_t qualityParametersCount = 0u;
+        float recordingTimeMs = 0.0f;       // CPU time of the command buffers recording of the previous frame
+        uint32_t recordingThreadsCount = 1u;
+        uint32_t reusedPassesCount = 0u;     // of the previous frame, see CommandBufferCache
+        uint32_t recordedPassesCount = 0u;
+        bool is_gpuTimingSupported = false;  // timestamp queries on the graphics queue, see GpuProfiler
+        bool is_pipelineStatisticsSupported = false;
+        std::array<GpuScope, MAX_GPU_SCOPES> gpuScopes{};  // the frame first
+        uint32_t gpuScopesCount = 0u;
+        std::array<float, GPU_HISTORY_SIZE> gpuFrameHistoryMs{};  // GPU time of the frames, oldest first
+        uint32_t gpuFrameHistoryCount = 0u;
+        std::array<MemoryHeap, MAX_MEMORY_HEAPS> memoryHeaps{};  // see MemoryAllocator
+        uint32_t memoryHeapsCount = 0u;
+        std::array<const char*, MAX_MEMORY_CATEGORIES> memoryCategoryNames{};
+        uint32_t memoryCategoriesCount = 0u;
     };
 
     constexpr UI() : m_resolutions{{
@@ -30,8 +106,13 @@ public:
 
     const States& updateAndDraw();
 
+    void setStats(const Stats& stats) {
+        mStats = stats;
+    }
+
 private:
     States mStates;
+    Stats mStats;
     std::array<ResolutionEntry, 4> m_resolutions;
     int m_selectedIdx = 0;
 };
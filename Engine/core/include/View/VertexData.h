@@ -39,6 +39,19 @@ struct alignas(16) Instance
     uint64_t prev_model_col1 = model_col1;
     uint64_t prev_model_col2 = model_col2;
     uint64_t prev_model_col3 = model_col3;
+
+    /// the current columns become the previous ones (motion vectors), the new matrix is packed to half floats
+    void setModelMatrix(const glm::mat4& model) {
+        prev_model_col0 = model_col0;
+        prev_model_col1 = model_col1;
+        prev_model_col2 = model_col2;
+        prev_model_col3 = model_col3;
+
+        model_col0 = glm::packHalf4x16(model[0]);
+        model_col1 = glm::packHalf4x16(model[1]);
+        model_col2 = glm::packHalf4x16(model[2]);
+        model_col3 = glm::packHalf4x16(model[3]);
+    }
 };
 
 namespace md5_animation {
@@ -11,6 +11,9 @@ layout(input_attachment_index = 2, set = 0, binding = 2) uniform subpassInput in
 layout(binding = 3) uniform sampler2D inputDepth;
 layout(binding = 4) uniform sampler2D inputShadowMap;
 
+// quality parameter: radius of the shadow PCF kernel in texels, 0 is a single tap
+layout (constant_id = 0) const int SHADOW_PCF_RADIUS = 1;
+
 
 layout(set = 0, binding = 5) uniform UBOViewProjectionObject {
     mat4 viewProj;
@@ -59,16 +62,16 @@ float getShading(vec3 world, float bias)
     // calculate average shading basing on nearest pixels
     float shadow = 0.0;
     vec2 texelSize = 1.0 / textureSize(inputShadowMap, 0);
-    for(int x = -1; x <= 1; ++x)
+    for(int x = -SHADOW_PCF_RADIUS; x <= SHADOW_PCF_RADIUS; ++x)
     {
-        for(int y = -1; y <= 1; ++y)
+        for(int y = -SHADOW_PCF_RADIUS; y <= SHADOW_PCF_RADIUS; ++y)
         {
             float pcfDepth = texture(inputShadowMap, normalizedCoords.xy + vec2(x, y) * texelSize).r;
             // check whether current frag pos is in shadow
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;        
         }    
     }
-    shadow /= 9.0;
+    shadow /= float((2 * SHADOW_PCF_RADIUS + 1) * (2 * SHADOW_PCF_RADIUS + 1));
 
     return 1.0 - shadow;
 }
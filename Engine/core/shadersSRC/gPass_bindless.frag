@@ -0,0 +1,49 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// bindless variant of gPass.frag: the textures of all the materials, indexed by the material of the draw
+// 2D Array of textures: diffuse, bump(optional)
+layout(binding = 1) uniform sampler2DArray texSamplers[];
+
+struct Material {
+    uint textureIndex;
+    uint layersCount;
+    uint padding0;
+    uint padding1;
+};
+
+layout(std430, binding = 3) readonly buffer Materials {
+    Material materials[];
+};
+
+layout(push_constant) uniform PushConstant {
+    uint materialIndex;
+} pushConstant;
+
+layout(location = 0)
+in VS_OUT {
+    vec2 TexCoord;
+    float isBumpMapping;
+    mat3 TBN;
+} fs_in;
+
+layout(location = 0) out vec4 out_Color; // not used in g-pass
+layout(location = 1) out vec4 out_GPass[2];
+
+void main() {
+  // the index is uniform for the draw, no nonuniformEXT needed
+  const Material material = materials[pushConstant.materialIndex];
+  vec3 normal = vec3(0.0, 0.0, 0.0);
+  if (fs_in.isBumpMapping > 0.0 && material.layersCount > 1) {
+    normal = texture(texSamplers[material.textureIndex], vec3(fs_in.TexCoord, 1.0)).rgb;
+    // from [0, 1] to [-1,1]
+    normal = normal * 2.0 - 1.0;  
+    // from texture to world orientation  
+    normal = fs_in.TBN * normal;
+  } else {
+    normal = fs_in.TBN[2];
+  }
+  // Normals, pack -1, +1 range to 0, 1.
+  out_GPass[0] = vec4(0.5 * normalize(normal) + 0.5, 1.0);
+  out_GPass[1] = texture(texSamplers[material.textureIndex], vec3(fs_in.TexCoord, 0.0));
+}
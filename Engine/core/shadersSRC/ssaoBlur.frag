@@ -6,23 +6,24 @@ layout(location = 0) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 out_color;
 
-const int blurFactor = 2;
+// quality parameter, the loops are unrolled by the driver
+layout (constant_id = 0) const int SSAO_BLUR_RADIUS = 2;
 
 void main()
 {
     vec2 texelSize = 1.0 / vec2(textureSize(inputSSAOTexture, 0));
     float result = 0.0;
 	vec2 offset = vec2(0.0);
-    for (int x = -blurFactor; x < blurFactor; ++x) 
+    for (int x = -SSAO_BLUR_RADIUS; x < SSAO_BLUR_RADIUS; ++x) 
     {
-        for (int y = -blurFactor; y < blurFactor; ++y) 
+        for (int y = -SSAO_BLUR_RADIUS; y < SSAO_BLUR_RADIUS; ++y) 
         {
             offset = vec2(float(x), float(y)) * texelSize;
             result += texture(inputSSAOTexture, fragTexCoord + offset).r;
         }
     }
 	
-    result /= pow(blurFactor + blurFactor, 2);
+    result /= pow(SSAO_BLUR_RADIUS + SSAO_BLUR_RADIUS, 2);
 
     out_color = vec4(vec3(0.0), 1.0 - result);
 	// for debug
@@ -0,0 +1,77 @@
+#include "HeadlessControl.h"
+
+#include <array>
+
+#include <imgui/imgui.h>
+
+#include "Utils.h"
+
+namespace {
+struct PathSegment {
+    uint32_t framesCount{0u};
+    uint32_t buttonFlag{0u};
+};
+
+// a loop around the scene: straight drives, turns while driving, reversing and turning on the spot
+constexpr std::array<PathSegment, 8> CAMERA_PATH{{
+    {240u, IControl::WindowQueueMSG::UP},
+    {45u, IControl::WindowQueueMSG::UP | IControl::WindowQueueMSG::LEFT},
+    {240u, IControl::WindowQueueMSG::UP},
+    {45u, IControl::WindowQueueMSG::UP | IControl::WindowQueueMSG::RIGHT},
+    {120u, IControl::WindowQueueMSG::DONW},
+    {90u, IControl::WindowQueueMSG::LEFT},
+    {180u, IControl::WindowQueueMSG::UP},
+    {90u, IControl::WindowQueueMSG::RIGHT},
+}};
+
+uint32_t getPathButtons(uint32_t frameIndex) {
+    static constexpr uint32_t PATH_FRAMES = [] {
+        uint32_t framesCount = 0u;
+        for (const auto& segment : CAMERA_PATH) {
+            framesCount += segment.framesCount;
+        }
+        return framesCount;
+    }();
+
+    uint32_t frame = frameIndex % PATH_FRAMES;
+    for (const auto& segment : CAMERA_PATH) {
+        if (frame < segment.framesCount) {
+            return segment.buttonFlag;
+        }
+        frame -= segment.framesCount;
+    }
+    return 0u;
+}
+}  // namespace
+
+HeadlessControl::~HeadlessControl() {
+    ImGui::DestroyContext();
+}
+
+void HeadlessControl::init() {
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::GetIO().DisplaySize = ImVec2(static_cast<float>(m_width), static_cast<float>(m_height));
+
+    Utils::printLog(INFO_PARAM, "headless mode, ", m_framesCount, " frames of ", m_width, "x", m_height,
+                    mp_inputReplay ? " replaying the recorded input" : "");
+}
+
+IControl::WindowQueueMSG HeadlessControl::processWindowQueueMSGs() {
+    m_windowQueueMsg.reset();
+    m_windowQueueMsg.hmiRenderData = false;
+    // the frame of the quit message is still rendered
+    m_windowQueueMsg.isQuited = m_frameIndex + 1u >= m_framesCount;
+    if (mp_inputReplay) {
+        const InputRecording::Frame& frame = mp_inputReplay->getFrames()[m_frameIndex];
+        m_windowQueueMsg.buttonFlag = frame.buttonFlag;
+        m_windowQueueMsg.mouseX = frame.mouseX;
+        m_windowQueueMsg.mouseY = frame.mouseY;
+        m_windowQueueMsg.replayedDeltaTimeMS = frame.deltaTimeMS;
+    } else {
+        m_windowQueueMsg.buttonFlag = getPathButtons(m_frameIndex);
+    }
+    ++m_frameIndex;
+
+    return m_windowQueueMsg;
+}
@@ -1,4 +1,7 @@
 #include "VulkanRenderer.h"
+#include "Constants.h"
+#include "CpuProfiler.h"
+#include "FrameTelemetry.h"
 #include "MD5Model.h"
 #include "ObjModel.h"
 #include "Particle.h"
@@ -18,6 +21,9 @@
 #include <chrono>
 #include <limits>
 #include <random>
+#include <thread>
+#include <tuple>
+#include <utility>
 
 #include <imgui/backends/imgui_impl_vulkan.h>
 #include <imgui/imgui.h>
@@ -57,8 +63,11 @@ static glm::vec3 _lastFootPrintPos = glm::vec3(0.0f, -1000.0f, 0.0f);
 // if the traveled distance exceeds 70 percentage of panzer lenght then we draw new footprint
 float _footPrintRedrawingK = 0.7f;
 
-VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, uint16_t windowHeight)
-    : VulkanState(appName, windowWidth, windowHeight, 1920, 1080),  // TODO
+VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, uint16_t windowHeight,
+                               uint32_t headlessFramesCount, const StressScene& stressScene,
+                               const InputRecording* inputReplay)
+    : VulkanState(appName, windowWidth, windowHeight, 1920, 1080, headlessFramesCount, inputReplay),  // TODO
+      m_stressScene(stressScene),
       mTextureFactory(new TextureFactory(*this)), /// this is not used imedially it's safe
       mCamera({FOV, static_cast<float>(windowWidth) / windowHeight, Z_NEAR, Z_FAR}, {0.0f, 55.0f, -130.0f}) {
     assert(mTextureFactory);
@@ -79,6 +88,7 @@ VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, u
                                                                   "tessCtrl_terrain.spv", "tessEval_terrain.spv", 0U,
                                                                   m_pushConstantRange));
     m_pipelineCreators[GPASS].reset(new PipelineCreatorTextured(*this, m_renderPass, "vert_gPass.spv", "frag_gPass.spv"));
+    static_cast<PipelineCreatorTextured*>(m_pipelineCreators[GPASS].get())->requestBindless("frag_gPass_bindless.spv");
     m_pipelineCreators[SKYBOX].reset(
         new PipelineCreatorSkyBox(*this, m_renderPass, "vert_skybox.spv", "frag_skybox.spv", 0u, m_pushConstantRange));
     m_pipelineCreators[SHADOWMAP].reset(new PipelineCreatorShadowMap(this->_shadowMapBuffer, *this, m_renderPassShadowMap,
@@ -87,7 +97,7 @@ VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, u
         *this, m_renderPass, "vert_gLigtingSubpass.spv", "frag_gLigtingSubpass.spv", true, true, 2u, m_pushConstantRange));
     m_pipelineCreators[POST_FXAA].reset(new PipelineCreatorQuad(*this, m_renderPassFXAA, "vert_fxaa.spv", "frag_fxaa.spv",
                                                                 &this->_colorBuffer, PipelineCreatorQuad::BLEND::NONE, true,
-                                                                m_pushConstantRange, true));
+                                                                m_pushConstantRange));
     m_pipelineCreators[PARTICLE].reset(new PipelineCreatorParticle(*this, m_renderPassSemiTrans, "vert_particle.spv",
                                                                    "frag_particle.spv", 0u, m_pushConstantRange));
     m_pipelineCreators[SEMI_TRANSPARENT].reset(new PipelineCreatorSemiTransparent(
@@ -108,6 +118,10 @@ VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, u
     m_pipelineCreators[SSAO_BLUR].reset(new PipelineCreatorQuad(*this, m_renderPassSSAOblur, "vert_ssaoBlur.spv",
                                                                 "frag_ssaoBlur.spv", &this->_shadingBuffer,
                                                                 PipelineCreatorQuad::BLEND::SRC_ALPHA_AND_DST_ONE_MINUS_ALPHA));
+    // quality parameters are the specialization constants of the shaders (constant_id)
+    m_pipelineCreators[TERRAIN]->declareQualityParameter("tessellation max level", 0u, {16u, 32u, 64u}, 2u);
+    m_pipelineCreators[POST_LIGHTING]->declareQualityParameter("shadow PCF radius", 0u, {0u, 1u, 2u}, 1u);
+    m_pipelineCreators[SSAO_BLUR]->declareQualityParameter("SSAO blur radius", 0u, {1u, 2u, 3u}, 1u);
     // validation
     for (auto i = 0u; i < Pipelines::MAX; ++i) {
         if (m_pipelineCreators[i] == nullptr) {
@@ -129,22 +143,20 @@ VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, u
     m_models.emplace_back(new Skybox(*this, *mTextureFactory, skyBoxTextures,
                                      static_cast<PipelineCreatorTextured*>(m_pipelineCreators[SKYBOX].get())));
 
+    // the placement of the objects is drawn from the seed of the stress scene
+    std::mt19937 gen(m_stressScene.seed);
+    const float limit = 0.8f * Z_FAR;
+
     // we create a lot of trees
     {
-        std::vector<Instance> semiTransparentInstances{TREES_COUNT};
-        std::random_device rd;
-        std::mt19937 gen(rd());  // seed the generator
-        float limit = 0.8f * Z_FAR;
+        std::vector<Instance> semiTransparentInstances(std::max(m_stressScene.treesCount, 1u));
         std::uniform_real_distribution<double> distrScale(0.5, 1.0); 
         int32_t gridLen = std::floor(std::sqrt(semiTransparentInstances.size()));
         float step = 2.0f * limit / gridLen;
-        // std::uniform_real<> distr(0.0f, 0.1f * step);
         const float startX = -limit;
         const float startZ = -limit;
         for (std::size_t i = 0u; i < semiTransparentInstances.size(); ++i) {
             auto& instance = semiTransparentInstances[i];
-            // float xOffset = distr(gen);
-            // float zOffset = distr(gen);
             instance.posShift.y = 0.0f;
 
             instance.scale = distrScale(gen);
@@ -154,6 +166,10 @@ VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, u
             instance.posShift.x = startX + row * step;
             instance.posShift.z = startZ + col * step;
         }
+        // the crowns are animated, the first trees get them
+        const std::size_t crownsCount = std::clamp<std::size_t>(m_stressScene.crownsCount, 1u, semiTransparentInstances.size());
+        const std::vector<Instance> crownInstances(semiTransparentInstances.begin(),
+                                                   semiTransparentInstances.begin() + crownsCount);
 
         auto lowPolyTrink =
             std::make_unique<ObjModel>(*this, *mTextureFactory, "lowpoly_tree_trunk.obj"sv,
@@ -167,26 +183,38 @@ VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, u
         m_semiTransparentModels.emplace_back(
             new MD5Model("tree_leaves.md5mesh"sv, "tree_leaves_idle.md5anim"sv, *this, *mTextureFactory,
                          static_cast<PipelineCreatorTextured*>(m_pipelineCreators[SEMI_TRANSPARENT].get()), nullptr, 10.0f, 0.1f,
-                         true, semiTransparentInstances));
-    }
-
-    m_particles[0] = std::make_unique<Particle>(*this, *mTextureFactory, "bush4.png",
-                                                static_cast<PipelineCreatorParticle*>(m_pipelineCreators[PARTICLE].get()), 5000u,
-                                                0.85 * Z_FAR, glm::vec3(10.0f, 19.0f, 10.0f));
-    m_particles[1] = std::make_unique<Particle>(*this, *mTextureFactory, "bush3.png",
-                                                static_cast<PipelineCreatorParticle*>(m_pipelineCreators[PARTICLE].get()), 20000u,
-                                                0.85 * Z_FAR, glm::vec3(2.0f, 5.0f, 2.0f));
-    m_particles[2] = std::make_unique<Particle>(*this, *mTextureFactory, "bush3.png",
-                                                static_cast<PipelineCreatorParticle*>(m_pipelineCreators[PARTICLE].get()), 2000u,
-                                                0.85 * Z_FAR, glm::vec3(7.0f, 10.0f, 7.0f));
-    m_particles[3] =
-        std::make_unique<Particle>(*this, *mTextureFactory, "smoke.png", "smoke_gradient.png",
-                                   static_cast<PipelineCreatorParticle*>(m_pipelineCreators[PARTICLE].get()), 250u,
-                                   glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.1f), glm::vec3(3.0f));
-    m_particles[4] =
-        std::make_unique<Particle>(*this, *mTextureFactory, "smoke.png", "smoke_gradient.png",
-                                   static_cast<PipelineCreatorParticle*>(m_pipelineCreators[PARTICLE].get()), 250u,
-                                   glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.1f), glm::vec3(3.0f));
+                         true, crownInstances));
+    }
+
+    auto& telemetry = FrameTelemetry::getInstance();
+    m_telemetryModels = {{m_models[0].get(), telemetry.registerModel("tank")},
+                         {m_semiTransparentModels[0].get(), telemetry.registerModel("treeTrunks")},
+                         {m_semiTransparentModels[1].get(), telemetry.registerModel("treeCrowns")}};
+
+    auto* particlePipelineCreator = static_cast<PipelineCreatorParticle*>(m_pipelineCreators[PARTICLE].get());
+    const std::array<std::tuple<std::string_view, uint32_t, glm::vec3>, 3u> bushLayers{
+        {{"bush4.png", m_stressScene.largeBushesCount, glm::vec3(10.0f, 19.0f, 10.0f)},
+         {"bush3.png", m_stressScene.smallBushesCount, glm::vec3(2.0f, 5.0f, 2.0f)},
+         {"bush3.png", m_stressScene.mediumBushesCount, glm::vec3(7.0f, 10.0f, 7.0f)}}};
+    for (const auto& [textureFileName, bushesCount, scale] : bushLayers) {
+        if (bushesCount != 0u) {
+            m_particles.push_back(std::make_unique<Particle>(*this, *mTextureFactory, textureFileName, particlePipelineCreator,
+                                                             bushesCount, 0.85 * Z_FAR, scale, gen()));
+        }
+    }
+
+    // the first two emitters are the exhaust pipes of the tank, the others smoke at their places
+    m_smokeEmittersFrom = m_particles.size();
+    for (uint32_t i = 0u; i < m_stressScene.smokeEmittersCount; ++i) {
+        m_particles.push_back(std::make_unique<Particle>(*this, *mTextureFactory, "smoke.png", "smoke_gradient.png",
+                                                         particlePipelineCreator, m_stressScene.smokeParticlesCount,
+                                                         glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                                                         glm::vec3(0.1f), glm::vec3(3.0f), gen()));
+        if (i >= 2u) {
+            std::uniform_real_distribution<float> distrPos(-limit, limit);
+            m_smokeEmitterPositions.emplace_back(distrPos(gen), 0.0f, distrPos(gen));
+        }
+    }
 
     // Initialize Bullet physics world used to drive transforms each frame.
     m_btCollisionConfig = new btDefaultCollisionConfiguration();
@@ -243,9 +271,38 @@ VulkanRenderer::VulkanRenderer(std::string_view appName, uint16_t windowWidth, u
             m_btTreeFallStates.push_back(state);
         }
     }
+
+    // Stress scene bodies: dynamic boxes dropped over the terrain, they load the broadphase and the solver only.
+    if (m_stressScene.physicsBodiesCount != 0u) {
+        btCollisionShape* boxShape = new btBoxShape(btVector3(2.0f, 2.0f, 2.0f));
+        m_btCollisionShapes.push_back(boxShape);
+        const btScalar mass = 1.0f;
+        btVector3 localInertia(0, 0, 0);
+        boxShape->calculateLocalInertia(mass, localInertia);
+
+        std::uniform_real_distribution<float> distrPos(-limit, limit);
+        std::uniform_real_distribution<float> distrHeight(10.0f, 100.0f);
+        m_btDynamicBodies.reserve(m_stressScene.physicsBodiesCount);
+        for (uint32_t i = 0u; i < m_stressScene.physicsBodiesCount; ++i) {
+            btTransform startTransform;
+            startTransform.setIdentity();
+            startTransform.setOrigin(btVector3(distrPos(gen), distrHeight(gen), distrPos(gen)));
+
+            btDefaultMotionState* motionState = new btDefaultMotionState(startTransform);
+            btRigidBody::btRigidBodyConstructionInfo boxRBInfo(mass, motionState, boxShape, localInertia);
+            btRigidBody* boxBody = new btRigidBody(boxRBInfo);
+            m_btDynamicsWorld->addRigidBody(boxBody);
+            m_btDynamicBodies.push_back(boxBody);
+        }
+    }
 }
 
 VulkanRenderer::~VulkanRenderer() {
+    destroyRecordingThreads();
+    // the background variants compile against the pipeline cache
+    for (auto& pipelineCreator : m_pipelineCreators) {
+        pipelineCreator->waitVariants();
+    }
     Pipeliner::getInstance().saveCache();
 
     if (m_btDynamicsWorld) {
@@ -257,6 +314,13 @@ VulkanRenderer::~VulkanRenderer() {
         m_btTreeBodies.clear();
         m_btTreeFallStates.clear();
 
+        for (auto* body : m_btDynamicBodies) {
+            m_btDynamicsWorld->removeRigidBody(body);
+            delete body->getMotionState();
+            delete body;
+        }
+        m_btDynamicBodies.clear();
+
         if (m_btTankBody) {
             m_btDynamicsWorld->removeRigidBody(m_btTankBody);
             delete m_btTankBody->getMotionState();
@@ -288,6 +352,9 @@ VulkanRenderer::~VulkanRenderer() {
     m_btCollisionConfig = nullptr;
 
     cleanupSwapChain();
+    destroyCommandBuffers();
+    destroyDescriptorPools();
+    cleanupRenderPasses();
 #if defined(USE_FSR) && USE_FSR
     if (mFSRSwapChainContext)
         ffxDestroyContext(&mFSRSwapChainContext, nullptr);
@@ -311,18 +378,8 @@ VulkanRenderer::~VulkanRenderer() {
 
 void VulkanRenderer::destroyPerFrameResources() {
     for (size_t i = 0u; i < _ubo.buffers.size(); ++i) {
-        if (_ubo.buffers[i] != VK_NULL_HANDLE) {
-            vkDestroyBuffer(_core.getDevice(), _ubo.buffers[i], nullptr);
-        }
-        if (_ubo.buffersMemory[i] != VK_NULL_HANDLE) {
-            vkFreeMemory(_core.getDevice(), _ubo.buffersMemory[i], nullptr);
-        }
-        if (_dynamicUbo.buffers[i] != VK_NULL_HANDLE) {
-            vkDestroyBuffer(_core.getDevice(), _dynamicUbo.buffers[i], nullptr);
-        }
-        if (_dynamicUbo.buffersMemory[i] != VK_NULL_HANDLE) {
-            vkFreeMemory(_core.getDevice(), _dynamicUbo.buffersMemory[i], nullptr);
-        }
+        Utils::VulkanDestroyBuffer(_core.getDevice(), _ubo.buffers[i], _ubo.buffersMemory[i]);
+        Utils::VulkanDestroyBuffer(_core.getDevice(), _dynamicUbo.buffers[i], _dynamicUbo.buffersMemory[i]);
     }
 
     for (size_t i = 0u; i < m_presentCompleteSem.size(); ++i) {
@@ -353,59 +410,42 @@ void VulkanRenderer::cleanupSwapChain() {
     // Clear tracking of images-in-flight to avoid stale fences pointing to destroyed resources
     m_imagesInFlight.clear();
 
-    vkFreeCommandBuffers(_core.getDevice(), _cmdBufPool, _swapchainImageCount, _cmdBufs.data());
-
     vkDestroyImageView(_core.getDevice(), _depthBuffer.depthImageView, nullptr);
-    vkDestroyImage(_core.getDevice(), _depthBuffer.depthImage, nullptr);
-    vkFreeMemory(_core.getDevice(), _depthBuffer.depthImageMemory, nullptr);
+    Utils::VulkanDestroyImage(_core.getDevice(), _depthBuffer.depthImage, _depthBuffer.depthImageMemory);
 
+    // the image is owned by m_transientAttachments
     vkDestroyImageView(_core.getDevice(), _depthTempBuffer.depthImageView, nullptr);
-    vkDestroyImage(_core.getDevice(), _depthTempBuffer.depthImage, nullptr);
-    vkFreeMemory(_core.getDevice(), _depthTempBuffer.depthImageMemory, nullptr);
+    _depthTempBuffer.depthImage = VK_NULL_HANDLE;
+    _depthTempBuffer.depthImageMemory = VK_NULL_HANDLE;
 
     vkDestroyImageView(_core.getDevice(), _footprintBuffer.depthImageView, nullptr);
-    vkDestroyImage(_core.getDevice(), _footprintBuffer.depthImage, nullptr);
-    vkFreeMemory(_core.getDevice(), _footprintBuffer.depthImageMemory, nullptr);
+    Utils::VulkanDestroyImage(_core.getDevice(), _footprintBuffer.depthImage, _footprintBuffer.depthImageMemory);
+
+    // shadow map is recreated by createDepthResources() as well, so it must be released here
+    vkDestroyImageView(_core.getDevice(), _shadowMapBuffer.depthImageView, nullptr);
+    Utils::VulkanDestroyImage(_core.getDevice(), _shadowMapBuffer.depthImage, _shadowMapBuffer.depthImageMemory);
 
     for (size_t i = 0u; i < static_cast<size_t>(_swapchainImageCount); ++i) {
         vkDestroyImageView(_core.getDevice(), _colorBuffer.colorBufferImageView[i], nullptr);
-        vkDestroyImage(_core.getDevice(), _colorBuffer.colorBufferImage[i], nullptr);
-        vkFreeMemory(_core.getDevice(), _colorBuffer.colorBufferImageMemory[i], nullptr);
-
-        vkDestroyImageView(_core.getDevice(), _gPassBuffer.normal.colorBufferImageView[i], nullptr);
-        vkDestroyImage(_core.getDevice(), _gPassBuffer.normal.colorBufferImage[i], nullptr);
-        vkFreeMemory(_core.getDevice(), _gPassBuffer.normal.colorBufferImageMemory[i], nullptr);
-
-        vkDestroyImageView(_core.getDevice(), _gPassBuffer.color.colorBufferImageView[i], nullptr);
-        vkDestroyImage(_core.getDevice(), _gPassBuffer.color.colorBufferImage[i], nullptr);
-        vkFreeMemory(_core.getDevice(), _gPassBuffer.color.colorBufferImageMemory[i], nullptr);
-
-        vkDestroyImageView(_core.getDevice(), _ssaoBuffer.colorBufferImageView[i], nullptr);
-        vkDestroyImage(_core.getDevice(), _ssaoBuffer.colorBufferImage[i], nullptr);
-        vkFreeMemory(_core.getDevice(), _ssaoBuffer.colorBufferImageMemory[i], nullptr);
-
-        vkDestroyImageView(_core.getDevice(), _viewSpaceBuffer.colorBufferImageView[i], nullptr);
-        vkDestroyImage(_core.getDevice(), _viewSpaceBuffer.colorBufferImage[i], nullptr);
-        vkFreeMemory(_core.getDevice(), _viewSpaceBuffer.colorBufferImageMemory[i], nullptr);
+        Utils::VulkanDestroyImage(_core.getDevice(), _colorBuffer.colorBufferImage[i], _colorBuffer.colorBufferImageMemory[i]);
+
+        // the images of the transient attachments are released by m_transientAttachments
+        for (auto* buf : {&_gPassBuffer.normal, &_gPassBuffer.color, &_ssaoBuffer, &_viewSpaceBuffer, &_shadingBuffer,
+                          &_bloomBuffer[0], &_bloomBuffer[1]}) {
+            vkDestroyImageView(_core.getDevice(), buf->colorBufferImageView[i], nullptr);
+            buf->colorBufferImage[i] = VK_NULL_HANDLE;
+            buf->colorBufferImageMemory[i] = VK_NULL_HANDLE;
+        }
 
         vkDestroyImageView(_core.getDevice(), _motionVectorsBuffer.colorBufferImageView[i], nullptr);
-        vkDestroyImage(_core.getDevice(), _motionVectorsBuffer.colorBufferImage[i], nullptr);
-        vkFreeMemory(_core.getDevice(), _motionVectorsBuffer.colorBufferImageMemory[i], nullptr);
-
-        vkDestroyImageView(_core.getDevice(), _shadingBuffer.colorBufferImageView[i], nullptr);
-        vkDestroyImage(_core.getDevice(), _shadingBuffer.colorBufferImage[i], nullptr);
-        vkFreeMemory(_core.getDevice(), _shadingBuffer.colorBufferImageMemory[i], nullptr);
+        Utils::VulkanDestroyImage(_core.getDevice(), _motionVectorsBuffer.colorBufferImage[i],
+                                  _motionVectorsBuffer.colorBufferImageMemory[i]);
 
         vkDestroyImageView(_core.getDevice(), _dlssOutputBuffer.colorBufferImageView[i], nullptr);
-        vkDestroyImage(_core.getDevice(), _dlssOutputBuffer.colorBufferImage[i], nullptr);
-        vkFreeMemory(_core.getDevice(), _dlssOutputBuffer.colorBufferImageMemory[i], nullptr);
-
-        for (auto& buf : _bloomBuffer) {
-            vkDestroyImageView(_core.getDevice(), buf.colorBufferImageView[i], nullptr);
-            vkDestroyImage(_core.getDevice(), buf.colorBufferImage[i], nullptr);
-            vkFreeMemory(_core.getDevice(), buf.colorBufferImageMemory[i], nullptr);
-        }
+        Utils::VulkanDestroyImage(_core.getDevice(), _dlssOutputBuffer.colorBufferImage[i],
+                                  _dlssOutputBuffer.colorBufferImageMemory[i]);
     }
+    m_transientAttachments.destroy();
 
     for (auto& framebuffer : m_fbs) {
         vkDestroyFramebuffer(_core.getDevice(), framebuffer, nullptr);
@@ -446,6 +486,11 @@ void VulkanRenderer::cleanupSwapChain() {
         vkDestroyImageView(_core.getDevice(), imageView, nullptr);
     }
 
+    for (size_t i = 0u; i < m_headlessImagesMemory.size(); ++i) {
+        Utils::VulkanDestroyImage(_core.getDevice(), _swapChain.images[i], m_headlessImagesMemory[i]);
+    }
+    m_headlessImagesMemory.clear();
+
 #if defined(USE_FSR) && USE_FSR
     if (mFSRSwapChainContext) {
         mFSRReplacementFunctions.pOutDestroySwapchainFFXAPI(_core.getDevice(), _swapChain.handle, nullptr, mFSRSwapChainContext);
@@ -456,6 +501,31 @@ void VulkanRenderer::cleanupSwapChain() {
     vkDestroySwapchainKHR(_core.getDevice(), _swapChain.handle, nullptr);
 #endif
 
+    _swapchainImageCount = 0u;
+}
+
+void VulkanRenderer::destroyCommandBuffers() {
+    if (!_cmdBufs.empty()) {
+        vkFreeCommandBuffers(_core.getDevice(), _cmdBufPool, static_cast<uint32_t>(_cmdBufs.size()), _cmdBufs.data());
+        _cmdBufs.clear();
+    }
+    for (auto& imageContexts : m_recordingContexts) {
+        for (auto& context : imageContexts) {
+            vkDestroyCommandPool(_core.getDevice(), context.cmdPool, nullptr);
+        }
+    }
+    m_recordingContexts.clear();
+    m_commandBufferCache.destroy();
+    m_gpuProfiler.destroy();
+}
+
+void VulkanRenderer::destroyDescriptorPools() {
+    for (auto& pipelineCreator : m_pipelineCreators) {
+        pipelineCreator->destroyDescriptorPool();
+    }
+}
+
+void VulkanRenderer::cleanupRenderPasses() {
     vkDestroyRenderPass(_core.getDevice(), m_renderPass, nullptr);
     vkDestroyRenderPass(_core.getDevice(), m_renderPassFXAA, nullptr);
     vkDestroyRenderPass(_core.getDevice(), m_renderPassUIOverlay, nullptr);
@@ -468,14 +538,9 @@ void VulkanRenderer::cleanupSwapChain() {
     vkDestroyRenderPass(_core.getDevice(), m_renderPassFootprint, nullptr);
     vkDestroyRenderPass(_core.getDevice(), m_renderPassSSAOblur, nullptr);
 
-    for (auto& pipelineCreator : m_pipelineCreators) {
-        pipelineCreator->destroyDescriptorPool();
-    }
     ImGui_ImplVulkan_Shutdown();
     vkDestroyDescriptorPool(_core.getDevice(), mImguiPool, nullptr);
     mImguiPool = VK_NULL_HANDLE;
-
-    _swapchainImageCount = 0u;
 }
 
 void VulkanRenderer::recreateSwapChain(uint16_t windowWidth, uint16_t windowHeight, uint16_t offscreenWidth,
@@ -489,8 +554,9 @@ void VulkanRenderer::recreateSwapChain(uint16_t windowWidth, uint16_t windowHeig
                 windowHeight, nextOffscreenWidth, nextOffscreenHeight);
     const bool windowSizeChanged = (_windowWidth != nextWindowWidth) || (_windowHeight != nextWindowHeight);
     if (windowSizeChanged || _offscreenWidth != nextOffscreenWidth || _offscreenHeight != nextOffscreenHeight) {
+        const auto startTime = std::chrono::steady_clock::now();
+        const uint32_t previousImageCount = _swapchainImageCount;
         cleanupSwapChain();
-        destroyPerFrameResources();
 
         _windowWidth = nextWindowWidth;
         _windowHeight = nextWindowHeight;
@@ -513,18 +579,41 @@ void VulkanRenderer::recreateSwapChain(uint16_t windowWidth, uint16_t windowHeig
         calculateAdditionalMat();
 
         auto swapchainCreateInfo = createSwapChain();
-        createCommandBuffer();
-        createDepthResources();
-        createColorBufferImage();
-        allocateDynamicBufferTransferSpace();
-        createUniformBuffers();
-        createDescriptorPool();
-        createRenderPass();
-        createFramebuffer();
-        createPipeline();
-        recreateDescriptorSets();
-        createSemaphores();
-        createDescriptorPoolForImGui();
+
+        // render passes depend on the formats only and the pipelines take viewport and scissor dynamically, the command
+        // buffers, uniform buffers, semaphores and descriptor sets on the image count only: so a resize reallocates the
+        // attachments and rewrites the descriptor bindings referencing them, the recorded passes are invalid then.
+        // A new image count invalidates the per image state of the pipeline creators and ImGui, everything is rebuilt then
+        const bool isPipelineStateKept = _swapchainImageCount == previousImageCount;
+        if (isPipelineStateKept) {
+            createDepthResources();
+            createColorBufferImage();
+            createFramebuffer();
+            updateAttachmentDescriptors();
+            m_commandBufferCache.invalidate();
+        } else {
+            destroyCommandBuffers();
+            destroyPerFrameResources();
+            destroyDescriptorPools();
+            cleanupRenderPasses();
+
+            createCommandBuffer();
+            createDepthResources();
+            createColorBufferImage();
+            allocateDynamicBufferTransferSpace();
+            createUniformBuffers();
+            createDescriptorPool();
+            createRenderPass();
+            createFramebuffer();
+            createPipeline();
+            mTextureFactory->resetDescriptorBindings();
+            recreateDescriptorSets();
+            createSemaphores();
+            createDescriptorPoolForImGui();
+        }
+
+        // arenas of the previous resolution stay empty when new attachments don't fit them anymore
+        MemoryAllocator::getInstance().releaseEmptyBlocks();
 
 #if defined(USE_DLSS) && USE_DLSS
         if (_core.isDlssSupported() && m_isDlssEnabled) {
@@ -544,13 +633,17 @@ void VulkanRenderer::recreateSwapChain(uint16_t windowWidth, uint16_t windowHeig
 #endif
 
         createFSRContext(swapchainCreateInfo);
+
+        Utils::printLog(INFO_PARAM, "swapchain resized in ",
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count(),
+                        " ms, pipelines ", isPipelineStateKept ? "kept" : "rebuilt");
     }
 }
 
 // FSR 3 frame generation
 void VulkanRenderer::createFSRContext(VkSwapchainCreateInfoKHR swapchainCreateInfo) {
 #if defined(USE_FSR) && USE_FSR
-    if (mFSRSwapChainContext) {
+    if (mFSRSwapChainContext || _core.isHeadless()) {
         return;
     }
 
@@ -670,6 +763,12 @@ void VulkanRenderer::recreateDescriptorSets() {
     }
 }
 
+void VulkanRenderer::updateAttachmentDescriptors() {
+    for (auto& pipelineCreator : m_pipelineCreators) {
+        pipelineCreator->updateAttachmentDescriptors();
+    }
+}
+
 void VulkanRenderer::calculateAdditionalMat() {
     // up vector is flipped for footPrint :vec3(0.0f, 0.0f, 1.0f) since we have 90 degree angle of view point
     const glm::vec3 footPrintUp = glm::vec3(0.0f, 0.0f, 1.0f);
@@ -679,20 +778,26 @@ void VulkanRenderer::calculateAdditionalMat() {
 }
 
 void VulkanRenderer::updateUniformBuffer(uint32_t currentImage, float deltaMS) {
+    PROFILE_FUNCTION();
     assert(_ubo.buffersMemory.size() > currentImage);
     const float kDelay = deltaMS;
 
     static const glm::mat4 identityMatrix = glm::mat4(1.0f);
 
     glm::vec4 velocity = mCamera.targetModelMat() * 4.0f * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
-    glm::vec4 exhaustPipePos1 =
+    const std::array<glm::vec4, 2u> exhaustPipePositions{
         mCamera.targetModelMat() *
-        glm::vec4(-4.0f, 19.0f, -30.0f, 1.0f);  // Note: here we use hardcoded position of pipe in our model!!!
-    m_particles[3]->update(currentImage, deltaMS, exhaustPipePos1, velocity);
-    glm::vec4 exhaustPipePos2 =
-        mCamera.targetModelMat() *
-        glm::vec4(4.0f, 19.0f, -30.0f, 1.0f);  // Note: here we use hardcoded position of pipe in our model!!!
-    m_particles[4]->update(currentImage, deltaMS, exhaustPipePos2, velocity);
+            glm::vec4(-4.0f, 19.0f, -30.0f, 1.0f),  // Note: here we use hardcoded position of pipe in our model!!!
+        mCamera.targetModelMat() * glm::vec4(4.0f, 19.0f, -30.0f, 1.0f)};
+    for (std::size_t i = m_smokeEmittersFrom; i < m_particles.size(); ++i) {
+        const std::size_t emitterIndex = i - m_smokeEmittersFrom;
+        if (emitterIndex < exhaustPipePositions.size()) {
+            m_particles[i]->update(currentImage, deltaMS, exhaustPipePositions[emitterIndex], velocity);
+        } else {
+            const glm::vec3& emitterPos = m_smokeEmitterPositions[emitterIndex - exhaustPipePositions.size()];
+            m_particles[i]->update(currentImage, deltaMS, glm::vec4(emitterPos, 1.0f), glm::vec4(0.0f));
+        }
+    }
 
     const auto objectsAmount = m_models.size();
 
@@ -710,10 +815,8 @@ void VulkanRenderer::updateUniformBuffer(uint32_t currentImage, float deltaMS) {
     mViewProj.footPrintViewProj = m_footPrintViewProj;
 
     // Copy VP data
-    void* data;
-    vkMapMemory(_core.getDevice(), _ubo.buffersMemory[currentImage], 0, sizeof(mViewProj), 0, &data);
+    void* data = MemoryAllocator::getInstance().getMappedData(_ubo.buffers[currentImage]);
     memcpy(data, &mViewProj, sizeof(mViewProj));
-    vkUnmapMemory(_core.getDevice(), _ubo.buffersMemory[currentImage]);
 
     // Copy Model data except skybox
     for (size_t i = 1u; i < objectsAmount - 1; i++) {
@@ -741,11 +844,11 @@ void VulkanRenderer::updateUniformBuffer(uint32_t currentImage, float deltaMS) {
     // Pull per-frame transforms from Bullet rigid bodies.
     auto& treeTrunkInstances = m_semiTransparentModels[0]->instances();
     auto& treeCrownInstances = m_semiTransparentModels[1]->instances();
-    const size_t treesToUpdate = std::min(std::min(treeTrunkInstances.size(), treeCrownInstances.size()), m_btTreeBodies.size());
+    // the crowns belong to the first trees of the stress scene
+    const size_t treesToUpdate = std::min(treeTrunkInstances.size(), m_btTreeBodies.size());
     glm::mat4 firstTreeModelMat = identityMatrix;
     for (size_t i = 0; i < treesToUpdate; i++) {
         auto& treeTrunkInstance = treeTrunkInstances[i];
-        auto& treeCrownInstance = treeCrownInstances[i];
 
         btTransform transform;
         if (m_btTreeBodies[i]->getMotionState()) {
@@ -768,25 +871,20 @@ void VulkanRenderer::updateUniformBuffer(uint32_t currentImage, float deltaMS) {
         const btVector3 baseWS = origin - transform.getBasis() * btVector3(0.0f, m_btTreeHalfHeight, 0.0f);
         const glm::vec3 bulletPos(baseWS.x(), baseWS.y(), baseWS.z());
         treeTrunkInstance.posShift = bulletPos;
-        treeCrownInstance.posShift = bulletPos;
 
-        //----------- Store previous model matrix columns for motion vector calculations-------//
-        treeTrunkInstance.prev_model_col0 = treeTrunkInstance.model_col0;
-        treeTrunkInstance.prev_model_col1 = treeTrunkInstance.model_col1;
-        treeTrunkInstance.prev_model_col2 = treeTrunkInstance.model_col2;
-        treeTrunkInstance.prev_model_col3 = treeTrunkInstance.model_col3;
+        //----------- Store model matrix columns, the previous ones are kept for motion vector calculations-------//
+        treeTrunkInstance.setModelMatrix(modelMat);
+        if (i >= treeCrownInstances.size()) {
+            continue;
+        }
 
+        // the crown shares the matrix of the trunk, it is packed once
+        auto& treeCrownInstance = treeCrownInstances[i];
+        treeCrownInstance.posShift = bulletPos;
         treeCrownInstance.prev_model_col0 = treeCrownInstance.model_col0;
         treeCrownInstance.prev_model_col1 = treeCrownInstance.model_col1;
         treeCrownInstance.prev_model_col2 = treeCrownInstance.model_col2;
         treeCrownInstance.prev_model_col3 = treeCrownInstance.model_col3;
-
-        //----------- Store current model matrix columns for general purpose usage-------//
-        treeTrunkInstance.model_col0 = glm::packHalf4x16(modelMat[0]);
-        treeTrunkInstance.model_col1 = glm::packHalf4x16(modelMat[1]);
-        treeTrunkInstance.model_col2 = glm::packHalf4x16(modelMat[2]);
-        treeTrunkInstance.model_col3 = glm::packHalf4x16(modelMat[3]);
-
         treeCrownInstance.model_col0 = treeTrunkInstance.model_col0;
         treeCrownInstance.model_col1 = treeTrunkInstance.model_col1;
         treeCrownInstance.model_col2 = treeTrunkInstance.model_col2;
@@ -833,10 +931,8 @@ void VulkanRenderer::updateUniformBuffer(uint32_t currentImage, float deltaMS) {
     m_lightViewProj[1][1] *= -1;
 
     // Map the list of model data
-    vkMapMemory(_core.getDevice(), _dynamicUbo.buffersMemory[currentImage], 0,
-                _modelUniformAlignment * (objectsAmount + m_semiTransparentModels.size()), 0, &data);
+    data = MemoryAllocator::getInstance().getMappedData(_dynamicUbo.buffers[currentImage]);
     memcpy(data, mp_modelTransferSpace, _modelUniformAlignment * (objectsAmount + m_semiTransparentModels.size()));
-    vkUnmapMemory(_core.getDevice(), _dynamicUbo.buffersMemory[currentImage]);
 }
 
 void VulkanRenderer::allocateDynamicBufferTransferSpace() {
@@ -859,6 +955,20 @@ void VulkanRenderer::releaseDynamicBufferTransferSpace() {
     }
 }
 
+void VulkanRenderer::createHeadlessImages(const VkSwapchainCreateInfoKHR& swapchainCreateInfo) {
+    assert(_core.isHeadless());
+    m_headlessImagesMemory.assign(_swapchainImageCount, VK_NULL_HANDLE);
+    for (uint32_t i = 0u; i < _swapchainImageCount; ++i) {
+        VkResult res = Utils::VulkanCreateImage(
+            _core.getDevice(), _core.getPhysDevice(), swapchainCreateInfo.imageExtent.width,
+            swapchainCreateInfo.imageExtent.height, swapchainCreateInfo.imageFormat, VK_IMAGE_TILING_OPTIMAL,
+            swapchainCreateInfo.imageUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _swapChain.images[i], m_headlessImagesMemory[i]);
+        CHECK_VULKAN_ERROR("headless image creation error %d\n", res);
+    }
+
+    Utils::printLog(INFO_PARAM, "Created ", _swapchainImageCount, " offscreen images in place of the swapchain");
+}
+
 void VulkanRenderer::createDescriptorPool() {
     for (auto& pipelineCreator : m_pipelineCreators) {
         pipelineCreator->createDescriptorPool();
@@ -900,44 +1010,46 @@ VkSwapchainCreateInfoKHR VulkanRenderer::createSwapChain() {
     SwapChainCreateInfo.clipped = VK_TRUE;
     SwapChainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 
-    VkResult res;
-#if defined(USE_FSR) && USE_FSR
-    if (mFSRSwapChainContext) {
-        res = mFSRReplacementFunctions.pOutCreateSwapchainFFXAPI(_core.getDevice(), &SwapChainCreateInfo, nullptr,
-                                                                 &_swapChain.handle, mFSRSwapChainContext);
+    VkResult res = VK_SUCCESS;
+    uint32_t NumSwapChainImages = desiredSwapchainImageCount;
+    if (_core.isHeadless()) {
+        // offscreen images of the window size take the place of the swapchain images, see createHeadlessImages
+        SwapChainCreateInfo.imageExtent = {_windowWidth, _windowHeight};
+        SwapChainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     } else {
-        res = vkCreateSwapchainKHR(_core.getDevice(), &SwapChainCreateInfo, nullptr, &_swapChain.handle);
-    }
+#if defined(USE_FSR) && USE_FSR
+        if (mFSRSwapChainContext) {
+            res = mFSRReplacementFunctions.pOutCreateSwapchainFFXAPI(_core.getDevice(), &SwapChainCreateInfo, nullptr,
+                                                                     &_swapChain.handle, mFSRSwapChainContext);
+        } else {
+            res = vkCreateSwapchainKHR(_core.getDevice(), &SwapChainCreateInfo, nullptr, &_swapChain.handle);
+        }
 #else
-    res = vkCreateSwapchainKHR(_core.getDevice(), &SwapChainCreateInfo, nullptr, &_swapChain.handle);
+        res = vkCreateSwapchainKHR(_core.getDevice(), &SwapChainCreateInfo, nullptr, &_swapChain.handle);
 #endif
-    CHECK_VULKAN_ERROR("vkCreateSwapchainKHR error %d\n", res);
+        CHECK_VULKAN_ERROR("vkCreateSwapchainKHR error %d\n", res);
 
-    Utils::printLog(INFO_PARAM, "Swap chain created");
+        Utils::printLog(DEBUG_PARAM, "Swap chain created");
 
-    uint32_t NumSwapChainImages = 0;
+        NumSwapChainImages = 0;
 #if defined(USE_FSR) && USE_FSR
-    if (mFSRSwapChainContext) {
-        res = mFSRReplacementFunctions.pOutGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages,
-                                                                 nullptr);
-    } else {
-        res = vkGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages, nullptr);
-    }
+        if (mFSRSwapChainContext) {
+            res = mFSRReplacementFunctions.pOutGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages,
+                                                                     nullptr);
+        } else {
+            res = vkGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages, nullptr);
+        }
 #else
-    res = vkGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages, nullptr);
+        res = vkGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages, nullptr);
 #endif
-    CHECK_VULKAN_ERROR("vkGetSwapchainImagesKHR error %d\n", res);
-    Utils::printLog(INFO_PARAM, "Available number of presentable images ", NumSwapChainImages);
+        CHECK_VULKAN_ERROR("vkGetSwapchainImagesKHR error %d\n", res);
+        Utils::printLog(DEBUG_PARAM, "Available number of presentable images ", NumSwapChainImages);
+    }
 
     _swapchainImageCount = NumSwapChainImages;
 
     _swapChain.images.assign(_swapchainImageCount, VK_NULL_HANDLE);
     _swapChain.views.assign(_swapchainImageCount, VK_NULL_HANDLE);
-    _cmdBufs.assign(_swapchainImageCount, VK_NULL_HANDLE);
-    _ubo.buffers.assign(_swapchainImageCount, VK_NULL_HANDLE);
-    _ubo.buffersMemory.assign(_swapchainImageCount, VK_NULL_HANDLE);
-    _dynamicUbo.buffers.assign(_swapchainImageCount, VK_NULL_HANDLE);
-    _dynamicUbo.buffersMemory.assign(_swapchainImageCount, VK_NULL_HANDLE);
 
     _colorBuffer.colorBufferImage.assign(_swapchainImageCount, VK_NULL_HANDLE);
     _colorBuffer.colorBufferImageMemory.assign(_swapchainImageCount, VK_NULL_HANDLE);
@@ -969,9 +1081,6 @@ VkSwapchainCreateInfoKHR VulkanRenderer::createSwapChain() {
         buf.colorBufferImageView.assign(_swapchainImageCount, VK_NULL_HANDLE);
     }
 
-    m_presentCompleteSem.assign(_swapchainImageCount, VK_NULL_HANDLE);
-    m_renderCompleteSem.assign(_swapchainImageCount, VK_NULL_HANDLE);
-    m_drawFences.assign(_swapchainImageCount, VK_NULL_HANDLE);
     m_fbs.assign(_swapchainImageCount, VK_NULL_HANDLE);
     m_fbsFXAA.assign(_swapchainImageCount, VK_NULL_HANDLE);
     m_fbsUIOverlay.assign(_swapchainImageCount, VK_NULL_HANDLE);
@@ -983,17 +1092,21 @@ VkSwapchainCreateInfoKHR VulkanRenderer::createSwapChain() {
     m_fbsDepth.assign(_swapchainImageCount, VK_NULL_HANDLE);
     m_fbsFootprint.assign(_swapchainImageCount, VK_NULL_HANDLE);
     m_fbsSSAOblur.assign(_swapchainImageCount, VK_NULL_HANDLE);
-#if defined(USE_FSR) && USE_FSR
-    if (mFSRSwapChainContext) {
-        res = mFSRReplacementFunctions.pOutGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages,
-                                                                 _swapChain.images.data());
+    if (_core.isHeadless()) {
+        createHeadlessImages(SwapChainCreateInfo);
     } else {
-        res = vkGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages, _swapChain.images.data());
-    }
+#if defined(USE_FSR) && USE_FSR
+        if (mFSRSwapChainContext) {
+            res = mFSRReplacementFunctions.pOutGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages,
+                                                                     _swapChain.images.data());
+        } else {
+            res = vkGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages, _swapChain.images.data());
+        }
 #else
-    res = vkGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages, _swapChain.images.data());
+        res = vkGetSwapchainImagesKHR(_core.getDevice(), _swapChain.handle, &NumSwapChainImages, _swapChain.images.data());
 #endif
-    CHECK_VULKAN_ERROR("vkGetSwapchainImagesKHR error %d\n", res);
+        CHECK_VULKAN_ERROR("vkGetSwapchainImagesKHR error %d\n", res);
+    }
 
     // initialize image-in-flight tracking
     m_imagesInFlight.assign(static_cast<size_t>(_swapchainImageCount), VK_NULL_HANDLE);
@@ -1012,6 +1125,11 @@ void VulkanRenderer::createUniformBuffers() {
     // Model buffer size
     VkDeviceSize modelBufferSize = _modelUniformAlignment * (m_models.size() + m_semiTransparentModels.size());
 
+    _ubo.buffers.assign(_swapchainImageCount, VK_NULL_HANDLE);
+    _ubo.buffersMemory.assign(_swapchainImageCount, VK_NULL_HANDLE);
+    _dynamicUbo.buffers.assign(_swapchainImageCount, VK_NULL_HANDLE);
+    _dynamicUbo.buffersMemory.assign(_swapchainImageCount, VK_NULL_HANDLE);
+
     /**
      * We should have multiple buffers, because multiple frames may be in flight at the same time and
      * we don't want to update the buffer in preparation of the next frame while a previous one is still reading from it!
@@ -1048,27 +1166,65 @@ void VulkanRenderer::createCommandBuffer() {
     cmdBufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     cmdBufAllocInfo.commandBufferCount = _swapchainImageCount;
 
+    _cmdBufs.assign(_swapchainImageCount, VK_NULL_HANDLE);
     VkResult res = vkAllocateCommandBuffers(_core.getDevice(), &cmdBufAllocInfo, _cmdBufs.data());
     CHECK_VULKAN_ERROR("vkAllocateCommandBuffers error %d\n", res);
 
-    Utils::printLog(INFO_PARAM, "Created command buffers");
+    // recording threads: the secondary command buffers of every thread and image come from their own pool,
+    // so neither recording nor resetting needs any synchronization
+    m_recordingContexts.assign(_swapchainImageCount, std::vector<RecordingContext>(m_recordingThreadsCount));
+    m_executedCmdBufs.resize(m_recordingThreadsCount);
+    for (auto& imageContexts : m_recordingContexts) {
+        for (auto& context : imageContexts) {
+
+            VkCommandPoolCreateInfo cmdPoolCreateInfo = {};
+            cmdPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            cmdPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;  /// re-recorded every frame
+            cmdPoolCreateInfo.queueFamilyIndex = _core.getQueueFamily();
+
+            res = vkCreateCommandPool(_core.getDevice(), &cmdPoolCreateInfo, nullptr, &context.cmdPool);
+            CHECK_VULKAN_ERROR("vkCreateCommandPool error %d\n", res);
+
+            VkCommandBufferAllocateInfo secondaryAllocInfo = {};
+            secondaryAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            secondaryAllocInfo.commandPool = context.cmdPool;
+            secondaryAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            secondaryAllocInfo.commandBufferCount = static_cast<uint32_t>(context.cmdBufs.size());
+
+            res = vkAllocateCommandBuffers(_core.getDevice(), &secondaryAllocInfo, context.cmdBufs.data());
+            CHECK_VULKAN_ERROR("vkAllocateCommandBuffers error %d\n", res);
+        }
+    }
+
+    m_gpuProfiler.init(_core.getDevice(), _core.getPhysDevice(), _core.getQueueFamily(), _swapchainImageCount,
+                       _core.isPipelineStatisticsQuerySupported());
+    // the benchmark report takes the statistics of the passes, the headless mode has no UI enabling them
+    if (_core.isHeadless()) {
+        m_gpuProfiler.setPipelineStatisticsEnabled(true);
+    }
+    // a new image count recreates the descriptor sets of the cached passes, nothing recorded is valid then
+    m_commandBufferCache.init(_core.getDevice(), _core.getQueueFamily(), _swapchainImageCount, CACHED_MAX,
+                              m_gpuProfiler.getPipelineStatisticsFlags());
+
+    Utils::printLog(INFO_PARAM, "Created command buffers, recording threads ", m_recordingThreadsCount);
 }
 
 void VulkanRenderer::recordCommandBuffers(uint32_t currentImage, bool hmiRenderData) {
+    PROFILE_FUNCTION();
+    const auto recordingStartTime = std::chrono::steady_clock::now();
+
     static VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr,
                                               VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, nullptr};
 
-    VkResult res = vkBeginCommandBuffer(_cmdBufs[currentImage], &beginInfo);
-    CHECK_VULKAN_ERROR("vkBeginCommandBuffer error %d\n", res);
-
     const static VkClearValue zeroClearValues{{0.0f, 0.0f, 0.0f, 0.0f}};
 
-    //---------------------------------------------------------------------------------------------//
+    std::array<VkRenderPassBeginInfo, SECONDARY_MAX> secondaryPassInfos{};
+
     /// depth writing pass (depth + view space pos + motion vectors)
     static std::array<VkClearValue, 3> depthWriterClearValues{zeroClearValues, zeroClearValues, zeroClearValues};
     depthWriterClearValues[0].depthStencil.depth = 1.0f;
 
-    VkRenderPassBeginInfo renderPassdepthWriterInfo = {};
+    VkRenderPassBeginInfo& renderPassdepthWriterInfo = secondaryPassInfos[SECONDARY_DEPTH];
     renderPassdepthWriterInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassdepthWriterInfo.renderPass = m_renderPassDepth;
     renderPassdepthWriterInfo.renderArea.offset.x = 0;
@@ -1079,30 +1235,11 @@ void VulkanRenderer::recordCommandBuffers(uint32_t currentImage, bool hmiRenderD
     renderPassdepthWriterInfo.pClearValues = depthWriterClearValues.data();
     renderPassdepthWriterInfo.framebuffer = m_fbsDepth[currentImage];
 
-    vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassdepthWriterInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    // depth writing for each object
-    for (uint32_t meshIndex = 0u; meshIndex < m_models.size(); ++meshIndex) {
-        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment) * meshIndex;
-        m_models[meshIndex]->drawWithCustomPipeline(m_pipelineCreators[DEPTH].get(), _cmdBufs[currentImage], currentImage,
-                                                    dynamicOffset);
-    }
-
-    vkCmdEndRenderPass(_cmdBufs[currentImage]);
-
-    // No explicit barrier needed here: m_renderPassDepth already ends _depthBuffer in
-    // VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL (attachment finalLayout).
-
-    // No explicit barier needed for _viewSpaceBuffer: COLOR_ATTACHMENT_OPTIMAL -> SHADER_READ_ONLY_OPTIMAL
-    // This is because m_renderPassDepth ends _viewSpaceBuffer in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL (attachment
-    // finalLayout).
-
-    //---------------------------------------------------------------------------------------------//
     /// shadow map pass
     VkClearValue shadowMapClearValues{};
     shadowMapClearValues.depthStencil.depth = 1.0f;
 
-    VkRenderPassBeginInfo renderPassShadowMapInfo = {};
+    VkRenderPassBeginInfo& renderPassShadowMapInfo = secondaryPassInfos[SECONDARY_SHADOWMAP];
     renderPassShadowMapInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassShadowMapInfo.renderPass = m_renderPassShadowMap;
     renderPassShadowMapInfo.renderArea.offset.x = 0;
@@ -1113,57 +1250,6 @@ void VulkanRenderer::recordCommandBuffers(uint32_t currentImage, bool hmiRenderD
     renderPassShadowMapInfo.pClearValues = &shadowMapClearValues;
     renderPassShadowMapInfo.framebuffer = m_fbsShadowMap[currentImage];
 
-    vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassShadowMapInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    // draw shadow of 3d mesh only
-    for (uint32_t meshIndex = 0u; meshIndex < m_models.size() - 2u; ++meshIndex) {
-        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment) * meshIndex;
-        m_models[meshIndex]->drawWithCustomPipeline(m_pipelineCreators[SHADOWMAP].get(), _cmdBufs[currentImage], currentImage,
-                                                    dynamicOffset);
-    }
-
-    for (uint32_t meshIndex = 0u; meshIndex < m_semiTransparentModels.size(); ++meshIndex) {
-        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment) * (meshIndex + m_models.size());
-        m_semiTransparentModels[meshIndex]->drawWithCustomPipeline(m_pipelineCreators[SHADOWMAP].get(), _cmdBufs[currentImage],
-                                                                   currentImage, dynamicOffset);
-    }
-
-    vkCmdEndRenderPass(_cmdBufs[currentImage]);
-
-    //---------------------------------------------------------------------------------------------//
-    /// footprint pass
-    VkRenderPassBeginInfo renderPassFootprintInfo = {};
-    renderPassFootprintInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassFootprintInfo.renderPass = m_renderPassFootprint;
-    renderPassFootprintInfo.renderArea.offset.x = 0;
-    renderPassFootprintInfo.renderArea.offset.y = 0;
-    renderPassFootprintInfo.renderArea.extent.width = _footprintBuffer.width;
-    renderPassFootprintInfo.renderArea.extent.height = _footprintBuffer.height;
-    renderPassFootprintInfo.framebuffer = m_fbsFootprint[currentImage];
-
-    vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassFootprintInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    if (_oneOffClearingFootPrint) {
-        VkClearValue footPrintClearValues{};
-        footPrintClearValues.depthStencil.depth = 1.0f;
-        VkClearAttachment clearAttachment{};
-        clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        clearAttachment.clearValue = footPrintClearValues;
-        clearAttachment.colorAttachment = 0u;
-        VkClearRect clearRect = {{{0u, 0u}, {_footprintBuffer.width, _footprintBuffer.height}}, 0u, 1u};
-        vkCmdClearAttachments(_cmdBufs[currentImage], 1, &clearAttachment, 1u, &clearRect);
-        _oneOffClearingFootPrint = false;
-    } else if (glm::distance(_lastFootPrintPos, mCamera.targetPos()) >= _footPrintRedrawingK * m_models[0]->radius()) {
-        // draw object tracks (the panzer will leave the footprint)
-        uint32_t meshIndex = 0u;
-        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment) * meshIndex;
-        m_models[meshIndex]->drawFootprints(_cmdBufs[currentImage], currentImage, dynamicOffset);
-        _lastFootPrintPos = mCamera.targetPos();
-    }
-
-    vkCmdEndRenderPass(_cmdBufs[currentImage]);
-
-    //---------------------------------------------------------------------------------------------//
     /// G pass
     VkClearValue clearValue{};
     clearValue.color = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -1172,7 +1258,7 @@ void VulkanRenderer::recordCommandBuffers(uint32_t currentImage, bool hmiRenderD
     clearValues[7] = VkClearValue{};
     clearValues[7].depthStencil.depth = 1.0f;
 
-    VkRenderPassBeginInfo renderPassInfo = {};
+    VkRenderPassBeginInfo& renderPassInfo = secondaryPassInfos[SECONDARY_GPASS];
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassInfo.renderPass = m_renderPass;
     renderPassInfo.renderArea.offset = {0, 0};
@@ -1182,66 +1268,70 @@ void VulkanRenderer::recordCommandBuffers(uint32_t currentImage, bool hmiRenderD
     renderPassInfo.pClearValues = clearValues.data();
     renderPassInfo.framebuffer = m_fbs[currentImage];
 
-    /** Note:
-     * We remove the manual barrier here, since RenderPass will automatically make the transition
-     * from UNDEFINED (initialLayout) to COLOR_ATTACHMENT_OPTIMAL.
-     * If the barrier is needed, the initialLayout in RenderPass must be
-     * VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL.
-     * Utils::VulkanImageMemoryBarrier(_cmdBufs[currentImage], _colorBuffer.colorBufferImage[currentImage],
-     * _colorBuffer.colorFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT,
-     * 1U, 1U, 0, 0, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
-     */
+    /// SEMI-TRANSPARENT OBJECTS render pass
+    static std::array<VkClearValue, 2> semiTransClearValues{zeroClearValues, zeroClearValues};
 
-    vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    VkRenderPassBeginInfo& renderPassSemiTransInfo = secondaryPassInfos[SECONDARY_SEMI_TRANSPARENT];
+    renderPassSemiTransInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassSemiTransInfo.renderPass = m_renderPassSemiTrans;
+    renderPassSemiTransInfo.renderArea.offset = {0, 0};
+    renderPassSemiTransInfo.renderArea.extent.width = _offscreenWidth;
+    renderPassSemiTransInfo.renderArea.extent.height = _offscreenHeight;
+    renderPassSemiTransInfo.clearValueCount = semiTransClearValues.size();
+    renderPassSemiTransInfo.pClearValues = semiTransClearValues.data();
+    renderPassSemiTransInfo.framebuffer = m_fbsSemiTrans[currentImage];
 
-    ///  SkyBox and 3D Models
-    for (uint32_t meshIndex = 0u; meshIndex < m_models.size(); ++meshIndex) {
-        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment) * meshIndex;
-        m_models[meshIndex]->draw(_cmdBufs[currentImage], currentImage, dynamicOffset);
+    //---------------------------------------------------------------------------------------------//
+    /// the model batches of the geometry passes are recorded in parallel, the first one by the render thread,
+    /// a batch has a model at least
+    const std::size_t batchedModelsCount = std::max(m_models.size(), m_semiTransparentModels.size());
+    m_recordingBatchesCount = static_cast<uint32_t>(std::clamp<std::size_t>(batchedModelsCount, 1u, m_recordingThreadsCount));
+    if (m_recordingBatchesCount > 1u) {
+        {
+            std::lock_guard<std::mutex> lock(m_recordingMutex);
+            m_recordingJob = RecordingJob{currentImage, m_recordingBatchesCount, &secondaryPassInfos};
+            ++m_recordingJobIndex;
+            m_pendingBatchesCount = m_recordingBatchesCount - 1u;
+        }
+        m_recordingCondition.notify_all();
     }
-
-    ///-----------------------------------------------------------------------------------///
-    /// Start second subpass (SSAO)
-    vkCmdNextSubpass(_cmdBufs[currentImage], VK_SUBPASS_CONTENTS_INLINE);
-
-    /// quad subpass
-    {
-        const auto& pipelineCreator = m_pipelineCreators[SSAO];
-        vkCmdPushConstants(_cmdBufs[currentImage], pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
-                           sizeof(PushConstant), &_pushConstant);
-        vkCmdBindPipeline(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
-        vkCmdBindDescriptorSets(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                pipelineCreator->getPipeline()->pipelineLayout, 0, 1,
-                                pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
+    std::exception_ptr recordingError;
+    try {
+        recordSecondaryCommandBuffers(currentImage, 0u, m_recordingBatchesCount, secondaryPassInfos);
+    } catch (...) {
+        // the workers reference the begin infos of this frame until their batches are recorded
+        recordingError = std::current_exception();
     }
-
-    vkCmdDraw(_cmdBufs[currentImage], 6, 1, 0, 0);
-
-    ///-----------------------------------------------------------------------------------///
-    /// Start third subpass
-    vkCmdNextSubpass(_cmdBufs[currentImage], VK_SUBPASS_CONTENTS_INLINE);
-
-    /// quad subpass
-    {
-        const auto& pipelineCreator = m_pipelineCreators[POST_LIGHTING];
-        vkCmdPushConstants(_cmdBufs[currentImage], pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
-                           sizeof(PushConstant), &_pushConstant);
-
-        vkCmdBindPipeline(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
-        vkCmdBindDescriptorSets(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                pipelineCreator->getPipeline()->pipelineLayout, 0, 1,
-                                pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
+    if (m_recordingBatchesCount > 1u) {
+        std::unique_lock<std::mutex> lock(m_recordingMutex);
+        m_recordedCondition.wait(lock, [this] { return m_pendingBatchesCount == 0u; });
+        if (!recordingError) {
+            recordingError = std::exchange(m_recordingError, nullptr);
+        }
+    }
+    if (recordingError) {
+        std::rethrow_exception(recordingError);
     }
 
-    vkCmdDraw(_cmdBufs[currentImage], 6, 1, 0, 0);
+    //---------------------------------------------------------------------------------------------//
+    FrameRecording recording{};
+    recording.currentImage = currentImage;
+    recording.secondaryPassInfos = &secondaryPassInfos;
 
-    vkCmdEndRenderPass(_cmdBufs[currentImage]);
+    /// render pass begin infos of the inline recorded passes
+    VkRenderPassBeginInfo& renderPassFootprintInfo = recording.footprintInfo;
+    renderPassFootprintInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassFootprintInfo.renderPass = m_renderPassFootprint;
+    renderPassFootprintInfo.renderArea.offset.x = 0;
+    renderPassFootprintInfo.renderArea.offset.y = 0;
+    renderPassFootprintInfo.renderArea.extent.width = _footprintBuffer.width;
+    renderPassFootprintInfo.renderArea.extent.height = _footprintBuffer.height;
+    renderPassFootprintInfo.framebuffer = m_fbsFootprint[currentImage];
 
-    //---------------------------------------------------------------------------------------------//
     // SSAO BLUR
     static std::array<VkClearValue, 2> ssaoBlurClearValues{zeroClearValues, zeroClearValues};
 
-    VkRenderPassBeginInfo renderPassSSAOblurInfo = {};
+    VkRenderPassBeginInfo& renderPassSSAOblurInfo = recording.ssaoBlurInfo;
     renderPassSSAOblurInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassSSAOblurInfo.renderPass = m_renderPassSSAOblur;
     renderPassSSAOblurInfo.renderArea.offset = {0, 0};
@@ -1251,83 +1341,36 @@ void VulkanRenderer::recordCommandBuffers(uint32_t currentImage, bool hmiRenderD
     renderPassSSAOblurInfo.pClearValues = ssaoBlurClearValues.data();
     renderPassSSAOblurInfo.framebuffer = m_fbsSSAOblur[currentImage];
 
-    // SSAO Blur: shading buffer already ends the main render pass in SHADER_READ_ONLY_OPTIMAL (after G-pass),
-    // so no explicit layout transition is needed here.
-    vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassSSAOblurInfo, VK_SUBPASS_CONTENTS_INLINE);
-    {
-        const auto& pipelineCreator = m_pipelineCreators[SSAO_BLUR];
-        vkCmdBindPipeline(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
-        vkCmdBindDescriptorSets(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                pipelineCreator->getPipeline()->pipelineLayout, 0, 1,
-                                pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
-    }
-
-    vkCmdDraw(_cmdBufs[currentImage], 6, 1, 0, 0);
-
-    vkCmdEndRenderPass(_cmdBufs[currentImage]);
+    /// GAUSS X Bloom render pass
+    static std::array<VkClearValue, 2> gaussXBloomClearValues{zeroClearValues, zeroClearValues};
+
+    VkRenderPassBeginInfo& renderPassGaussXBloomInfo = recording.gaussXBloomInfo;
+    renderPassGaussXBloomInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassGaussXBloomInfo.renderPass = m_renderPassXBlur;
+    renderPassGaussXBloomInfo.renderArea.offset = {0, 0};
+    renderPassGaussXBloomInfo.renderArea.extent.width = _offscreenWidth;
+    renderPassGaussXBloomInfo.renderArea.extent.height = _offscreenHeight;
+    renderPassGaussXBloomInfo.clearValueCount = gaussXBloomClearValues.size();
+    renderPassGaussXBloomInfo.pClearValues = gaussXBloomClearValues.data();
+    renderPassGaussXBloomInfo.framebuffer = m_fbsXBlur[currentImage];
+
+    /// GAUSS Y Bloom render pass
+    static std::array<VkClearValue, 2> gaussYBloomClearValues{zeroClearValues, zeroClearValues};
+
+    VkRenderPassBeginInfo& renderPassGaussYBloomInfo = recording.gaussYBloomInfo;
+    renderPassGaussYBloomInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassGaussYBloomInfo.renderPass = m_renderPassYBlur;
+    renderPassGaussYBloomInfo.renderArea.offset = {0, 0};
+    renderPassGaussYBloomInfo.renderArea.extent.width = _offscreenWidth;
+    renderPassGaussYBloomInfo.renderArea.extent.height = _offscreenHeight;
+    renderPassGaussYBloomInfo.clearValueCount = gaussYBloomClearValues.size();
+    renderPassGaussYBloomInfo.pClearValues = gaussYBloomClearValues.data();
+    renderPassGaussYBloomInfo.framebuffer = m_fbsYBlur[currentImage];
 
-    //---------------------------------------------------------------------------------------------//
-    // 3 times gauss blurring
-    for (int32_t t = 0; t < 3; ++t) {
-        /// GAUSS X Bloom render pass
-        static std::array<VkClearValue, 2> gaussXBloomClearValues{zeroClearValues, zeroClearValues};
-
-        VkRenderPassBeginInfo renderPassGaussXBloomInfo = {};
-        renderPassGaussXBloomInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassGaussXBloomInfo.renderPass = m_renderPassXBlur;
-        renderPassGaussXBloomInfo.renderArea.offset = {0, 0};
-        renderPassGaussXBloomInfo.renderArea.extent.width = _offscreenWidth;
-        renderPassGaussXBloomInfo.renderArea.extent.height = _offscreenHeight;
-        renderPassGaussXBloomInfo.clearValueCount = gaussXBloomClearValues.size();
-        renderPassGaussXBloomInfo.pClearValues = gaussXBloomClearValues.data();
-        renderPassGaussXBloomInfo.framebuffer = m_fbsXBlur[currentImage];
-
-        vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassGaussXBloomInfo, VK_SUBPASS_CONTENTS_INLINE);
-        {
-            const auto& pipelineCreator = m_pipelineCreators[GAUSS_X_BLUR];
-            vkCmdBindPipeline(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
-            vkCmdBindDescriptorSets(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    pipelineCreator->getPipeline()->pipelineLayout, 0, 1,
-                                    pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
-        }
-
-        vkCmdDraw(_cmdBufs[currentImage], 6, 1, 0, 0);
-
-        vkCmdEndRenderPass(_cmdBufs[currentImage]);
-
-        /// GAUSS Y Bloom render pass
-        static std::array<VkClearValue, 2> gaussYBloomClearValues{zeroClearValues, zeroClearValues};
-
-        VkRenderPassBeginInfo renderPassGaussYBloomInfo = {};
-        renderPassGaussYBloomInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassGaussYBloomInfo.renderPass = m_renderPassYBlur;
-        renderPassGaussYBloomInfo.renderArea.offset = {0, 0};
-        renderPassGaussYBloomInfo.renderArea.extent.width = _offscreenWidth;
-        renderPassGaussYBloomInfo.renderArea.extent.height = _offscreenHeight;
-        renderPassGaussYBloomInfo.clearValueCount = gaussYBloomClearValues.size();
-        renderPassGaussYBloomInfo.pClearValues = gaussYBloomClearValues.data();
-        renderPassGaussYBloomInfo.framebuffer = m_fbsYBlur[currentImage];
-
-        vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassGaussYBloomInfo, VK_SUBPASS_CONTENTS_INLINE);
-        {
-            const auto& pipelineCreator = m_pipelineCreators[GAUSS_Y_BLUR];
-            vkCmdBindPipeline(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
-            vkCmdBindDescriptorSets(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    pipelineCreator->getPipeline()->pipelineLayout, 0, 1,
-                                    pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
-        }
-
-        vkCmdDraw(_cmdBufs[currentImage], 6, 1, 0, 0);
-
-        vkCmdEndRenderPass(_cmdBufs[currentImage]);
-    }
-
-    //---------------------------------------------------------------------------------------------//
     /// BLOOM
-
     static std::array<VkClearValue, 2> bloomClearValues{zeroClearValues, zeroClearValues};
 
-    VkRenderPassBeginInfo renderPassBloomInfo = {};
+    VkRenderPassBeginInfo& renderPassBloomInfo = recording.bloomInfo;
     renderPassBloomInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassBloomInfo.renderPass = m_renderPassBloom;
     renderPassBloomInfo.renderArea.offset = {0, 0};
@@ -1337,189 +1380,590 @@ void VulkanRenderer::recordCommandBuffers(uint32_t currentImage, bool hmiRenderD
     renderPassBloomInfo.pClearValues = bloomClearValues.data();
     renderPassBloomInfo.framebuffer = m_fbsBloom[currentImage];
 
-    vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassBloomInfo, VK_SUBPASS_CONTENTS_INLINE);
-    {
-        const auto& pipelineCreator = m_pipelineCreators[BLOOM];
-        vkCmdBindPipeline(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
-        vkCmdBindDescriptorSets(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                pipelineCreator->getPipeline()->pipelineLayout, 0, 1,
-                                pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
+    /// FXAA render pass (FINAL PASS) render with native resolution!
+    static std::array<VkClearValue, 2> fxaaClearValues;
+    fxaaClearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
+    fxaaClearValues[1].color = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    VkRenderPassBeginInfo& renderPassFXAAInfo = recording.fxaaInfo;
+    renderPassFXAAInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassFXAAInfo.renderPass = m_renderPassFXAA;
+    renderPassFXAAInfo.renderArea.offset.x = 0;
+    renderPassFXAAInfo.renderArea.offset.y = 0;
+    renderPassFXAAInfo.renderArea.extent.width = _windowWidth;
+    renderPassFXAAInfo.renderArea.extent.height = _windowHeight;
+    renderPassFXAAInfo.clearValueCount = fxaaClearValues.size();
+    renderPassFXAAInfo.pClearValues = fxaaClearValues.data();
+    renderPassFXAAInfo.framebuffer = m_fbsFXAA[currentImage];
+
+    /// UI overlay
+    VkRenderPassBeginInfo& renderPassUIInfo = recording.uiInfo;
+    renderPassUIInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassUIInfo.renderPass = m_renderPassUIOverlay;
+    renderPassUIInfo.renderArea.offset.x = 0;
+    renderPassUIInfo.renderArea.offset.y = 0;
+    renderPassUIInfo.renderArea.extent.width = _windowWidth;
+    renderPassUIInfo.renderArea.extent.height = _windowHeight;
+    renderPassUIInfo.clearValueCount = 0;
+    renderPassUIInfo.pClearValues = nullptr;
+    renderPassUIInfo.framebuffer = m_fbsUIOverlay[currentImage];
+
+    //---------------------------------------------------------------------------------------------//
+    /// the conditions of the optional passes are evaluated before the graph is built
+    const bool is_clearingFootprint = _oneOffClearingFootPrint;
+    // draw object tracks (the panzer will leave the footprint) only if it moved far enough
+    const bool is_drawingFootprint =
+        !is_clearingFootprint &&
+        glm::distance(_lastFootPrintPos, mCamera.targetPos()) >= _footPrintRedrawingK * m_models[0]->radius();
+    _oneOffClearingFootPrint = false;
+    if (is_drawingFootprint) {
+        _lastFootPrintPos = mCamera.targetPos();
     }
 
-    vkCmdDraw(_cmdBufs[currentImage], 6, 1, 0, 0);
+    bool isDlssFrameTokenValid = true;
+    [[maybe_unused]] bool is_dlssPassEnabled = false;
+#if defined(USE_DLSS) && USE_DLSS
+    sl::FrameToken* dlssFrameToken = nullptr;
+    const bool is_dlssFrameRequested = _core.isDlssSupported() && m_isDlssEnabled;
+    if (is_dlssFrameRequested) {
+        sl::Result frameTokenRes = _core.slGetNewFrameTokenSafe(dlssFrameToken, &m_slFrameIndex);
+        if (frameTokenRes != sl::Result::eOk || !dlssFrameToken) {
+            isDlssFrameTokenValid = false;
+            if (!m_slConstantsErrorLogged) {
+                Utils::printLog(INFO_PARAM, "slGetNewFrameToken failed, sl::Result=%d", static_cast<int>(frameTokenRes));
+                m_slConstantsErrorLogged = true;
+            }
+        }
+        is_dlssPassEnabled = isDlssFrameTokenValid;
+    }
+#endif
+    const bool is_fxaaPassEnabled = !m_isDlssEnabled || !_core.isDlssSupported() || !isDlssFrameTokenValid;
 
-    vkCmdEndRenderPass(_cmdBufs[currentImage]);
+    //---------------------------------------------------------------------------------------------//
+    /// the state the record functions of the frame graph read
+    recording.is_clearingFootprint = is_clearingFootprint;
+    recording.is_drawingFootprint = is_drawingFootprint;
+    recording.is_fxaaPassEnabled = is_fxaaPassEnabled;
+    recording.is_uiEnabled = hmiRenderData;
+#if defined(USE_DLSS) && USE_DLSS
+    recording.is_dlssPassEnabled = is_dlssPassEnabled;
+    recording.dlssFrameToken = dlssFrameToken;
+#endif
+    // FXAA samples the offscreen color buffer, so the shader needs the source texture resolution here
+    // even though the render pass output target is the window-sized swapchain image.
+    // The shader reads windowSize only, the per-frame push constant data is not recorded.
+    recording.fxaaWindowSize = _pushConstant.windowSize;
+    recording.fxaaWindowSize.x = static_cast<float>(_offscreenWidth);
+    recording.fxaaWindowSize.y = static_cast<float>(_offscreenHeight);
+
+    addFramePasses(m_renderGraph, &recording);
+    m_renderGraph.compile();
 
     //---------------------------------------------------------------------------------------------//
-    /// SEMI-TRANSPARENT OBJECTS render pass
+    VkResult res = vkBeginCommandBuffer(_cmdBufs[currentImage], &beginInfo);
+    CHECK_VULKAN_ERROR("vkBeginCommandBuffer error %d\n", res);
 
-    static std::array<VkClearValue, 2> semiTransClearValues{zeroClearValues, zeroClearValues};
+    // the results of the previous submission of the image are read back, its fence is signaled already
+    m_gpuProfiler.beginFrame(_cmdBufs[currentImage], currentImage);
+    m_renderGraph.execute(_cmdBufs[currentImage], &m_gpuProfiler);
+    m_gpuProfiler.endFrame(_cmdBufs[currentImage]);
 
-    VkRenderPassBeginInfo renderPassSemiTransInfo = {};
-    renderPassSemiTransInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassSemiTransInfo.renderPass = m_renderPassSemiTrans;
-    renderPassSemiTransInfo.renderArea.offset = {0, 0};
-    renderPassSemiTransInfo.renderArea.extent.width = _offscreenWidth;
-    renderPassSemiTransInfo.renderArea.extent.height = _offscreenHeight;
-    renderPassSemiTransInfo.clearValueCount = semiTransClearValues.size();
-    renderPassSemiTransInfo.pClearValues = semiTransClearValues.data();
-    renderPassSemiTransInfo.framebuffer = m_fbsSemiTrans[currentImage];
+#if defined(USE_DLSS) && USE_DLSS
+    if (is_dlssFrameRequested) {
+        ++m_slFrameIndex;
+    }
+#endif
 
-    // The depth image was sampled as read-only earlier (SSAO/lighting). Re-open it as a depth attachment
-    // so the semi-transparent pass can run depth test and update depth.
-    Utils::VulkanImageMemoryBarrier(_cmdBufs[currentImage], _depthBuffer.depthImage, _depthBuffer.depthFormat,
-                                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
-                                    VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_IMAGE_ASPECT_DEPTH_BIT, 1U, 1U,
-                                    VK_ACCESS_SHADER_READ_BIT,
-                                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-                                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
+    res = vkEndCommandBuffer(_cmdBufs[currentImage]);
+    CHECK_VULKAN_ERROR("vkEndCommandBuffer error %d\n", res);
 
-    vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassSemiTransInfo, VK_SUBPASS_CONTENTS_INLINE);
-    {
-        const auto& pipelineCreator = m_pipelineCreators[PARTICLE];
-        vkCmdPushConstants(_cmdBufs[currentImage], pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
-                           sizeof(PushConstant), &_pushConstant);
-        for (auto& particle : m_particles) {
-            particle->draw(_cmdBufs[currentImage], currentImage);
-        }
+    if (m_isRenderGraphDumpRequested) {
+        m_isRenderGraphDumpRequested = false;
+        Utils::printLog(INFO_PARAM, m_renderGraph.dump());
     }
 
-    for (uint32_t meshIndex = 0u; meshIndex < m_semiTransparentModels.size(); ++meshIndex) {
-        // TODO
-        const auto& pipelineCreator = m_pipelineCreators[SEMI_TRANSPARENT];
-        vkCmdPushConstants(_cmdBufs[currentImage], pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
-                           sizeof(PushConstant), &_pushConstant);
-        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment) * (meshIndex + m_models.size());
-        m_semiTransparentModels[meshIndex]->draw(_cmdBufs[currentImage], currentImage, dynamicOffset);
+    if (m_isGpuTimingsExportRequested) {
+        m_isGpuTimingsExportRequested = false;
+        m_gpuProfiler.exportCsv(std::string{Constants::GPU_TIMINGS_FILE});
     }
-    vkCmdEndRenderPass(_cmdBufs[currentImage]);
 
-    // Semi-transparent pass uses depth as writable attachment; switch back to read-only
-    // before DLSS tags/evaluation and for a stable end-of-frame layout.
-    Utils::VulkanImageMemoryBarrier(
-        _cmdBufs[currentImage], _depthBuffer.depthImage, _depthBuffer.depthFormat,
-        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
-        VK_IMAGE_ASPECT_DEPTH_BIT, 1U, 1U,
-        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-        VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
-
-    Utils::VulkanImageMemoryBarrier(
-        _cmdBufs[currentImage], _colorBuffer.colorBufferImage[currentImage], _colorBuffer.colorFormat,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT,
-        1U, 1U, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
-
-    // After writing motion vectors in the semi-transparent pass, transition back to shader-read layout
-    // so subsequent post-process stages (TAA/FSR/DLAA) can safely sample this texture.
-    Utils::VulkanImageMemoryBarrier(
-        _cmdBufs[currentImage], _motionVectorsBuffer.colorBufferImage[currentImage], _motionVectorsBuffer.colorFormat,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT,
-        1U, 1U, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    m_recordingTimeMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordingStartTime).count();
+}
 
-    bool isDlssFrameTokenValid = true;
-#if defined(USE_DLSS) && USE_DLSS
-    sl::FrameToken* dlssFrameToken = nullptr;
-    if (_core.isDlssSupported() && m_isDlssEnabled) {
-        sl::Result frameTokenRes = _core.slGetNewFrameTokenSafe(dlssFrameToken, &m_slFrameIndex);
-        if (frameTokenRes != sl::Result::eOk || !dlssFrameToken) {
-            isDlssFrameTokenValid = false; 
-            if (!m_slConstantsErrorLogged) {
-                Utils::printLog(INFO_PARAM, "slGetNewFrameToken failed, sl::Result=%d", static_cast<int>(frameTokenRes));
-                m_slConstantsErrorLogged = true;
+void VulkanRenderer::addFramePasses(RenderGraph& graph, const FrameRecording* recording) {
+    /// the frame graph: the images of the swapchain image and the layouts they are left in for the next frame.
+    /// The attachment accesses follow the initial/final layouts of the render passes (see createRenderPass),
+    /// the graph adds the transitions the render passes don't do (depth re-opened by the semi-transparent pass,
+    /// the offscreen color and motion vectors sampled by the final pass)
+    using Access = RenderGraph::ResourceAccess;
+    constexpr VkPipelineStageFlags COLOR_STAGE = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    constexpr VkPipelineStageFlags DEPTH_STAGE =
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    constexpr VkPipelineStageFlags SAMPLING_STAGE = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    constexpr VkAccessFlags COLOR_WRITE = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    constexpr VkAccessFlags DEPTH_WRITE =
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    constexpr VkAccessFlags SAMPLING = VK_ACCESS_SHADER_READ_BIT;
+    constexpr VkImageLayout UNDEFINED = VK_IMAGE_LAYOUT_UNDEFINED;
+    constexpr VkImageLayout COLOR_ATTACHMENT = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    constexpr VkImageLayout DEPTH_READ_ONLY = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    constexpr VkImageLayout SHADER_READ = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // the accesses only graph is declared before the per image attachments exist
+    const auto frameImage = [recording](const std::vector<VkImage>& images) {
+        return recording ? images[recording->currentImage] : VkImage{};
+    };
+
+    graph.reset();
+    const auto depth = graph.importImage("depth", _depthBuffer.depthImage, VK_IMAGE_ASPECT_DEPTH_BIT, DEPTH_READ_ONLY,
+                                         DEPTH_READ_ONLY);
+    const auto viewSpace = graph.importImage("view space", frameImage(_viewSpaceBuffer.colorBufferImage),
+                                             VK_IMAGE_ASPECT_COLOR_BIT, SHADER_READ);
+    const auto motion = graph.importImage("motion vectors", frameImage(_motionVectorsBuffer.colorBufferImage),
+                                          VK_IMAGE_ASPECT_COLOR_BIT, SHADER_READ, SHADER_READ);
+    const auto shadowMap = graph.importImage("shadow map", _shadowMapBuffer.depthImage, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                             DEPTH_READ_ONLY);
+    // the tracks are accumulated over frames
+    const auto footprint = graph.importImage("footprint", _footprintBuffer.depthImage, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                             DEPTH_READ_ONLY, UNDEFINED, true);
+    const auto color = graph.importImage("color", frameImage(_colorBuffer.colorBufferImage), VK_IMAGE_ASPECT_COLOR_BIT,
+                                         SHADER_READ, SHADER_READ);
+    const auto gNormal = graph.importImage("g normal", frameImage(_gPassBuffer.normal.colorBufferImage),
+                                           VK_IMAGE_ASPECT_COLOR_BIT, SHADER_READ);
+    const auto gColor = graph.importImage("g color", frameImage(_gPassBuffer.color.colorBufferImage),
+                                          VK_IMAGE_ASPECT_COLOR_BIT, SHADER_READ);
+    const auto ssao = graph.importImage("ssao", frameImage(_ssaoBuffer.colorBufferImage), VK_IMAGE_ASPECT_COLOR_BIT,
+                                        SHADER_READ);
+    const auto shading = graph.importImage("shading", frameImage(_shadingBuffer.colorBufferImage),
+                                           VK_IMAGE_ASPECT_COLOR_BIT, SHADER_READ);
+    const auto bloom0 = graph.importImage("bloom 0", frameImage(_bloomBuffer[0].colorBufferImage),
+                                          VK_IMAGE_ASPECT_COLOR_BIT, SHADER_READ);
+    const auto bloom1 = graph.importImage("bloom 1", frameImage(_bloomBuffer[1].colorBufferImage),
+                                          VK_IMAGE_ASPECT_COLOR_BIT, SHADER_READ);
+    const auto depthTemp = graph.importImage("depth temp", _depthTempBuffer.depthImage, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    const auto swapchain = graph.importImage("swapchain", frameImage(_swapChain.images), VK_IMAGE_ASPECT_COLOR_BIT,
+                                             UNDEFINED, UNDEFINED, true);
+
+    /// depth writing pass (depth + view space pos + motion vectors)
+    graph.addPass("depth",
+                  {Access{depth, true, DEPTH_STAGE, DEPTH_WRITE, UNDEFINED, DEPTH_READ_ONLY, true},
+                   Access{viewSpace, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, SHADER_READ, true},
+                   Access{motion, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, COLOR_ATTACHMENT, true}},
+                  [this, recording](VkCommandBuffer cmdBuf) {
+                      vkCmdBeginRenderPass(cmdBuf, &(*recording->secondaryPassInfos)[SECONDARY_DEPTH],
+                                           VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                      executeSecondaryCommandBuffers(recording->currentImage, SECONDARY_DEPTH);
+                      vkCmdEndRenderPass(cmdBuf);
+                  });
+
+    /// shadow map pass
+    graph.addPass("shadow map", {Access{shadowMap, true, DEPTH_STAGE, DEPTH_WRITE, UNDEFINED, DEPTH_READ_ONLY, true}},
+                  [this, recording](VkCommandBuffer cmdBuf) {
+                      vkCmdBeginRenderPass(cmdBuf, &(*recording->secondaryPassInfos)[SECONDARY_SHADOWMAP],
+                                           VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                      executeSecondaryCommandBuffers(recording->currentImage, SECONDARY_SHADOWMAP);
+                      vkCmdEndRenderPass(cmdBuf);
+                  });
+
+    /// footprint pass, culled while the tracks don't change
+    graph.addPass(
+        "footprint", {Access{footprint, true, DEPTH_STAGE, DEPTH_WRITE, DEPTH_READ_ONLY, DEPTH_READ_ONLY, true}},
+        [this, recording](VkCommandBuffer cmdBuf) {
+            vkCmdBeginRenderPass(cmdBuf, &recording->footprintInfo, VK_SUBPASS_CONTENTS_INLINE);
+            Utils::VulkanSetViewport(cmdBuf, recording->footprintInfo.renderArea.extent);
+
+            if (recording->is_clearingFootprint) {
+                VkClearValue footPrintClearValues{};
+                footPrintClearValues.depthStencil.depth = 1.0f;
+                VkClearAttachment clearAttachment{};
+                clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+                clearAttachment.clearValue = footPrintClearValues;
+                clearAttachment.colorAttachment = 0u;
+                VkClearRect clearRect = {{{0u, 0u}, {_footprintBuffer.width, _footprintBuffer.height}}, 0u, 1u};
+                vkCmdClearAttachments(cmdBuf, 1, &clearAttachment, 1u, &clearRect);
+            } else {
+                uint32_t meshIndex = 0u;
+                const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment) * meshIndex;
+                m_models[meshIndex]->drawFootprints(cmdBuf, recording->currentImage, dynamicOffset);
             }
-        } else {
-            setDLSSConstants(*dlssFrameToken);
+
+            vkCmdEndRenderPass(cmdBuf);
+        },
+        recording && (recording->is_clearingFootprint || recording->is_drawingFootprint));
+
+    /// G pass: SkyBox and 3D Models, SSAO and lighting subpasses
+    graph.addPass(
+        "g-pass",
+        {Access{depth, false, SAMPLING_STAGE, SAMPLING, DEPTH_READ_ONLY, UNDEFINED, true},
+         Access{shadowMap, false, SAMPLING_STAGE, SAMPLING, DEPTH_READ_ONLY, UNDEFINED, true},
+         Access{footprint, false, SAMPLING_STAGE, SAMPLING, DEPTH_READ_ONLY, UNDEFINED, true},
+         Access{viewSpace, false, SAMPLING_STAGE, SAMPLING, SHADER_READ, UNDEFINED, true},
+         Access{color, true, COLOR_STAGE, COLOR_WRITE, SHADER_READ, COLOR_ATTACHMENT, true},
+         Access{gNormal, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, SHADER_READ, true},
+         Access{gColor, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, SHADER_READ, true},
+         Access{ssao, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, SHADER_READ, true},
+         Access{bloom0, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, SHADER_READ, true},
+         Access{depthTemp, true, DEPTH_STAGE, DEPTH_WRITE, UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true},
+         Access{shading, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, SHADER_READ, true},
+         Access{motion, true, COLOR_STAGE, COLOR_WRITE, COLOR_ATTACHMENT, COLOR_ATTACHMENT, true}},
+        [this, recording](VkCommandBuffer cmdBuf) {
+            const VkRenderPassBeginInfo& renderPassInfo = (*recording->secondaryPassInfos)[SECONDARY_GPASS];
+            const uint32_t currentImage = recording->currentImage;
+
+            // the first subpass executes secondary command buffers only, its scope is closed in the next subpass
+            auto subpassScope = m_gpuProfiler.beginScope(cmdBuf, "geometry");
+            vkCmdBeginRenderPass(cmdBuf, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            executeSecondaryCommandBuffers(currentImage, SECONDARY_GPASS);
+
+            ///-----------------------------------------------------------------------------------///
+            /// Start second subpass (SSAO)
+            vkCmdNextSubpass(cmdBuf, VK_SUBPASS_CONTENTS_INLINE);
+            m_gpuProfiler.endScope(cmdBuf, subpassScope);
+            subpassScope = m_gpuProfiler.beginScope(cmdBuf, "ssao");
+            // the dynamic state of the secondary command buffers is not inherited back
+            Utils::VulkanSetViewport(cmdBuf, renderPassInfo.renderArea.extent);
+
+            /// quad subpass
+            {
+                const auto& pipelineCreator = m_pipelineCreators[SSAO];
+                vkCmdPushConstants(cmdBuf, pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
+                                   sizeof(PushConstant), &_pushConstant);
+                vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
+                FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
+                vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipelineLayout, 0,
+                                        1, pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
+                FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
+            }
+
+            vkCmdDraw(cmdBuf, 6, 1, 0, 0);
+            FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
+
+            ///-----------------------------------------------------------------------------------///
+            /// Start third subpass
+            vkCmdNextSubpass(cmdBuf, VK_SUBPASS_CONTENTS_INLINE);
+            m_gpuProfiler.endScope(cmdBuf, subpassScope);
+            subpassScope = m_gpuProfiler.beginScope(cmdBuf, "lighting");
+
+            /// quad subpass
+            {
+                const auto& pipelineCreator = m_pipelineCreators[POST_LIGHTING];
+                vkCmdPushConstants(cmdBuf, pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
+                                   sizeof(PushConstant), &_pushConstant);
+
+                vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
+                FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
+                vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipelineLayout, 0,
+                                        1, pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
+                FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
+            }
+
+            vkCmdDraw(cmdBuf, 6, 1, 0, 0);
+            FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
+
+            vkCmdEndRenderPass(cmdBuf);
+            m_gpuProfiler.endScope(cmdBuf, subpassScope);
+        });
+
+    /// SSAO blur applied on the color buffer
+    graph.addPass("ssao blur",
+                  {Access{shading, false, SAMPLING_STAGE, SAMPLING, SHADER_READ, UNDEFINED, true},
+                   Access{color, true, COLOR_STAGE, COLOR_WRITE, COLOR_ATTACHMENT, COLOR_ATTACHMENT, true}},
+                  [this, recording](VkCommandBuffer) {
+                      drawCachedQuadPass(recording->currentImage, CACHED_SSAO_BLUR, SSAO_BLUR, recording->ssaoBlurInfo);
+                  });
+
+    /// 3 times gauss blurring of the bright parts, culled with the bloom pass
+    graph.addPass("gauss blur",
+                  {Access{bloom0, false, SAMPLING_STAGE, SAMPLING, SHADER_READ, UNDEFINED, true},
+                   Access{bloom1, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, SHADER_READ, true},
+                   Access{bloom0, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, SHADER_READ, true}},
+                  [this, recording](VkCommandBuffer) {
+                      for (int32_t t = 0; t < 3; ++t) {
+                          // the iterations execute the same secondary command buffers
+                          drawCachedQuadPass(recording->currentImage, CACHED_GAUSS_X_BLUR, GAUSS_X_BLUR,
+                                             recording->gaussXBloomInfo);
+                          drawCachedQuadPass(recording->currentImage, CACHED_GAUSS_Y_BLUR, GAUSS_Y_BLUR,
+                                             recording->gaussYBloomInfo);
+                      }
+                  });
+
+    /// BLOOM
+    graph.addPass(
+        "bloom",
+        {Access{bloom0, false, SAMPLING_STAGE, SAMPLING, SHADER_READ, UNDEFINED, true},
+         Access{color, true, COLOR_STAGE, COLOR_WRITE, COLOR_ATTACHMENT, COLOR_ATTACHMENT, true}},
+        [this, recording](VkCommandBuffer) {
+            drawCachedQuadPass(recording->currentImage, CACHED_BLOOM, BLOOM, recording->bloomInfo);
+        },
+        m_isBloomEnabled);
+
+    /// SEMI-TRANSPARENT OBJECTS render pass
+    // the depth image sampled as read-only earlier (SSAO/lighting) is re-opened as a depth attachment by the graph,
+    // so the semi-transparent pass can run depth test and update depth
+    graph.addPass(
+        "semi-transparent",
+        {Access{color, true, COLOR_STAGE, COLOR_WRITE, COLOR_ATTACHMENT, COLOR_ATTACHMENT, true},
+         Access{depth, true, DEPTH_STAGE, DEPTH_WRITE, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true},
+         Access{motion, true, COLOR_STAGE, COLOR_WRITE, COLOR_ATTACHMENT, COLOR_ATTACHMENT, true}},
+        [this, recording](VkCommandBuffer cmdBuf) {
+            vkCmdBeginRenderPass(cmdBuf, &(*recording->secondaryPassInfos)[SECONDARY_SEMI_TRANSPARENT],
+                                 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            executeSecondaryCommandBuffers(recording->currentImage, SECONDARY_SEMI_TRANSPARENT);
+            vkCmdEndRenderPass(cmdBuf);
+        });
+
+#if defined(USE_DLSS) && USE_DLSS
+    /// DLSS evaluation and the blit into the swapchain image, the swapchain transitions are done by evaluateDLSSPass
+    constexpr VkPipelineStageFlags DLSS_STAGE = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    graph.addPass(
+        "dlss",
+        {Access{color, false, DLSS_STAGE, SAMPLING, SHADER_READ, UNDEFINED, false},
+         Access{depth, false, DLSS_STAGE, SAMPLING, DEPTH_READ_ONLY, UNDEFINED, false},
+         Access{motion, false, DLSS_STAGE, SAMPLING, SHADER_READ, UNDEFINED, false},
+         Access{swapchain, true, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, UNDEFINED,
+                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, true}},
+        [this, recording](VkCommandBuffer) {
+            setDLSSConstants(*recording->dlssFrameToken);
             // Tag the final per-frame DLSS inputs once all producer passes have completed.
-            setDLSSResourceTags(currentImage, *dlssFrameToken);
-            evaluateDLSSPass(currentImage, *dlssFrameToken);
+            setDLSSResourceTags(recording->currentImage, *recording->dlssFrameToken);
+            evaluateDLSSPass(recording->currentImage, *recording->dlssFrameToken);
 
             if (m_slConstantsErrorLogged) {
                 m_isDlssEnabled = false;
                 Utils::printLog(INFO_PARAM, "DLSS disabled due to slGetNewFrameToken failure");
             }
+        },
+        recording && recording->is_dlssPassEnabled);
+#endif
+
+    /// FXAA, the fallback of DLSS
+    graph.addPass(
+        "fxaa",
+        {Access{color, false, SAMPLING_STAGE, SAMPLING, SHADER_READ, UNDEFINED, false},
+         Access{swapchain, true, COLOR_STAGE, COLOR_WRITE, UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, true}},
+        [this, recording](VkCommandBuffer) {
+            drawCachedQuadPass(recording->currentImage, CACHED_FXAA, POST_FXAA, recording->fxaaInfo,
+                               &recording->fxaaWindowSize);
+        },
+        recording && recording->is_fxaaPassEnabled);
+
+    /// UI overlay on top of the final image
+    graph.addPass("ui overlay",
+                  {Access{swapchain, true, COLOR_STAGE, COLOR_WRITE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                          VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, true}},
+                  [this, recording](VkCommandBuffer cmdBuf) {
+                      vkCmdBeginRenderPass(cmdBuf, &recording->uiInfo, VK_SUBPASS_CONTENTS_INLINE);
+                      _core.getWinController()->imGuiNewFrame(cmdBuf);
+                      vkCmdEndRenderPass(cmdBuf);
+                  },
+                  recording && recording->is_uiEnabled);
+}
+
+
+void VulkanRenderer::createRecordingThreads() {
+    // hardware_concurrency may return 0
+    m_recordingThreadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+    m_is_recordingStopped = false;
+    for (uint32_t threadIndex = 1u; threadIndex < m_recordingThreadsCount; ++threadIndex) {
+        m_recordingThreads.emplace_back(&VulkanRenderer::recordingWorker, this, threadIndex);
+    }
+}
+
+void VulkanRenderer::destroyRecordingThreads() {
+    {
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
+        m_is_recordingStopped = true;
+    }
+    m_recordingCondition.notify_all();
+    for (auto& recordingThread : m_recordingThreads) {
+        recordingThread.join();
+    }
+    m_recordingThreads.clear();
+}
 
-            if (hmiRenderData) {
-                VkRenderPassBeginInfo renderPassUIInfo = {};
-                renderPassUIInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-                renderPassUIInfo.renderPass = m_renderPassUIOverlay;
-                renderPassUIInfo.renderArea.offset.x = 0;
-                renderPassUIInfo.renderArea.offset.y = 0;
-                renderPassUIInfo.renderArea.extent.width = _windowWidth;
-                renderPassUIInfo.renderArea.extent.height = _windowHeight;
-                renderPassUIInfo.clearValueCount = 0;
-                renderPassUIInfo.pClearValues = nullptr;
-                renderPassUIInfo.framebuffer = m_fbsUIOverlay[currentImage];
-
-                vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassUIInfo, VK_SUBPASS_CONTENTS_INLINE);
-                _core.getWinController()->imGuiNewFrame(_cmdBufs[currentImage]);
-                vkCmdEndRenderPass(_cmdBufs[currentImage]);
+void VulkanRenderer::recordingWorker(uint32_t threadIndex) {
+    uint64_t recordedJobIndex = 0u;
+    for (;;) {
+        RecordingJob job;
+        {
+            std::unique_lock<std::mutex> lock(m_recordingMutex);
+            m_recordingCondition.wait(lock, [this, recordedJobIndex] {
+                return m_is_recordingStopped || m_recordingJobIndex != recordedJobIndex;
+            });
+            if (m_is_recordingStopped) {
+                return;
             }
+            recordedJobIndex = m_recordingJobIndex;
+            job = m_recordingJob;
+        }
+        // the threads beyond the batches of the job sleep until the next one
+        if (threadIndex >= job.batchesCount) {
+            continue;
+        }
+
+        std::exception_ptr recordingError;
+        try {
+            recordSecondaryCommandBuffers(job.currentImage, threadIndex, job.batchesCount, *job.renderPassInfos);
+        } catch (...) {
+            recordingError = std::current_exception();
         }
-        ++m_slFrameIndex;
-    }
-#endif
 
-    if (!m_isDlssEnabled || !_core.isDlssSupported() || !isDlssFrameTokenValid) {
-        //---------------------------------------------------------------------------------------------//
-        /// FXAA render pass (FINAL PASS) render with native resolution!
-
-        static std::array<VkClearValue, 2> fxaaClearValues;
-        fxaaClearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
-        fxaaClearValues[1].color = {0.0f, 0.0f, 0.0f, 1.0f};
-
-        VkRenderPassBeginInfo renderPassFXAAInfo = {};
-        renderPassFXAAInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassFXAAInfo.renderPass = m_renderPassFXAA;
-        renderPassFXAAInfo.renderArea.offset.x = 0;
-        renderPassFXAAInfo.renderArea.offset.y = 0;
-        renderPassFXAAInfo.renderArea.extent.width = _windowWidth;
-        renderPassFXAAInfo.renderArea.extent.height = _windowHeight;
-        renderPassFXAAInfo.clearValueCount = fxaaClearValues.size();
-        renderPassFXAAInfo.pClearValues = fxaaClearValues.data();
-        renderPassFXAAInfo.framebuffer = m_fbsFXAA[currentImage];
-
-        // FXAA render pass begins with the color buffer already in SHADER_READ_ONLY_OPTIMAL after semi-transparent pass.
-        // The render pass begin will handle the layout transition if necessary.
-        vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassFXAAInfo, VK_SUBPASS_CONTENTS_INLINE);
+        bool is_lastBatch = false;
         {
-            const auto& pipelineCreator = m_pipelineCreators[POST_FXAA];
-            PushConstant fxaaPushConstant = _pushConstant;
-            // FXAA samples the offscreen color buffer, so the shader needs the source texture resolution here
-            // even though the render pass output target is the window-sized swapchain image.
-            fxaaPushConstant.windowSize.x = static_cast<float>(_offscreenWidth);
-            fxaaPushConstant.windowSize.y = static_cast<float>(_offscreenHeight);
-            vkCmdPushConstants(_cmdBufs[currentImage], pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
-                               sizeof(PushConstant), &fxaaPushConstant);
-            vkCmdBindPipeline(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline()->pipeline);
-            vkCmdBindDescriptorSets(_cmdBufs[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    pipelineCreator->getPipeline()->pipelineLayout, 0, 1,
-                                    pipelineCreator->getDescriptorSet(currentImage), 0, nullptr);
-        }
-
-        vkCmdDraw(_cmdBufs[currentImage], 6, 1, 0, 0);
-        vkCmdEndRenderPass(_cmdBufs[currentImage]);
-
-        if (hmiRenderData) {
-            VkRenderPassBeginInfo renderPassUIInfo = {};
-            renderPassUIInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassUIInfo.renderPass = m_renderPassUIOverlay;
-            renderPassUIInfo.renderArea.offset.x = 0;
-            renderPassUIInfo.renderArea.offset.y = 0;
-            renderPassUIInfo.renderArea.extent.width = _windowWidth;
-            renderPassUIInfo.renderArea.extent.height = _windowHeight;
-            renderPassUIInfo.clearValueCount = 0;
-            renderPassUIInfo.pClearValues = nullptr;
-            renderPassUIInfo.framebuffer = m_fbsUIOverlay[currentImage];
-
-            vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassUIInfo, VK_SUBPASS_CONTENTS_INLINE);
-            _core.getWinController()->imGuiNewFrame(_cmdBufs[currentImage]);
-            vkCmdEndRenderPass(_cmdBufs[currentImage]);
+            std::lock_guard<std::mutex> lock(m_recordingMutex);
+            if (recordingError && !m_recordingError) {
+                m_recordingError = recordingError;
+            }
+            is_lastBatch = --m_pendingBatchesCount == 0u;
+        }
+        if (is_lastBatch) {
+            m_recordedCondition.notify_one();
         }
     }
+}
 
-    res = vkEndCommandBuffer(_cmdBufs[currentImage]);
+void VulkanRenderer::recordSecondaryCommandBuffers(uint32_t currentImage, uint32_t threadIndex, uint32_t batchesCount,
+                                                   const std::array<VkRenderPassBeginInfo, SECONDARY_MAX>& renderPassInfos) {
+    PROFILE_FUNCTION();
+    // the fence of the image is signaled, nothing recorded by the pool is pending anymore
+    VkResult res = vkResetCommandPool(_core.getDevice(), m_recordingContexts[currentImage][threadIndex].cmdPool, 0);
+    CHECK_VULKAN_ERROR("vkResetCommandPool error %d\n", res);
+
+    // contiguous batches keep the drawing order of the models once executed one after another
+    const auto getBatch = [threadIndex, batchesCount](std::size_t modelsCount) {
+        const std::size_t chunkOffset = modelsCount / batchesCount;
+        const std::size_t indexFrom = threadIndex * chunkOffset;
+        const std::size_t indexTo = threadIndex + 1u >= batchesCount ? modelsCount : (threadIndex + 1u) * chunkOffset;
+        return std::make_pair(indexFrom, indexTo);
+    };
+    const auto [modelFrom, modelTo] = getBatch(m_models.size());
+    const auto [semiTransFrom, semiTransTo] = getBatch(m_semiTransparentModels.size());
+
+    /// depth writing for each object
+    VkCommandBuffer cmdBuf = beginSecondaryCommandBuffer(currentImage, threadIndex, SECONDARY_DEPTH,
+                                                         renderPassInfos[SECONDARY_DEPTH]);
+    for (std::size_t meshIndex = modelFrom; meshIndex < modelTo; ++meshIndex) {
+        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment * meshIndex);
+        m_models[meshIndex]->drawWithCustomPipeline(m_pipelineCreators[DEPTH].get(), cmdBuf, currentImage, dynamicOffset);
+    }
+    res = vkEndCommandBuffer(cmdBuf);
     CHECK_VULKAN_ERROR("vkEndCommandBuffer error %d\n", res);
+
+    /// draw shadow of 3d mesh only
+    cmdBuf = beginSecondaryCommandBuffer(currentImage, threadIndex, SECONDARY_SHADOWMAP, renderPassInfos[SECONDARY_SHADOWMAP]);
+    for (std::size_t meshIndex = modelFrom; meshIndex < std::min(modelTo, m_models.size() - 2u); ++meshIndex) {
+        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment * meshIndex);
+        m_models[meshIndex]->drawWithCustomPipeline(m_pipelineCreators[SHADOWMAP].get(), cmdBuf, currentImage, dynamicOffset);
+    }
+    for (std::size_t meshIndex = semiTransFrom; meshIndex < semiTransTo; ++meshIndex) {
+        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment * (meshIndex + m_models.size()));
+        m_semiTransparentModels[meshIndex]->drawWithCustomPipeline(m_pipelineCreators[SHADOWMAP].get(), cmdBuf, currentImage,
+                                                                   dynamicOffset);
+    }
+    res = vkEndCommandBuffer(cmdBuf);
+    CHECK_VULKAN_ERROR("vkEndCommandBuffer error %d\n", res);
+
+    ///  SkyBox and 3D Models, the first subpass of G pass
+    cmdBuf = beginSecondaryCommandBuffer(currentImage, threadIndex, SECONDARY_GPASS, renderPassInfos[SECONDARY_GPASS]);
+    for (std::size_t meshIndex = modelFrom; meshIndex < modelTo; ++meshIndex) {
+        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment * meshIndex);
+        m_models[meshIndex]->draw(cmdBuf, currentImage, dynamicOffset);
+    }
+    res = vkEndCommandBuffer(cmdBuf);
+    CHECK_VULKAN_ERROR("vkEndCommandBuffer error %d\n", res);
+
+    /// particles go first to keep the order of the single threaded recording
+    cmdBuf = beginSecondaryCommandBuffer(currentImage, threadIndex, SECONDARY_SEMI_TRANSPARENT,
+                                         renderPassInfos[SECONDARY_SEMI_TRANSPARENT]);
+    if (threadIndex == 0u) {
+        const auto& pipelineCreator = m_pipelineCreators[PARTICLE];
+        vkCmdPushConstants(cmdBuf, pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
+                           sizeof(PushConstant), &_pushConstant);
+        for (auto& particle : m_particles) {
+            particle->draw(cmdBuf, currentImage);
+        }
+    }
+
+    for (std::size_t meshIndex = semiTransFrom; meshIndex < semiTransTo; ++meshIndex) {
+        const auto& pipelineCreator = m_pipelineCreators[SEMI_TRANSPARENT];
+        vkCmdPushConstants(cmdBuf, pipelineCreator->getPipeline()->pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0,
+                           sizeof(PushConstant), &_pushConstant);
+        const uint32_t dynamicOffset = static_cast<uint32_t>(_modelUniformAlignment * (meshIndex + m_models.size()));
+        m_semiTransparentModels[meshIndex]->draw(cmdBuf, currentImage, dynamicOffset);
+    }
+    res = vkEndCommandBuffer(cmdBuf);
+    CHECK_VULKAN_ERROR("vkEndCommandBuffer error %d\n", res);
+}
+
+VkCommandBuffer VulkanRenderer::beginSecondaryCommandBuffer(uint32_t currentImage, uint32_t threadIndex, SecondaryPasses pass,
+                                                            const VkRenderPassBeginInfo& renderPassInfo) {
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = renderPassInfo.renderPass;
+    inheritanceInfo.subpass = 0u;  // all the secondary passes are recorded into the first subpass
+    inheritanceInfo.framebuffer = renderPassInfo.framebuffer;
+    // executed inside the pipeline statistics query of the pass
+    inheritanceInfo.pipelineStatistics = m_gpuProfiler.getPipelineStatisticsFlags();
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    VkCommandBuffer cmdBuf = m_recordingContexts[currentImage][threadIndex].cmdBufs[pass];
+    VkResult res = vkBeginCommandBuffer(cmdBuf, &beginInfo);
+    CHECK_VULKAN_ERROR("vkBeginCommandBuffer error %d\n", res);
+
+    // viewport and scissor are not inherited from the primary command buffer
+    Utils::VulkanSetViewport(cmdBuf, renderPassInfo.renderArea.extent);
+
+    return cmdBuf;
+}
+
+void VulkanRenderer::drawCachedQuadPass(uint32_t currentImage, CachedPasses pass, Pipelines pipeline,
+                                        const VkRenderPassBeginInfo& renderPassInfo, const glm::vec4* windowSize) {
+    static constexpr uint32_t QUAD_VERTICES_COUNT = 6u;
+
+    const auto& pipelineCreator = m_pipelineCreators[pipeline];
+    const VkPipeline vkPipeline = pipelineCreator->getPipeline()->pipeline;
+    const VkPipelineLayout pipelineLayout = pipelineCreator->getPipeline()->pipelineLayout;
+    const VkDescriptorSet descriptorSet = *pipelineCreator->getDescriptorSet(currentImage);
+    const glm::vec4 pushedWindowSize = windowSize ? *windowSize : glm::vec4(0.0f);
+
+    // a quality variant swap changes the pipeline, a resize the framebuffer and the extent
+    const uint64_t inputsHash =
+        CommandBufferCache::hashInputs(renderPassInfo.renderPass, renderPassInfo.framebuffer, renderPassInfo.renderArea.extent,
+                                       vkPipeline, pipelineLayout, descriptorSet, QUAD_VERTICES_COUNT, pushedWindowSize);
+
+    VkCommandBuffer cmdBuf = m_commandBufferCache.get(
+        currentImage, pass, inputsHash, renderPassInfo,
+        [&](VkCommandBuffer secondaryCmdBuf, CommandBufferCache::Counts& outCounts) {
+            Utils::VulkanSetViewport(secondaryCmdBuf, renderPassInfo.renderArea.extent);
+            if (windowSize) {
+                vkCmdPushConstants(secondaryCmdBuf, pipelineLayout, PUSH_CONSTANT_STAGE_FLAGS, 0, sizeof(glm::vec4), windowSize);
+            }
+            vkCmdBindPipeline(secondaryCmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, vkPipeline);
+            ++outCounts.pipelineBinds;
+            vkCmdBindDescriptorSets(secondaryCmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0,
+                                    nullptr);
+            ++outCounts.descriptorBinds;
+            vkCmdDraw(secondaryCmdBuf, QUAD_VERTICES_COUNT, 1, 0, 0);
+            ++outCounts.drawCalls;
+        });
+
+    vkCmdBeginRenderPass(_cmdBufs[currentImage], &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(_cmdBufs[currentImage], 1u, &cmdBuf);
+    vkCmdEndRenderPass(_cmdBufs[currentImage]);
+}
+
+void VulkanRenderer::executeSecondaryCommandBuffers(uint32_t currentImage, SecondaryPasses pass) {
+    for (uint32_t threadIndex = 0u; threadIndex < m_recordingBatchesCount; ++threadIndex) {
+        m_executedCmdBufs[threadIndex] = m_recordingContexts[currentImage][threadIndex].cmdBufs[pass];
+    }
+    vkCmdExecuteCommands(_cmdBufs[currentImage], m_recordingBatchesCount, m_executedCmdBufs.data());
 }
 
 void VulkanRenderer::createColorBufferImage() {
@@ -1558,6 +2002,10 @@ void VulkanRenderer::createColorBufferImage() {
     _shadingBuffer.colorFormat = _ssaoBuffer.colorFormat;
     _dlssOutputBuffer.colorFormat = _colorBuffer.colorFormat;
 
+    // the attachments alive within a frame only share memory if the frame graph passes using them don't overlap
+    using TransientAttachmentInfo = TransientAttachmentAllocator::AttachmentInfo;
+    std::vector<std::array<TransientAttachmentAllocator::Handle, 7u>> transientHandles(_swapchainImageCount);
+
     for (size_t i = 0; i < static_cast<size_t>(_swapchainImageCount); ++i) {
         // By keeping G Pass buffers on-tile only (VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT), we can save a lot of bandwidth and
         // memory. we don't need to write the g-buffer data out to memory let's leave everything in tile memory,
@@ -1578,73 +2026,47 @@ void VulkanRenderer::createColorBufferImage() {
 
         // Optional, Pre-transition to SHADER_READ_ONLY_OPTIMAL so G-pass initialLayout matches on the first frame.
         // to sync with colorAttachment.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        Utils::VulkanTransitionImageLayout(_core.getDevice(), _queue, _cmdBufPool,
-                           _colorBuffer.colorBufferImage[i], _colorBuffer.colorFormat,
+        Utils::VulkanTransitionImageLayout(_colorBuffer.colorBufferImage[i], _colorBuffer.colorFormat,
                            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                            VK_IMAGE_ASPECT_COLOR_BIT, 1U, 1U);
 
-        // the same applied to G pass buffer
+        const uint32_t group = static_cast<uint32_t>(i);
+        auto& handles = transientHandles[i];
 
-        Utils::VulkanCreateImage(
-            _core.getDevice(), _core.getPhysDevice(), _offscreenWidth, _offscreenHeight,
-            _gPassBuffer.normal.colorFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-                                                                           VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
-                                                                           VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _gPassBuffer.normal.colorBufferImage[i],
-            _gPassBuffer.normal.colorBufferImageMemory[i]);
-        Utils::VulkanCreateImageView(_core.getDevice(), _gPassBuffer.normal.colorBufferImage[i], _gPassBuffer.normal.colorFormat,
-                                     VK_IMAGE_ASPECT_COLOR_BIT, _gPassBuffer.normal.colorBufferImageView[i]);
-
-        Utils::VulkanCreateImage(
-            _core.getDevice(), _core.getPhysDevice(), _offscreenWidth, _offscreenHeight,
-            _gPassBuffer.color.colorFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-                                                                          VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
-                                                                          VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _gPassBuffer.color.colorBufferImage[i],
-            _gPassBuffer.color.colorBufferImageMemory[i]);
-        Utils::VulkanCreateImageView(_core.getDevice(), _gPassBuffer.color.colorBufferImage[i], _gPassBuffer.color.colorFormat,
-                                     VK_IMAGE_ASPECT_COLOR_BIT, _gPassBuffer.color.colorBufferImageView[i]);
-
-        // HDR render targets for Bloom effect
-        for (size_t bufIndex = 0u; bufIndex < _bloomBuffer.size(); ++bufIndex) {
-            auto& buf = _bloomBuffer[bufIndex];
-            buf.colorFormat = HDRFormat;
-            Utils::VulkanCreateImage(_core.getDevice(), _core.getPhysDevice(), _offscreenWidth, _offscreenHeight, buf.colorFormat,
-                                     VK_IMAGE_TILING_OPTIMAL,
-                                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
-                                         VK_IMAGE_USAGE_SAMPLED_BIT,
-                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buf.colorBufferImage[i], buf.colorBufferImageMemory[i]);
+        // the same applied to G pass buffer, its attachments are lazily allocated where the device supports it
+        handles[0] = m_transientAttachments.addAttachment(TransientAttachmentInfo{
+            "g normal", _offscreenWidth, _offscreenHeight, _gPassBuffer.normal.colorFormat,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+            group});
 
-            Utils::VulkanCreateImageView(_core.getDevice(), buf.colorBufferImage[i], buf.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT,
-                                         buf.colorBufferImageView[i]);
+        handles[1] = m_transientAttachments.addAttachment(TransientAttachmentInfo{
+            "g color", _offscreenWidth, _offscreenHeight, _gPassBuffer.color.colorFormat,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+            group});
 
-            if (bufIndex == 1u) {
-                Utils::VulkanTransitionImageLayout(_core.getDevice(), _queue, _cmdBufPool, buf.colorBufferImage[i],
-                                                   buf.colorFormat, VK_IMAGE_LAYOUT_UNDEFINED,
-                                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 1U, 1U);
-            }
+        // HDR render targets for Bloom effect: written by the lighting subpass and blurred ping-pong
+        for (auto& buf : _bloomBuffer) {
+            buf.colorFormat = HDRFormat;
         }
+        handles[2] = m_transientAttachments.addAttachment(TransientAttachmentInfo{
+            "bloom 0", _offscreenWidth, _offscreenHeight, _bloomBuffer[0].colorFormat,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, group});
+        handles[3] = m_transientAttachments.addAttachment(TransientAttachmentInfo{
+            "bloom 1", _offscreenWidth, _offscreenHeight, _bloomBuffer[1].colorFormat,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, group});
 
         // SSAO render target
-        Utils::VulkanCreateImage(_core.getDevice(), _core.getPhysDevice(), _offscreenWidth, _offscreenHeight,
-                                 _ssaoBuffer.colorFormat, VK_IMAGE_TILING_OPTIMAL,
+        handles[4] = m_transientAttachments.addAttachment(TransientAttachmentInfo{
+            "ssao", _offscreenWidth, _offscreenHeight, _ssaoBuffer.colorFormat,
             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _ssaoBuffer.colorBufferImage[i], _ssaoBuffer.colorBufferImageMemory[i]);
-
-        Utils::VulkanCreateImageView(_core.getDevice(), _ssaoBuffer.colorBufferImage[i], _ssaoBuffer.colorFormat,
-                                     VK_IMAGE_ASPECT_COLOR_BIT, _ssaoBuffer.colorBufferImageView[i]);
+            group});
 
         // view space position render target
-        Utils::VulkanCreateImage(_core.getDevice(), _core.getPhysDevice(), _offscreenWidth, _offscreenHeight,
-                                 _viewSpaceBuffer.colorFormat, VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            _viewSpaceBuffer.colorBufferImage[i], _viewSpaceBuffer.colorBufferImageMemory[i]);
-
-        Utils::VulkanCreateImageView(_core.getDevice(), _viewSpaceBuffer.colorBufferImage[i], _viewSpaceBuffer.colorFormat,
-                                     VK_IMAGE_ASPECT_COLOR_BIT, _viewSpaceBuffer.colorBufferImageView[i]);
+        handles[5] = m_transientAttachments.addAttachment(TransientAttachmentInfo{
+            "view space", _offscreenWidth, _offscreenHeight, _viewSpaceBuffer.colorFormat,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, group});
 
-        // motion vectors render target
+        // motion vectors render target, sampled by the upscalers at the end of the frame thus never aliased
         Utils::VulkanCreateImage(
             _core.getDevice(), _core.getPhysDevice(), _offscreenWidth, _offscreenHeight, _motionVectorsBuffer.colorFormat,
             VK_IMAGE_TILING_OPTIMAL,
@@ -1656,14 +2078,9 @@ void VulkanRenderer::createColorBufferImage() {
                                      VK_IMAGE_ASPECT_COLOR_BIT, _motionVectorsBuffer.colorBufferImageView[i]);
 
         // SHADING render target
-        Utils::VulkanCreateImage(_core.getDevice(), _core.getPhysDevice(), _offscreenWidth, _offscreenHeight,
-                                 _shadingBuffer.colorFormat, VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            _shadingBuffer.colorBufferImage[i], _shadingBuffer.colorBufferImageMemory[i]);
-
-        Utils::VulkanCreateImageView(_core.getDevice(), _shadingBuffer.colorBufferImage[i], _shadingBuffer.colorFormat,
-                                     VK_IMAGE_ASPECT_COLOR_BIT, _shadingBuffer.colorBufferImageView[i]);
+        handles[6] = m_transientAttachments.addAttachment(TransientAttachmentInfo{
+            "shading", _offscreenWidth, _offscreenHeight, _shadingBuffer.colorFormat,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, group});
 
         Utils::VulkanCreateImage(_core.getDevice(), _core.getPhysDevice(), _windowWidth, _windowHeight,
                                  _dlssOutputBuffer.colorFormat, VK_IMAGE_TILING_OPTIMAL,
@@ -1675,9 +2092,30 @@ void VulkanRenderer::createColorBufferImage() {
         Utils::VulkanCreateImageView(_core.getDevice(), _dlssOutputBuffer.colorBufferImage[i], _dlssOutputBuffer.colorFormat,
                                      VK_IMAGE_ASPECT_COLOR_BIT, _dlssOutputBuffer.colorBufferImageView[i]);
 
-        Utils::VulkanTransitionImageLayout(_core.getDevice(), _queue, _cmdBufPool, _dlssOutputBuffer.colorBufferImage[i],
-                                           _dlssOutputBuffer.colorFormat, VK_IMAGE_LAYOUT_UNDEFINED,
-                                           VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_ASPECT_COLOR_BIT, 1U, 1U);
+        Utils::VulkanTransitionImageLayout(_dlssOutputBuffer.colorBufferImage[i], _dlssOutputBuffer.colorFormat,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_ASPECT_COLOR_BIT, 1U, 1U);
+    }
+
+    RenderGraph frameGraph;
+    addFramePasses(frameGraph, nullptr);
+    m_transientAttachments.allocate(frameGraph);
+
+    for (size_t i = 0; i < static_cast<size_t>(_swapchainImageCount); ++i) {
+        const std::array<ColorBuffer*, 7u> buffers{&_gPassBuffer.normal, &_gPassBuffer.color, &_bloomBuffer[0], &_bloomBuffer[1],
+                                                   &_ssaoBuffer,         &_viewSpaceBuffer,   &_shadingBuffer};
+        for (size_t bufIndex = 0u; bufIndex < buffers.size(); ++bufIndex) {
+            auto& buf = *buffers[bufIndex];
+            buf.colorBufferImage[i] = m_transientAttachments.getImage(transientHandles[i][bufIndex]);
+            // owned by the allocator, possibly shared with other attachments
+            buf.colorBufferImageMemory[i] = m_transientAttachments.getMemory(transientHandles[i][bufIndex]);
+            Utils::VulkanCreateImageView(_core.getDevice(), buf.colorBufferImage[i], buf.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT,
+                                         buf.colorBufferImageView[i]);
+        }
+
+        // sampled by the gauss blur descriptor sets, the render pass discards it each frame anyway
+        Utils::VulkanTransitionImageLayout(_bloomBuffer[1].colorBufferImage[i], _bloomBuffer[1].colorFormat,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                           VK_IMAGE_ASPECT_COLOR_BIT, 1U, 1U);
     }
 }
 
@@ -1727,6 +2165,7 @@ void VulkanRenderer::loadModels() {
 }
 
 bool VulkanRenderer::renderScene() {
+    PROFILE_FUNCTION();
     bool ret_status = true;
 
     const auto& winController = _core.getWinController();
@@ -1740,6 +2179,9 @@ bool VulkanRenderer::renderScene() {
 
     auto windowQueueMSG = winController->processWindowQueueMSGs();  /// falls into NRVO
     ret_status = !windowQueueMSG.isQuited;
+    if (windowQueueMSG.replayedDeltaTimeMS >= 0.0f) {
+        deltaTime = windowQueueMSG.replayedDeltaTimeMS;
+    }
 
     if (windowQueueMSG.isResized && windowQueueMSG.width > 0 && windowQueueMSG.height > 0) {
         recreateSwapChain(windowQueueMSG.width, windowQueueMSG.height);
@@ -1756,6 +2198,39 @@ bool VulkanRenderer::renderScene() {
         return ret_status;
     }
 
+    if (windowQueueMSG.hmiStates && windowQueueMSG.hmiStates->qualityChanged) {
+        auto* hmiStates = const_cast<UI::States*>(windowQueueMSG.hmiStates);
+        hmiStates->qualityChanged = false;
+        setQualityLevel(hmiStates->qualityIndex, hmiStates->qualityLevel);
+    }
+
+    if (windowQueueMSG.hmiStates) {
+        auto* hmiStates = const_cast<UI::States*>(windowQueueMSG.hmiStates);
+        m_isBloomEnabled = hmiStates->bloomEnabled.second;
+        m_gpuProfiler.setPipelineStatisticsEnabled(hmiStates->pipelineStatisticsEnabled.second);
+        if (hmiStates->renderGraphDumpRequested) {
+            hmiStates->renderGraphDumpRequested = false;
+            m_isRenderGraphDumpRequested = true;
+        }
+        if (hmiStates->gpuTimingsExportRequested) {
+            hmiStates->gpuTimingsExportRequested = false;
+            m_isGpuTimingsExportRequested = true;
+        }
+        if (hmiStates->telemetryExportRequested) {
+            hmiStates->telemetryExportRequested = false;
+            FrameTelemetry::getInstance().exportCsv(std::string{Constants::TELEMETRY_FILE});
+        }
+        if (hmiStates->cpuTraceCaptureRequested) {
+            hmiStates->cpuTraceCaptureRequested = false;
+            CpuProfiler::getInstance().requestCapture(1u, std::string{Constants::CPU_TRACE_FILE});
+        }
+    }
+
+    // the frames returned above don't advance the simulation, their time goes into a later time step
+    if (mp_inputRecording) {
+        mp_inputRecording->addFrame(windowQueueMSG, deltaTime);
+    }
+
     // USER INPUT handling
     if (windowQueueMSG.buttonFlag & IControl::WindowQueueMSG::UP) {
         _footPrintRedrawingK = 0.7f;
@@ -1779,6 +2254,7 @@ bool VulkanRenderer::renderScene() {
     _pushConstant.windDirElapsedTimeMS.w += deltaTime;
 
     if (m_btTankBody) {
+        FrameTelemetry::PhaseScope physicsPhase(FrameTelemetry::PHASE_PHYSICS);
         static glm::vec3 prevTankPos = mCamera.targetPos();
         static glm::quat prevTankRot = glm::quat_cast(glm::mat3(mCamera.targetModelMat()));
 
@@ -1828,6 +2304,7 @@ bool VulkanRenderer::renderScene() {
     }
 
     if (m_btDynamicsWorld && deltaTime > 0.0f) {
+        FrameTelemetry::PhaseScope physicsPhase(FrameTelemetry::PHASE_PHYSICS);
         // --- Animate tree falls (kinematic bodies, no physics simulation needed) ---
         const glm::vec3 tankPos = mCamera.targetPos();
         const float tankRadius  = m_models[0]->radius() / 2.0f;
@@ -1875,6 +2352,7 @@ bool VulkanRenderer::renderScene() {
         }
 
         const float deltaSec = deltaTime * 0.001f;
+        PROFILE_SCOPE("stepSimulation");
         m_btDynamicsWorld->stepSimulation(deltaSec, 10, 1.0f / 60.0f);
     }
 
@@ -1884,26 +2362,31 @@ bool VulkanRenderer::renderScene() {
     // NOTE: DO NOT reset fence here. We'll reset it immediately before vkQueueSubmit.
 
     uint32_t ImageIndex = 0;
-    VkResult res;
-#if defined(USE_FSR) && USE_FSR
-    if (mFSRSwapChainContext) {
-        res = mFSRReplacementFunctions.pOutAcquireNextImageKHR(_core.getDevice(), _swapChain.handle, UINT64_MAX,
-                                                               m_presentCompleteSem[m_currentFrame], VK_NULL_HANDLE, &ImageIndex);
+    VkResult res = VK_SUCCESS;
+    if (_core.isHeadless()) {
+        // the offscreen images are used in turn, the fence above guards the image of the frame
+        ImageIndex = m_currentFrame;
     } else {
+#if defined(USE_FSR) && USE_FSR
+        if (mFSRSwapChainContext) {
+            res = mFSRReplacementFunctions.pOutAcquireNextImageKHR(_core.getDevice(), _swapChain.handle, UINT64_MAX,
+                                                                   m_presentCompleteSem[m_currentFrame], VK_NULL_HANDLE, &ImageIndex);
+        } else {
+            res = vkAcquireNextImageKHR(_core.getDevice(), _swapChain.handle, UINT64_MAX, m_presentCompleteSem[m_currentFrame],
+                                        VK_NULL_HANDLE, &ImageIndex);
+        }
+#else
         res = vkAcquireNextImageKHR(_core.getDevice(), _swapChain.handle, UINT64_MAX, m_presentCompleteSem[m_currentFrame],
                                     VK_NULL_HANDLE, &ImageIndex);
-    }
-#else
-    res = vkAcquireNextImageKHR(_core.getDevice(), _swapChain.handle, UINT64_MAX, m_presentCompleteSem[m_currentFrame],
-                                VK_NULL_HANDLE, &ImageIndex);
 #endif
 
-    // If acquire returned VK_ERROR_OUT_OF_DATE_KHR, we will process the resize.
-    if (res == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreateSwapChain(_windowWidth, _windowHeight);
-        return ret_status;
+        // If acquire returned VK_ERROR_OUT_OF_DATE_KHR, we will process the resize.
+        if (res == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapChain(_windowWidth, _windowHeight);
+            return ret_status;
+        }
+        CHECK_VULKAN_ERROR("vkAcquireNextImageKHR error %d\n", res);
     }
-    CHECK_VULKAN_ERROR("vkAcquireNextImageKHR error %d\n", res);
 
     // --- ensure the acquired swapchain image is not still in use by a previous frame
     VkFence imageFence = m_imagesInFlight[ImageIndex];
@@ -1930,53 +2413,122 @@ bool VulkanRenderer::renderScene() {
     submitInfo.pSignalSemaphores = &m_renderCompleteSem[ImageIndex]; 
     submitInfo.signalSemaphoreCount = 1;
 
+    // nothing is acquired or presented in the headless mode
+    if (_core.isHeadless()) {
+        submitInfo.waitSemaphoreCount = 0;
+        submitInfo.signalSemaphoreCount = 0;
+    }
+
     updateUniformBuffer(ImageIndex, deltaTime);
     static bool isGPUCalculationFavorable = true;
     if (windowQueueMSG.hmiStates) {
         isGPUCalculationFavorable = windowQueueMSG.hmiStates->gpuAnimationEnabled.second;
     }
 
-    for (auto& model : m_models) {
-        model->update(deltaTime, 0, isGPUCalculationFavorable, ImageIndex, mViewProj.viewProj, Z_FAR, mCamera.cameraPosition());
+    {
+        PROFILE_SCOPE("updateModels");
+        FrameTelemetry::PhaseScope updatePhase(FrameTelemetry::PHASE_UPDATE);
+        for (auto& model : m_models) {
+            model->update(deltaTime, 0, isGPUCalculationFavorable, ImageIndex, mViewProj.viewProj, Z_FAR,
+                          mCamera.cameraPosition());
+        }
+
+        for (auto& model : m_semiTransparentModels) {
+            model->update(deltaTime, 0, isGPUCalculationFavorable, ImageIndex, mViewProj.viewProj, Z_FAR,
+                          mCamera.cameraPosition());
+        }
+
+        for (const auto& [model, telemetrySlot] : m_telemetryModels) {
+            FrameTelemetry::getInstance().addVisibleInstances(telemetrySlot, model->getVisibleInstancesCount(),
+                                                              model->getVisibleLowPolyInstancesCount());
+        }
     }
 
-    for (auto& model : m_semiTransparentModels) {
-        model->update(deltaTime, 0, isGPUCalculationFavorable, ImageIndex, mViewProj.viewProj, Z_FAR, mCamera.cameraPosition());
+    // texture streaming: mip levels wanted by the visible instances
+    {
+        FrameTelemetry::PhaseScope streamingPhase(FrameTelemetry::PHASE_STREAMING);
+        mTextureFactory->setViewportHeight(_offscreenHeight);
+        for (auto& model : m_models) {
+            model->requestTextureLevels(mViewProj.viewProj, mCamera.cameraPosition());
+        }
+        for (auto& model : m_semiTransparentModels) {
+            model->requestTextureLevels(mViewProj.viewProj, mCamera.cameraPosition());
+        }
+        for (auto& particle : m_particles) {
+            particle->requestTextureLevels(mViewProj.viewProj, mCamera.cameraPosition());
+        }
+
+        // textures decoded by now replace their placeholders with the same batch, the descriptor sets of ImageIndex get the
+        // views of the streamed images before they are recorded
+        mTextureFactory->update(ImageIndex);
+    }
+    {
+        const auto& streamingStats = mTextureFactory->getStreamingStats();
+        UI::Stats uiStats;
+        uiStats.textureResidentBytes = streamingStats.residentBytes;
+        uiStats.textureRequestedBytes = streamingStats.requestedBytes;
+        uiStats.textureBudgetBytes = streamingStats.budgetBytes;
+        uiStats.streamingTexturesCount = streamingStats.streamingCount;
+        fillQualityStats(uiStats);
+        uiStats.recordingTimeMs = static_cast<float>(m_recordingTimeMs);
+        uiStats.recordingThreadsCount = m_recordingBatchesCount;
+        uiStats.reusedPassesCount = m_commandBufferCache.getStats().reusedCount;
+        uiStats.recordedPassesCount = m_commandBufferCache.getStats().recordedCount;
+        m_commandBufferCache.resetStats();
+        fillGpuTimingStats(uiStats);
+        fillMemoryStats(uiStats);
+        _core.getWinController()->setUIStats(uiStats);
+    }
+
+    // variants compiled in background since the previous frame replace the pipelines before recording
+    for (auto& pipelineCreator : m_pipelineCreators) {
+        pipelineCreator->updateVariants();
+    }
+
+    {
+        FrameTelemetry::PhaseScope recordingPhase(FrameTelemetry::PHASE_RECORDING);
+        recordCommandBuffers(ImageIndex, windowQueueMSG.hmiRenderData);
     }
 
-    recordCommandBuffers(ImageIndex, windowQueueMSG.hmiRenderData);
+    // the pending uploads, the submit and the present, till the end of the frame
+    FrameTelemetry::PhaseScope submitPhase(FrameTelemetry::PHASE_SUBMIT);
+    // submit pending uploads (geometry, textures, layout transitions) ahead of the frame which consumes them
+    UploadManager::getInstance().flush();
 
     // RESET fence of the current frame just before submit
     vkResetFences(_core.getDevice(), 1, &m_drawFences[m_currentFrame]);
 
     res = vkQueueSubmit(_queue, 1, &submitInfo, m_drawFences[m_currentFrame]);
     CHECK_VULKAN_ERROR("vkQueueSubmit error %d\n", res);
-
-    // --- PREPARE PRESENT INFO ---
-    VkPresentInfoKHR presentInfo = {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = &_swapChain.handle;
-    presentInfo.pImageIndices = &ImageIndex;
+    FrameTelemetry::count(FrameTelemetry::QUEUE_SUBMITS);
+
+    if (!_core.isHeadless()) {
+        // --- PREPARE PRESENT INFO ---
+        VkPresentInfoKHR presentInfo = {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &_swapChain.handle;
+        presentInfo.pImageIndices = &ImageIndex;
     
-    // We pass the rendering semaphore associated with this particular Swapchainimage.
-    presentInfo.pWaitSemaphores = &m_renderCompleteSem[ImageIndex]; 
-    presentInfo.waitSemaphoreCount = 1;
+        // We pass the rendering semaphore associated with this particular Swapchainimage.
+        presentInfo.pWaitSemaphores = &m_renderCompleteSem[ImageIndex]; 
+        presentInfo.waitSemaphoreCount = 1;
 
 #if defined(USE_FSR) && USE_FSR
-    if (mFSRSwapChainContext) {
-        res = mFSRReplacementFunctions.pOutQueuePresentKHR(_queue, &presentInfo);
-    } else {
-        res = vkQueuePresentKHR(_queue, &presentInfo);
-    }
+        if (mFSRSwapChainContext) {
+            res = mFSRReplacementFunctions.pOutQueuePresentKHR(_queue, &presentInfo);
+        } else {
+            res = vkQueuePresentKHR(_queue, &presentInfo);
+        }
 #else
-    res = vkQueuePresentKHR(_queue, &presentInfo);
+        res = vkQueuePresentKHR(_queue, &presentInfo);
 #endif
 
-    if (res == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreateSwapChain(_windowWidth, _windowHeight);
-    } else {
-        CHECK_VULKAN_ERROR("vkQueuePresentKHR error %d\n", res);
+        if (res == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapChain(_windowWidth, _windowHeight);
+        } else {
+            CHECK_VULKAN_ERROR("vkQueuePresentKHR error %d\n", res);
+        }
     }
 
     // Advance frame index
@@ -1985,6 +2537,9 @@ bool VulkanRenderer::renderScene() {
     endTime = std::chrono::high_resolution_clock::now();
     deltaTime = std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count();
     startTime = endTime;
+    if (m_fixedTimeStepMs > 0.0f) {
+        deltaTime = m_fixedTimeStepMs;
+    }
 
     return ret_status;
 }
@@ -3150,6 +3705,9 @@ void VulkanRenderer::createSemaphores() {
     fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
+    m_presentCompleteSem.assign(_swapchainImageCount, VK_NULL_HANDLE);
+    m_renderCompleteSem.assign(_swapchainImageCount, VK_NULL_HANDLE);
+    m_drawFences.assign(_swapchainImageCount, VK_NULL_HANDLE);
     for (size_t i = 0; i < static_cast<size_t>(_swapchainImageCount); i++) {
         if (vkCreateSemaphore(_core.getDevice(), &semaphoreCreateInfo, nullptr, &m_presentCompleteSem[i]) != VK_SUCCESS ||
             vkCreateSemaphore(_core.getDevice(), &semaphoreCreateInfo, nullptr, &m_renderCompleteSem[i]) != VK_SUCCESS ||
@@ -3227,15 +3785,120 @@ void VulkanRenderer::createDescriptorPoolForImGui() {
 }
 
 void VulkanRenderer::createPipeline() {
-    // Reset shared blend-attachment state before any individual PipelineCreator runs. Without this,
-    // mutations made by pipelines created earlier in a PREVIOUS cycle (e.g. Particle/SemiTransparent
-    // restricting colorWriteMask on attachment index 1 for their own motion-vector output) would leak
-    // into this cycle and corrupt unrelated pipelines reusing the same attachment index for a different
-    // purpose (e.g. GPass's normal buffer), causing e.g. a missing B channel after any recreateSwapChain().
-    Pipeliner::getInstance().resetColorBlendAttachments();
+    std::vector<PipelineCreatorBase*> pipelineCreators;
+    pipelineCreators.reserve(m_pipelineCreators.size());
+    for (auto& pipelineCreator : m_pipelineCreators) {
+        pipelineCreators.push_back(pipelineCreator.get());
+    }
+
+    PipelineCreatorBase::recreate(pipelineCreators);
+
+    // the other quality levels are ready by the time they are picked in the UI
+    for (auto* pipelineCreator : pipelineCreators) {
+        pipelineCreator->prewarmVariants();
+    }
+}
 
+void VulkanRenderer::setQualityLevel(uint32_t qualityIndex, uint32_t level) {
     for (auto& pipelineCreator : m_pipelineCreators) {
-        pipelineCreator->recreate();
+        const size_t parametersCount = pipelineCreator->getQualityParameters().size();
+        if (qualityIndex < parametersCount) {
+            pipelineCreator->setQualityLevel(qualityIndex, level);
+            return;
+        }
+        qualityIndex -= static_cast<uint32_t>(parametersCount);
+    }
+}
+
+void VulkanRenderer::fillGpuTimingStats(UI::Stats& uiStats) const {
+    uiStats.is_gpuTimingSupported = m_gpuProfiler.isSupported();
+    uiStats.is_pipelineStatisticsSupported = m_gpuProfiler.isPipelineStatisticsSupported();
+    // the overdraw is given per pixel of the offscreen image whatever the render area of the pass
+    const uint64_t pixelsCount = static_cast<uint64_t>(_offscreenWidth) * _offscreenHeight;
+    uiStats.gpuScopesCount = 0u;
+    for (const auto& scope : m_gpuProfiler.getScopeStats()) {
+        if (uiStats.gpuScopesCount == UI::MAX_GPU_SCOPES) {
+            break;
+        }
+        // the names live as long as the profiler
+        auto& uiScope = uiStats.gpuScopes[uiStats.gpuScopesCount++];
+        uiScope.name = scope.name.c_str();
+        uiScope.level = scope.level;
+        uiScope.lastMs = scope.lastMs;
+        uiScope.averageMs = scope.averageMs;
+        uiScope.maxMs = scope.maxMs;
+        uiScope.has_statistics = scope.has_statistics;
+        if (scope.has_statistics) {
+            const auto& statistics = scope.statistics;
+            uiScope.inputVertices = statistics.inputVertices;
+            uiScope.inputPrimitives = statistics.inputPrimitives;
+            uiScope.vertexInvocations = statistics.vertexInvocations;
+            uiScope.tessControlPatches = statistics.tessControlPatches;
+            uiScope.tessEvaluationInvocations = statistics.tessEvaluationInvocations;
+            uiScope.clippingPrimitives = statistics.clippingPrimitives;
+            uiScope.fragmentInvocations = statistics.fragmentInvocations;
+            uiScope.overdraw = statistics.getOverdraw(pixelsCount);
+            uiScope.acmr = statistics.getACMR();
+            uiScope.vertexReuse = statistics.getVertexReuse();
+        }
+    }
+
+    // the frame scope is the first one, its history goes to the graph oldest first
+    uiStats.gpuFrameHistoryCount = 0u;
+    if (!m_gpuProfiler.getScopeStats().empty()) {
+        const auto& frameHistory = m_gpuProfiler.getScopeStats().front().history;
+        const uint32_t historySize = std::min(m_gpuProfiler.getHistorySize(), UI::GPU_HISTORY_SIZE);
+        const uint32_t historyStart = m_gpuProfiler.getHistoryStart() + m_gpuProfiler.getHistorySize() - historySize;
+        for (uint32_t i = 0u; i < historySize; ++i) {
+            const float value = frameHistory[(historyStart + i) % GpuProfiler::HISTORY_SIZE];
+            uiStats.gpuFrameHistoryMs[uiStats.gpuFrameHistoryCount++] = std::max(value, 0.0f);
+        }
+    }
+}
+
+void VulkanRenderer::fillMemoryStats(UI::Stats& uiStats) const {
+    // the categories without AUTO, the names are literals
+    constexpr uint32_t CATEGORIES_COUNT = static_cast<uint32_t>(MemoryAllocator::Category::MAX) - 1u;
+    uiStats.memoryCategoriesCount = std::min(CATEGORIES_COUNT, UI::MAX_MEMORY_CATEGORIES);
+    for (uint32_t i = 0u; i < uiStats.memoryCategoriesCount; ++i) {
+        uiStats.memoryCategoryNames[i] = MemoryAllocator::getCategoryName(static_cast<MemoryAllocator::Category>(i + 1u));
+    }
+
+    uiStats.memoryHeapsCount = 0u;
+    for (const auto& heap : MemoryAllocator::getInstance().getHeapStats()) {
+        if (uiStats.memoryHeapsCount == UI::MAX_MEMORY_HEAPS) {
+            break;
+        }
+        auto& uiHeap = uiStats.memoryHeaps[uiStats.memoryHeapsCount++];
+        uiHeap.is_deviceLocal = heap.is_deviceLocal;
+        uiHeap.liveBytes = heap.liveBytes;
+        uiHeap.peakBytes = heap.peakBytes;
+        uiHeap.budgetBytes = heap.budgetBytes;
+        uiHeap.usageBytes = heap.usageBytes;
+        uiHeap.is_overBudget = static_cast<double>(heap.usageBytes) >
+                               MemoryAllocator::BUDGET_WARNING_RATIO * static_cast<double>(heap.budgetBytes);
+        for (uint32_t i = 0u; i < uiStats.memoryCategoriesCount; ++i) {
+            uiHeap.categoryLiveBytes[i] = heap.categories[i + 1u].liveBytes;
+            uiHeap.categoryPeakBytes[i] = heap.categories[i + 1u].peakBytes;
+        }
+    }
+}
+
+void VulkanRenderer::fillQualityStats(UI::Stats& uiStats) const {
+    uiStats.qualityParametersCount = 0u;
+    for (const auto& pipelineCreator : m_pipelineCreators) {
+        for (const auto& parameter : pipelineCreator->getQualityParameters()) {
+            if (uiStats.qualityParametersCount == UI::MAX_QUALITY_PARAMETERS) {
+                return;
+            }
+            // the names are literals of the declarations
+            auto& uiParameter = uiStats.qualityParameters[uiStats.qualityParametersCount++];
+            uiParameter.name = parameter.name.data();
+            uiParameter.level = parameter.level;
+            uiParameter.levelsCount = static_cast<uint32_t>(parameter.levels.size());
+            uiParameter.value = parameter.levels[parameter.level];
+            uiParameter.is_compiling = pipelineCreator->isVariantPending();
+        }
     }
 }
 
@@ -3263,7 +3926,8 @@ void VulkanRenderer::createDepthResources() {
         _core.getDevice(), _core.getPhysDevice(), _shadowMapBuffer.width, _shadowMapBuffer.height, _shadowMapBuffer.depthFormat,
         VK_IMAGE_TILING_OPTIMAL,
         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _shadowMapBuffer.depthImage, _shadowMapBuffer.depthImageMemory);
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _shadowMapBuffer.depthImage, _shadowMapBuffer.depthImageMemory, 1U, 1U,
+        MemoryAllocator::Usage::DEDICATED);
     Utils::VulkanCreateImageView(_core.getDevice(), _shadowMapBuffer.depthImage, _shadowMapBuffer.depthFormat,
                                  VK_IMAGE_ASPECT_DEPTH_BIT, _shadowMapBuffer.depthImageView);
 
@@ -3275,10 +3939,15 @@ void VulkanRenderer::createDepthResources() {
     Utils::VulkanCreateImageView(_core.getDevice(), _depthBuffer.depthImage, _depthBuffer.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
                                  _depthBuffer.depthImageView);
 
-    Utils::VulkanCreateImage(_core.getDevice(), _core.getPhysDevice(), _depthTempBuffer.width, _depthTempBuffer.height,
-                             _depthTempBuffer.depthFormat, VK_IMAGE_TILING_OPTIMAL,
-                             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
-                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _depthTempBuffer.depthImage, _depthTempBuffer.depthImageMemory);
+    // used by the G-pass only and shared by the swapchain images, it has a group of its own
+    const auto depthTempHandle = m_transientAttachments.addAttachment(TransientAttachmentAllocator::AttachmentInfo{
+        "depth temp", _depthTempBuffer.width, _depthTempBuffer.height, _depthTempBuffer.depthFormat,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, UINT32_MAX});
+    RenderGraph frameGraph;
+    addFramePasses(frameGraph, nullptr);
+    m_transientAttachments.allocate(frameGraph);
+    _depthTempBuffer.depthImage = m_transientAttachments.getImage(depthTempHandle);
+    _depthTempBuffer.depthImageMemory = m_transientAttachments.getMemory(depthTempHandle);
     Utils::VulkanCreateImageView(_core.getDevice(), _depthTempBuffer.depthImage, _depthTempBuffer.depthFormat,
                                  VK_IMAGE_ASPECT_DEPTH_BIT, _depthTempBuffer.depthImageView);
 
@@ -3286,11 +3955,11 @@ void VulkanRenderer::createDepthResources() {
                              _footprintBuffer.depthFormat, VK_IMAGE_TILING_OPTIMAL,
                              VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
                                  VK_IMAGE_USAGE_SAMPLED_BIT,
-                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _footprintBuffer.depthImage, _footprintBuffer.depthImageMemory);
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _footprintBuffer.depthImage, _footprintBuffer.depthImageMemory,
+                             1U, 1U, MemoryAllocator::Usage::DEDICATED);
 
     // Keep the footprint depth image in its steady sampled/read-only state between passes.
-    Utils::VulkanTransitionImageLayout(_core.getDevice(), _queue, _cmdBufPool, _footprintBuffer.depthImage,
-                                       _footprintBuffer.depthFormat, VK_IMAGE_LAYOUT_UNDEFINED,
+    Utils::VulkanTransitionImageLayout(_footprintBuffer.depthImage, _footprintBuffer.depthFormat, VK_IMAGE_LAYOUT_UNDEFINED,
                                        VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_DEPTH_BIT, 1U, 1U);
 
     Utils::VulkanCreateImageView(_core.getDevice(), _footprintBuffer.depthImage, _footprintBuffer.depthFormat,
@@ -3456,6 +4125,7 @@ void VulkanRenderer::evaluateDLSSPass(uint32_t currentImage, const sl::FrameToke
 
 void VulkanRenderer::init() {
     _core.init();
+    m_transientAttachments.init(_core.getDevice(), _core.getPhysDevice());
     // Get properties of our new device
     vkGetPhysicalDeviceProperties(_core.getPhysDevice(), &mDeviceProperties);
 
@@ -3486,6 +4156,7 @@ void VulkanRenderer::init() {
 
     auto swapchainCreateInfo = createSwapChain();
     createCommandPool();
+    createRecordingThreads();
     createCommandBuffer();
     createDepthResources();
     createColorBufferImage();
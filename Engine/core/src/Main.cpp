@@ -1,10 +1,167 @@
+#include "Benchmark.h"
+#include "Constants.h"
+#include "CpuProfiler.h"
+#include "FrameTelemetry.h"
+#include "InputRecording.h"
+#include "Logger.h"
+#include "ShaderRegistry.h"
+#include "StressScene.h"
+#include "Utils.h"
 #include "VulkanRenderer.h"
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
 static constexpr std::string_view _appName{"Vulkan"};
 static constexpr int16_t WINDOW_WIDTH = 1920;
 static constexpr int16_t WINDOW_HEIGHT = 1080;
+static constexpr uint32_t BENCHMARK_FRAMES = 1000u;
+
+// renders framesCount frames of the scripted path offscreen at a fixed time step and writes the report
+// inputReplay: the recorded frames at their recorded time steps instead, in the recorded window size and scene
+static int runBenchmark(uint32_t framesCount, const std::string& reportPath, const StressScene& stressScene,
+                        InputRecording* inputRecording, const InputRecording* inputReplay = nullptr) {
+    const auto loadStartTime = std::chrono::steady_clock::now();
+    const uint16_t width = inputReplay ? static_cast<uint16_t>(inputReplay->getWidth()) : WINDOW_WIDTH;
+    const uint16_t height = inputReplay ? static_cast<uint16_t>(inputReplay->getHeight()) : WINDOW_HEIGHT;
+    VulkanRenderer _vulkanRenderer(_appName, width, height, framesCount, stressScene, inputReplay);
+    if (!inputReplay) {
+        _vulkanRenderer.setFixedTimeStep(Benchmark::FIXED_TIME_STEP_MS);
+    }
+    _vulkanRenderer.setInputRecording(inputRecording);
+    _vulkanRenderer.init();
+    Benchmark benchmark(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStartTime).count());
+
+    bool bQuit = false;
+    while (!bQuit) {
+        const auto frameStartTime = std::chrono::steady_clock::now();
+        PROFILE_BEGIN_FRAME();
+        FrameTelemetry::getInstance().beginFrame();
+        bQuit = !_vulkanRenderer.renderScene();
+        FrameTelemetry::getInstance().endFrame();
+        PROFILE_END_FRAME();
+        benchmark.addFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStartTime).count(),
+                           _vulkanRenderer.getGpuProfiler());
+    }
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(_vulkanRenderer._core.getPhysDevice(), &properties);
+    return benchmark.writeReport(reportPath, _vulkanRenderer.getGpuProfiler(), properties.deviceName, stressScene) ? 0 : 1;
+}
+
+// writes the input recording if recordingPath is given, a failed write turns the exit code into an error
+static int finishInputRecording(int exitCode, const InputRecording& inputRecording, const std::string& recordingPath) {
+    if (!recordingPath.empty() && !inputRecording.save(recordingPath)) {
+        return 1;
+    }
+    return exitCode;
+}
+
+// writes the telemetry history if telemetryPath is given, a failed threshold turns the exit code into an error
+static int finishTelemetry(int exitCode, const std::string& telemetryPath) {
+    const auto& telemetry = FrameTelemetry::getInstance();
+    if (!telemetryPath.empty()) {
+        telemetry.exportCsv(telemetryPath);
+    }
+    if (telemetry.hasThresholds() && !telemetry.checkThresholds()) {
+        return 1;
+    }
+    return exitCode;
+}
 
 int main(int argc, char** argv) {
+    // packs the compiled shaders into one archive for shipping, see ShaderRegistry
+    if (argc > 1 && strcmp(argv[1], "--pack-shaders") == 0) {
+        const std::string archivePath = Utils::formPath(Constants::SHADERS_DIR, Constants::SHADERS_ARCHIVE);
+        return ShaderRegistry::packArchive(Constants::SHADERS_DIR, archivePath) ? 0 : 1;
+    }
+
+    PROFILE_THREAD_NAME("main");
+    // --cpu-trace [frame]: the CPU scopes of the given frame (after the loading hitches by default) go to a Chrome trace
+    // --benchmark [frames] [report]: headless run of the scripted path, see Benchmark
+    // --stress <config file | key=value>: object counts of the scene, see StressScene (repeatable, the last value wins)
+    // --telemetry [csv]: the frame telemetry history is written at exit, see FrameTelemetry
+    // --telemetry-threshold "<statistic> <column> <op> <value>": checked at exit, fails the run (repeatable)
+    // --record [file]: the input of every frame is written at exit, see InputRecording
+    // --replay [file] [report]: headless run of a recording at its time steps, written as a benchmark report
+    // --log-level <debug|info|warning|critical|off>: the messages below it are skipped, see Logger
+    // --log-file [file]: the log goes to the rotated file too
+    uint32_t benchmarkFrames = 0u;
+    std::string benchmarkReportPath{Constants::BENCHMARK_REPORT_FILE};
+    StressScene stressScene;
+    std::string telemetryPath;
+    std::string recordingPath;
+    std::string replayPath;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--cpu-trace") == 0) {
+            const uint32_t skippedFrames = i + 1 < argc ? static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10)) : 100u;
+            CpuProfiler::getInstance().requestCapture(1u, std::string{Constants::CPU_TRACE_FILE}, skippedFrames);
+        } else if (strcmp(argv[i], "--benchmark") == 0) {
+            benchmarkFrames = BENCHMARK_FRAMES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                benchmarkFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+                if (i + 1 < argc && argv[i + 1][0] != '-') {
+                    benchmarkReportPath = argv[++i];
+                }
+            }
+        } else if (strcmp(argv[i], "--stress") == 0 && i + 1 < argc) {
+            const std::string_view stressArg{argv[++i]};
+            const bool is_stressSceneValid = stressArg.find('=') != std::string_view::npos
+                                                 ? stressScene.parse(stressArg)
+                                                 : stressScene.loadFile(std::string{stressArg});
+            if (!is_stressSceneValid) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--telemetry") == 0) {
+            telemetryPath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : std::string{Constants::TELEMETRY_FILE};
+        } else if (strcmp(argv[i], "--telemetry-threshold") == 0 && i + 1 < argc) {
+            if (!FrameTelemetry::getInstance().addThreshold(argv[++i])) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            Logger::Level logLevel = Logger::Level::INFO;
+            if (!Logger::parseLevel(argv[++i], logLevel)) {
+                Utils::printLog(INFO_PARAM, "unknown log level '", argv[i], "'");
+                return 1;
+            }
+            Logger::setLevel(logLevel);
+        } else if (strcmp(argv[i], "--log-file") == 0) {
+            const std::string logPath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : std::string{Constants::LOG_FILE};
+            if (!Logger::getInstance().setFile(logPath)) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--record") == 0) {
+            recordingPath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : std::string{Constants::INPUT_RECORDING_FILE};
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            replayPath = std::string{Constants::INPUT_RECORDING_FILE};
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                replayPath = argv[++i];
+                if (i + 1 < argc && argv[i + 1][0] != '-') {
+                    benchmarkReportPath = argv[++i];
+                }
+            }
+        }
+    }
+    if (!replayPath.empty()) {
+        InputRecording inputReplay;
+        // a recording which can't be loaded fails the run, a run of the live input would pass as a replay
+        if (!inputReplay.load(replayPath)) {
+            return 1;
+        }
+        // the replay is recorded again on request, the two files compare the input the runs got
+        InputRecording inputRecording(inputReplay.getWidth(), inputReplay.getHeight(), inputReplay.getStressScene());
+        const int exitCode = runBenchmark(0u, benchmarkReportPath, inputReplay.getStressScene(),
+                                          recordingPath.empty() ? nullptr : &inputRecording, &inputReplay);
+        return finishTelemetry(finishInputRecording(exitCode, inputRecording, recordingPath), telemetryPath);
+    }
+    if (benchmarkFrames != 0u) {
+        InputRecording inputRecording(WINDOW_WIDTH, WINDOW_HEIGHT, stressScene);
+        const int exitCode = runBenchmark(benchmarkFrames, benchmarkReportPath, stressScene,
+                                          recordingPath.empty() ? nullptr : &inputRecording);
+        return finishTelemetry(finishInputRecording(exitCode, inputRecording, recordingPath), telemetryPath);
+    }
+
     int16_t width = WINDOW_WIDTH;
     int16_t height = WINDOW_HEIGHT;
 #ifdef _WIN32
@@ -18,15 +175,21 @@ int main(int argc, char** argv) {
     height = monitorInfo.rcMonitor.bottom - monitorInfo.rcMonitor.top;
 #endif
 
-    VulkanRenderer _vulkanRenderer(_appName, width, height);
+    InputRecording inputRecording(width, height, stressScene);
+    VulkanRenderer _vulkanRenderer(_appName, width, height, 0u, stressScene);
+    _vulkanRenderer.setInputRecording(recordingPath.empty() ? nullptr : &inputRecording);
     _vulkanRenderer.init();
 
     /* program main loop */
 
     bool bQuit = false;
     while (!bQuit) {
+        PROFILE_BEGIN_FRAME();
+        FrameTelemetry::getInstance().beginFrame();
         bQuit = !_vulkanRenderer.renderScene();
+        FrameTelemetry::getInstance().endFrame();
+        PROFILE_END_FRAME();
     }
 
-    return 0;
+    return finishTelemetry(finishInputRecording(0, inputRecording, recordingPath), telemetryPath);
 }
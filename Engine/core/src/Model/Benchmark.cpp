@@ -0,0 +1,151 @@
+#include "Benchmark.h"
+
+#include "GpuProfiler.h"
+#include "MemoryAllocator.h"
+#include "StressScene.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#elif __linux__
+#include <sys/resource.h>
+#endif
+
+namespace {
+constexpr double BYTES_IN_MIB = 1024.0 * 1024.0;
+
+uint64_t getPeakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+    }
+#elif __linux__
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;  // KiB
+    }
+#endif
+    return 0u;
+}
+
+void writeEscaped(std::ofstream& file, const std::string& text) {
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            file << '\\';
+        }
+        file << c;
+    }
+}
+}  // namespace
+
+void Benchmark::addFrame(double cpuFrameMs, const GpuProfiler& gpuProfiler) {
+    if (++m_framesCount > WARMUP_FRAMES) {
+        m_cpuFramesMs.push_back(cpuFrameMs);
+    }
+
+    // the frame scope comes first, a frame without it (dropped results) isn't counted
+    const uint32_t resolvedCount = gpuProfiler.getResolvedCount();
+    if (resolvedCount != m_gpuResolvedCount) {
+        m_gpuResolvedCount = resolvedCount;
+        const auto& scopeStats = gpuProfiler.getScopeStats();
+        if (resolvedCount > WARMUP_FRAMES && !scopeStats.empty() && scopeStats[0].lastMs != GpuProfiler::NOT_RECORDED) {
+            m_gpuFramesMs.push_back(scopeStats[0].lastMs);
+        }
+    }
+}
+
+Benchmark::Summary Benchmark::summarize(std::vector<double> framesMs) {
+    Summary summary{};
+    if (framesMs.empty()) {
+        return summary;
+    }
+
+    std::sort(framesMs.begin(), framesMs.end());
+    // nearest rank percentile
+    const auto percentile = [&framesMs](double p) {
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(framesMs.size())));
+        return framesMs[std::clamp<std::size_t>(rank, 1u, framesMs.size()) - 1u];
+    };
+    summary.meanMs = std::accumulate(framesMs.begin(), framesMs.end(), 0.0) / static_cast<double>(framesMs.size());
+    summary.p50Ms = percentile(0.50);
+    summary.p95Ms = percentile(0.95);
+    summary.p99Ms = percentile(0.99);
+    summary.maxMs = framesMs.back();
+    return summary;
+}
+
+bool Benchmark::writeReport(const std::string& filePath, const GpuProfiler& gpuProfiler, const std::string& deviceName,
+                            const StressScene& stressScene) const {
+    std::ofstream file(filePath);
+    if (!file) {
+        Utils::printLog(INFO_PARAM, "failed to write benchmark report to ", filePath);
+        return false;
+    }
+
+    const auto writeSummary = [&file](const char* name, const std::vector<double>& framesMs) {
+        const Summary summary = summarize(framesMs);
+        file << "  \"" << name << "\": {\"frames\": " << framesMs.size() << ", \"mean\": " << summary.meanMs
+             << ", \"p50\": " << summary.p50Ms << ", \"p95\": " << summary.p95Ms << ", \"p99\": " << summary.p99Ms
+             << ", \"max\": " << summary.maxMs << "},\n";
+    };
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\n  \"device\": \"";
+    writeEscaped(file, deviceName);
+    file << "\",\n";
+    file << "  \"frames\": " << m_framesCount << ",\n";
+    file << "  \"warmupFrames\": " << WARMUP_FRAMES << ",\n";
+    file << "  \"fixedTimeStepMs\": " << FIXED_TIME_STEP_MS << ",\n";
+    file << "  \"loadTimeMs\": " << m_loadTimeMs << ",\n";
+    file << "  \"pipelineStatistics\": " << (gpuProfiler.isPipelineStatisticsSupported() ? "true" : "false") << ",\n";
+    file << "  \"scene\": {\"trees\": " << stressScene.treesCount << ", \"crowns\": " << stressScene.crownsCount
+         << ", \"largeBushes\": " << stressScene.largeBushesCount << ", \"smallBushes\": " << stressScene.smallBushesCount
+         << ", \"mediumBushes\": " << stressScene.mediumBushesCount << ", \"smokeEmitters\": " << stressScene.smokeEmittersCount
+         << ", \"smokeParticles\": " << stressScene.smokeParticlesCount
+         << ", \"physicsBodies\": " << stressScene.physicsBodiesCount << ", \"seed\": " << stressScene.seed << "},\n";
+    writeSummary("cpuFrameMs", m_cpuFramesMs);
+    writeSummary("gpuFrameMs", m_gpuFramesMs);
+    file << "  \"peakResidentMemoryMiB\": " << static_cast<double>(getPeakResidentBytes()) / BYTES_IN_MIB << ",\n";
+    file << "  \"peakDeviceMemoryMiB\": "
+         << static_cast<double>(MemoryAllocator::getInstance().getTotalStats().peakBytes) / BYTES_IN_MIB << ",\n";
+
+    file << "  \"passes\": [";
+    bool is_first = true;
+    for (const auto& stats : gpuProfiler.getScopeStats()) {
+        file << (is_first ? "\n" : ",\n") << "    {\"path\": \"";
+        writeEscaped(file, stats.path);
+        file << "\", \"averageMs\": " << stats.averageMs << ", \"maxMs\": " << stats.maxMs;
+        if (stats.has_statistics) {
+            const auto& statistics = stats.statistics;
+            file << ", \"inputPrimitives\": " << statistics.inputPrimitives
+                 << ", \"vertexInvocations\": " << statistics.vertexInvocations
+                 << ", \"fragmentInvocations\": " << statistics.fragmentInvocations << ", \"acmr\": " << statistics.getACMR();
+        }
+        file << "}";
+        is_first = false;
+    }
+    file << "\n  ]\n}\n";
+
+    // the statistics are queried for the children of the frame scope
+    const auto& scopeStats = gpuProfiler.getScopeStats();
+    const bool has_passStatistics = std::any_of(scopeStats.begin(), scopeStats.end(), [](const auto& stats) {
+        return stats.level == 1u && stats.has_statistics;
+    });
+    if (gpuProfiler.isPipelineStatisticsSupported() && !has_passStatistics) {
+        Utils::printLog(WARNING_PARAM, "benchmark report ", filePath, " has no pipeline statistics of the passes");
+        return false;
+    }
+
+    const Summary cpu = summarize(m_cpuFramesMs);
+    Utils::printLog(INFO_PARAM, "benchmark of ", m_framesCount, " frames: CPU mean ", cpu.meanMs, " ms, p99 ", cpu.p99Ms,
+                    " ms, report written to ", filePath);
+    return true;
+}
@@ -0,0 +1,319 @@
+#include "BlockCompressor.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace {
+constexpr uint32_t BLOCK_TEXELS = BlockCompressor::BLOCK_EXTENT * BlockCompressor::BLOCK_EXTENT;
+
+using Color = std::array<float, 4>;
+
+/// endpoints on the principal axis of the block texels (power iteration on the covariance matrix) which cover
+/// all the texels projections, only the first channelsCount channels are taken into account
+void findEndpoints(const uint8_t* block, uint32_t channelsCount, Color& outMin, Color& outMax) {
+    Color mean{};
+    for (uint32_t i = 0u; i < BLOCK_TEXELS; ++i) {
+        for (uint32_t c = 0u; c < channelsCount; ++c) {
+            mean[c] += block[i * 4u + c];
+        }
+    }
+    for (uint32_t c = 0u; c < channelsCount; ++c) {
+        mean[c] /= static_cast<float>(BLOCK_TEXELS);
+    }
+
+    float covariance[4][4]{};
+    for (uint32_t i = 0u; i < BLOCK_TEXELS; ++i) {
+        for (uint32_t a = 0u; a < channelsCount; ++a) {
+            for (uint32_t b = 0u; b < channelsCount; ++b) {
+                covariance[a][b] += (block[i * 4u + a] - mean[a]) * (block[i * 4u + b] - mean[b]);
+            }
+        }
+    }
+
+    Color axis{1.0f, 1.0f, 1.0f, 1.0f};
+    for (uint32_t iteration = 0u; iteration < 8u; ++iteration) {
+        Color next{};
+        float maxComponent = 0.0f;
+        for (uint32_t a = 0u; a < channelsCount; ++a) {
+            for (uint32_t b = 0u; b < channelsCount; ++b) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            maxComponent = std::max(maxComponent, std::abs(next[a]));
+        }
+        if (maxComponent < std::numeric_limits<float>::epsilon()) {
+            break;  // flat block, any axis works
+        }
+        for (uint32_t c = 0u; c < channelsCount; ++c) {
+            axis[c] = next[c] / maxComponent;
+        }
+    }
+
+    float length = 0.0f;
+    for (uint32_t c = 0u; c < channelsCount; ++c) {
+        length += axis[c] * axis[c];
+    }
+    length = std::sqrt(length);
+    for (uint32_t c = 0u; c < channelsCount; ++c) {
+        axis[c] /= length;
+    }
+
+    float minProjection = std::numeric_limits<float>::max();
+    float maxProjection = std::numeric_limits<float>::lowest();
+    for (uint32_t i = 0u; i < BLOCK_TEXELS; ++i) {
+        float projection = 0.0f;
+        for (uint32_t c = 0u; c < channelsCount; ++c) {
+            projection += (block[i * 4u + c] - mean[c]) * axis[c];
+        }
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    // slight inset reduces the error of the interpolated palette entries
+    const float inset = (maxProjection - minProjection) / 32.0f;
+    minProjection += inset;
+    maxProjection -= inset;
+
+    outMin = Color{0.0f, 0.0f, 0.0f, 255.0f};
+    outMax = Color{0.0f, 0.0f, 0.0f, 255.0f};
+    for (uint32_t c = 0u; c < channelsCount; ++c) {
+        outMin[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+        outMax[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+    }
+}
+
+template <uint32_t PALETTE_SIZE>
+uint32_t findClosest(const uint8_t* texel, const int (&palette)[PALETTE_SIZE][4], uint32_t channelsCount) {
+    uint32_t bestIndex = 0u;
+    int bestError = std::numeric_limits<int>::max();
+    for (uint32_t i = 0u; i < PALETTE_SIZE; ++i) {
+        int error = 0;
+        for (uint32_t c = 0u; c < channelsCount; ++c) {
+            const int diff = texel[c] - palette[i][c];
+            error += diff * diff;
+        }
+        if (error < bestError) {
+            bestError = error;
+            bestIndex = i;
+        }
+    }
+
+    return bestIndex;
+}
+
+uint16_t packRGB565(const Color& color) {
+    const uint32_t r = static_cast<uint32_t>(std::lround(color[0] * 31.0f / 255.0f));
+    const uint32_t g = static_cast<uint32_t>(std::lround(color[1] * 63.0f / 255.0f));
+    const uint32_t b = static_cast<uint32_t>(std::lround(color[2] * 31.0f / 255.0f));
+    return static_cast<uint16_t>((r << 11u) | (g << 5u) | b);
+}
+
+void unpackRGB565(uint16_t packed, int (&outColor)[4]) {
+    const int r = (packed >> 11u) & 31;
+    const int g = (packed >> 5u) & 63;
+    const int b = packed & 31;
+    outColor[0] = (r << 3) | (r >> 2);
+    outColor[1] = (g << 2) | (g >> 4);
+    outColor[2] = (b << 3) | (b >> 2);
+    outColor[3] = 255;
+}
+
+void compressBC1(const uint8_t* block, uint8_t* out) {
+    Color minColor, maxColor;
+    findEndpoints(block, 3u, minColor, maxColor);
+
+    uint16_t color0 = packRGB565(maxColor);
+    uint16_t color1 = packRGB565(minColor);
+    /// Note: color0 > color1 selects the four colors mode, equal colors keep all indices at 0
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    uint32_t indices = 0u;
+    if (color0 != color1) {
+        int palette[4][4];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (uint32_t c = 0u; c < 3u; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+
+        for (uint32_t i = 0u; i < BLOCK_TEXELS; ++i) {
+            indices |= findClosest(block + i * 4u, palette, 3u) << (2u * i);
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(color0 & 0xFFu);
+    out[1] = static_cast<uint8_t>(color0 >> 8u);
+    out[2] = static_cast<uint8_t>(color1 & 0xFFu);
+    out[3] = static_cast<uint8_t>(color1 >> 8u);
+    for (uint32_t i = 0u; i < 4u; ++i) {
+        out[4u + i] = static_cast<uint8_t>((indices >> (8u * i)) & 0xFFu);
+    }
+}
+
+/// single channel block: two 8 bit endpoints + 3 bit indices of the eight values palette
+void compressBC4(const uint8_t* block, uint32_t channel, uint8_t* out) {
+    int minValue = 255;
+    int maxValue = 0;
+    for (uint32_t i = 0u; i < BLOCK_TEXELS; ++i) {
+        minValue = std::min<int>(minValue, block[i * 4u + channel]);
+        maxValue = std::max<int>(maxValue, block[i * 4u + channel]);
+    }
+
+    uint64_t indices = 0u;
+    if (maxValue != minValue) {
+        // value0 > value1 selects the eight values mode
+        int palette[8][4]{};
+        palette[0][0] = maxValue;
+        palette[1][0] = minValue;
+        for (int k = 2; k < 8; ++k) {
+            palette[k][0] = ((8 - k) * maxValue + (k - 1) * minValue + 3) / 7;
+        }
+
+        for (uint32_t i = 0u; i < BLOCK_TEXELS; ++i) {
+            const uint8_t value = block[i * 4u + channel];
+            indices |= static_cast<uint64_t>(findClosest(&value, palette, 1u)) << (3u * i);
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(maxValue);
+    out[1] = static_cast<uint8_t>(minValue);
+    for (uint32_t i = 0u; i < 6u; ++i) {
+        out[2u + i] = static_cast<uint8_t>((indices >> (8u * i)) & 0xFFu);
+    }
+}
+
+/// BC7 mode 6: one subset, RGBA endpoints of 7 bits + unique p-bit (the lowest bit), 4 bit indices
+void compressBC7(const uint8_t* block, uint8_t* out) {
+    static constexpr int WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    std::array<Color, 2> endpoints;
+    findEndpoints(block, 4u, endpoints[0], endpoints[1]);
+
+    uint32_t quantized[2][4];
+    uint32_t pBits[2];
+    int palette[16][4];
+    for (uint32_t e = 0u; e < 2u; ++e) {
+        float bestError = std::numeric_limits<float>::max();
+        for (uint32_t pBit = 0u; pBit < 2u; ++pBit) {
+            float error = 0.0f;
+            uint32_t candidate[4];
+            for (uint32_t c = 0u; c < 4u; ++c) {
+                candidate[c] = static_cast<uint32_t>(std::clamp<long>(std::lround((endpoints[e][c] - pBit) / 2.0f), 0, 127));
+                const float diff = static_cast<float>((candidate[c] << 1u) | pBit) - endpoints[e][c];
+                error += diff * diff;
+            }
+            if (error < bestError) {
+                bestError = error;
+                pBits[e] = pBit;
+                std::copy(std::begin(candidate), std::end(candidate), std::begin(quantized[e]));
+            }
+        }
+    }
+
+    for (uint32_t i = 0u; i < 16u; ++i) {
+        for (uint32_t c = 0u; c < 4u; ++c) {
+            const int value0 = static_cast<int>((quantized[0][c] << 1u) | pBits[0]);
+            const int value1 = static_cast<int>((quantized[1][c] << 1u) | pBits[1]);
+            palette[i][c] = ((64 - WEIGHTS[i]) * value0 + WEIGHTS[i] * value1 + 32) >> 6;
+        }
+    }
+
+    uint32_t indices[BLOCK_TEXELS];
+    for (uint32_t i = 0u; i < BLOCK_TEXELS; ++i) {
+        indices[i] = findClosest(block + i * 4u, palette, 4u);
+    }
+
+    // the highest bit of the anchor (first) index is implicit zero: swapped endpoints mirror the indices
+    if (indices[0] & 8u) {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(pBits[0], pBits[1]);
+        for (auto& index : indices) {
+            index = 15u - index;
+        }
+    }
+
+    uint64_t bits[2]{0u, 0u};
+    uint32_t position = 0u;
+    auto write = [&bits, &position](uint32_t value, uint32_t bitsCount) {
+        for (uint32_t b = 0u; b < bitsCount; ++b, ++position) {
+            bits[position / 64u] |= static_cast<uint64_t>((value >> b) & 1u) << (position % 64u);
+        }
+    };
+
+    write(1u << 6u, 7u);  // mode 6
+    for (uint32_t c = 0u; c < 4u; ++c) {
+        write(quantized[0][c], 7u);
+        write(quantized[1][c], 7u);
+    }
+    write(pBits[0], 1u);
+    write(pBits[1], 1u);
+    write(indices[0], 3u);
+    for (uint32_t i = 1u; i < BLOCK_TEXELS; ++i) {
+        write(indices[i], 4u);
+    }
+    assert(position == 128u);
+
+    for (uint32_t i = 0u; i < 16u; ++i) {
+        out[i] = static_cast<uint8_t>((bits[i / 8u] >> (8u * (i % 8u))) & 0xFFu);
+    }
+}
+}  // namespace
+
+namespace BlockCompressor {
+uint32_t getBlockSize(Format format) {
+    return format == Format::BC1 ? 8u : 16u;
+}
+
+uint64_t getCompressedSize(Format format, uint32_t width, uint32_t height) {
+    const uint64_t blocksX = (width + BLOCK_EXTENT - 1u) / BLOCK_EXTENT;
+    const uint64_t blocksY = (height + BLOCK_EXTENT - 1u) / BLOCK_EXTENT;
+    return blocksX * blocksY * getBlockSize(format);
+}
+
+void compressImage(Format format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out) {
+    assert(rgba && out && width > 0u && height > 0u);
+    const uint32_t blocksX = (width + BLOCK_EXTENT - 1u) / BLOCK_EXTENT;
+    const uint32_t blocksY = (height + BLOCK_EXTENT - 1u) / BLOCK_EXTENT;
+    const uint32_t blockSize = getBlockSize(format);
+
+    uint8_t block[BLOCK_TEXELS * 4u];
+    for (uint32_t blockY = 0u; blockY < blocksY; ++blockY) {
+        for (uint32_t blockX = 0u; blockX < blocksX; ++blockX) {
+            for (uint32_t y = 0u; y < BLOCK_EXTENT; ++y) {
+                const uint32_t srcY = std::min(blockY * BLOCK_EXTENT + y, height - 1u);
+                for (uint32_t x = 0u; x < BLOCK_EXTENT; ++x) {
+                    const uint32_t srcX = std::min(blockX * BLOCK_EXTENT + x, width - 1u);
+                    memcpy(block + (y * BLOCK_EXTENT + x) * 4u, rgba + (static_cast<size_t>(srcY) * width + srcX) * 4u, 4u);
+                }
+            }
+            compressBlock(format, block, out + (static_cast<size_t>(blockY) * blocksX + blockX) * blockSize);
+        }
+    }
+}
+
+void compressBlock(Format format, const uint8_t* block, uint8_t* out) {
+    switch (format) {
+        case Format::BC1:
+            compressBC1(block, out);
+            break;
+        case Format::BC3:
+            compressBC4(block, 3u, out);
+            compressBC1(block, out + 8u);
+            break;
+        case Format::BC5:
+            compressBC4(block, 0u, out);
+            compressBC4(block, 1u, out + 8u);
+            break;
+        case Format::BC7:
+            compressBC7(block, out);
+            break;
+    }
+}
+}  // namespace BlockCompressor
@@ -0,0 +1,103 @@
+#include "CommandBufferCache.h"
+
+#include "FrameTelemetry.h"
+
+#include <assert.h>
+
+void CommandBufferCache::init(VkDevice device, uint32_t queueFamilyIndex, uint32_t imagesCount, uint32_t passesCount,
+                              VkQueryPipelineStatisticFlags pipelineStatistics) {
+    assert(device);
+    destroy();
+
+    m_device = device;
+    m_passesCount = passesCount;
+    m_pipelineStatistics = pipelineStatistics;
+
+    VkCommandPoolCreateInfo cmdPoolCreateInfo = {};
+    cmdPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;  // a pass is re-recorded alone
+    cmdPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+
+    VkResult res = vkCreateCommandPool(m_device, &cmdPoolCreateInfo, nullptr, &m_cmdPool);
+    CHECK_VULKAN_ERROR("vkCreateCommandPool error %d\n", res);
+
+    std::vector<VkCommandBuffer> cmdBufs(imagesCount * passesCount);
+    VkCommandBufferAllocateInfo cmdBufAllocInfo = {};
+    cmdBufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufAllocInfo.commandPool = m_cmdPool;
+    cmdBufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    cmdBufAllocInfo.commandBufferCount = static_cast<uint32_t>(cmdBufs.size());
+
+    res = vkAllocateCommandBuffers(m_device, &cmdBufAllocInfo, cmdBufs.data());
+    CHECK_VULKAN_ERROR("vkAllocateCommandBuffers error %d\n", res);
+
+    m_entries.resize(cmdBufs.size());
+    for (size_t i = 0u; i < cmdBufs.size(); ++i) {
+        m_entries[i].cmdBuf = cmdBufs[i];
+    }
+}
+
+void CommandBufferCache::destroy() {
+    if (m_cmdPool) {
+        // the buffers are freed with their pool
+        vkDestroyCommandPool(m_device, m_cmdPool, nullptr);
+        m_cmdPool = nullptr;
+    }
+    m_entries.clear();
+    m_passesCount = 0u;
+    m_device = nullptr;
+}
+
+VkCommandBuffer CommandBufferCache::get(uint32_t imageIndex, uint32_t passIndex, uint64_t inputsHash,
+                                        const VkRenderPassBeginInfo& renderPassInfo, const RecordFunc& recordFunc) {
+    assert(passIndex < m_passesCount);
+    assert(imageIndex * m_passesCount + passIndex < m_entries.size());
+
+    auto& entry = m_entries[imageIndex * m_passesCount + passIndex];
+    if (entry.is_recorded && entry.inputsHash == inputsHash) {
+        ++m_stats.reusedCount;
+        countExecution(entry.counts);
+        return entry.cmdBuf;
+    }
+
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = renderPassInfo.renderPass;
+    inheritanceInfo.subpass = 0u;
+    inheritanceInfo.framebuffer = renderPassInfo.framebuffer;
+    inheritanceInfo.pipelineStatistics = m_pipelineStatistics;
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    // the primary command buffer of the image is re-recorded at the moment, nothing pending references the entry
+    VkResult res = vkBeginCommandBuffer(entry.cmdBuf, &beginInfo);
+    CHECK_VULKAN_ERROR("vkBeginCommandBuffer error %d\n", res);
+
+    entry.counts = Counts{};
+    recordFunc(entry.cmdBuf, entry.counts);
+
+    res = vkEndCommandBuffer(entry.cmdBuf);
+    CHECK_VULKAN_ERROR("vkEndCommandBuffer error %d\n", res);
+
+    entry.inputsHash = inputsHash;
+    entry.is_recorded = true;
+    ++m_stats.recordedCount;
+    countExecution(entry.counts);
+
+    return entry.cmdBuf;
+}
+
+void CommandBufferCache::countExecution(const Counts& counts) {
+    FrameTelemetry::count(FrameTelemetry::DRAW_CALLS, counts.drawCalls);
+    FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS, counts.descriptorBinds);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS, counts.pipelineBinds);
+}
+
+void CommandBufferCache::invalidate() {
+    for (auto& entry : m_entries) {
+        entry.is_recorded = false;
+    }
+}
@@ -0,0 +1,183 @@
+#include "CpuProfiler.h"
+
+#include "Utils.h"
+
+#include <fstream>
+#include <iomanip>
+
+// returns the buffer of the thread to the pool when the thread exits
+struct ThreadBufferOwner {
+    CpuProfiler::ThreadBuffer* buffer{nullptr};
+
+    ~ThreadBufferOwner() {
+        if (buffer) {
+            CpuProfiler::getInstance().releaseBuffer(buffer);
+        }
+    }
+};
+
+namespace {
+thread_local ThreadBufferOwner t_bufferOwner;
+
+int64_t toNs(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+void writeEscaped(std::ofstream& file, const char* text) {
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') {
+            file << '\\';
+        }
+        file << *text;
+    }
+}
+}  // namespace
+
+CpuProfiler::CpuProfiler() : m_epoch(std::chrono::steady_clock::now()) {}
+
+void CpuProfiler::requestCapture(uint32_t framesCount, std::string filePath, uint32_t skippedFrames) {
+    if (framesCount == 0u || m_isCaptureRequested || isCapturing()) {
+        Utils::printLog(INFO_PARAM, "CPU trace capture is already pending, request ignored");
+        return;
+    }
+    m_remainingFrames = framesCount;
+    m_skippedFrames = skippedFrames;
+    m_filePath = std::move(filePath);
+    m_isCaptureRequested = true;
+}
+
+void CpuProfiler::beginFrame() {
+    if (m_isCaptureRequested) {
+        if (m_skippedFrames > 0u) {
+            --m_skippedFrames;
+        } else {
+            m_isCaptureRequested = false;
+            m_captureIndex.fetch_add(1u, std::memory_order_release);
+            m_captureStartNs = toNs(std::chrono::steady_clock::now() - m_epoch);
+            s_isCapturing.store(true, std::memory_order_relaxed);
+        }
+    }
+    if (isCapturing()) {
+        m_frameStartTime = std::chrono::steady_clock::now();
+    }
+}
+
+void CpuProfiler::endFrame() {
+    if (!isCapturing()) {
+        return;
+    }
+    record("frame", m_frameStartTime, std::chrono::steady_clock::now());
+    if (--m_remainingFrames == 0u) {
+        s_isCapturing.store(false, std::memory_order_relaxed);
+        writeTrace();
+        // the buffers of the exited threads can be reused, the late events of the running ones go to no capture
+        m_captureIndex.fetch_add(1u, std::memory_order_release);
+    }
+}
+
+void CpuProfiler::setThreadName(const char* name) {
+    if (!t_bufferOwner.buffer) {
+        t_bufferOwner.buffer = acquireBuffer();
+    }
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    t_bufferOwner.buffer->threadName = name;
+}
+
+void CpuProfiler::record(const char* name, std::chrono::steady_clock::time_point startTime,
+                         std::chrono::steady_clock::time_point endTime) {
+    if (!t_bufferOwner.buffer) {
+        t_bufferOwner.buffer = acquireBuffer();
+    }
+    ThreadBuffer& buffer = *t_bufferOwner.buffer;
+
+    const uint32_t captureIndex = m_captureIndex.load(std::memory_order_acquire);
+    if (buffer.captureIndex.load(std::memory_order_relaxed) != captureIndex) {
+        buffer.eventsCount.store(0u, std::memory_order_relaxed);
+        buffer.captureIndex.store(captureIndex, std::memory_order_release);
+    }
+    if (!buffer.events) {
+        buffer.events = std::make_unique<Event[]>(MAX_THREAD_EVENTS);
+    }
+
+    const uint32_t count = buffer.eventsCount.load(std::memory_order_relaxed);
+    if (count >= MAX_THREAD_EVENTS) {
+        return;
+    }
+    buffer.events[count] = Event{name, toNs(startTime - m_epoch), toNs(endTime - startTime)};
+    // publishes the event to writeTrace
+    buffer.eventsCount.store(count + 1u, std::memory_order_release);
+}
+
+CpuProfiler::ThreadBuffer* CpuProfiler::acquireBuffer() {
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    const uint32_t captureIndex = m_captureIndex.load(std::memory_order_acquire);
+
+    ThreadBuffer* buffer = nullptr;
+    for (auto& pooled : m_buffers) {
+        // events of the running capture are kept until it is written
+        if (!pooled->is_owned && (pooled->captureIndex.load(std::memory_order_acquire) != captureIndex ||
+                                  pooled->eventsCount.load(std::memory_order_acquire) == 0u)) {
+            buffer = pooled.get();
+            break;
+        }
+    }
+    if (!buffer) {
+        m_buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = m_buffers.back().get();
+    }
+
+    buffer->is_owned = true;
+    buffer->threadId = m_nextThreadId++;
+    buffer->threadName = "worker";
+    return buffer;
+}
+
+void CpuProfiler::releaseBuffer(ThreadBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    buffer->is_owned = false;
+}
+
+bool CpuProfiler::writeTrace() const {
+    std::ofstream file(m_filePath);
+    if (!file) {
+        Utils::printLog(INFO_PARAM, "failed to write CPU trace to ", m_filePath);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    const uint32_t captureIndex = m_captureIndex.load(std::memory_order_acquire);
+
+    // Chrome trace event format: "X" complete events, timestamps in microseconds since the capture start
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Engine\"}}";
+    size_t eventsCount = 0u;
+    for (const auto& buffer : m_buffers) {
+        if (buffer->captureIndex.load(std::memory_order_acquire) != captureIndex) {
+            continue;
+        }
+        const uint32_t count = buffer->eventsCount.load(std::memory_order_acquire);
+        if (count == 0u) {
+            continue;
+        }
+
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+             << ",\"args\":{\"name\":\"";
+        writeEscaped(file, buffer->threadName);
+        file << "\"}}";
+
+        for (uint32_t i = 0u; i < count; ++i) {
+            const Event& event = buffer->events[i];
+            file << ",\n{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << static_cast<double>(event.startNs - m_captureStartNs) / 1000.0
+                 << ",\"dur\":" << static_cast<double>(event.durationNs) / 1000.0 << "}";
+        }
+        eventsCount += count;
+    }
+    file << "\n]}\n";
+
+    Utils::printLog(INFO_PARAM, "CPU trace of ", eventsCount, " events written to ", m_filePath);
+    return true;
+}
@@ -0,0 +1,255 @@
+#include "FrameTelemetry.h"
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+// returns the counters of the thread to the pool when the thread exits
+struct ThreadCountersOwner {
+    FrameTelemetry::ThreadCounters* counters{nullptr};
+
+    ~ThreadCountersOwner() {
+        if (counters) {
+            FrameTelemetry::getInstance().releaseCounters(counters);
+        }
+    }
+};
+
+namespace {
+thread_local ThreadCountersOwner t_countersOwner;
+
+constexpr std::array<std::string_view, FrameTelemetry::PHASES_MAX> PHASE_COLUMNS{
+    "frameMs", "physicsMs", "updateMs", "streamingMs", "recordingMs", "submitMs"};
+constexpr std::array<std::string_view, FrameTelemetry::COUNTERS_MAX> COUNTER_COLUMNS{
+    "drawCalls", "descriptorBinds", "pipelineBinds", "queueSubmits", "uploadedBytes", "skinnedVertices"};
+constexpr uint32_t FIXED_COLUMNS_COUNT =
+    static_cast<uint32_t>(FrameTelemetry::PHASES_MAX) + static_cast<uint32_t>(FrameTelemetry::COUNTERS_MAX);
+}  // namespace
+
+void FrameTelemetry::count(Counter counter, uint64_t value) {
+    if (!t_countersOwner.counters) {
+        t_countersOwner.counters = getInstance().acquireCounters();
+    }
+    // the only writer, the load and the store don't race with other threads
+    auto& total = t_countersOwner.counters->values[counter];
+    total.store(total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+FrameTelemetry::ThreadCounters* FrameTelemetry::acquireCounters() {
+    std::lock_guard<std::mutex> lock(m_countersMutex);
+    for (auto& pooled : m_threadCounters) {
+        if (!pooled->is_owned) {
+            pooled->is_owned = true;
+            return pooled.get();
+        }
+    }
+    m_threadCounters.push_back(std::make_unique<ThreadCounters>());
+    m_threadCounters.back()->is_owned = true;
+    return m_threadCounters.back().get();
+}
+
+void FrameTelemetry::releaseCounters(ThreadCounters* counters) {
+    std::lock_guard<std::mutex> lock(m_countersMutex);
+    counters->is_owned = false;
+}
+
+void FrameTelemetry::beginFrame() {
+    m_frameStartTime = std::chrono::steady_clock::now();
+    m_phasesTime.fill(std::chrono::steady_clock::duration::zero());
+}
+
+void FrameTelemetry::endFrame() {
+    m_phasesTime[PHASE_FRAME] = std::chrono::steady_clock::now() - m_frameStartTime;
+    for (uint32_t i = 0u; i < PHASES_MAX; ++i) {
+        m_currentRecord.phasesMs[i] = std::chrono::duration<float, std::milli>(m_phasesTime[i]).count();
+    }
+
+    std::array<uint64_t, COUNTERS_MAX> totals{};
+    {
+        std::lock_guard<std::mutex> lock(m_countersMutex);
+        for (const auto& threadCounters : m_threadCounters) {
+            for (uint32_t i = 0u; i < COUNTERS_MAX; ++i) {
+                totals[i] += threadCounters->values[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    for (uint32_t i = 0u; i < COUNTERS_MAX; ++i) {
+        m_currentRecord.counters[i] = totals[i] - m_previousTotals[i];
+    }
+    m_previousTotals = totals;
+
+    m_currentRecord.frameIndex = m_framesCount;
+    m_history[m_framesCount % HISTORY_SIZE] = m_currentRecord;
+    ++m_framesCount;
+    // models which aren't updated by a frame have no visible instances in it
+    m_currentRecord.visibleInstances.fill(0u);
+    m_currentRecord.visibleLowPolyInstances.fill(0u);
+}
+
+uint32_t FrameTelemetry::registerModel(std::string name) {
+    if (m_modelNames.size() == MAX_MODELS) {
+        Utils::printLog(INFO_PARAM, "telemetry: more than ", MAX_MODELS, " models, ", name, " shares the last columns");
+        return MAX_MODELS - 1u;
+    }
+    m_modelNames.push_back(std::move(name));
+    return static_cast<uint32_t>(m_modelNames.size() - 1u);
+}
+
+void FrameTelemetry::addVisibleInstances(uint32_t modelSlot, std::size_t instancesCount, std::size_t lowPolyInstancesCount) {
+    m_currentRecord.visibleInstances[modelSlot] += static_cast<uint32_t>(instancesCount);
+    m_currentRecord.visibleLowPolyInstances[modelSlot] += static_cast<uint32_t>(lowPolyInstancesCount);
+}
+
+std::vector<std::string> FrameTelemetry::getColumnNames() const {
+    std::vector<std::string> names;
+    names.reserve(FIXED_COLUMNS_COUNT + 2u * MAX_MODELS);
+    names.insert(names.end(), PHASE_COLUMNS.begin(), PHASE_COLUMNS.end());
+    names.insert(names.end(), COUNTER_COLUMNS.begin(), COUNTER_COLUMNS.end());
+    for (const auto& modelName : m_modelNames) {
+        names.push_back(modelName + "Visible");
+        names.push_back(modelName + "VisibleLowPoly");
+    }
+    return names;
+}
+
+double FrameTelemetry::getColumnValue(const FrameRecord& record, uint32_t column) {
+    if (column < PHASES_MAX) {
+        return record.phasesMs[column];
+    }
+    if (column < FIXED_COLUMNS_COUNT) {
+        return static_cast<double>(record.counters[column - PHASES_MAX]);
+    }
+    const uint32_t modelColumn = column - FIXED_COLUMNS_COUNT;
+    return modelColumn % 2u == 0u ? record.visibleInstances[modelColumn / 2u] : record.visibleLowPolyInstances[modelColumn / 2u];
+}
+
+bool FrameTelemetry::addThreshold(std::string_view expression) {
+    std::istringstream stream{std::string(expression)};
+    std::string statistic, column, operation, value;
+    stream >> statistic >> column >> operation >> value;
+
+    Threshold threshold;
+    threshold.expression = expression;
+    const std::array<std::pair<std::string_view, Statistic>, 5u> statistics{{{"mean", Statistic::MEAN},
+                                                                            {"p50", Statistic::P50},
+                                                                            {"p95", Statistic::P95},
+                                                                            {"p99", Statistic::P99},
+                                                                            {"max", Statistic::MAX}}};
+    const auto statisticIt = std::find_if(statistics.begin(), statistics.end(),
+                                          [&statistic](const auto& entry) { return entry.first == statistic; });
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), threshold.value);
+    if (statisticIt == statistics.end() || column.empty() || error != std::errc{} || end != value.data() + value.size() ||
+        (operation != "<" && operation != "<=" && operation != ">" && operation != ">=")) {
+        Utils::printLog(INFO_PARAM, "telemetry: invalid threshold '", expression, "'");
+        return false;
+    }
+    threshold.statistic = statisticIt->second;
+    threshold.column = std::move(column);
+    threshold.is_less = operation[0] == '<';
+    threshold.is_orEqual = operation.size() == 2u;
+    m_thresholds.push_back(std::move(threshold));
+    return true;
+}
+
+bool FrameTelemetry::checkThresholds() const {
+    const uint32_t historySize = getHistorySize();
+    // the model columns are known once the models are registered
+    const auto columnNames = getColumnNames();
+    bool is_passed = true;
+    for (const auto& threshold : m_thresholds) {
+        const auto columnIt = std::find(columnNames.begin(), columnNames.end(), threshold.column);
+        if (columnIt == columnNames.end()) {
+            Utils::printLog(INFO_PARAM, "telemetry threshold '", threshold.expression, "' FAILED: unknown column");
+            is_passed = false;
+            continue;
+        }
+        const auto column = static_cast<uint32_t>(columnIt - columnNames.begin());
+
+        std::vector<double> values;
+        values.reserve(historySize);
+        for (uint64_t frame = m_framesCount - historySize; frame < m_framesCount; ++frame) {
+            if (frame >= SKIPPED_FRAMES) {
+                values.push_back(getColumnValue(m_history[frame % HISTORY_SIZE], column));
+            }
+        }
+        if (values.empty()) {
+            Utils::printLog(INFO_PARAM, "telemetry threshold '", threshold.expression, "' FAILED: no frames recorded");
+            is_passed = false;
+            continue;
+        }
+
+        std::sort(values.begin(), values.end());
+        // nearest rank percentile
+        const auto percentile = [&values](double p) {
+            const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(values.size())));
+            return values[std::clamp<std::size_t>(rank, 1u, values.size()) - 1u];
+        };
+        double actual = 0.0;
+        switch (threshold.statistic) {
+            case Statistic::MEAN:
+                actual = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+                break;
+            case Statistic::P50:
+                actual = percentile(0.50);
+                break;
+            case Statistic::P95:
+                actual = percentile(0.95);
+                break;
+            case Statistic::P99:
+                actual = percentile(0.99);
+                break;
+            case Statistic::MAX:
+                actual = values.back();
+                break;
+        }
+
+        const bool is_equalPassed = threshold.is_orEqual && actual == threshold.value;
+        const bool is_thresholdPassed =
+            (threshold.is_less ? actual < threshold.value : actual > threshold.value) || is_equalPassed;
+        Utils::printLog(INFO_PARAM, "telemetry threshold '", threshold.expression, "' ", is_thresholdPassed ? "passed" : "FAILED",
+                        ": ", actual, " over ", values.size(), " frames");
+        is_passed = is_passed && is_thresholdPassed;
+    }
+    return is_passed;
+}
+
+bool FrameTelemetry::exportCsv(const std::string& filePath) const {
+    std::ofstream file(filePath);
+    if (!file) {
+        Utils::printLog(INFO_PARAM, "failed to write telemetry to ", filePath);
+        return false;
+    }
+
+    const auto columnNames = getColumnNames();
+    file << "frame";
+    for (const auto& name : columnNames) {
+        file << ',' << name;
+    }
+    file << '\n';
+
+    const uint32_t historySize = getHistorySize();
+    file << std::fixed << std::setprecision(3);
+    for (uint64_t frame = m_framesCount - historySize; frame < m_framesCount; ++frame) {
+        const FrameRecord& record = m_history[frame % HISTORY_SIZE];
+        file << record.frameIndex;
+        for (uint32_t i = 0u; i < PHASES_MAX; ++i) {
+            file << ',' << record.phasesMs[i];
+        }
+        for (uint32_t i = 0u; i < COUNTERS_MAX; ++i) {
+            file << ',' << record.counters[i];
+        }
+        for (uint32_t i = 0u; i < m_modelNames.size(); ++i) {
+            file << ',' << record.visibleInstances[i] << ',' << record.visibleLowPolyInstances[i];
+        }
+        file << '\n';
+    }
+
+    Utils::printLog(INFO_PARAM, "telemetry of ", historySize, " frames written to ", filePath);
+    return true;
+}
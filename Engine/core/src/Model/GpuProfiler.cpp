@@ -0,0 +1,292 @@
+#include "GpuProfiler.h"
+
+#include "Utils.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+void GpuProfiler::init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t framesCount,
+                       bool is_pipelineStatisticsSupported) {
+    assert(device && physicalDevice);
+    destroy();
+    m_device = device;
+    // the names of the stats may be referenced by the UI, they must not move
+    m_scopeStats.reserve(MAX_SCOPES);
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    uint32_t queueFamiliesCount = 0u;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamiliesCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamiliesCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamiliesCount, queueFamilies.data());
+    const uint32_t validBits = queueFamilyIndex < queueFamiliesCount ? queueFamilies[queueFamilyIndex].timestampValidBits : 0u;
+
+    // timestampComputeAndGraphics guarantees the timestamps on every graphics queue, without it the queue family decides
+    m_isSupported = validBits != 0u && properties.limits.timestampPeriod > 0.0f;
+    if (!m_isSupported) {
+        Utils::printLog(INFO_PARAM, "GPU profiler disabled: timestamps are not supported by the queue family ",
+                        queueFamilyIndex, " (timestampComputeAndGraphics ", properties.limits.timestampComputeAndGraphics,
+                        ")");
+        return;
+    }
+
+    m_timestampPeriod = properties.limits.timestampPeriod;
+    m_timestampMask = validBits >= 64u ? UINT64_MAX : (uint64_t{1u} << validBits) - 1u;
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = MAX_SCOPES * 2u;
+
+    VkQueryPoolCreateInfo statisticsPoolInfo{};
+    statisticsPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    statisticsPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    statisticsPoolInfo.queryCount = MAX_SCOPES;
+    statisticsPoolInfo.pipelineStatistics = PIPELINE_STATISTICS;
+
+    m_isPipelineStatisticsSupported = is_pipelineStatisticsSupported;
+    m_frames.resize(framesCount);
+    for (auto& frame : m_frames) {
+        VkResult res = vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &frame.queryPool);
+        CHECK_VULKAN_ERROR("vkCreateQueryPool error %d\n", res);
+        if (m_isPipelineStatisticsSupported) {
+            res = vkCreateQueryPool(m_device, &statisticsPoolInfo, nullptr, &frame.statisticsPool);
+            CHECK_VULKAN_ERROR("vkCreateQueryPool error %d\n", res);
+        }
+    }
+}
+
+void GpuProfiler::destroy() {
+    for (auto& frame : m_frames) {
+        vkDestroyQueryPool(m_device, frame.queryPool, nullptr);
+        vkDestroyQueryPool(m_device, frame.statisticsPool, nullptr);
+    }
+    m_frames.clear();
+    m_openScopes.clear();
+    mp_currentFrame = nullptr;
+    m_isSupported = false;
+    m_isPipelineStatisticsSupported = false;
+    m_device = nullptr;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer cmdBuf, uint32_t frameIndex) {
+    if (!m_isSupported) {
+        return;
+    }
+    assert(frameIndex < m_frames.size());
+    assert(!mp_currentFrame);
+
+    auto& frame = m_frames[frameIndex];
+    if (!frame.scopes.empty()) {
+        resolveFrame(frame);
+        frame.scopes.clear();
+    }
+
+    vkCmdResetQueryPool(cmdBuf, frame.queryPool, 0u, MAX_SCOPES * 2u);
+    frame.statisticsCount = 0u;
+    frame.is_statisticsEnabled = m_isPipelineStatisticsSupported && m_isPipelineStatisticsEnabled;
+    if (frame.is_statisticsEnabled) {
+        vkCmdResetQueryPool(cmdBuf, frame.statisticsPool, 0u, MAX_SCOPES);
+    }
+    mp_currentFrame = &frame;
+    m_openScopes.clear();
+    beginScope(cmdBuf, "frame");
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer cmdBuf) {
+    if (!mp_currentFrame) {
+        return;
+    }
+    endScope(cmdBuf, 0u);
+    assert(m_openScopes.empty());
+    mp_currentFrame = nullptr;
+}
+
+GpuProfiler::ScopeHandle GpuProfiler::beginScope(VkCommandBuffer cmdBuf, std::string_view name) {
+    if (!mp_currentFrame || mp_currentFrame->scopes.size() == MAX_SCOPES) {
+        return INVALID_SCOPE;
+    }
+
+    const uint32_t statsIndex = findScopeStats(name);
+    if (statsIndex == INVALID_SCOPE) {
+        return INVALID_SCOPE;
+    }
+
+    auto& scopes = mp_currentFrame->scopes;
+    Scope scope{statsIndex, static_cast<uint32_t>(scopes.size()) * 2u};
+    // the children of the frame scope, nothing else is active then
+    const bool has_statistics = mp_currentFrame->is_statisticsEnabled && m_openScopes.size() == 1u;
+    if (has_statistics) {
+        scope.statisticsQuery = mp_currentFrame->statisticsCount++;
+    }
+    scopes.push_back(scope);
+    m_openScopes.push_back(statsIndex);
+
+    vkCmdWriteTimestamp(cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mp_currentFrame->queryPool, scope.firstQuery);
+    if (has_statistics) {
+        vkCmdBeginQuery(cmdBuf, mp_currentFrame->statisticsPool, scope.statisticsQuery, 0u);
+    }
+
+    return static_cast<ScopeHandle>(scopes.size() - 1u);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer cmdBuf, ScopeHandle scope) {
+    if (!mp_currentFrame || scope == INVALID_SCOPE) {
+        return;
+    }
+    assert(scope < mp_currentFrame->scopes.size());
+    assert(!m_openScopes.empty() && m_openScopes.back() == mp_currentFrame->scopes[scope].statsIndex);
+
+    m_openScopes.pop_back();
+    if (mp_currentFrame->scopes[scope].statisticsQuery != UINT32_MAX) {
+        vkCmdEndQuery(cmdBuf, mp_currentFrame->statisticsPool, mp_currentFrame->scopes[scope].statisticsQuery);
+    }
+    vkCmdWriteTimestamp(cmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mp_currentFrame->queryPool,
+                        mp_currentFrame->scopes[scope].firstQuery + 1u);
+}
+
+bool GpuProfiler::exportCsv(const std::string& filePath) const {
+    std::ofstream file(filePath);
+    if (!file.is_open()) {
+        Utils::printLog(WARNING_PARAM, "GPU timings are not writable: ", filePath);
+        return false;
+    }
+
+    file << "index";
+    for (const auto& stats : m_scopeStats) {
+        file << ',' << stats.path;
+    }
+    file << '\n';
+
+    const uint32_t historySize = getHistorySize();
+    const uint32_t historyStart = getHistoryStart();
+    char value[32];
+    for (uint32_t i = 0u; i < historySize; ++i) {
+        const uint32_t slot = (historyStart + i) % HISTORY_SIZE;
+        file << m_resolvedCount - historySize + i;
+        for (const auto& stats : m_scopeStats) {
+            file << ',';
+            if (stats.history[slot] != NOT_RECORDED) {
+                std::snprintf(value, sizeof(value), "%.4f", stats.history[slot]);
+                file << value;
+            }
+        }
+        file << '\n';
+    }
+
+    Utils::printLog(INFO_PARAM, "GPU timings of ", historySize, " frames exported to ", filePath);
+    return true;
+}
+
+void GpuProfiler::resolveFrame(Frame& frame) {
+    // the value and the availability of every query, the frame isn't waited for
+    const uint32_t queriesCount = static_cast<uint32_t>(frame.scopes.size()) * 2u;
+    std::array<uint64_t, MAX_SCOPES * 2u * 2u> results{};
+    const VkResult res = vkGetQueryPoolResults(m_device, frame.queryPool, 0u, queriesCount, sizeof(uint64_t) * 2u * queriesCount,
+                                               results.data(), sizeof(uint64_t) * 2u,
+                                               VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (res != VK_SUCCESS) {
+        return;
+    }
+    for (uint32_t query = 0u; query < queriesCount; ++query) {
+        if (results[query * 2u + 1u] == 0u) {
+            return;
+        }
+    }
+
+    const uint32_t slot = m_resolvedCount % HISTORY_SIZE;
+    for (auto& stats : m_scopeStats) {
+        stats.history[slot] = NOT_RECORDED;
+        stats.has_statistics = false;
+    }
+    for (const auto& scope : frame.scopes) {
+        const uint64_t beginTicks = results[scope.firstQuery * 2u];
+        const uint64_t endTicks = results[(scope.firstQuery + 1u) * 2u];
+        const float ms = static_cast<float>(static_cast<double>((endTicks - beginTicks) & m_timestampMask) *
+                                            static_cast<double>(m_timestampPeriod) / 1000000.0);
+        // a scope recorded several times per frame is summed up
+        auto& value = m_scopeStats[scope.statsIndex].history[slot];
+        value = value == NOT_RECORDED ? ms : value + ms;
+    }
+    ++m_resolvedCount;
+
+    if (frame.statisticsCount != 0u) {
+        resolveStatistics(frame);
+    }
+
+    const uint32_t historySize = getHistorySize();
+    for (auto& stats : m_scopeStats) {
+        stats.lastMs = stats.history[slot];
+        stats.maxMs = 0.0f;
+        float sum = 0.0f;
+        uint32_t recordedCount = 0u;
+        for (uint32_t i = 0u; i < historySize; ++i) {
+            if (stats.history[i] != NOT_RECORDED) {
+                sum += stats.history[i];
+                stats.maxMs = std::max(stats.maxMs, stats.history[i]);
+                ++recordedCount;
+            }
+        }
+        stats.averageMs = recordedCount != 0u ? sum / static_cast<float>(recordedCount) : 0.0f;
+    }
+}
+
+void GpuProfiler::resolveStatistics(const Frame& frame) {
+    // the counters in the order of the PIPELINE_STATISTICS bits and the availability
+    constexpr uint32_t VALUES_COUNT = 8u;
+    std::array<uint64_t, MAX_SCOPES * VALUES_COUNT> results{};
+    const VkResult res = vkGetQueryPoolResults(m_device, frame.statisticsPool, 0u, frame.statisticsCount,
+                                               sizeof(uint64_t) * VALUES_COUNT * frame.statisticsCount, results.data(),
+                                               sizeof(uint64_t) * VALUES_COUNT,
+                                               VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (res != VK_SUCCESS) {
+        return;
+    }
+
+    for (const auto& scope : frame.scopes) {
+        if (scope.statisticsQuery == UINT32_MAX) {
+            continue;
+        }
+        const uint64_t* values = &results[scope.statisticsQuery * VALUES_COUNT];
+        if (values[VALUES_COUNT - 1u] == 0u) {
+            continue;
+        }
+
+        auto& stats = m_scopeStats[scope.statsIndex];
+        if (!stats.has_statistics) {
+            stats.statistics = PipelineStatistics{};
+            stats.has_statistics = true;
+        }
+        stats.statistics.inputVertices += values[0];
+        stats.statistics.inputPrimitives += values[1];
+        stats.statistics.vertexInvocations += values[2];
+        stats.statistics.clippingPrimitives += values[3];
+        stats.statistics.fragmentInvocations += values[4];
+        stats.statistics.tessControlPatches += values[5];
+        stats.statistics.tessEvaluationInvocations += values[6];
+    }
+}
+
+uint32_t GpuProfiler::findScopeStats(std::string_view name) {
+    std::string path = m_openScopes.empty() ? std::string{} : m_scopeStats[m_openScopes.back()].path + "/";
+    path += name;
+
+    const auto it = std::find_if(m_scopeStats.begin(), m_scopeStats.end(), [&path](const auto& stats) { return stats.path == path; });
+    if (it != m_scopeStats.end()) {
+        return static_cast<uint32_t>(std::distance(m_scopeStats.begin(), it));
+    }
+    if (m_scopeStats.size() == MAX_SCOPES) {
+        return INVALID_SCOPE;
+    }
+
+    ScopeStats stats;
+    stats.name = name;
+    stats.path = std::move(path);
+    stats.level = static_cast<uint32_t>(m_openScopes.size());
+    stats.history.fill(NOT_RECORDED);
+    m_scopeStats.push_back(std::move(stats));
+    return static_cast<uint32_t>(m_scopeStats.size() - 1u);
+}
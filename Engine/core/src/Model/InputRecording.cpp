@@ -0,0 +1,74 @@
+#include "InputRecording.h"
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+void InputRecording::addFrame(const IControl::WindowQueueMSG& windowQueueMSG, float deltaTimeMS) {
+    static constexpr uint32_t MAX_MOUSE_POS = std::numeric_limits<uint16_t>::max();
+
+    Frame frame;
+    frame.deltaTimeMS = deltaTimeMS;
+    frame.mouseX = static_cast<uint16_t>(std::min(windowQueueMSG.mouseX, MAX_MOUSE_POS));
+    frame.mouseY = static_cast<uint16_t>(std::min(windowQueueMSG.mouseY, MAX_MOUSE_POS));
+    frame.buttonFlag = static_cast<uint8_t>(windowQueueMSG.buttonFlag);
+    m_frames.push_back(frame);
+}
+
+bool InputRecording::save(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        Utils::printLog(WARNING_PARAM, "failed to write input recording to ", filePath);
+        return false;
+    }
+
+    FileHeader header;
+    header.width = m_width;
+    header.height = m_height;
+    header.framesCount = static_cast<uint32_t>(m_frames.size());
+    header.stressScene = m_stressScene;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+    file.write(reinterpret_cast<const char*>(m_frames.data()), m_frames.size() * sizeof(Frame));
+    if (!file) {
+        Utils::printLog(WARNING_PARAM, "failed to write input recording to ", filePath);
+        return false;
+    }
+
+    Utils::printLog(INFO_PARAM, "input of ", m_frames.size(), " frames recorded to ", filePath);
+    return true;
+}
+
+bool InputRecording::load(const std::string& filePath) {
+    m_frames.clear();
+    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        Utils::printLog(WARNING_PARAM, "failed to open input recording ", filePath);
+        return false;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    FileHeader header;
+    const FileHeader expectedHeader;
+    if (fileSize < sizeof(FileHeader) || !file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader)) ||
+        memcmp(header.identifier, expectedHeader.identifier, sizeof(header.identifier)) != 0 ||
+        header.version != FORMAT_VERSION || header.framesCount == 0u ||
+        fileSize < sizeof(FileHeader) + static_cast<uint64_t>(header.framesCount) * sizeof(Frame)) {
+        Utils::printLog(WARNING_PARAM, "unsupported or broken input recording ", filePath);
+        return false;
+    }
+
+    m_frames.resize(header.framesCount);
+    if (!file.read(reinterpret_cast<char*>(m_frames.data()), m_frames.size() * sizeof(Frame))) {
+        Utils::printLog(WARNING_PARAM, "broken input recording ", filePath);
+        m_frames.clear();
+        return false;
+    }
+    m_width = header.width;
+    m_height = header.height;
+    m_stressScene = header.stressScene;
+    return true;
+}
@@ -0,0 +1,385 @@
+#include "Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+struct Logger::Record {
+    int64_t timeNs{0};
+    uint32_t threadIndex{0u};
+    uint32_t suppressedCount{0u};
+    Level level{Level::INFO};
+    bool is_repeatsReport{false};  // the text wasn't passed again, it was suppressed suppressedCount times
+    std::string text;
+};
+
+struct Logger::ThreadRing {
+    struct Header {
+        uint32_t size{0u};  // with the header and the alignment, 0: the rest of the ring is skipped
+        uint32_t textLength{0u};
+        uint32_t suppressedCount{0u};
+        Level level{Level::INFO};
+        bool is_repeatsReport{false};
+        int64_t timeNs{0};
+    };
+
+    struct RepeatedMessage {
+        uint64_t hash{0u};
+        int64_t windowStartNs{0};
+        int64_t lastSuppressedNs{0};
+        uint32_t count{0u};
+        uint32_t suppressedCount{0u};  // not reported yet
+        Level level{Level::INFO};
+        std::string text;  // of the suppressed repeats, for their report when no passed repeat follows
+    };
+
+    static constexpr uint32_t ALIGNMENT = alignof(Header);
+    static constexpr uint32_t REPEATED_MESSAGES_COUNT = 64u;
+    static_assert(RING_SIZE % ALIGNMENT == 0u);
+
+    alignas(Header) std::array<char, RING_SIZE> data{};
+    std::atomic<uint64_t> writePos{0u};  // monotonic, the owner thread only stores it
+    std::atomic<uint64_t> readPos{0u};   // monotonic, the draining thread only stores it
+    uint32_t index{0u};
+    bool is_owned{false};  // guarded by m_ringsMutex
+    // the rate limiting state of the owner thread, direct mapped by the message hash, the pending repeats are reported
+    // by the draining thread too
+    std::mutex repeatsMutex;
+    std::array<RepeatedMessage, REPEATED_MESSAGES_COUNT> repeatedMessages{};  // guarded by repeatsMutex
+};
+
+// returns the ring of the thread to the pool when the thread exits
+struct ThreadRingOwner {
+    Logger::ThreadRing* ring{nullptr};
+
+    ~ThreadRingOwner() {
+        if (ring && !Logger::s_is_destroyed.load(std::memory_order_acquire)) {
+            Logger::getInstance().releaseRing(ring);
+        }
+    }
+};
+
+namespace {
+thread_local ThreadRingOwner t_ringOwner;
+
+constexpr std::array<std::string_view, 5u> LEVEL_NAMES{"debug", "info", "warning", "critical", "off"};
+constexpr std::array<char, 5u> LEVEL_TAGS{'D', 'I', 'W', 'C', '-'};
+
+uint64_t hashText(std::string_view text) {
+    // FNV-1a, see Utils::hashBytes (Utils.h includes the logger)
+    uint64_t hash = 14695981039346656037ull;
+    for (const char symbol : text) {
+        hash = (hash ^ static_cast<uint8_t>(symbol)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t alignUp(uint64_t size, uint64_t alignment) {
+    return (size + alignment - 1u) / alignment * alignment;
+}
+
+// the rest of the ring from offset is skipped if it has no room for a header or holds a header of size 0
+template <class Header>
+bool isRingEndSkipped(const char* data, uint32_t offset, uint32_t ringSize) {
+    if (ringSize - offset < sizeof(Header)) {
+        return true;
+    }
+    uint32_t size = 0u;
+    memcpy(&size, data + offset, sizeof(size));
+    return size == 0u;
+}
+}  // namespace
+
+Logger::Logger() : m_thread(&Logger::run, this) {
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+        m_is_stopping = true;
+    }
+    m_threadCondition.notify_one();
+    m_thread.join();
+    {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        drain(true);
+    }
+    s_is_destroyed.store(true, std::memory_order_release);
+}
+
+bool Logger::parseLevel(std::string_view name, Level& outLevel) {
+    const auto levelIt = std::find(LEVEL_NAMES.begin(), LEVEL_NAMES.end(), name);
+    if (levelIt == LEVEL_NAMES.end()) {
+        return false;
+    }
+    outLevel = static_cast<Level>(levelIt - LEVEL_NAMES.begin());
+    return true;
+}
+
+void Logger::log(Level level, std::string_view text) {
+    if (s_is_destroyed.load(std::memory_order_acquire)) {
+        std::cout << text << '\n';
+        return;
+    }
+    Logger& logger = getInstance();
+    logger.write(level, text);
+    if (level == Level::CRITICAL) {
+        std::lock_guard<std::mutex> lock(logger.m_drainMutex);
+        logger.drain(true);
+    }
+}
+
+void Logger::flush() {
+    if (s_is_destroyed.load(std::memory_order_acquire)) {
+        return;
+    }
+    Logger& logger = getInstance();
+    std::lock_guard<std::mutex> lock(logger.m_drainMutex);
+    logger.drain(true);
+}
+
+void Logger::setLevel(Level level) {
+    // the repeats suppressed at the previous level are reported before it changes
+    flush();
+    s_level.store(level, std::memory_order_relaxed);
+}
+
+void Logger::write(Level level, std::string_view text) {
+    if (!t_ringOwner.ring) {
+        t_ringOwner.ring = acquireRing();
+    }
+    ThreadRing& ring = *t_ringOwner.ring;
+    const int64_t timeNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+
+    uint32_t suppressedCount = 0u;
+    if (level != Level::CRITICAL) {
+        const uint64_t hash = hashText(text);
+        auto& repeated = ring.repeatedMessages[hash % ThreadRing::REPEATED_MESSAGES_COUNT];
+        const int64_t windowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(RATE_LIMIT_WINDOW).count();
+        ThreadRing::RepeatedMessage takenOver;
+        {
+            std::lock_guard<std::mutex> lock(ring.repeatsMutex);
+            if (repeated.hash != hash || timeNs - repeated.windowStartNs >= windowNs) {
+                if (repeated.hash == hash) {
+                    suppressedCount = repeated.suppressedCount;
+                } else if (repeated.suppressedCount != 0u) {
+                    // another message takes the slot over, the repeats of the previous one get a report of their own
+                    takenOver.lastSuppressedNs = repeated.lastSuppressedNs;
+                    takenOver.suppressedCount = repeated.suppressedCount;
+                    takenOver.level = repeated.level;
+                    takenOver.text.swap(repeated.text);
+                }
+                repeated.hash = hash;
+                repeated.windowStartNs = timeNs;
+                repeated.count = 0u;
+                repeated.suppressedCount = 0u;
+            }
+            if (++repeated.count > RATE_LIMIT_BURST) {
+                if (repeated.suppressedCount++ == 0u) {
+                    repeated.text.assign(text.substr(0u, MAX_MESSAGE_SIZE));
+                }
+                repeated.lastSuppressedNs = timeNs;
+                repeated.level = level;
+                return;
+            }
+        }
+        // pushed without the lock, a flood of messages drains the rings
+        if (takenOver.suppressedCount != 0u) {
+            push(ring, takenOver.level, takenOver.lastSuppressedNs, takenOver.suppressedCount, true, takenOver.text);
+        }
+    }
+    push(ring, level, timeNs, suppressedCount, false, text);
+}
+
+void Logger::push(ThreadRing& ring, Level level, int64_t timeNs, uint32_t suppressedCount, bool is_repeatsReport,
+                  std::string_view text) {
+    ThreadRing::Header header;
+    header.textLength = static_cast<uint32_t>(std::min<size_t>(text.size(), MAX_MESSAGE_SIZE));
+    header.size = static_cast<uint32_t>(alignUp(sizeof(ThreadRing::Header) + header.textLength, ThreadRing::ALIGNMENT));
+    header.suppressedCount = suppressedCount;
+    header.level = level;
+    header.is_repeatsReport = is_repeatsReport;
+    header.timeNs = timeNs;
+
+    uint64_t writePos = ring.writePos.load(std::memory_order_relaxed);
+    const uint32_t offset = static_cast<uint32_t>(writePos % RING_SIZE);
+    // a message is never split at the end of the ring, the rest of it is skipped
+    const uint32_t skippedSize = RING_SIZE - offset < header.size ? RING_SIZE - offset : 0u;
+    if (writePos + skippedSize + header.size - ring.readPos.load(std::memory_order_acquire) > RING_SIZE) {
+        // a flood of messages: the thread empties the rings instead of dropping the message
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        drain();
+    }
+    if (skippedSize != 0u) {
+        if (skippedSize >= sizeof(ThreadRing::Header)) {
+            const ThreadRing::Header skipHeader{};
+            memcpy(ring.data.data() + offset, &skipHeader, sizeof(ThreadRing::Header));
+        }
+        writePos += skippedSize;
+    }
+    char* record = ring.data.data() + writePos % RING_SIZE;
+    memcpy(record, &header, sizeof(ThreadRing::Header));
+    memcpy(record + sizeof(ThreadRing::Header), text.data(), header.textLength);
+    ring.writePos.store(writePos + header.size, std::memory_order_release);
+}
+
+Logger::ThreadRing* Logger::acquireRing() {
+    std::lock_guard<std::mutex> lock(m_ringsMutex);
+    for (auto& pooled : m_rings) {
+        if (!pooled->is_owned) {
+            pooled->is_owned = true;
+            return pooled.get();
+        }
+    }
+    m_rings.push_back(std::make_unique<ThreadRing>());
+    m_rings.back()->index = static_cast<uint32_t>(m_rings.size() - 1u);
+    m_rings.back()->is_owned = true;
+    return m_rings.back().get();
+}
+
+void Logger::releaseRing(ThreadRing* ring) {
+    std::lock_guard<std::mutex> lock(m_ringsMutex);
+    ring->is_owned = false;
+}
+
+void Logger::drain(bool is_reportingRepeats) {
+    std::vector<ThreadRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        rings.reserve(m_rings.size());
+        for (const auto& ring : m_rings) {
+            rings.push_back(ring.get());
+        }
+    }
+
+    m_records.clear();
+    for (ThreadRing* ring : rings) {
+        uint64_t readPos = ring->readPos.load(std::memory_order_relaxed);
+        const uint64_t writePos = ring->writePos.load(std::memory_order_acquire);
+        while (readPos < writePos) {
+            const uint32_t offset = static_cast<uint32_t>(readPos % RING_SIZE);
+            if (isRingEndSkipped<ThreadRing::Header>(ring->data.data(), offset, RING_SIZE)) {
+                readPos += RING_SIZE - offset;
+                continue;
+            }
+            ThreadRing::Header header;
+            memcpy(&header, ring->data.data() + offset, sizeof(ThreadRing::Header));
+            Record& record = m_records.emplace_back();
+            record.timeNs = header.timeNs;
+            record.threadIndex = ring->index;
+            record.suppressedCount = header.suppressedCount;
+            record.level = header.level;
+            record.is_repeatsReport = header.is_repeatsReport;
+            record.text.assign(ring->data.data() + offset + sizeof(ThreadRing::Header), header.textLength);
+            readPos += header.size;
+        }
+        ring->readPos.store(readPos, std::memory_order_release);
+
+        if (!is_reportingRepeats) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(ring->repeatsMutex);
+        for (auto& repeated : ring->repeatedMessages) {
+            if (repeated.suppressedCount == 0u) {
+                continue;
+            }
+            Record& record = m_records.emplace_back();
+            record.timeNs = repeated.lastSuppressedNs;
+            record.threadIndex = ring->index;
+            record.suppressedCount = repeated.suppressedCount;
+            record.level = repeated.level;
+            record.is_repeatsReport = true;
+            record.text = repeated.text;
+            // the window goes on, the next repeats are counted from 0
+            repeated.suppressedCount = 0u;
+        }
+    }
+    if (m_records.empty()) {
+        return;
+    }
+
+    // the rings are ordered, the threads are interleaved by time
+    std::stable_sort(m_records.begin(), m_records.end(),
+                     [](const Record& left, const Record& right) { return left.timeNs < right.timeNs; });
+    m_output.clear();
+    char prefix[48];
+    for (const Record& record : m_records) {
+        snprintf(prefix, sizeof(prefix), "[%10.3f] %c t%u ", static_cast<double>(record.timeNs) * 1e-9,
+                 LEVEL_TAGS[static_cast<uint32_t>(record.level)], record.threadIndex);
+        m_output += prefix;
+        m_output += record.text;
+        if (record.is_repeatsReport) {
+            m_output += " (repeated " + std::to_string(record.suppressedCount) + " times)";
+        } else if (record.suppressedCount != 0u) {
+            m_output += " (" + std::to_string(record.suppressedCount) + " repeats suppressed)";
+        }
+        m_output += '\n';
+    }
+    writeToSinks(m_output);
+}
+
+void Logger::writeToSinks(const std::string& text) {
+    std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+    std::cout.flush();
+
+    if (!m_file) {
+        return;
+    }
+    if (m_fileBytes + text.size() > m_maxFileBytes && m_fileBytes != 0u) {
+        rotateFile();
+        if (!m_file) {
+            return;
+        }
+    }
+    m_file->write(text.data(), static_cast<std::streamsize>(text.size()));
+    m_file->flush();
+    m_fileBytes += text.size();
+}
+
+void Logger::rotateFile() {
+    m_file.reset();
+    std::error_code error;
+    // path.(n-1) is dropped, path.i becomes path.(i+1), path becomes path.1
+    for (uint32_t i = m_filesCount - 1u; i > 0u; --i) {
+        const std::string olderPath = m_filePath + '.' + std::to_string(i);
+        const std::string newerPath = i == 1u ? m_filePath : m_filePath + '.' + std::to_string(i - 1u);
+        std::filesystem::remove(olderPath, error);
+        std::filesystem::rename(newerPath, olderPath, error);
+    }
+    std::filesystem::remove(m_filePath, error);
+
+    m_file = std::make_unique<std::ofstream>(m_filePath, std::ios::binary | std::ios::trunc);
+    m_fileBytes = 0u;
+    if (!m_file->is_open()) {
+        m_file.reset();
+        std::cout << "logger: " << m_filePath << " is not writable, the file output is stopped\n";
+    }
+}
+
+bool Logger::setFile(const std::string& filePath, uint64_t maxFileBytes, uint32_t filesCount) {
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    m_filePath = filePath;
+    m_maxFileBytes = std::max<uint64_t>(maxFileBytes, 1u);
+    m_filesCount = std::max(filesCount, 1u);
+    // the file of the previous run is kept as path.1
+    rotateFile();
+    return m_file != nullptr;
+}
+
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(m_threadMutex);
+    while (!m_is_stopping) {
+        m_threadCondition.wait_for(lock, DRAIN_PERIOD, [this] { return m_is_stopping; });
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> drainLock(m_drainMutex);
+            drain();
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,978 @@
+#include "MemoryAllocator.h"
+#include "Utils.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace {
+static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return alignment > 1u ? (value + alignment - 1u) / alignment * alignment : value;
+}
+
+template <class T>
+inline uint64_t toKey(T handle) {
+    return (uint64_t)(handle);
+}
+
+inline double toMiB(VkDeviceSize bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+}  // namespace
+
+/// Two-Level Segregated Fit block: free ranges are kept in FL x SL lists (first level is the power of two,
+/// second level splits it into SL_COUNT linear ranges), bitmaps give a suitable list in O(1).
+/// Neighbour ranges are linked physically so that released ranges are merged immediately.
+class MemoryAllocator::TlsfBlock {
+public:
+    static constexpr uint32_t SL_BITS = 5u;
+    static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+    static constexpr uint32_t FL_COUNT = 64u - SL_BITS + 1u;
+
+    TlsfBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t id) : m_memory(memory), m_size(size), m_id(id) {
+        for (auto& heads : m_heads) {
+            heads.fill(INVALID_INDEX);
+        }
+        const uint32_t nodeId = createNode();
+        m_nodes[nodeId].offset = 0u;
+        m_nodes[nodeId].size = size;
+        insertFree(nodeId);
+    }
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset, uint32_t& outNodeId) {
+        /// Note: search for size + alignment - 1 so that any range of the found list fits after aligning its offset
+        const uint32_t nodeId = findFree(size + alignment - 1u);
+        if (nodeId == INVALID_INDEX) {
+            return false;
+        }
+        removeFree(nodeId);
+
+        const VkDeviceSize alignedOffset = alignUp(m_nodes[nodeId].offset, alignment);
+        const VkDeviceSize padding = alignedOffset - m_nodes[nodeId].offset;
+        if (padding > 0u) {
+            // the previous physical neighbour is never free (free neighbours are always merged)
+            const uint32_t padId = createNode();
+            Node& pad = m_nodes[padId];
+            Node& node = m_nodes[nodeId];
+            pad.offset = node.offset;
+            pad.size = padding;
+            pad.prevPhys = node.prevPhys;
+            pad.nextPhys = nodeId;
+            if (node.prevPhys != INVALID_INDEX) {
+                m_nodes[node.prevPhys].nextPhys = padId;
+            }
+            node.prevPhys = padId;
+            node.offset = alignedOffset;
+            node.size -= padding;
+            insertFree(padId);
+        }
+
+        const VkDeviceSize remainder = m_nodes[nodeId].size - size;
+        if (remainder > 0u) {
+            const uint32_t restId = createNode();
+            Node& rest = m_nodes[restId];
+            Node& node = m_nodes[nodeId];
+            rest.offset = node.offset + size;
+            rest.size = remainder;
+            rest.prevPhys = nodeId;
+            rest.nextPhys = node.nextPhys;
+            if (node.nextPhys != INVALID_INDEX) {
+                m_nodes[node.nextPhys].prevPhys = restId;
+            }
+            node.nextPhys = restId;
+            node.size = size;
+            insertFree(restId);
+        }
+
+        m_nodes[nodeId].isFree = false;
+        m_usedBytes += size;
+        ++m_allocationCount;
+
+        outOffset = m_nodes[nodeId].offset;
+        outNodeId = nodeId;
+        return true;
+    }
+
+    void free(uint32_t nodeId) {
+        assert(nodeId < m_nodes.size() && !m_nodes[nodeId].isFree);
+        m_usedBytes -= m_nodes[nodeId].size;
+        --m_allocationCount;
+
+        // merge with the previous physical neighbour
+        const uint32_t prevId = m_nodes[nodeId].prevPhys;
+        if (prevId != INVALID_INDEX && m_nodes[prevId].isFree) {
+            removeFree(prevId);
+            m_nodes[prevId].size += m_nodes[nodeId].size;
+            m_nodes[prevId].nextPhys = m_nodes[nodeId].nextPhys;
+            if (m_nodes[nodeId].nextPhys != INVALID_INDEX) {
+                m_nodes[m_nodes[nodeId].nextPhys].prevPhys = prevId;
+            }
+            releaseNode(nodeId);
+            nodeId = prevId;
+        }
+
+        // merge with the next physical neighbour
+        const uint32_t nextId = m_nodes[nodeId].nextPhys;
+        if (nextId != INVALID_INDEX && m_nodes[nextId].isFree) {
+            removeFree(nextId);
+            m_nodes[nodeId].size += m_nodes[nextId].size;
+            m_nodes[nodeId].nextPhys = m_nodes[nextId].nextPhys;
+            if (m_nodes[nextId].nextPhys != INVALID_INDEX) {
+                m_nodes[m_nodes[nextId].nextPhys].prevPhys = nodeId;
+            }
+            releaseNode(nextId);
+        }
+
+        insertFree(nodeId);
+    }
+
+    /// the block is mapped once, vkFreeMemory unmaps it
+    void* map(VkDevice device) {
+        if (!m_mappedData && vkMapMemory(device, m_memory, 0u, VK_WHOLE_SIZE, 0u, &m_mappedData) != VK_SUCCESS) {
+            m_mappedData = nullptr;
+        }
+        return m_mappedData;
+    }
+
+    VkDeviceMemory getMemory() const {
+        return m_memory;
+    }
+    VkDeviceSize getSize() const {
+        return m_size;
+    }
+    VkDeviceSize getUsedBytes() const {
+        return m_usedBytes;
+    }
+    uint32_t getId() const {
+        return m_id;
+    }
+    bool isEmpty() const {
+        return m_allocationCount == 0u;
+    }
+
+private:
+    struct Node {
+        VkDeviceSize offset{0u};
+        VkDeviceSize size{0u};
+        uint32_t prevPhys{INVALID_INDEX};
+        uint32_t nextPhys{INVALID_INDEX};
+        uint32_t prevFree{INVALID_INDEX};
+        uint32_t nextFree{INVALID_INDEX};
+        bool isFree{false};
+    };
+
+    static void mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl) {
+        if (size < SL_COUNT) {
+            fl = 0u;
+            sl = static_cast<uint32_t>(size);
+        } else {
+            const uint32_t msb = static_cast<uint32_t>(std::bit_width(size)) - 1u;
+            sl = static_cast<uint32_t>((size >> (msb - SL_BITS)) - SL_COUNT);
+            fl = msb - SL_BITS + 1u;
+        }
+    }
+
+    uint32_t findFree(VkDeviceSize size) const {
+        if (size >= SL_COUNT) {
+            /// round up to the next list so that every range of it is big enough (good fit)
+            const uint32_t msb = static_cast<uint32_t>(std::bit_width(size)) - 1u;
+            size += (VkDeviceSize{1u} << (msb - SL_BITS)) - 1u;
+        }
+        uint32_t fl, sl;
+        mapping(size, fl, sl);
+        if (fl >= FL_COUNT) {
+            return INVALID_INDEX;
+        }
+
+        uint32_t slMap = m_slBitmaps[fl] & (~0u << sl);
+        if (!slMap) {
+            if (fl + 1u >= FL_COUNT) {
+                return INVALID_INDEX;
+            }
+            const uint64_t flMap = m_flBitmap & (~0ull << (fl + 1u));
+            if (!flMap) {
+                return INVALID_INDEX;
+            }
+            fl = static_cast<uint32_t>(std::countr_zero(flMap));
+            slMap = m_slBitmaps[fl];
+        }
+        sl = static_cast<uint32_t>(std::countr_zero(slMap));
+        return m_heads[fl][sl];
+    }
+
+    void insertFree(uint32_t nodeId) {
+        uint32_t fl, sl;
+        mapping(m_nodes[nodeId].size, fl, sl);
+        Node& node = m_nodes[nodeId];
+        node.isFree = true;
+        node.prevFree = INVALID_INDEX;
+        node.nextFree = m_heads[fl][sl];
+        if (node.nextFree != INVALID_INDEX) {
+            m_nodes[node.nextFree].prevFree = nodeId;
+        }
+        m_heads[fl][sl] = nodeId;
+        m_slBitmaps[fl] |= 1u << sl;
+        m_flBitmap |= 1ull << fl;
+    }
+
+    void removeFree(uint32_t nodeId) {
+        uint32_t fl, sl;
+        mapping(m_nodes[nodeId].size, fl, sl);
+        Node& node = m_nodes[nodeId];
+        if (node.prevFree != INVALID_INDEX) {
+            m_nodes[node.prevFree].nextFree = node.nextFree;
+        } else {
+            m_heads[fl][sl] = node.nextFree;
+        }
+        if (node.nextFree != INVALID_INDEX) {
+            m_nodes[node.nextFree].prevFree = node.prevFree;
+        }
+        node.prevFree = node.nextFree = INVALID_INDEX;
+        node.isFree = false;
+
+        if (m_heads[fl][sl] == INVALID_INDEX) {
+            m_slBitmaps[fl] &= ~(1u << sl);
+            if (!m_slBitmaps[fl]) {
+                m_flBitmap &= ~(1ull << fl);
+            }
+        }
+    }
+
+    uint32_t createNode() {
+        if (!m_unusedNodes.empty()) {
+            const uint32_t nodeId = m_unusedNodes.back();
+            m_unusedNodes.pop_back();
+            m_nodes[nodeId] = Node{};
+            return nodeId;
+        }
+        m_nodes.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1u);
+    }
+
+    void releaseNode(uint32_t nodeId) {
+        m_nodes[nodeId] = Node{};
+        m_unusedNodes.push_back(nodeId);
+    }
+
+    VkDeviceMemory m_memory{nullptr};
+    VkDeviceSize m_size{0u};
+    uint32_t m_id{0u};
+    void* m_mappedData{nullptr};
+    VkDeviceSize m_usedBytes{0u};
+    uint32_t m_allocationCount{0u};
+    std::vector<Node> m_nodes{};
+    std::vector<uint32_t> m_unusedNodes{};
+    uint64_t m_flBitmap{0u};
+    std::array<uint32_t, FL_COUNT> m_slBitmaps{};
+    std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT> m_heads{};
+};
+
+/// Bump allocator, individual allocations are never reused: the arena rewinds once the last allocation is released
+/// (e.g. all size dependent attachments are destroyed in cleanupSwapChain and recreated afterwards)
+class MemoryAllocator::LinearBlock {
+public:
+    LinearBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t id) : m_memory(memory), m_size(size), m_id(id) {
+    }
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset) {
+        const VkDeviceSize alignedOffset = alignUp(m_head, alignment);
+        if (alignedOffset + size > m_size) {
+            return false;
+        }
+        m_head = alignedOffset + size;
+        m_usedBytes += size;
+        ++m_allocationCount;
+        outOffset = alignedOffset;
+        return true;
+    }
+
+    void free(VkDeviceSize size) {
+        assert(m_allocationCount > 0u);
+        m_usedBytes -= size;
+        if (--m_allocationCount == 0u) {
+            m_head = 0u;
+            m_usedBytes = 0u;
+        }
+    }
+
+    /// the block is mapped once, vkFreeMemory unmaps it
+    void* map(VkDevice device) {
+        if (!m_mappedData && vkMapMemory(device, m_memory, 0u, VK_WHOLE_SIZE, 0u, &m_mappedData) != VK_SUCCESS) {
+            m_mappedData = nullptr;
+        }
+        return m_mappedData;
+    }
+
+    VkDeviceMemory getMemory() const {
+        return m_memory;
+    }
+    VkDeviceSize getSize() const {
+        return m_size;
+    }
+    VkDeviceSize getUsedBytes() const {
+        return m_usedBytes;
+    }
+    uint32_t getId() const {
+        return m_id;
+    }
+    bool isEmpty() const {
+        return m_allocationCount == 0u;
+    }
+
+private:
+    VkDeviceMemory m_memory{nullptr};
+    VkDeviceSize m_size{0u};
+    uint32_t m_id{0u};
+    void* m_mappedData{nullptr};
+    VkDeviceSize m_head{0u};
+    VkDeviceSize m_usedBytes{0u};
+    uint32_t m_allocationCount{0u};
+};
+
+void MemoryAllocator::init(VkDevice device, VkPhysicalDevice physicalDevice, bool is_memoryBudgetEnabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(device && physicalDevice);
+    m_device = device;
+    m_physicalDevice = physicalDevice;
+    m_is_memoryBudgetEnabled = is_memoryBudgetEnabled;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memProperties);
+    for (uint32_t i = 0u; i < m_memProperties.memoryHeapCount; ++i) {
+        m_heapStats[i].size = m_memProperties.memoryHeaps[i].size;
+        m_heapStats[i].is_deviceLocal = (m_memProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0u;
+    }
+    Utils::printLog(INFO_PARAM, "memory allocator: ", m_memProperties.memoryTypeCount, " memory types, ",
+                    m_memProperties.memoryHeapCount, " heaps, block size ", toMiB(BLOCK_SIZE), " MiB");
+}
+
+void MemoryAllocator::destroy() {
+    if (!isInitialized()) {
+        return;
+    }
+    printStats();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_allocations.empty()) {
+        Utils::printLog(INFO_PARAM, "memory allocator: ", m_allocations.size(), " allocations were not released");
+    }
+    for (const auto& [resource, record] : m_allocations) {
+        if (record.first.strategy == Strategy::DEDICATED) {
+            vkFreeMemory(m_device, record.first.memory, nullptr);
+        }
+    }
+    m_allocations.clear();
+    // the owners free their memory
+    if (!m_externalMemories.empty()) {
+        Utils::printLog(INFO_PARAM, "memory allocator: ", m_externalMemories.size(), " registered memories were not unregistered");
+    }
+    m_externalMemories.clear();
+
+    for (auto& pools : m_pools) {
+        for (auto& pool : pools) {
+            for (auto& block : pool.tlsfBlocks) {
+                vkFreeMemory(m_device, block->getMemory(), nullptr);
+            }
+            for (auto& block : pool.linearBlocks) {
+                vkFreeMemory(m_device, block->getMemory(), nullptr);
+            }
+            pool.tlsfBlocks.clear();
+            pool.linearBlocks.clear();
+        }
+    }
+    m_stats.fill(Stats{});
+    m_heapStats.fill(HeapStats{});
+    m_is_overBudget.fill(false);
+    m_device = nullptr;
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0u; i < m_memProperties.memoryTypeCount; ++i) {
+        if ((memoryTypeBits & (1u << i)) && (m_memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    Utils::printLog(ERROR_PARAM, "failed to find suitable memory type!");
+    return INVALID_INDEX;
+}
+
+void MemoryAllocator::updatePeak(uint32_t memoryTypeIndex) {
+    auto& stats = m_stats[memoryTypeIndex];
+    stats.peakBytes = std::max(stats.peakBytes, stats.blockBytes + stats.dedicatedBytes + stats.externalBytes);
+}
+
+void MemoryAllocator::addHeapBytes(uint32_t memoryTypeIndex, VkDeviceSize size) {
+    const uint32_t heapIndex = m_memProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    auto& heap = m_heapStats[heapIndex];
+    heap.liveBytes += size;
+    heap.peakBytes = std::max(heap.peakBytes, heap.liveBytes);
+    updatePeak(memoryTypeIndex);
+    checkBudget(heapIndex);
+}
+
+void MemoryAllocator::removeHeapBytes(uint32_t memoryTypeIndex, VkDeviceSize size) {
+    m_heapStats[m_memProperties.memoryTypes[memoryTypeIndex].heapIndex].liveBytes -= size;
+}
+
+void MemoryAllocator::addCategoryBytes(const Allocation& allocation) {
+    const uint32_t heapIndex = m_memProperties.memoryTypes[allocation.memoryTypeIndex].heapIndex;
+    auto& category = m_heapStats[heapIndex].categories[static_cast<size_t>(allocation.category)];
+    ++category.count;
+    category.liveBytes += allocation.size;
+    category.peakBytes = std::max(category.peakBytes, category.liveBytes);
+}
+
+void MemoryAllocator::removeCategoryBytes(const Allocation& allocation) {
+    const uint32_t heapIndex = m_memProperties.memoryTypes[allocation.memoryTypeIndex].heapIndex;
+    auto& category = m_heapStats[heapIndex].categories[static_cast<size_t>(allocation.category)];
+    --category.count;
+    category.liveBytes -= allocation.size;
+}
+
+void MemoryAllocator::queryBudget(std::vector<HeapStats>& heapStats) const {
+    for (auto& heap : heapStats) {
+        heap.budgetBytes = heap.size;
+        heap.usageBytes = heap.liveBytes;
+    }
+    if (!m_is_memoryBudgetEnabled) {
+        return;
+    }
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 memProperties{};
+    memProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memProperties.pNext = &budgetProperties;
+    vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &memProperties);
+    for (uint32_t i = 0u; i < heapStats.size(); ++i) {
+        heapStats[i].budgetBytes = budgetProperties.heapBudget[i];
+        heapStats[i].usageBytes = budgetProperties.heapUsage[i];
+    }
+}
+
+void MemoryAllocator::checkBudget(uint32_t heapIndex) {
+    std::vector<HeapStats> heapStats(m_heapStats.begin(), m_heapStats.begin() + m_memProperties.memoryHeapCount);
+    queryBudget(heapStats);
+    const auto& heap = heapStats[heapIndex];
+    const bool is_overBudget =
+        static_cast<double>(heap.usageBytes) > BUDGET_WARNING_RATIO * static_cast<double>(heap.budgetBytes);
+    if (is_overBudget && !m_is_overBudget[heapIndex]) {
+        Utils::printLog(WARNING_PARAM, "memory heap ", heapIndex, ": ", toMiB(heap.usageBytes), " MiB used of the budget ",
+                        toMiB(heap.budgetBytes), " MiB");
+    }
+    m_is_overBudget[heapIndex] = is_overBudget;
+}
+
+VkResult MemoryAllocator::allocateDedicated(const VkMemoryRequirements& memRequirements, uint32_t memoryTypeIndex,
+                                            const VkMemoryDedicatedAllocateInfo& dedicatedInfo, Allocation& outAllocation) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext = &dedicatedInfo;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkDeviceMemory memory = nullptr;
+    const VkResult res = vkAllocateMemory(m_device, &allocInfo, nullptr, &memory);
+    if (res != VK_SUCCESS) {
+        return res;
+    }
+
+    outAllocation.memory = memory;
+    outAllocation.offset = 0u;
+    outAllocation.size = memRequirements.size;
+    outAllocation.memoryTypeIndex = memoryTypeIndex;
+    outAllocation.blockId = 0u;
+    outAllocation.strategy = Strategy::DEDICATED;
+
+    auto& stats = m_stats[memoryTypeIndex];
+    ++stats.dedicatedCount;
+    stats.dedicatedBytes += memRequirements.size;
+    addHeapBytes(memoryTypeIndex, memRequirements.size);
+
+    return res;
+}
+
+VkResult MemoryAllocator::allocate(const VkMemoryRequirements& memRequirements, VkMemoryPropertyFlags properties, Usage usage,
+                                   PoolKind kind, const VkMemoryDedicatedAllocateInfo& dedicatedInfo, bool isDedicatedPreferred,
+                                   Allocation& outAllocation) {
+    assert(isInitialized());
+    const uint32_t memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+
+    if (usage == Usage::DEDICATED || isDedicatedPreferred || memRequirements.size >= DEDICATED_THRESHOLD) {
+        return allocateDedicated(memRequirements, memoryTypeIndex, dedicatedInfo, outAllocation);
+    }
+
+    /// Note: don't grab more than 1/8 of a small heap (integrated GPUs, lavapipe) for a single block
+    const uint32_t heapIndex = m_memProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    const VkDeviceSize blockSize =
+        std::max(std::min(BLOCK_SIZE, m_memProperties.memoryHeaps[heapIndex].size / 8u), memRequirements.size);
+
+    auto& pool = m_pools[memoryTypeIndex][kind];
+    auto& stats = m_stats[memoryTypeIndex];
+
+    outAllocation.memoryTypeIndex = memoryTypeIndex;
+    outAllocation.size = memRequirements.size;
+
+    auto createBlockMemory = [&](VkDeviceMemory& memory) {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = blockSize;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+        const VkResult res = vkAllocateMemory(m_device, &allocInfo, nullptr, &memory);
+        if (res == VK_SUCCESS) {
+            ++stats.blockCount;
+            stats.blockBytes += blockSize;
+            addHeapBytes(memoryTypeIndex, blockSize);
+        }
+        return res;
+    };
+
+    if (usage == Usage::TRANSIENT) {
+        outAllocation.strategy = Strategy::LINEAR;
+        for (auto& block : pool.linearBlocks) {
+            if (block->allocate(memRequirements.size, memRequirements.alignment, outAllocation.offset)) {
+                outAllocation.memory = block->getMemory();
+                outAllocation.blockId = block->getId();
+                stats.usedBytes += memRequirements.size;
+                ++stats.allocationCount;
+                return VK_SUCCESS;
+            }
+        }
+
+        VkDeviceMemory memory = nullptr;
+        if (createBlockMemory(memory) != VK_SUCCESS) {
+            // out of memory for a new arena, try the exact size
+            return allocateDedicated(memRequirements, memoryTypeIndex, dedicatedInfo, outAllocation);
+        }
+        auto& block = pool.linearBlocks.emplace_back(std::make_unique<LinearBlock>(memory, blockSize, m_nextBlockId++));
+        const bool isAllocated = block->allocate(memRequirements.size, memRequirements.alignment, outAllocation.offset);
+        assert(isAllocated);
+        outAllocation.memory = block->getMemory();
+        outAllocation.blockId = block->getId();
+    } else {
+        outAllocation.strategy = Strategy::TLSF;
+        for (auto& block : pool.tlsfBlocks) {
+            if (block->allocate(memRequirements.size, memRequirements.alignment, outAllocation.offset, outAllocation.nodeId)) {
+                outAllocation.memory = block->getMemory();
+                outAllocation.blockId = block->getId();
+                stats.usedBytes += memRequirements.size;
+                ++stats.allocationCount;
+                return VK_SUCCESS;
+            }
+        }
+
+        VkDeviceMemory memory = nullptr;
+        if (createBlockMemory(memory) != VK_SUCCESS) {
+            return allocateDedicated(memRequirements, memoryTypeIndex, dedicatedInfo, outAllocation);
+        }
+        auto& block = pool.tlsfBlocks.emplace_back(std::make_unique<TlsfBlock>(memory, blockSize, m_nextBlockId++));
+        const bool isAllocated =
+            block->allocate(memRequirements.size, memRequirements.alignment, outAllocation.offset, outAllocation.nodeId);
+        assert(isAllocated);
+        outAllocation.memory = block->getMemory();
+        outAllocation.blockId = block->getId();
+    }
+
+    stats.usedBytes += memRequirements.size;
+    ++stats.allocationCount;
+    return VK_SUCCESS;
+}
+
+VkResult MemoryAllocator::allocateBuffer(VkBuffer buffer, VkBufferUsageFlags bufferUsage, VkMemoryPropertyFlags properties,
+                                         Usage usage, Category category, Allocation& outAllocation) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(buffer);
+
+    VkMemoryDedicatedRequirements dedicatedRequirements{};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+    VkMemoryRequirements2 memRequirements{};
+    memRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    memRequirements.pNext = &dedicatedRequirements;
+    VkBufferMemoryRequirementsInfo2 requirementsInfo{};
+    requirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    requirementsInfo.buffer = buffer;
+    vkGetBufferMemoryRequirements2(m_device, &requirementsInfo, &memRequirements);
+
+    VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+    dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    dedicatedInfo.buffer = buffer;
+
+    const bool isDedicatedPreferred =
+        dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+    if (usage == Usage::AUTO) {
+        usage = Usage::LONG_LIVED;
+    }
+
+    VkResult res = allocate(memRequirements.memoryRequirements, properties, usage, LINEAR_RESOURCES, dedicatedInfo,
+                            isDedicatedPreferred, outAllocation);
+    if (res != VK_SUCCESS) {
+        return res;
+    }
+
+    outAllocation.category = category == Category::AUTO ? getBufferCategory(bufferUsage, properties) : category;
+    /// Note: the requested flags matter, not the flags of the chosen type (on UMA every type is host visible)
+    if ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0u) {
+        outAllocation.mappedData = map(outAllocation, LINEAR_RESOURCES);
+    }
+    addCategoryBytes(outAllocation);
+    m_allocations.insert_or_assign(toKey(buffer), std::make_pair(outAllocation, LINEAR_RESOURCES));
+    if ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0u && !outAllocation.mappedData) {
+        free(toKey(buffer));
+        outAllocation = Allocation{};
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+    return vkBindBufferMemory(m_device, buffer, outAllocation.memory, outAllocation.offset);
+}
+
+VkResult MemoryAllocator::allocateImage(VkImage image, VkImageTiling tiling, VkImageUsageFlags imageUsage,
+                                        VkMemoryPropertyFlags properties, Usage usage, Category category,
+                                        Allocation& outAllocation) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(image);
+
+    VkMemoryDedicatedRequirements dedicatedRequirements{};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+    VkMemoryRequirements2 memRequirements{};
+    memRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    memRequirements.pNext = &dedicatedRequirements;
+    VkImageMemoryRequirementsInfo2 requirementsInfo{};
+    requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+    requirementsInfo.image = image;
+    vkGetImageMemoryRequirements2(m_device, &requirementsInfo, &memRequirements);
+
+    VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+    dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    dedicatedInfo.image = image;
+
+    const bool isDedicatedPreferred =
+        dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+    if (usage == Usage::AUTO) {
+        const bool isAttachment =
+            (imageUsage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) != 0u;
+        usage = isAttachment ? Usage::TRANSIENT : Usage::LONG_LIVED;
+    }
+
+    const PoolKind kind = tiling == VK_IMAGE_TILING_OPTIMAL ? OPTIMAL_IMAGES : LINEAR_RESOURCES;
+    VkResult res =
+        allocate(memRequirements.memoryRequirements, properties, usage, kind, dedicatedInfo, isDedicatedPreferred, outAllocation);
+    if (res != VK_SUCCESS) {
+        return res;
+    }
+
+    outAllocation.category = category == Category::AUTO ? getImageCategory(imageUsage) : category;
+    addCategoryBytes(outAllocation);
+    res = vkBindImageMemory(m_device, image, outAllocation.memory, outAllocation.offset);
+    m_allocations.insert_or_assign(toKey(image), std::make_pair(outAllocation, kind));
+    return res;
+}
+
+bool MemoryAllocator::free(uint64_t resource) {
+    auto it = m_allocations.find(resource);
+    if (it == m_allocations.end()) {
+        return false;
+    }
+
+    const auto& [allocation, kind] = it->second;
+    auto& stats = m_stats[allocation.memoryTypeIndex];
+    auto& pool = m_pools[allocation.memoryTypeIndex][kind];
+
+    switch (allocation.strategy) {
+        case Strategy::TLSF: {
+            auto block = std::find_if(pool.tlsfBlocks.begin(), pool.tlsfBlocks.end(),
+                                      [&](const auto& b) { return b->getId() == allocation.blockId; });
+            assert(block != pool.tlsfBlocks.end());
+            (*block)->free(allocation.nodeId);
+            stats.usedBytes -= allocation.size;
+            --stats.allocationCount;
+            break;
+        }
+        case Strategy::LINEAR: {
+            auto block = std::find_if(pool.linearBlocks.begin(), pool.linearBlocks.end(),
+                                      [&](const auto& b) { return b->getId() == allocation.blockId; });
+            assert(block != pool.linearBlocks.end());
+            (*block)->free(allocation.size);
+            stats.usedBytes -= allocation.size;
+            --stats.allocationCount;
+            break;
+        }
+        case Strategy::DEDICATED:
+            vkFreeMemory(m_device, allocation.memory, nullptr);
+            --stats.dedicatedCount;
+            stats.dedicatedBytes -= allocation.size;
+            removeHeapBytes(allocation.memoryTypeIndex, allocation.size);
+            break;
+    }
+
+    removeCategoryBytes(allocation);
+    m_allocations.erase(it);
+    return true;
+}
+
+void* MemoryAllocator::map(const Allocation& allocation, PoolKind kind) {
+    void* data = nullptr;
+    auto& pool = m_pools[allocation.memoryTypeIndex][kind];
+    switch (allocation.strategy) {
+        case Strategy::TLSF: {
+            auto block = std::find_if(pool.tlsfBlocks.begin(), pool.tlsfBlocks.end(),
+                                      [&](const auto& b) { return b->getId() == allocation.blockId; });
+            assert(block != pool.tlsfBlocks.end());
+            data = (*block)->map(m_device);
+            break;
+        }
+        case Strategy::LINEAR: {
+            auto block = std::find_if(pool.linearBlocks.begin(), pool.linearBlocks.end(),
+                                      [&](const auto& b) { return b->getId() == allocation.blockId; });
+            assert(block != pool.linearBlocks.end());
+            data = (*block)->map(m_device);
+            break;
+        }
+        case Strategy::DEDICATED:
+            if (vkMapMemory(m_device, allocation.memory, 0u, VK_WHOLE_SIZE, 0u, &data) != VK_SUCCESS) {
+                data = nullptr;
+            }
+            break;
+    }
+    return data ? static_cast<char*>(data) + allocation.offset : nullptr;
+}
+
+void* MemoryAllocator::getMappedData(VkBuffer buffer) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_allocations.find(toKey(buffer));
+    return it != m_allocations.end() ? it->second.first.mappedData : nullptr;
+}
+
+bool MemoryAllocator::freeBuffer(VkBuffer buffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return buffer ? free(toKey(buffer)) : false;
+}
+
+bool MemoryAllocator::freeImage(VkImage image) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return image ? free(toKey(image)) : false;
+}
+
+void MemoryAllocator::registerMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex, Category category) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(memory && memoryTypeIndex < m_memProperties.memoryTypeCount && category != Category::AUTO);
+
+    Allocation allocation;
+    allocation.memory = memory;
+    allocation.size = size;
+    allocation.memoryTypeIndex = memoryTypeIndex;
+    allocation.category = category;
+    m_externalMemories.insert_or_assign(toKey(memory), allocation);
+
+    m_stats[memoryTypeIndex].externalBytes += size;
+    addHeapBytes(memoryTypeIndex, size);
+    addCategoryBytes(allocation);
+}
+
+bool MemoryAllocator::unregisterMemory(VkDeviceMemory memory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_externalMemories.find(toKey(memory));
+    if (it == m_externalMemories.end()) {
+        return false;
+    }
+
+    const Allocation& allocation = it->second;
+    m_stats[allocation.memoryTypeIndex].externalBytes -= allocation.size;
+    removeHeapBytes(allocation.memoryTypeIndex, allocation.size);
+    removeCategoryBytes(allocation);
+    m_externalMemories.erase(it);
+    return true;
+}
+
+MemoryAllocator::Category MemoryAllocator::getBufferCategory(VkBufferUsageFlags bufferUsage, VkMemoryPropertyFlags properties) {
+    if (bufferUsage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+        return Category::UNIFORM;
+    }
+    if (bufferUsage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT)) {
+        // the meshes are uploaded to device local memory, the instances are written every frame
+        return (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ? Category::INSTANCE : Category::MESH;
+    }
+    if (bufferUsage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT) {
+        return Category::STAGING;
+    }
+    return Category::OTHER;
+}
+
+MemoryAllocator::Category MemoryAllocator::getImageCategory(VkImageUsageFlags imageUsage) {
+    constexpr VkImageUsageFlags TARGET_USAGE =
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+    return (imageUsage & TARGET_USAGE) ? Category::ATTACHMENT : Category::TEXTURE;
+}
+
+const char* MemoryAllocator::getCategoryName(Category category) {
+    switch (category) {
+        case Category::AUTO:
+            return "auto";
+        case Category::ATTACHMENT:
+            return "attachment";
+        case Category::TEXTURE:
+            return "texture";
+        case Category::MESH:
+            return "mesh";
+        case Category::INSTANCE:
+            return "instance";
+        case Category::STAGING:
+            return "staging";
+        case Category::UNIFORM:
+            return "uniform";
+        case Category::OTHER:
+        case Category::MAX:
+            break;
+    }
+    return "other";
+}
+
+MemoryAllocator::Stats MemoryAllocator::getStats(uint32_t memoryTypeIndex) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(memoryTypeIndex < VK_MAX_MEMORY_TYPES);
+    return m_stats[memoryTypeIndex];
+}
+
+bool MemoryAllocator::getDeviceLocalBudget(VkDeviceSize& outBudget, VkDeviceSize& outUsage) const {
+    if (!m_is_memoryBudgetEnabled) {
+        return false;
+    }
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 memProperties{};
+    memProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memProperties.pNext = &budgetProperties;
+    vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &memProperties);
+
+    outBudget = 0u;
+    outUsage = 0u;
+    for (uint32_t i = 0u; i < memProperties.memoryProperties.memoryHeapCount; ++i) {
+        if (memProperties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            outBudget += budgetProperties.heapBudget[i];
+            outUsage += budgetProperties.heapUsage[i];
+        }
+    }
+
+    return true;
+}
+
+MemoryAllocator::Stats MemoryAllocator::getTotalStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats total{};
+    for (const auto& stats : m_stats) {
+        total.blockCount += stats.blockCount;
+        total.allocationCount += stats.allocationCount;
+        total.dedicatedCount += stats.dedicatedCount;
+        total.blockBytes += stats.blockBytes;
+        total.usedBytes += stats.usedBytes;
+        total.dedicatedBytes += stats.dedicatedBytes;
+        total.externalBytes += stats.externalBytes;
+        total.peakBytes += stats.peakBytes;
+    }
+    return total;
+}
+
+std::vector<MemoryAllocator::HeapStats> MemoryAllocator::getHeapStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<HeapStats> heapStats(m_heapStats.begin(), m_heapStats.begin() + m_memProperties.memoryHeapCount);
+    queryBudget(heapStats);
+    return heapStats;
+}
+
+void MemoryAllocator::printStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t i = 0u; i < m_memProperties.memoryTypeCount; ++i) {
+        const auto& stats = m_stats[i];
+        if (stats.peakBytes == 0u) {
+            continue;
+        }
+        Utils::printLog(INFO_PARAM, "memory type ", i, " (heap ", m_memProperties.memoryTypes[i].heapIndex, ", flags ",
+                        m_memProperties.memoryTypes[i].propertyFlags, "): blocks ", stats.blockCount, " / ",
+                        toMiB(stats.blockBytes), " MiB, used ", toMiB(stats.usedBytes), " MiB in ", stats.allocationCount,
+                        " allocations, dedicated ", stats.dedicatedCount, " / ", toMiB(stats.dedicatedBytes), " MiB, external ",
+                        toMiB(stats.externalBytes), " MiB, peak ", toMiB(stats.peakBytes), " MiB");
+    }
+
+    std::vector<HeapStats> heapStats(m_heapStats.begin(), m_heapStats.begin() + m_memProperties.memoryHeapCount);
+    queryBudget(heapStats);
+    for (uint32_t i = 0u; i < heapStats.size(); ++i) {
+        const auto& heap = heapStats[i];
+        if (heap.peakBytes == 0u) {
+            continue;
+        }
+        Utils::printLog(INFO_PARAM, "memory heap ", i, heap.is_deviceLocal ? " (device local)" : "", ": live ",
+                        toMiB(heap.liveBytes), " MiB, peak ", toMiB(heap.peakBytes), " MiB, usage ", toMiB(heap.usageBytes),
+                        " MiB of the budget ", toMiB(heap.budgetBytes), " MiB");
+        for (uint32_t category = 0u; category < heap.categories.size(); ++category) {
+            const auto& categoryStats = heap.categories[category];
+            if (categoryStats.peakBytes == 0u) {
+                continue;
+            }
+            Utils::printLog(INFO_PARAM, "    ", getCategoryName(static_cast<Category>(category)), ": live ",
+                            toMiB(categoryStats.liveBytes), " MiB in ", categoryStats.count, " resources, peak ",
+                            toMiB(categoryStats.peakBytes), " MiB");
+        }
+    }
+}
+
+std::vector<MemoryAllocator::DefragCandidate> MemoryAllocator::getDefragCandidates(float maxBlockOccupancy) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<DefragCandidate> candidates;
+
+    for (const auto& [resource, record] : m_allocations) {
+        const auto& [allocation, kind] = record;
+        if (allocation.strategy != Strategy::TLSF) {
+            continue;
+        }
+        const auto& blocks = m_pools[allocation.memoryTypeIndex][kind].tlsfBlocks;
+        // a single block can't be emptied into another one
+        if (blocks.size() < 2u) {
+            continue;
+        }
+        auto block = std::find_if(blocks.begin(), blocks.end(), [&](const auto& b) { return b->getId() == allocation.blockId; });
+        assert(block != blocks.end());
+        const float occupancy = static_cast<float>((*block)->getUsedBytes()) / static_cast<float>((*block)->getSize());
+        if (occupancy <= maxBlockOccupancy) {
+            candidates.push_back({resource, allocation.memoryTypeIndex, allocation.blockId, allocation.size, occupancy});
+        }
+    }
+
+    // the emptiest blocks first
+    std::sort(candidates.begin(), candidates.end(),
+              [](const DefragCandidate& a, const DefragCandidate& b) { return a.blockOccupancy < b.blockOccupancy; });
+    return candidates;
+}
+
+VkDeviceSize MemoryAllocator::releaseEmptyBlocks() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    VkDeviceSize releasedBytes = 0u;
+
+    auto release = [&](auto& blocks, uint32_t memoryTypeIndex) {
+        Stats& stats = m_stats[memoryTypeIndex];
+        auto it = std::remove_if(blocks.begin(), blocks.end(), [&](const auto& block) {
+            if (!block->isEmpty()) {
+                return false;
+            }
+            vkFreeMemory(m_device, block->getMemory(), nullptr);
+            releasedBytes += block->getSize();
+            stats.blockBytes -= block->getSize();
+            --stats.blockCount;
+            removeHeapBytes(memoryTypeIndex, block->getSize());
+            return true;
+        });
+        blocks.erase(it, blocks.end());
+    };
+
+    for (uint32_t i = 0u; i < m_memProperties.memoryTypeCount; ++i) {
+        for (auto& pool : m_pools[i]) {
+            release(pool.tlsfBlocks, i);
+            release(pool.linearBlocks, i);
+        }
+    }
+
+    if (releasedBytes > 0u) {
+        Utils::printLog(INFO_PARAM, "memory allocator: released ", toMiB(releasedBytes), " MiB of empty blocks");
+    }
+    return releasedBytes;
+}
@@ -0,0 +1,235 @@
+#include "PipelineCacheStore.h"
+#include "Utils.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+constexpr std::string_view CACHE_FILE_EXTENSION{".cache"};
+constexpr std::string_view TEMP_FILE_EXTENSION{".tmp"};
+
+double getElapsedMs(std::chrono::steady_clock::time_point startTime) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+}  // namespace
+
+void PipelineCacheStore::init(const VkPhysicalDeviceProperties& properties, uint64_t shadersHash) {
+    m_header = FileHeader{};
+    m_header.vendorID = properties.vendorID;
+    m_header.deviceID = properties.deviceID;
+    m_header.driverVersion = properties.driverVersion;
+    memcpy(m_header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    m_header.shadersHash = shadersHash;
+
+    // <vendorID><deviceID>_<pipelineCacheUUID>_<driverVersion>_<shadersHash>.cache
+    char hex[20];
+    snprintf(hex, sizeof(hex), "%04x%04x_", m_header.vendorID & 0xFFFFu, m_header.deviceID & 0xFFFFu);
+    std::string fileName{hex};
+    for (uint32_t i = 0u; i < VK_UUID_SIZE; ++i) {
+        snprintf(hex, sizeof(hex), "%02x", m_header.pipelineCacheUUID[i]);
+        fileName += hex;
+    }
+    snprintf(hex, sizeof(hex), "_%08x_", m_header.driverVersion);
+    fileName += hex;
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(shadersHash));
+    fileName += hex;
+    fileName += CACHE_FILE_EXTENSION;
+
+    m_filePath = Utils::formPath(m_cacheDir, fileName);
+}
+
+bool PipelineCacheStore::load(std::vector<char>& outData) {
+    assert(!m_filePath.empty());
+    const auto startTime = std::chrono::steady_clock::now();
+    outData.clear();
+    m_stats.is_loaded = false;
+    m_stats.loadedBytes = 0u;
+
+    std::ifstream file(m_filePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        Utils::printLog(INFO_PARAM, "pipeline cache not found ", m_filePath);
+        m_stats.loadTimeMs = getElapsedMs(startTime);
+        return false;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    FileHeader header;
+    if (fileSize < sizeof(FileHeader) || !file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader)) ||
+        memcmp(header.identifier, m_header.identifier, sizeof(header.identifier)) != 0 || header.version != FORMAT_VERSION ||
+        header.vendorID != m_header.vendorID || header.deviceID != m_header.deviceID ||
+        header.driverVersion != m_header.driverVersion ||
+        memcmp(header.pipelineCacheUUID, m_header.pipelineCacheUUID, VK_UUID_SIZE) != 0 ||
+        header.shadersHash != m_header.shadersHash || header.dataSize != fileSize - sizeof(FileHeader)) {
+        Utils::printLog(INFO_PARAM, "outdated pipeline cache ", m_filePath);
+        m_stats.loadTimeMs = getElapsedMs(startTime);
+        return false;
+    }
+
+    outData.resize(static_cast<size_t>(header.dataSize));
+    if (!file.read(outData.data(), outData.size()) ||
+        Utils::hashBytes(Utils::HASH_OFFSET_BASIS, outData.data(), outData.size()) != header.dataHash || !isCompatible(outData)) {
+        Utils::printLog(INFO_PARAM, "broken pipeline cache ", m_filePath);
+        outData.clear();
+        m_stats.loadTimeMs = getElapsedMs(startTime);
+        return false;
+    }
+
+    m_stats.is_loaded = true;
+    m_stats.loadedBytes = outData.size();
+    m_stats.loadTimeMs = getElapsedMs(startTime);
+
+    return true;
+}
+
+bool PipelineCacheStore::save(const std::vector<char>& data) {
+    assert(!m_filePath.empty());
+    const auto startTime = std::chrono::steady_clock::now();
+    m_stats.savedBytes = 0u;
+
+    // the driver may return an empty or a foreign blob (e.g. no pipelines were created), keep the previous file then
+    if (data.empty() || !isCompatible(data)) {
+        Utils::printLog(INFO_PARAM, "pipeline cache data is not stored ", m_filePath);
+        m_stats.saveTimeMs = getElapsedMs(startTime);
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_cacheDir, error);
+
+    FileHeader header = m_header;
+    header.dataSize = data.size();
+    header.dataHash = Utils::hashBytes(Utils::HASH_OFFSET_BASIS, data.data(), data.size());
+
+    // rename publishes the complete file only
+    const std::string tempPath = m_filePath + std::string{TEMP_FILE_EXTENSION};
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open()) {
+            Utils::printLog(INFO_PARAM, "pipeline cache is not writable: ", tempPath);
+            m_stats.saveTimeMs = getElapsedMs(startTime);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        file.write(data.data(), data.size());
+        file.flush();
+
+        if (!file) {
+            Utils::printLog(INFO_PARAM, "failed to write pipeline cache ", tempPath);
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            m_stats.saveTimeMs = getElapsedMs(startTime);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, m_filePath, error);
+    if (error) {
+        Utils::printLog(INFO_PARAM, "failed to store pipeline cache ", m_filePath, ": ", error.message());
+        std::filesystem::remove(tempPath, error);
+        m_stats.saveTimeMs = getElapsedMs(startTime);
+        return false;
+    }
+
+    prune();
+
+    m_stats.savedBytes = sizeof(FileHeader) + data.size();
+    m_stats.saveTimeMs = getElapsedMs(startTime);
+
+    return true;
+}
+
+uint64_t PipelineCacheStore::hashShaders(std::string_view shadersDir) {
+    std::error_code error;
+    std::vector<std::filesystem::path> shaderPaths;
+    for (const auto& entry : std::filesystem::directory_iterator(shadersDir, error)) {
+        // the archive may be shipped without the .spv files
+        const auto extension = entry.path().extension();
+        if (entry.is_regular_file(error) && (extension == ".spv" || extension == ".pak")) {
+            shaderPaths.push_back(entry.path());
+        }
+    }
+    // directory order is not specified
+    std::sort(shaderPaths.begin(), shaderPaths.end());
+
+    uint64_t hash = Utils::HASH_OFFSET_BASIS;
+    std::vector<char> code;
+    for (const auto& shaderPath : shaderPaths) {
+        const std::string fileName = shaderPath.filename().string();
+        hash = Utils::hashBytes(hash, fileName.data(), fileName.size());
+
+        std::ifstream file(shaderPath, std::ios::ate | std::ios::binary);
+        if (!file.is_open()) {
+            continue;
+        }
+        code.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(code.data(), code.size());
+        hash = Utils::hashBytes(hash, code.data(), code.size());
+    }
+
+    return hash;
+}
+
+bool PipelineCacheStore::isCompatible(const std::vector<char>& data) const {
+    VkPipelineCacheHeaderVersionOne cacheHeader{};
+    if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) {
+        return false;
+    }
+    memcpy(&cacheHeader, data.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+
+    return cacheHeader.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+           cacheHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && cacheHeader.vendorID == m_header.vendorID &&
+           cacheHeader.deviceID == m_header.deviceID &&
+           memcmp(cacheHeader.pipelineCacheUUID, m_header.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCacheStore::prune() {
+    if (m_maxBytes == 0u) {
+        return;
+    }
+
+    struct CacheFile {
+        std::filesystem::path path;
+        std::filesystem::file_time_type writeTime;
+        uint64_t size;
+    };
+
+    std::error_code error;
+    const auto currentFileName = std::filesystem::path(m_filePath).filename();
+    std::vector<CacheFile> cacheFiles;
+    uint64_t totalSize = 0u;
+    for (const auto& entry : std::filesystem::directory_iterator(m_cacheDir, error)) {
+        if (!entry.is_regular_file(error) || entry.path().extension() != CACHE_FILE_EXTENSION) {
+            continue;
+        }
+        const uint64_t size = entry.file_size(error);
+        totalSize += size;
+        if (entry.path().filename() != currentFileName) {
+            cacheFiles.push_back({entry.path(), entry.last_write_time(error), size});
+        }
+    }
+
+    if (totalSize <= m_maxBytes) {
+        return;
+    }
+
+    // the least recently written first, the file of the current key is never removed
+    std::sort(cacheFiles.begin(), cacheFiles.end(),
+              [](const CacheFile& a, const CacheFile& b) { return a.writeTime < b.writeTime; });
+    for (const auto& cacheFile : cacheFiles) {
+        if (totalSize <= m_maxBytes) {
+            break;
+        }
+        if (std::filesystem::remove(cacheFile.path, error)) {
+            totalSize -= cacheFile.size;
+            ++m_stats.prunedFilesCount;
+        }
+    }
+}
@@ -1,25 +1,159 @@
 #include "PipelineCreatorBase.h"
+#include "ShaderRegistry.h"
 #include "Utils.h"
 
-void PipelineCreatorBase::recreate() {
+#include <algorithm>
+#include <chrono>
+
+Pipeliner::Description PipelineCreatorBase::prepareRecreation() {
     if (!m_descriptorSetLayout) {
         createDescriptorSetLayout();
     }
 
-    /// make a reset if exists
+    /// make a reset if exists, the variants are compiled against the previous render pass
+    waitVariants();
+    m_variants.clear();
     m_pipeline.reset();
 
     if (m_descriptorSetLayout) {
         auto deleter = [device = m_vkState._core.getDevice()](VkDescriptorSetLayout* p) {
             assert(device);
-            Utils::printLog(INFO_PARAM, "removal triggered");
+            Utils::printLog(DEBUG_PARAM, "removal triggered");
             vkDestroyDescriptorSetLayout(device, *p, nullptr);
             delete p;
         };
         m_descriptorSetLayout.get_deleter() = deleter;
     }
 
-    createPipeline(); // Call the virtual createPipeline(Template Method pattern)
+    assert(m_descriptorSetLayout);
+    assert(m_renderPass);
+    assert(m_vkState._core.getDevice());
+
+    Pipeliner::Description description = Pipeliner::getInstance().getDefaultDescription();
+    description.vertShader = m_vertShader;
+    description.fragShader = m_fragShader;
+    description.descriptorSetLayout = *m_descriptorSetLayout.get();
+    description.renderPass = m_renderPass;
+    description.subpass = m_subpassAmount;
+    description.pushConstantRange = m_pushConstantRange;
+    description.layoutBindings = m_layoutBindings;
+
+    describePipeline(description); // Call the virtual describePipeline(Template Method pattern)
+
+    m_activeVariant = getRequestedVariant();
+    for (size_t i = 0u; i < m_qualityParameters.size(); ++i) {
+        description.specializationConstants.push_back({m_qualityParameters[i].constantId, m_activeVariant[i]});
+    }
+    m_description = description;
+
+    return description;
+}
+
+void PipelineCreatorBase::recreate(const std::vector<PipelineCreatorBase*>& pipelineCreators) {
+    if (pipelineCreators.empty()) {
+        return;
+    }
+
+    std::vector<Pipeliner::Description> descriptions;
+    descriptions.reserve(pipelineCreators.size());
+    for (auto* pipelineCreator : pipelineCreators) {
+        assert(pipelineCreator);
+        descriptions.push_back(pipelineCreator->prepareRecreation());
+    }
+
+    auto pipelines =
+        Pipeliner::getInstance().createPipeLines(descriptions, pipelineCreators.front()->m_vkState._core.getDevice());
+    for (size_t i = 0u; i < pipelineCreators.size(); ++i) {
+        pipelineCreators[i]->m_pipeline = std::move(pipelines[i]);
+        assert(pipelineCreators[i]->m_pipeline);
+    }
+}
+
+void PipelineCreatorBase::declareQualityParameter(std::string_view name, uint32_t constantId, std::vector<uint32_t> levels,
+                                                  uint32_t defaultLevel) {
+    assert(!levels.empty() && defaultLevel < levels.size());
+    assert(!m_pipeline && "quality parameters must be declared before the pipeline creation");
+    m_qualityParameters.push_back({name, constantId, std::move(levels), defaultLevel});
+}
+
+void PipelineCreatorBase::setQualityLevel(size_t parameterIndex, uint32_t level) {
+    assert(parameterIndex < m_qualityParameters.size());
+    auto& parameter = m_qualityParameters[parameterIndex];
+    parameter.level = std::min<uint32_t>(level, static_cast<uint32_t>(parameter.levels.size() - 1u));
+
+    if (m_pipeline) {
+        compileVariant(getRequestedVariant());
+    }
+}
+
+bool PipelineCreatorBase::isVariantPending() const {
+    return m_pendingVariants.count(getRequestedVariant()) != 0u;
+}
+
+void PipelineCreatorBase::prewarmVariants() {
+    assert(m_pipeline);
+    const variant_key requestedVariant = getRequestedVariant();
+    for (size_t i = 0u; i < m_qualityParameters.size(); ++i) {
+        variant_key variant = requestedVariant;
+        for (uint32_t value : m_qualityParameters[i].levels) {
+            variant[i] = value;
+            compileVariant(variant);
+        }
+    }
+}
+
+void PipelineCreatorBase::updateVariants() {
+    for (auto it = m_pendingVariants.begin(); it != m_pendingVariants.end();) {
+        if (it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            m_variants[it->first] = it->second.get();
+            it = m_pendingVariants.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const variant_key requestedVariant = getRequestedVariant();
+    if (requestedVariant == m_activeVariant) {
+        return;
+    }
+
+    auto variant = m_variants.find(requestedVariant);
+    if (variant != m_variants.end()) {
+        // the previous pipeline may still be used by the frames in flight, it stays among the variants
+        Pipeliner::pipeline_ptr previousPipeline = std::move(m_pipeline);
+        m_pipeline = std::move(variant->second);
+        m_variants.erase(variant);
+        m_variants[m_activeVariant] = std::move(previousPipeline);
+        m_activeVariant = requestedVariant;
+    }
+}
+
+void PipelineCreatorBase::waitVariants() {
+    for (auto& [variant, pipeline] : m_pendingVariants) {
+        pipeline.wait();
+    }
+    m_pendingVariants.clear();
+}
+
+PipelineCreatorBase::variant_key PipelineCreatorBase::getRequestedVariant() const {
+    variant_key variant(m_qualityParameters.size());
+    for (size_t i = 0u; i < m_qualityParameters.size(); ++i) {
+        variant[i] = m_qualityParameters[i].levels[m_qualityParameters[i].level];
+    }
+    return variant;
+}
+
+void PipelineCreatorBase::compileVariant(const variant_key& variant) {
+    if (variant == m_activeVariant || m_variants.count(variant) != 0u || m_pendingVariants.count(variant) != 0u) {
+        return;
+    }
+
+    Pipeliner::Description description = m_description;
+    for (size_t i = 0u; i < variant.size(); ++i) {
+        description.specializationConstants[i].value = variant[i];
+    }
+    m_pendingVariants.emplace(variant, Pipeliner::getInstance().createPipeLineAsync(std::move(description),
+                                                                                    m_vkState._core.getDevice()));
 }
 
 void PipelineCreatorBase::destroyDescriptorPool() {
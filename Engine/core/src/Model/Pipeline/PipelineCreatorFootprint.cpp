@@ -3,18 +3,8 @@
 #include "I3DModel.h"
 #include "Utils.h"
 
-void PipelineCreatorFootprint::createPipeline() {
-    assert(m_descriptorSetLayout);
-    assert(m_renderPass);
-    assert(m_vkState._core.getDevice());
-
-    auto& vertexInputInfo = Pipeliner::getInstance().getVertexInputInfo();
-    auto& bindingDescriptions = I3DModel::Vertex::getBindingDescription();
-
-    // it is passed to vertexInputInfo and
-    // it needs to remain valid for the lifetime of the pipeline
-    static std::array<VkVertexInputAttributeDescription, 8u> attributeDescriptions{};
-    attributeDescriptions.fill({});
+void PipelineCreatorFootprint::describePipeline(Pipeliner::Description& description) {
+    std::array<VkVertexInputAttributeDescription, 8u> attributeDescriptions{};
 
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
@@ -56,22 +46,13 @@ void PipelineCreatorFootprint::createPipeline() {
     attributeDescriptions[7].format = VK_FORMAT_R16G16B16A16_SFLOAT;
     attributeDescriptions[7].offset = offsetof(Instance, model_col3);
 
-    vertexInputInfo.vertexBindingDescriptionCount = bindingDescriptions.size();
-    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
-    vertexInputInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    description.vertexAttributes.assign(attributeDescriptions.begin(), attributeDescriptions.end());
 
     // avoiding Peter Pan effect, invisible faces generate proper shadows
     // draw both faces for plane line objects with single face
-    auto& rasterInfo = Pipeliner::getInstance().getRasterizationInfo();
-    rasterInfo.cullMode = VK_CULL_MODE_NONE;
-    rasterInfo.depthClampEnable =
+    description.rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
+    description.rasterizationInfo.depthClampEnable =
         VK_TRUE;  // fragments that are beyond the near and far planes are clamped to them as opposed to discarding them
-
-    m_pipeline = Pipeliner::getInstance().createPipeLine(m_vertShader, m_fragShader, m_depthBuffer.width, m_depthBuffer.height,
-                                                         *m_descriptorSetLayout.get(), m_renderPass, m_vkState._core.getDevice(),
-                                                         m_subpassAmount, m_pushConstantRange);
-    assert(m_pipeline);
 }
 
 void PipelineCreatorFootprint::createDescriptorSetLayout() {
@@ -106,6 +87,7 @@ void PipelineCreatorFootprint::createDescriptorSetLayout() {
     inputLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     inputLayoutCreateInfo.bindingCount = inputBindings.size();
     inputLayoutCreateInfo.pBindings = inputBindings.data();
+    m_layoutBindings.assign(inputBindings.begin(), inputBindings.end());
 
     // Create Descriptor Set Layout
     m_descriptorSetLayout = std::make_unique<VkDescriptorSetLayout>();
@@ -228,6 +210,7 @@ uint32_t PipelineCreatorFootprint::createDescriptorWithId(std::weak_ptr<TextureF
         textureSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         textureSetWrite.descriptorCount = 1;
         textureSetWrite.pImageInfo = &imageInfo;
+        sharedPtrTexture->trackDescriptor(material.descriptorSets[i], 2, i, sampler);
 
         // List of Descriptor Set Writes
         std::array<VkWriteDescriptorSet, 3u> setWrites{dynamicUBOSetWrite, textureSetWrite, uboDescriptorWrite};
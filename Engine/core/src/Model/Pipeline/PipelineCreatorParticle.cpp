@@ -3,40 +3,24 @@
 #include "Particle.h"
 #include "Utils.h"
 
-void PipelineCreatorParticle::createPipeline() {
-    assert(m_descriptorSetLayout);
-    assert(m_renderPass);
-    assert(m_vkState._core.getDevice());
-
-    auto& vertexInputInfo = Pipeliner::getInstance().getVertexInputInfo();
+void PipelineCreatorParticle::describePipeline(Pipeliner::Description& description) {
     const auto& bindingDescription = Particle::getBindingDescription();
     const auto& attributeDescriptions = Particle::getAttributeDescription();
-    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescription.size());
-    vertexInputInfo.pVertexBindingDescriptions = bindingDescription.data();
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    description.vertexBindings.assign(bindingDescription.begin(), bindingDescription.end());
+    description.vertexAttributes.assign(attributeDescriptions.begin(), attributeDescriptions.end());
 
-    auto& raster = Pipeliner::getInstance().getRasterizationInfo();
-    raster.cullMode = VK_CULL_MODE_NONE;
+    description.rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
 
-    auto& blendInfo = Pipeliner::getInstance().getColorBlendInfo();
-    blendInfo.attachmentCount = 2;  // Color + motion vectors
-    auto blendAttachments = const_cast<VkPipelineColorBlendAttachmentState*>(blendInfo.pAttachments);
+    description.colorBlendInfo.attachmentCount = 2;  // Color + motion vectors
+    auto& blendAttachments = description.blendAttachments;
     blendAttachments[1] = blendAttachments[0];
     blendAttachments[1].blendEnable = VK_FALSE;
     blendAttachments[1].colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT;
 
-    auto& depthStencil = Pipeliner::getInstance().getDepthStencilInfo();
-    depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_FALSE;  // a lot of small particles beeing overlapped
-
-    auto& pipelineIACreateInfo = Pipeliner::getInstance().getInputAssemblyInfo();
-    pipelineIACreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    description.depthStencilInfo.depthTestEnable = VK_TRUE;
+    description.depthStencilInfo.depthWriteEnable = VK_FALSE;  // a lot of small particles beeing overlapped
 
-    m_pipeline = Pipeliner::getInstance().createPipeLine(m_vertShader, m_fragShader, m_vkState._offscreenWidth, m_vkState._offscreenHeight,
-                                                         *m_descriptorSetLayout.get(), m_renderPass, m_vkState._core.getDevice(),
-                                                         m_subpassAmount, m_pushConstantRange);
-    assert(m_pipeline);
+    description.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
 }
 
 void PipelineCreatorParticle::createDescriptorSetLayout() {
@@ -72,6 +56,7 @@ void PipelineCreatorParticle::createDescriptorSetLayout() {
     inputLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     inputLayoutCreateInfo.bindingCount = inputBindings.size();
     inputLayoutCreateInfo.pBindings = inputBindings.data();
+    m_layoutBindings.assign(inputBindings.begin(), inputBindings.end());
 
     // Create Descriptor Set Layout
     m_descriptorSetLayout = std::make_unique<VkDescriptorSetLayout>();
@@ -188,6 +173,8 @@ uint32_t PipelineCreatorParticle::createDescriptorWithId(std::weak_ptr<TextureFa
         textureSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         textureSetWrite.descriptorCount = 1;
         textureSetWrite.pImageInfo = &imageInfo;
+        sharedPtrTexture->trackDescriptor(material.descriptorSets[i], 1, i, particleSampler);
+        sharedPtrTextureGradient->trackDescriptor(material.descriptorSets[i], 2, i, gradientSampler);
 
         // Texture Gradient
         VkDescriptorImageInfo imageGradientInfo = imageInfo;
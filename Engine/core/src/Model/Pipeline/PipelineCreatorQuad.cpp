@@ -2,24 +2,14 @@
 #include <assert.h>
 #include "Utils.h"
 
-void PipelineCreatorQuad::createPipeline() {
-    assert(m_descriptorSetLayout);
-    assert(m_renderPass);
-    assert(m_vkState._core.getDevice());
+void PipelineCreatorQuad::describePipeline(Pipeliner::Description& description) {
+    description.vertexBindings.clear();
+    description.vertexAttributes.clear();
 
-    auto& vertexInputInfo = Pipeliner::getInstance().getVertexInputInfo();
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.pVertexBindingDescriptions = nullptr;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-    vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+    description.depthStencilInfo.depthWriteEnable = VK_FALSE;
 
-    auto& depthStencil = Pipeliner::getInstance().getDepthStencilInfo();
-    depthStencil.depthWriteEnable = VK_FALSE;
-
-    auto& blendInfo = Pipeliner::getInstance().getColorBlendInfo();
     if (m_blend != BLEND::NONE) {
-        // We use static because Pipeliner stores a pointer to this structure.
-        static VkPipelineColorBlendAttachmentState blendAttachState{};
+        VkPipelineColorBlendAttachmentState& blendAttachState = description.blendAttachments[0];
         blendAttachState = {};
         blendAttachState.colorWriteMask =
             VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -38,24 +28,12 @@ void PipelineCreatorQuad::createPipeline() {
             blendAttachState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
             blendAttachState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
         }
-
-        blendInfo.pAttachments = &blendAttachState;
     }
 
-    blendInfo.attachmentCount = m_isGPassNeeded ? 3 : 1;
-
-    auto& pipelineIACreateInfo = Pipeliner::getInstance().getInputAssemblyInfo();
-    pipelineIACreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;  // as a simple set with two triangles for quad drawing
-
-    uint16_t renderTargetWidth = m_isWindowSizeTarget ? m_vkState._windowWidth : m_vkState._offscreenWidth;
-    uint16_t renderTargetHeight = m_isWindowSizeTarget ? m_vkState._windowHeight : m_vkState._offscreenHeight;
-
-    m_pipeline = Pipeliner::getInstance().createPipeLine(
-        m_vertShader, m_fragShader, renderTargetWidth, renderTargetHeight,
-        *m_descriptorSetLayout.get(), m_renderPass, m_vkState._core.getDevice(),
-        m_subpassAmount, m_pushConstantRange);
+    description.colorBlendInfo.attachmentCount = m_isGPassNeeded ? 3 : 1;
 
-    assert(m_pipeline);
+    description.inputAssemblyInfo.topology =
+        VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;  // as a simple set with two triangles for quad drawing
 }
 
 uint32_t PipelineCreatorQuad::getInputBindingsAmount() const {
@@ -125,6 +103,7 @@ void PipelineCreatorQuad::createDescriptorSetLayout() {
     inputLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     inputLayoutCreateInfo.bindingCount = static_cast<uint32_t>(inputBindings.size());
     inputLayoutCreateInfo.pBindings = inputBindings.data();
+    m_layoutBindings.assign(inputBindings.begin(), inputBindings.end());
 
     // Create Descriptor Set Layout
     m_descriptorSetLayout = std::make_unique<VkDescriptorSetLayout>();
@@ -209,6 +188,14 @@ void PipelineCreatorQuad::recreateDescriptors() {
     VkResult result = vkAllocateDescriptorSets(m_vkState._core.getDevice(), &setAllocInfo, m_descriptorSets.data());
     CHECK_VULKAN_ERROR("Failed to allocate Input Attachment Descriptor Sets %d", result);
 
+    writeDescriptors(false);
+}
+
+void PipelineCreatorQuad::updateAttachmentDescriptors() {
+    writeDescriptors(true);
+}
+
+void PipelineCreatorQuad::writeDescriptors(bool isAttachmentsOnly) {
     const auto attachmentsAmount = getInputBindingsAmount();
     // Update each descriptor set with input attachment
     for (size_t i = 0u; i < m_vkState._swapchainImageCount; ++i) {
@@ -316,9 +303,11 @@ void PipelineCreatorQuad::recreateDescriptors() {
             depthWrite.pImageInfo = &depthShadowAttachmentDescriptor;
 
             setWrites.push_back(depthWrite);
+        }
 
-            // View Projection UBO Descriptor
-            VkDescriptorBufferInfo bufferInfo{};
+        // View Projection UBO Descriptor, the last binding
+        VkDescriptorBufferInfo bufferInfo{};
+        if (m_isGPassNeeded && !isAttachmentsOnly) {
             bufferInfo.buffer = m_vkState._ubo.buffers[i];
             bufferInfo.offset = 0;
             bufferInfo.range = sizeof(VulkanState::ViewProj);
@@ -10,12 +10,10 @@ PipelineCreatorSSAO::PipelineCreatorSSAO(const VulkanState& vkState, VkRenderPas
 
 PipelineCreatorSSAO::~PipelineCreatorSSAO() {
     for (size_t i = 0u; i < m_vkState._swapchainImageCount; ++i) {
-        vkDestroyBuffer(m_vkState._core.getDevice(), m_ubo.buffers[i], nullptr);
-        vkFreeMemory(m_vkState._core.getDevice(), m_ubo.buffersMemory[i], nullptr);
+        Utils::VulkanDestroyBuffer(m_vkState._core.getDevice(), m_ubo.buffers[i], m_ubo.buffersMemory[i]);
     }
     vkDestroyImageView(m_vkState._core.getDevice(), m_noiseTexture.m_textureImageView, nullptr);
-    vkDestroyImage(m_vkState._core.getDevice(), m_noiseTexture.m_textureImage, nullptr);
-    vkFreeMemory(m_vkState._core.getDevice(), m_noiseTexture.m_textureImageMemory, nullptr);
+    Utils::VulkanDestroyImage(m_vkState._core.getDevice(), m_noiseTexture.m_textureImage, m_noiseTexture.m_textureImageMemory);
 
     // setLayout must be deleted before destroying the samplers since they are integrated
     m_descriptorSetLayout.reset();
@@ -23,8 +21,8 @@ PipelineCreatorSSAO::~PipelineCreatorSSAO() {
     vkDestroySampler(m_vkState._core.getDevice(), mSamplerViewSpace, nullptr);
 }
 
-void PipelineCreatorSSAO::createPipeline() {
-    PipelineCreatorQuad::createPipeline();
+void PipelineCreatorSSAO::describePipeline(Pipeliner::Description& description) {
+    PipelineCreatorQuad::describePipeline(description);
 
     std::uniform_real_distribution<float> randomFloats(0.0, 1.0);
     std::default_random_engine generator;
@@ -45,28 +43,13 @@ void PipelineCreatorSSAO::createPipeline() {
         }
 
         const VkDeviceSize uboBufSize = sizeof(UBOSemiSpheraKernel::Params);
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        Utils::VulkanCreateBuffer(
-            m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), uboBufSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(m_vkState._core.getDevice(), stagingBufferMemory, 0, uboBufSize, 0, &data);
-        memcpy(data, &m_ubo.params, (size_t)uboBufSize);
-        vkUnmapMemory(m_vkState._core.getDevice(), stagingBufferMemory);
-
         for (size_t i = 0u; i < m_vkState._swapchainImageCount; ++i) {
             Utils::VulkanCreateBuffer(m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), uboBufSize,
                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_ubo.buffers[i], m_ubo.buffersMemory[i]);
 
-            Utils::VulkanCopyBuffer(m_vkState._core.getDevice(), m_vkState._queue, m_vkState._cmdBufPool, stagingBuffer,
-                                    m_ubo.buffers[i], uboBufSize);
+            UploadManager::getInstance().uploadBuffer(m_ubo.buffers[i], &m_ubo.params, uboBufSize);
         }
-
-        vkDestroyBuffer(m_vkState._core.getDevice(), stagingBuffer, nullptr);
-        vkFreeMemory(m_vkState._core.getDevice(), stagingBufferMemory, nullptr);
     }
 
     // noise 4x4 texture with GL_REPEAT mode for random offsets along XY plane
@@ -88,41 +71,20 @@ void PipelineCreatorSSAO::createPipeline() {
         m_noiseTexture.height = height;
         m_noiseTexture.mipLevels = 1u;
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        Utils::VulkanCreateBuffer(
-            m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(m_vkState._core.getDevice(), stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, ssaoNoise.data(), imageSize);
-        vkUnmapMemory(m_vkState._core.getDevice(), stagingBufferMemory);
-
         auto res = Utils::VulkanCreateImage(
             m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), m_noiseTexture.width, m_noiseTexture.height,
             imageFormat, VK_IMAGE_TILING_OPTIMAL,
             VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_noiseTexture.m_textureImage, m_noiseTexture.m_textureImageMemory);
 
-        Utils::VulkanTransitionImageLayout(m_vkState._core.getDevice(), m_vkState._queue, m_vkState._cmdBufPool,
-                                           m_noiseTexture.m_textureImage, imageFormat, VK_IMAGE_LAYOUT_UNDEFINED,
-                                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
-        Utils::VulkanCopyBufferToImage(m_vkState._core.getDevice(), m_vkState._queue, m_vkState._cmdBufPool, stagingBuffer,
-                                       m_noiseTexture.m_textureImage, m_noiseTexture.width, m_noiseTexture.height);
-
-        Utils::VulkanTransitionImageLayout(m_vkState._core.getDevice(), m_vkState._queue, m_vkState._cmdBufPool,
-                                           m_noiseTexture.m_textureImage, imageFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
+        UploadManager::getInstance().uploadImage(m_noiseTexture.m_textureImage, imageFormat, m_noiseTexture.width,
+                                                 m_noiseTexture.height, {ssaoNoise.data()}, imageSize);
 
         if (Utils::VulkanCreateImageView(m_vkState._core.getDevice(), m_noiseTexture.m_textureImage, imageFormat,
                                          VK_IMAGE_ASPECT_COLOR_BIT, m_noiseTexture.m_textureImageView,
                                          m_noiseTexture.mipLevels) != VK_SUCCESS) {
             Utils::printLog(ERROR_PARAM, "failed to create texture imageView for SSAO");
         }
-
-        vkDestroyBuffer(m_vkState._core.getDevice(), stagingBuffer, nullptr);
-        vkFreeMemory(m_vkState._core.getDevice(), stagingBufferMemory, nullptr);
     }
 }
 
@@ -212,6 +174,7 @@ void PipelineCreatorSSAO::createDescriptorSetLayout() {
     inputLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     inputLayoutCreateInfo.bindingCount = inputBindings.size();
     inputLayoutCreateInfo.pBindings = inputBindings.data();
+    m_layoutBindings.assign(inputBindings.begin(), inputBindings.end());
 
     // Create Descriptor Set Layout
     m_descriptorSetLayout = std::make_unique<VkDescriptorSetLayout>();
@@ -281,6 +244,15 @@ void PipelineCreatorSSAO::recreateDescriptors() {
         return;
     }
 
+    writeDescriptors(false);
+    mIsPoolRecreated = false;
+}
+
+void PipelineCreatorSSAO::updateAttachmentDescriptors() {
+    writeDescriptors(true);
+}
+
+void PipelineCreatorSSAO::writeDescriptors(bool isAttachmentsOnly) {
     // Update each descriptor set with input attachment
     for (uint32_t i = 0u; i < m_vkState._swapchainImageCount; ++i) {
         // G Normal
@@ -375,11 +347,13 @@ void PipelineCreatorSSAO::recreateDescriptors() {
         viewSpacePosWrite.descriptorCount = 1;
         viewSpacePosWrite.pImageInfo = &viewSpacePosInfo;
 
-        std::array<VkWriteDescriptorSet, 6u> descriptorSets{gNormalWrite, depthWrite, textureSetWrite, uboKernelDescriptorWrite,
-                                                            uboDescriptorWrite, viewSpacePosWrite};
+        std::vector<VkWriteDescriptorSet> descriptorSets{gNormalWrite, depthWrite, viewSpacePosWrite};
+        if (!isAttachmentsOnly) {
+            descriptorSets.insert(descriptorSets.end(), {textureSetWrite, uboKernelDescriptorWrite, uboDescriptorWrite});
+        }
 
         // Update descriptor sets
-        vkUpdateDescriptorSets(m_vkState._core.getDevice(), descriptorSets.size(), descriptorSets.data(), 0, nullptr);
+        vkUpdateDescriptorSets(m_vkState._core.getDevice(), static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(),
+                               0, nullptr);
     }
-    mIsPoolRecreated = false;
 }
@@ -3,16 +3,9 @@
 #include "I3DModel.h"
 #include "Utils.h"
 
-void PipelineCreatorSemiTransparent::createPipeline() {
-    assert(m_descriptorSetLayout);
-    assert(m_renderPass);
-    assert(m_vkState._core.getDevice());
-
-    auto& vertexInputInfo = Pipeliner::getInstance().getVertexInputInfo();
-    auto& bindingDescriptions = I3DModel::Vertex::getBindingDescription();
-    auto baseAttributeDescriptions = I3DModel::Vertex::getAttributeDescriptions();
-    static std::array<VkVertexInputAttributeDescription, 15> attributeDescriptions{};
-    attributeDescriptions.fill({});
+void PipelineCreatorSemiTransparent::describePipeline(Pipeliner::Description& description) {
+    const auto& baseAttributeDescriptions = I3DModel::Vertex::getAttributeDescriptions();
+    std::array<VkVertexInputAttributeDescription, 15> attributeDescriptions{};
     for (size_t i = 0; i < baseAttributeDescriptions.size(); ++i) {
         attributeDescriptions[i] = baseAttributeDescriptions[i];
     }
@@ -37,29 +30,18 @@ void PipelineCreatorSemiTransparent::createPipeline() {
     attributeDescriptions[14].format = VK_FORMAT_R16G16B16A16_SFLOAT;
     attributeDescriptions[14].offset = offsetof(Instance, prev_model_col3);
 
-    vertexInputInfo.vertexBindingDescriptionCount = bindingDescriptions.size();
-    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    description.vertexAttributes.assign(attributeDescriptions.begin(), attributeDescriptions.end());
 
-    auto& blendInfo = Pipeliner::getInstance().getColorBlendInfo();
-    blendInfo.attachmentCount = 2;  // Color + motion vectors
-    auto blendAttachments = const_cast<VkPipelineColorBlendAttachmentState*>(blendInfo.pAttachments);
+    description.colorBlendInfo.attachmentCount = 2;  // Color + motion vectors
+    auto& blendAttachments = description.blendAttachments;
     blendAttachments[1] = blendAttachments[0];
     blendAttachments[1].blendEnable = VK_FALSE;
     blendAttachments[1].colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT;
 
-    auto& raster = Pipeliner::getInstance().getRasterizationInfo();
-    raster.cullMode = VK_CULL_MODE_NONE;
-
-    auto& depthStencil = Pipeliner::getInstance().getDepthStencilInfo();
-    depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    
-    m_pipeline = Pipeliner::getInstance().createPipeLine(m_vertShader, m_fragShader, m_vkState._offscreenWidth, m_vkState._offscreenHeight,
-                                                         *m_descriptorSetLayout.get(), m_renderPass, m_vkState._core.getDevice(),
-                                                         m_subpassAmount, m_pushConstantRange);
-    assert(m_pipeline);
+    description.rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
+
+    description.depthStencilInfo.depthTestEnable = VK_TRUE;
+    description.depthStencilInfo.depthWriteEnable = VK_TRUE;
 }
 
 void PipelineCreatorSemiTransparent::createDescriptorSetLayout() {
@@ -94,6 +76,7 @@ void PipelineCreatorSemiTransparent::createDescriptorSetLayout() {
     inputLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     inputLayoutCreateInfo.bindingCount = inputBindings.size();
     inputLayoutCreateInfo.pBindings = inputBindings.data();
+    m_layoutBindings.assign(inputBindings.begin(), inputBindings.end());
 
     // Create Descriptor Set Layout
     m_descriptorSetLayout = std::make_unique<VkDescriptorSetLayout>();
@@ -193,6 +176,7 @@ uint32_t PipelineCreatorSemiTransparent::createDescriptor(std::weak_ptr<TextureF
         textureSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         textureSetWrite.descriptorCount = 1;
         textureSetWrite.pImageInfo = &imageInfo;
+        sharedPtrTexture->trackDescriptor(material.descriptorSets[i], 1, i, sampler);
 
         VkDescriptorBufferInfo uboViewProjBufferInfo{};
         uboViewProjBufferInfo.buffer = m_vkState._ubo.buffers[i];
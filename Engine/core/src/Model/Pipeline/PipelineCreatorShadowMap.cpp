@@ -3,18 +3,8 @@
 #include "I3DModel.h"
 #include "Utils.h"
 
-void PipelineCreatorShadowMap::createPipeline() {
-    assert(m_descriptorSetLayout);
-    assert(m_renderPass);
-    assert(m_vkState._core.getDevice());
-
-    auto& vertexInputInfo = Pipeliner::getInstance().getVertexInputInfo();
-    auto& bindingDescriptions = I3DModel::Vertex::getBindingDescription();
-
-    // Make the array static, since a pointer to it is passed to vertexInputInfo and
-    // it needs to remain valid for the lifetime of the pipeline
-    static std::array<VkVertexInputAttributeDescription, 11u> attributeDescriptions{};
-    attributeDescriptions.fill({}); 
+void PipelineCreatorShadowMap::describePipeline(Pipeliner::Description& description) {
+    std::array<VkVertexInputAttributeDescription, 11u> attributeDescriptions{};
 
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
@@ -71,32 +61,22 @@ void PipelineCreatorShadowMap::createPipeline() {
     attributeDescriptions[10].format = VK_FORMAT_R16G16B16A16_SFLOAT;
     attributeDescriptions[10].offset = offsetof(Instance, prev_model_col3);
 
-    vertexInputInfo.vertexBindingDescriptionCount = bindingDescriptions.size();
-    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
-    vertexInputInfo.vertexAttributeDescriptionCount =
-        m_motionVectors ? attributeDescriptions.size() : attributeDescriptions.size() - 4u;
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    const size_t attributesCount = m_motionVectors ? attributeDescriptions.size() : attributeDescriptions.size() - 4u;
+    description.vertexAttributes.assign(attributeDescriptions.begin(), attributeDescriptions.begin() + attributesCount);
 
     // avoiding Peter Pan effect, invisible faces generate proper shadows
     // draw both faces for plane line objects with single face
-    auto& rasterInfo = Pipeliner::getInstance().getRasterizationInfo();
-    rasterInfo.cullMode = VK_CULL_MODE_NONE;
-    rasterInfo.depthClampEnable =
+    description.rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
+    description.rasterizationInfo.depthClampEnable =
         VK_TRUE;  // fragments that are beyond the near and far planes are clamped to them as opposed to discarding them
 
-    auto& blendInfo = Pipeliner::getInstance().getColorBlendInfo();
-    blendInfo.attachmentCount = m_motionVectors ? 2 : 1;
+    description.colorBlendInfo.attachmentCount = m_motionVectors ? 2 : 1;
     if (m_motionVectors) {
-        auto blendAttachments = const_cast<VkPipelineColorBlendAttachmentState*>(blendInfo.pAttachments);
+        auto& blendAttachments = description.blendAttachments;
         blendAttachments[1] = blendAttachments[0];
         blendAttachments[1].blendEnable = VK_FALSE;
         blendAttachments[1].colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT;
     }
-
-    m_pipeline = Pipeliner::getInstance().createPipeLine(m_vertShader, m_fragShader, m_depthBuffer.width, m_depthBuffer.height,
-        *m_descriptorSetLayout.get(), m_renderPass, m_vkState._core.getDevice(),
-        m_subpassAmount, m_pushConstantRange);
-    assert(m_pipeline);
 }
 
 void PipelineCreatorShadowMap::createDescriptorSetLayout() {
@@ -123,6 +103,7 @@ void PipelineCreatorShadowMap::createDescriptorSetLayout() {
     inputLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     inputLayoutCreateInfo.bindingCount = inputBindings.size();
     inputLayoutCreateInfo.pBindings = inputBindings.data();
+    m_layoutBindings.assign(inputBindings.begin(), inputBindings.end());
 
     // Create Descriptor Set Layout
     m_descriptorSetLayout = std::make_unique<VkDescriptorSetLayout>();
@@ -1,44 +1,90 @@
 
 #include "PipelineCreatorTextured.h"
+#include "ShaderRegistry.h"
 #include <assert.h>
+#include <algorithm>
+#include <array>
 
-void PipelineCreatorTextured::createPipeline() {
-    assert(m_descriptorSetLayout);
-    assert(m_renderPass);
-    assert(m_vkState._core.getDevice());
+PipelineCreatorTextured::~PipelineCreatorTextured() {
+    if (m_materialsBuffer) {
+        Utils::VulkanDestroyBuffer(m_vkState._core.getDevice(), m_materialsBuffer, m_materialsBufferMemory);
+    }
+}
+
+void PipelineCreatorTextured::requestBindless(std::string_view fragShader) {
+    assert(!m_isBindlessResolved && "bindless mode must be requested before the pipeline creation");
+    // the push constant carries the material index only, the footprint binding of the terrain is not in the bindless layout
+    assert(!m_isTessellated && !isPushContantActive());
+    m_bindlessFragShader = fragShader;
+}
+
+void PipelineCreatorTextured::resolveBindless() {
+    if (m_isBindlessResolved) {
+        return;
+    }
+    m_isBindlessResolved = true;
 
-    auto& blendInfo = Pipeliner::getInstance().getColorBlendInfo();
-    blendInfo.attachmentCount = 4; // + motion vector buffer for dynamic skybox(morphing clouds)
+    if (m_bindlessFragShader.empty()) {
+        return;
+    }
+    if (!m_vkState._core.isDescriptorIndexingSupported()) {
+        Utils::printLog(INFO_PARAM, "no descriptor indexing, materials of ", m_fragShader, " use descriptor sets");
+        return;
+    }
+    // the shader must declare the textures and the materials of the bindless layout, see createDescriptorSetLayout
+    ShaderRegistry::Reflection reflection;
+    if (!ShaderRegistry::getInstance().isLoadable(m_bindlessFragShader, reflection)) {
+        Utils::printLog(WARNING_PARAM, m_bindlessFragShader, " is missing or invalid (rebuild the shaders), materials of ",
+                        m_fragShader, " use descriptor sets");
+        return;
+    }
+    auto isDeclared = [&reflection](uint32_t binding, VkDescriptorType type) {
+        return std::any_of(reflection.bindings.begin(), reflection.bindings.end(), [binding, type](const auto& declared) {
+            return declared.set == 0u && declared.binding == binding && declared.type == type;
+        });
+    };
+    if (!isDeclared(1u, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) || !isDeclared(3u, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)) {
+        Utils::printLog(WARNING_PARAM, m_bindlessFragShader, " doesn't declare the bindless textures and materials, ",
+                        "materials of ", m_fragShader, " use descriptor sets");
+        return;
+    }
+
+    m_isBindless = true;
+    m_fragShader = m_bindlessFragShader;
+    m_pushConstantRange = {VK_SHADER_STAGE_FRAGMENT_BIT, 0u, sizeof(uint32_t)};
+
+    // written once per material, the entries in use by the frames in flight are never changed
+    const VkDeviceSize bufferSize = sizeof(BindlessMaterial) * MAX_BINDLESS_MATERIALS;
+    Utils::VulkanCreateBuffer(m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), bufferSize,
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_materialsBuffer,
+                              m_materialsBufferMemory);
+    m_materials = static_cast<BindlessMaterial*>(MemoryAllocator::getInstance().getMappedData(m_materialsBuffer));
+    Utils::printLog(INFO_PARAM, "bindless materials: ", m_fragShader);
+}
+
+void PipelineCreatorTextured::describePipeline(Pipeliner::Description& description) {
+    description.colorBlendInfo.attachmentCount = 4; // + motion vector buffer for dynamic skybox(morphing clouds)
 
     // motion vector buffer
     {
-        auto blendAttachments = const_cast<VkPipelineColorBlendAttachmentState*>(blendInfo.pAttachments);
+        auto& blendAttachments = description.blendAttachments;
         blendAttachments[3] = blendAttachments[0];
         blendAttachments[3].blendEnable = VK_FALSE;
         blendAttachments[3].colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT;
     }
 
     if (m_isTessellated) {
-        auto& pipelineIACreateInfo = Pipeliner::getInstance().getInputAssemblyInfo();
-        pipelineIACreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
-
-        auto& tessInfo = Pipeliner::getInstance().getTessInfo();
-        tessInfo.patchControlPoints = 3;
-
-        m_pipeline = Pipeliner::getInstance().createPipeLine(m_vertShader, m_fragShader, m_tessCtrlShader, m_tessEvalShader,
-                                                             m_vkState._offscreenWidth, m_vkState._offscreenHeight,
-            *m_descriptorSetLayout.get(), m_renderPass, m_vkState._core.getDevice(), m_subpassAmount, m_pushConstantRange);
-
-    } else {
-        m_pipeline = Pipeliner::getInstance().createPipeLine(m_vertShader, m_fragShader, m_vkState._offscreenWidth, m_vkState._offscreenHeight,
-                                                             *m_descriptorSetLayout.get(), m_renderPass,
-                                                             m_vkState._core.getDevice(), m_subpassAmount, m_pushConstantRange);
+        description.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+        description.tessInfo.patchControlPoints = 3;
+        description.tessCtrlShader = m_tessCtrlShader;
+        description.tessEvalShader = m_tessEvalShader;
     }
-
-    assert(m_pipeline);
 }
 
 void PipelineCreatorTextured::createDescriptorSetLayout() {
+    resolveBindless();
+
     // dynamic UBO Binding Info
     VkDescriptorSetLayoutBinding dynamicUBOLayoutBinding = {};
     dynamicUBOLayoutBinding.binding = 0;
@@ -67,9 +113,27 @@ void PipelineCreatorTextured::createDescriptorSetLayout() {
     }
     uboViewProjLayoutBinding.pImmutableSamplers = nullptr;
 
+    // the bindless textures array is written as the materials are created, the rest of its elements are never sampled
+    std::vector<VkDescriptorBindingFlags> bindingFlags{0u, 0u, 0u};
+    if (m_isBindless) {
+        samplerLayoutBinding.descriptorCount = VulkanCore::MAX_BINDLESS_TEXTURES;
+        bindingFlags[1] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+    }
+
     std::vector<VkDescriptorSetLayoutBinding> layoutBindings{dynamicUBOLayoutBinding, samplerLayoutBinding,
                                                                uboViewProjLayoutBinding};
-    if (m_isTessellated) {
+    if (m_isBindless) {
+        // materials of the bindless mode
+        VkDescriptorSetLayoutBinding materialsLayoutBinding{};
+        materialsLayoutBinding.binding = 3;
+        materialsLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        materialsLayoutBinding.descriptorCount = 1;
+        materialsLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        materialsLayoutBinding.pImmutableSamplers = nullptr;
+
+        layoutBindings.push_back(materialsLayoutBinding);
+        bindingFlags.push_back(0u);
+    } else if (m_isTessellated) {
         // Depth footprint texture, sampled from tessellation evaluation and fragment shaders
         VkDescriptorSetLayoutBinding depthFootPrintInputLayoutBinding{};
         depthFootPrintInputLayoutBinding.binding = 3;
@@ -86,6 +150,15 @@ void PipelineCreatorTextured::createDescriptorSetLayout() {
     layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutCreateInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
     layoutCreateInfo.pBindings = layoutBindings.data();
+    m_layoutBindings = layoutBindings;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+    if (m_isBindless) {
+        layoutCreateInfo.pNext = &bindingFlagsInfo;
+    }
 
     m_descriptorSetLayout = std::make_unique<VkDescriptorSetLayout>();
     if (vkCreateDescriptorSetLayout(m_vkState._core.getDevice(), &layoutCreateInfo, nullptr, m_descriptorSetLayout.get()) !=
@@ -96,6 +169,31 @@ void PipelineCreatorTextured::createDescriptorSetLayout() {
 
 void PipelineCreatorTextured::createDescriptorPool() {
     assert(m_descriptorPool == nullptr);  // avoid multiple alocation of the same pool
+    resolveBindless();
+
+    if (m_isBindless) {
+        // one set per swapchain image whatever the materials count is
+        const uint32_t setsCount = m_vkState._swapchainImageCount;
+        const std::array<VkDescriptorPoolSize, 4u> bindlessPoolSizes{
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, setsCount},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setsCount * VulkanCore::MAX_BINDLESS_TEXTURES},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, setsCount},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setsCount}};
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(bindlessPoolSizes.size());
+        poolInfo.pPoolSizes = bindlessPoolSizes.data();
+        poolInfo.maxSets = setsCount;
+
+        if (vkCreateDescriptorPool(m_vkState._core.getDevice(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+            Utils::printLog(ERROR_PARAM, "failed to create descriptor pool!");
+        }
+        // the sets of the previous pool are gone
+        m_bindlessSets.clear();
+        return;
+    }
+
     // Type of descriptors + how many Descriptors needed to be allocated in pool
     uint32_t descriptorCount =
         m_vkState._swapchainImageCount * m_maxObjectsCount *
@@ -132,9 +230,145 @@ void PipelineCreatorTextured::createDescriptorPool() {
 }
 
 uint32_t PipelineCreatorTextured::createDescriptor(std::weak_ptr<TextureFactory::Texture> texture, VkSampler sampler) {
+    if (m_isBindless) {
+        return createBindlessMaterial(texture, sampler);
+    }
     return createDescriptorWithId(texture, sampler, 0u);
 }
 
+uint32_t PipelineCreatorTextured::createBindlessMaterial(std::weak_ptr<TextureFactory::Texture> texture, VkSampler sampler) {
+    auto sharedPtrTexture = texture.lock();
+    assert(sharedPtrTexture);
+    if (m_bindlessMaterialsCount == MAX_BINDLESS_MATERIALS) {
+        Utils::printLog(ERROR_PARAM, "too many bindless materials ", MAX_BINDLESS_MATERIALS);
+    }
+
+    if (m_bindlessSets.empty()) {
+        allocateBindlessSets();
+    }
+
+    // materials of the same texture and sampler share the array element
+    auto bindlessTexture = std::find_if(m_bindlessTextures.cbegin(), m_bindlessTextures.cend(), [&](const auto& material) {
+        return material.sampler == sampler && material.texture.lock() == sharedPtrTexture;
+    });
+    uint32_t textureIndex = static_cast<uint32_t>(std::distance(m_bindlessTextures.cbegin(), bindlessTexture));
+    if (bindlessTexture == m_bindlessTextures.cend()) {
+        if (m_bindlessTextures.size() == VulkanCore::MAX_BINDLESS_TEXTURES) {
+            Utils::printLog(ERROR_PARAM, "too many bindless textures ", VulkanCore::MAX_BINDLESS_TEXTURES);
+        }
+        I3DModel::Material material;
+        material.texture = texture;
+        material.sampler = sampler;
+        material.descriptorSetLayout = *m_descriptorSetLayout.get();
+        m_bindlessTextures.push_back(material);
+        writeBindlessTexture(textureIndex);
+    }
+
+    m_materials[m_bindlessMaterialsCount].textureIndex = textureIndex;
+    m_materials[m_bindlessMaterialsCount].layersCount = sharedPtrTexture->layersCount;
+
+    return m_bindlessMaterialsCount++;
+}
+
+void PipelineCreatorTextured::allocateBindlessSets() {
+    assert(m_descriptorPool && m_descriptorSetLayout);
+
+    std::vector<VkDescriptorSetLayout> layouts(m_vkState._swapchainImageCount, *m_descriptorSetLayout.get());
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_descriptorPool;
+    allocInfo.descriptorSetCount = m_vkState._swapchainImageCount;
+    allocInfo.pSetLayouts = layouts.data();
+
+    m_bindlessSets.resize(m_vkState._swapchainImageCount);
+    auto status = vkAllocateDescriptorSets(m_vkState._core.getDevice(), &allocInfo, m_bindlessSets.data());
+    if (status != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to allocate descriptor sets! ", status);
+    }
+
+    for (uint32_t i = 0u; i < m_vkState._swapchainImageCount; ++i) {
+        // Dynamic UBO DESCRIPTOR
+        VkDescriptorBufferInfo DUBOInfo = {};
+        DUBOInfo.buffer = m_vkState._dynamicUbo.buffers[i];
+        DUBOInfo.offset = 0;
+        DUBOInfo.range = m_vkState._modelUniformAlignment;
+
+        VkWriteDescriptorSet dynamicUBOSetWrite = {};
+        dynamicUBOSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        dynamicUBOSetWrite.dstSet = m_bindlessSets[i];
+        dynamicUBOSetWrite.dstBinding = 0;
+        dynamicUBOSetWrite.dstArrayElement = 0;
+        dynamicUBOSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        dynamicUBOSetWrite.descriptorCount = 1;
+        dynamicUBOSetWrite.pBufferInfo = &DUBOInfo;
+
+        // UBO ViewProj DESCRIPTOR
+        VkDescriptorBufferInfo UBOBufferInfo{};
+        UBOBufferInfo.buffer = m_vkState._ubo.buffers[i];
+        UBOBufferInfo.offset = 0;
+        UBOBufferInfo.range = sizeof(VulkanState::ViewProj);
+
+        VkWriteDescriptorSet uboDescriptorWrite{};
+        uboDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        uboDescriptorWrite.dstSet = m_bindlessSets[i];
+        uboDescriptorWrite.dstBinding = 2;
+        uboDescriptorWrite.dstArrayElement = 0;
+        uboDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboDescriptorWrite.descriptorCount = 1;
+        uboDescriptorWrite.pBufferInfo = &UBOBufferInfo;
+
+        // Materials SSBO DESCRIPTOR
+        VkDescriptorBufferInfo materialsBufferInfo{};
+        materialsBufferInfo.buffer = m_materialsBuffer;
+        materialsBufferInfo.offset = 0;
+        materialsBufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet materialsDescriptorWrite{};
+        materialsDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        materialsDescriptorWrite.dstSet = m_bindlessSets[i];
+        materialsDescriptorWrite.dstBinding = 3;
+        materialsDescriptorWrite.dstArrayElement = 0;
+        materialsDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        materialsDescriptorWrite.descriptorCount = 1;
+        materialsDescriptorWrite.pBufferInfo = &materialsBufferInfo;
+
+        const std::array<VkWriteDescriptorSet, 3u> setWrites{dynamicUBOSetWrite, uboDescriptorWrite, materialsDescriptorWrite};
+        vkUpdateDescriptorSets(m_vkState._core.getDevice(), static_cast<uint32_t>(setWrites.size()), setWrites.data(), 0,
+                               nullptr);
+    }
+
+    for (uint32_t textureIndex = 0u; textureIndex < m_bindlessTextures.size(); ++textureIndex) {
+        writeBindlessTexture(textureIndex);
+    }
+}
+
+void PipelineCreatorTextured::writeBindlessTexture(uint32_t textureIndex) {
+    const auto& material = m_bindlessTextures[textureIndex];
+    auto sharedPtrTexture = material.texture.lock();
+    if (!sharedPtrTexture) {
+        return;
+    }
+
+    for (uint32_t i = 0u; i < m_vkState._swapchainImageCount; ++i) {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = sharedPtrTexture->m_textureImageView;
+        imageInfo.sampler = material.sampler;
+
+        VkWriteDescriptorSet textureSetWrite = {};
+        textureSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        textureSetWrite.dstSet = m_bindlessSets[i];
+        textureSetWrite.dstBinding = 1;
+        textureSetWrite.dstArrayElement = textureIndex;
+        textureSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        textureSetWrite.descriptorCount = 1;
+        textureSetWrite.pImageInfo = &imageInfo;
+        sharedPtrTexture->trackDescriptor(m_bindlessSets[i], 1, i, material.sampler, textureIndex);
+
+        vkUpdateDescriptorSets(m_vkState._core.getDevice(), 1u, &textureSetWrite, 0, nullptr);
+    }
+}
+
 uint32_t PipelineCreatorTextured::createDescriptorWithId(std::weak_ptr<TextureFactory::Texture> texture, VkSampler sampler,
                                                          uint32_t materialId) {
     assert(m_vkState._core.getDevice());
@@ -196,6 +430,7 @@ uint32_t PipelineCreatorTextured::createDescriptorWithId(std::weak_ptr<TextureFa
         textureSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         textureSetWrite.descriptorCount = 1;
         textureSetWrite.pImageInfo = &imageInfo;
+        sharedPtrTexture->trackDescriptor(material.descriptorSets[i], 1, i, sampler);
 
         // UBO ViewProj DESCRIPTOR
         VkDescriptorBufferInfo UBOBufferInfo{};
@@ -246,12 +481,24 @@ uint32_t PipelineCreatorTextured::createDescriptorWithId(std::weak_ptr<TextureFa
 }
 
 const VkDescriptorSet* PipelineCreatorTextured::getDescriptorSet(uint32_t descriptorSetsIndex, uint32_t materialId) const {
+    if (m_isBindless) {
+        // one set for all the materials
+        assert(m_bindlessSets.size() > descriptorSetsIndex);
+        return &m_bindlessSets[descriptorSetsIndex];
+    }
     assert(m_descriptorSets.find(materialId) != m_descriptorSets.cend());
     assert(m_descriptorSets.at(materialId).descriptorSets.size() > descriptorSetsIndex);
     return &m_descriptorSets.at(materialId).descriptorSets.at(descriptorSetsIndex);
 }
 
 void PipelineCreatorTextured::recreateDescriptors() {
+    if (m_isBindless) {
+        if (!m_bindlessTextures.empty()) {
+            allocateBindlessSets();
+        }
+        return;
+    }
+
     if (m_descriptorSets.empty()) {
         return;
     }
@@ -262,3 +509,35 @@ void PipelineCreatorTextured::recreateDescriptors() {
         createDescriptorWithId(material.second.texture, material.second.sampler, material.first);
     }
 }
+
+void PipelineCreatorTextured::updateAttachmentDescriptors() {
+    // the footprint depth is the only attachment, the bindless mode has no tessellation
+    if (!m_isTessellated) {
+        return;
+    }
+
+    VkDescriptorImageInfo depthAttachmentInfo{};
+    depthAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    depthAttachmentInfo.imageView = m_vkState._footprintBuffer.depthImageView;
+    depthAttachmentInfo.sampler = *getOrCreateCommonSampler();
+
+    std::vector<VkWriteDescriptorSet> setWrites;
+    for (const auto& material : m_descriptorSets) {
+        for (const auto& descriptorSet : material.second.descriptorSets) {
+            VkWriteDescriptorSet depthWrite{};
+            depthWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            depthWrite.dstSet = descriptorSet;
+            depthWrite.dstBinding = 3;
+            depthWrite.dstArrayElement = 0;
+            depthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            depthWrite.descriptorCount = 1;
+            depthWrite.pImageInfo = &depthAttachmentInfo;
+            setWrites.push_back(depthWrite);
+        }
+    }
+
+    if (!setWrites.empty()) {
+        vkUpdateDescriptorSets(m_vkState._core.getDevice(), static_cast<uint32_t>(setWrites.size()), setWrites.data(), 0,
+                               nullptr);
+    }
+}
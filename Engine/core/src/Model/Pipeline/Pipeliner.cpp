@@ -2,54 +2,75 @@
 #include "Pipeliner.h"
 #include "Constants.h"
 #include "I3DModel.h"
+#include "ShaderRegistry.h"
 #include "Utils.h"
 
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <thread>
 
 void deletePipeLine(Pipeliner::PipeLine* p) {
     auto device = Pipeliner::getInstance().m_device;
-    Utils::printLog(INFO_PARAM, "pipeline removal");
+    Utils::printLog(DEBUG_PARAM, "pipeline removal");
     assert(p);
     vkDestroyPipeline(device, p->pipeline, nullptr);
     vkDestroyPipelineLayout(device, p->pipelineLayout, nullptr);
-    vkDestroyShaderModule(device, p->vsModule, nullptr);
-    vkDestroyShaderModule(device, p->fsModule, nullptr);
-    if (p->tsCtrlModule && p->tsEvalModule) {
-        vkDestroyShaderModule(device, p->tsCtrlModule, nullptr);
-        vkDestroyShaderModule(device, p->tsEvalModule, nullptr);
-    }
+    auto& shaderRegistry = ShaderRegistry::getInstance();
+    shaderRegistry.release(p->vsModule);
+    shaderRegistry.release(p->fsModule);
+    shaderRegistry.release(p->tsCtrlModule);
+    shaderRegistry.release(p->tsEvalModule);
     delete p;
 }
 
-bool Pipeliner::saveCache() {
-    Utils::printLog(INFO_PARAM, "saving pipeline cache: ", Constants::PIPELINE_CACHE_FILE);
+std::vector<char> Pipeliner::getCacheData() const {
     assert(m_device);
     assert(m_pipeline_cache);
     size_t cacheDataSize = 0u;
     // Determine the size of the cache data.
     VkResult result = vkGetPipelineCacheData(m_device, m_pipeline_cache, &cacheDataSize, nullptr);
-    if (result == VK_SUCCESS) {
-        // Allocate a temporary store for the cache data.
-        std::vector<char> buffer(cacheDataSize);
-        // Retrieve the actual data from the cache.
-        result = vkGetPipelineCacheData(m_device, m_pipeline_cache, &cacheDataSize, buffer.data());
-        if (result == VK_SUCCESS) {
-            // Open the file and write the data to it.
-
-            std::ofstream file(std::string{Constants::PIPELINE_CACHE_FILE}, std::ios::binary);
-            if (!file.is_open()) {
-                Utils::printLog(ERROR_PARAM, "error when opening file: ", std::string{Constants::PIPELINE_CACHE_FILE});
-            }
+    if (result != VK_SUCCESS) {
+        return {};
+    }
 
-            file.write(buffer.data(), buffer.size());
-            file.close();
-        }
+    // Retrieve the actual data from the cache.
+    std::vector<char> buffer(cacheDataSize);
+    result = vkGetPipelineCacheData(m_device, m_pipeline_cache, &cacheDataSize, buffer.data());
+    if (result != VK_SUCCESS) {
+        return {};
     }
 
+    buffer.resize(cacheDataSize);
+    return buffer;
+}
+
+void Pipeliner::init(VkDevice device, VkPhysicalDevice physicalDevice) {
+    assert(device);
+    assert(physicalDevice);
+    assert(!m_pipeline_cache);
+    m_device = device;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    m_cacheStore.init(properties, PipelineCacheStore::hashShaders(Constants::SHADERS_DIR));
+}
+
+bool Pipeliner::saveCache() {
+    assert(m_device);
+    assert(m_pipeline_cache);
+
+    const bool isSaved = m_cacheStore.save(getCacheData());
+    const auto& cacheStats = m_cacheStore.getStats();
+    Utils::printLog(INFO_PARAM, "pipeline cache: saved ", cacheStats.savedBytes / 1024u, " KiB in ", cacheStats.saveTimeMs,
+                    " ms, pruned files ", cacheStats.prunedFilesCount);
+
     vkDestroyPipelineCache(m_device, m_pipeline_cache, nullptr);
     m_pipeline_cache = nullptr;
 
-    return result == VK_SUCCESS ? true : false;
+    return isSaved;
 }
 
 bool Pipeliner::createCache() {
@@ -60,20 +81,7 @@ bool Pipeliner::createCache() {
 
     assert(m_device);
     std::vector<char> pipeline_data;
-
-    std::ifstream file(std::string{Constants::PIPELINE_CACHE_FILE}, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        Utils::printLog(INFO_PARAM, " pipeline cache not found ", Constants::PIPELINE_CACHE_FILE);
-    } else {
-        size_t cacheDataSize = (size_t)file.tellg();
-        pipeline_data.reserve(cacheDataSize);
-        pipeline_data.resize(cacheDataSize);
-
-        (cacheDataSize);
-        file.seekg(0);
-        file.read(pipeline_data.data(), cacheDataSize);
-        file.close();
-    }
+    m_cacheStore.load(pipeline_data);
 
     /* Add initial pipeline cache data from the cached file */
     VkPipelineCacheCreateInfo create_info{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
@@ -89,66 +97,24 @@ bool Pipeliner::createCache() {
 
 Pipeliner::Pipeliner() {
     // explicitly set all pipeline create info structs to default values to avoid uninitialized memory usage
-    memset(m_shaderStageCreateInfo, 0, sizeof(m_shaderStageCreateInfo));
-    _vertexInputInfo = {};
-    _pipelineIACreateInfo = {};
-    m_vpCreateInfo = {};
-    _rastCreateInfo = {};
-    _pipelineMSCreateInfo = {};
-    _blendCreateInfo = {};
-    _depthStencil = {};
-    _tessInfo = {};
-
-    m_shaderStageCreateInfo[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    m_shaderStageCreateInfo[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-    m_shaderStageCreateInfo[0].module = nullptr;
-    m_shaderStageCreateInfo[0].pName = "main";
-    m_shaderStageCreateInfo[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    m_shaderStageCreateInfo[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    m_shaderStageCreateInfo[1].module = nullptr;
-    m_shaderStageCreateInfo[1].pName = "main";
-    m_shaderStageCreateInfo[2].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    m_shaderStageCreateInfo[2].stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
-    m_shaderStageCreateInfo[2].module = nullptr;
-    m_shaderStageCreateInfo[2].pName = "main";
-    m_shaderStageCreateInfo[3].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    m_shaderStageCreateInfo[3].stage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
-    m_shaderStageCreateInfo[3].module = nullptr;
-    m_shaderStageCreateInfo[3].pName = "main";
-
-    _vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    static auto bindingDescriptions = I3DModel::Vertex::getBindingDescription();
-    static auto attributeDescriptions = I3DModel::Vertex::getAttributeDescriptions();
-    _vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    _vertexInputInfo.vertexBindingDescriptionCount = bindingDescriptions.size();
-    _vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
-    _vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    _pipelineIACreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    _pipelineIACreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-
-    m_vp.x = 0.0f;
-    m_vp.y = 0.0f;
-    m_vp.minDepth = 0.0f;
-    m_vp.maxDepth = 1.0f;
-
-    m_scissor.offset.x = 0;
-    m_scissor.offset.y = 0;
-
-    m_vpCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    m_vpCreateInfo.viewportCount = 1;
-    m_vpCreateInfo.pViewports = &m_vp;
-    m_vpCreateInfo.scissorCount = 1;
-    m_vpCreateInfo.pScissors = &m_scissor;
-
-    _rastCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    _rastCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
-    _rastCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-    _rastCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    _rastCreateInfo.lineWidth = 1.0f;
-
-    _pipelineMSCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    _pipelineMSCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    Description& description = m_defaultDescription;
+
+    const auto& bindingDescriptions = I3DModel::Vertex::getBindingDescription();
+    const auto& attributeDescriptions = I3DModel::Vertex::getAttributeDescriptions();
+    description.vertexBindings.assign(bindingDescriptions.begin(), bindingDescriptions.end());
+    description.vertexAttributes.assign(attributeDescriptions.begin(), attributeDescriptions.end());
+
+    description.inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    description.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    description.rasterizationInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    description.rasterizationInfo.polygonMode = VK_POLYGON_MODE_FILL;
+    description.rasterizationInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+    description.rasterizationInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    description.rasterizationInfo.lineWidth = 1.0f;
+
+    description.multisampleInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    description.multisampleInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
     // Default alpha blending
     VkPipelineColorBlendAttachmentState blendAttachState = {};
@@ -162,114 +128,226 @@ Pipeliner::Pipeliner() {
     blendAttachState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
     blendAttachState.alphaBlendOp = VK_BLEND_OP_ADD;
 
-    m_blendAttachments.assign(MAX_COLOR_ATTACHMENTS, blendAttachState);
-
-    _blendCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    _blendCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-    _blendCreateInfo.attachmentCount = static_cast<uint32_t>(m_blendAttachments.size());
-    _blendCreateInfo.pAttachments = m_blendAttachments.data();
-
-    _depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    _depthStencil.depthTestEnable = VK_TRUE;
-    _depthStencil.depthWriteEnable = VK_TRUE;
-    _depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-    _depthStencil.depthBoundsTestEnable = VK_FALSE;
-    _depthStencil.minDepthBounds = 0.0f;  // Optional
-    _depthStencil.maxDepthBounds = 1.0f;  // Optional
-    _depthStencil.stencilTestEnable = VK_FALSE;
-    _depthStencil.front = {};  // Optional
-    _depthStencil.back = {};   // Optional
-
-    _tessInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
-    _tessInfo.pNext = nullptr;
-    _tessInfo.flags = 0;
-    _tessInfo.patchControlPoints = 3;
-
-    /// set default configuration
-    m_vertexInputInfo = _vertexInputInfo;
-    m_pipelineIACreateInfo = _pipelineIACreateInfo;
-    m_rastCreateInfo = _rastCreateInfo;
-    m_pipelineMSCreateInfo = _pipelineMSCreateInfo;
-    m_blendCreateInfo = _blendCreateInfo;
-    m_depthStencil = _depthStencil;
-    m_tessInfo = _tessInfo;
+    description.blendAttachments.fill(blendAttachState);
+
+    description.colorBlendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    description.colorBlendInfo.logicOp = VK_LOGIC_OP_COPY;
+    description.colorBlendInfo.attachmentCount = MAX_COLOR_ATTACHMENTS;
+
+    description.depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    description.depthStencilInfo.depthTestEnable = VK_TRUE;
+    description.depthStencilInfo.depthWriteEnable = VK_TRUE;
+    description.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+    description.depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
+    description.depthStencilInfo.minDepthBounds = 0.0f;  // Optional
+    description.depthStencilInfo.maxDepthBounds = 1.0f;  // Optional
+    description.depthStencilInfo.stencilTestEnable = VK_FALSE;
+    description.depthStencilInfo.front = {};  // Optional
+    description.depthStencilInfo.back = {};   // Optional
+
+    description.tessInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    description.tessInfo.pNext = nullptr;
+    description.tessInfo.flags = 0;
+    description.tessInfo.patchControlPoints = 3;
 }
 
-void Pipeliner::resetColorBlendAttachments() {
-    // Restore every attachment slot to the pristine default (all channels writable, standard alpha blend).
-    // Several PipelineCreator::createPipeline() implementations (Particle, SemiTransparent) mutate specific
-    // slots of this SHARED singleton array in place (e.g. restrict colorWriteMask to R|G for their own
-    // motion-vector attachment) and never revert them. Without this reset, those mutations leak into the
-    // NEXT pipeline-(re)creation cycle and corrupt unrelated pipelines/attachments that happen to reuse the
-    // same attachment index for a different purpose (e.g. GPass's normal buffer at index 1).
-    VkPipelineColorBlendAttachmentState blendAttachState = {};
-    blendAttachState.colorWriteMask =
-        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    blendAttachState.blendEnable = VK_TRUE;
-    blendAttachState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    blendAttachState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-    blendAttachState.colorBlendOp = VK_BLEND_OP_ADD;
-    blendAttachState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    blendAttachState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    blendAttachState.alphaBlendOp = VK_BLEND_OP_ADD;
+Pipeliner::pipeline_ptr Pipeliner::createPipeLine(const Description& description, VkDevice device) {
+    m_device = device;
+    assert(m_device);
 
-    m_blendAttachments.assign(MAX_COLOR_ATTACHMENTS, blendAttachState);
-    m_blendCreateInfo.attachmentCount = static_cast<uint32_t>(m_blendAttachments.size());
-    m_blendCreateInfo.pAttachments = m_blendAttachments.data();
+    if (!m_pipeline_cache) {
+        createCache();
+    }
+
+    VkPipelineCreationFeedback feedback{};
+    return compilePipeLine(description, device, m_pipeline_cache, feedback);
 }
 
-Pipeliner::pipeline_ptr Pipeliner::createPipeLine(std::string_view vertShader, std::string_view fragShader, uint32_t width,
-                                                  uint32_t height, VkDescriptorSetLayout descriptorSetLayout,
-                                                  VkRenderPass renderPass, VkDevice device, uint32_t subpass,
-                                                  VkPushConstantRange pushConstantRange) {
-    return createPipeLine(vertShader, fragShader, std::string_view{}, std::string_view{}, width, height, descriptorSetLayout,
-                          renderPass, device, subpass, pushConstantRange);
+std::future<Pipeliner::pipeline_ptr> Pipeliner::createPipeLineAsync(Description description, VkDevice device) {
+    m_device = device;
+    assert(m_device);
+
+    if (!m_pipeline_cache) {
+        createCache();
+    }
+
+    // the cache is internally synchronized, the render thread may compile against it concurrently
+    return std::async(std::launch::async, [this, description = std::move(description), device, cache = m_pipeline_cache]() {
+        VkPipelineCreationFeedback feedback{};
+        return compilePipeLine(description, device, cache, feedback);
+    });
 }
 
-Pipeliner::pipeline_ptr Pipeliner::createPipeLine(std::string_view vertShader, std::string_view fragShader,
-                                                  std::string_view tessCtrlShader, std::string_view tessEvalShader,
-                                                  uint32_t width, uint32_t height, VkDescriptorSetLayout descriptorSetLayout,
-                                                  VkRenderPass renderPass, VkDevice device, uint32_t subpass,
-                                                  VkPushConstantRange pushConstantRange) {
+std::vector<Pipeliner::pipeline_ptr> Pipeliner::createPipeLines(const std::vector<Description>& descriptions, VkDevice device) {
     m_device = device;
     assert(m_device);
-    assert(descriptorSetLayout);
 
     if (!m_pipeline_cache) {
         createCache();
     }
 
-    VkGraphicsPipelineCreateInfo pipelineInfo = {};
+    std::vector<pipeline_ptr> pipelines(descriptions.size());
+    if (descriptions.empty()) {
+        return pipelines;
+    }
+    const auto startTime = std::chrono::steady_clock::now();
+
+    const uint32_t threadsCount =
+        std::clamp(std::thread::hardware_concurrency(), 1u, static_cast<uint32_t>(descriptions.size()));
+
+    // drivers lock a cache on every lookup and insertion, so each thread gets its own one
+    // seeded by the shared cache, the pipelines compiled before are still hits
+    const std::vector<char> cacheData = getCacheData();
+    VkPipelineCacheCreateInfo cacheInfo{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    cacheInfo.initialDataSize = cacheData.size();
+    cacheInfo.pInitialData = cacheData.data();
+
+    std::vector<VkPipelineCache> threadCaches(threadsCount, VK_NULL_HANDLE);
+    for (auto& threadCache : threadCaches) {
+        VkResult res = vkCreatePipelineCache(device, &cacheInfo, nullptr, &threadCache);
+        CHECK_VULKAN_ERROR("vkCreatePipelineCache error %d\n", res);
+    }
 
-    bool isTesselationEnabled = !tessCtrlShader.empty() && !tessEvalShader.empty();
+    std::vector<VkPipelineCreationFeedback> feedbacks(descriptions.size());
+    std::atomic<size_t> nextDescription{0u};
+    std::vector<std::future<void>> workerThreads{threadsCount};
+    for (uint32_t i = 0u; i < threadsCount; ++i) {
+        workerThreads[i] = std::async(std::launch::async, [this, &descriptions, &pipelines, &feedbacks, &nextDescription,
+                                                            device, cache = threadCaches[i]]() {
+            for (size_t index = nextDescription++; index < descriptions.size(); index = nextDescription++) {
+                pipelines[index] = compilePipeLine(descriptions[index], device, cache, feedbacks[index]);
+            }
+        });
+    }
+
+    // the caches must outlive the workers, so the first error is rethrown after the merge
+    std::exception_ptr workerError{nullptr};
+    for (auto& workerThread : workerThreads) {
+        try {
+            workerThread.get();
+        } catch (...) {
+            if (!workerError) {
+                workerError = std::current_exception();
+            }
+        }
+    }
+
+    VkResult res = vkMergePipelineCaches(device, m_pipeline_cache, threadsCount, threadCaches.data());
+    CHECK_VULKAN_ERROR("vkMergePipelineCaches error %d\n", res);
+
+    for (auto threadCache : threadCaches) {
+        vkDestroyPipelineCache(device, threadCache, nullptr);
+    }
+
+    if (workerError) {
+        std::rethrow_exception(workerError);
+    }
+
+    m_stats = {};
+    m_stats.pipelinesCount = static_cast<uint32_t>(descriptions.size());
+    m_stats.threadsCount = threadsCount;
+    m_stats.compileTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    for (const auto& feedback : feedbacks) {
+        if ((feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) &&
+            (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)) {
+            ++m_stats.cacheHitsCount;
+        }
+    }
+
+    const auto& cacheStats = m_cacheStore.getStats();
+    Utils::printLog(INFO_PARAM, "pipelines: ", m_stats.pipelinesCount, " created in ", m_stats.compileTimeMs, " ms on ",
+                    m_stats.threadsCount, " threads, cache hits ", m_stats.cacheHitsCount, "/", m_stats.pipelinesCount,
+                    ", cache ", cacheStats.is_loaded ? "loaded " : "not loaded ", cacheStats.loadedBytes / 1024u, " KiB in ",
+                    cacheStats.loadTimeMs, " ms");
+
+    return pipelines;
+}
+
+Pipeliner::pipeline_ptr Pipeliner::compilePipeLine(const Description& description, VkDevice device,
+                                                   VkPipelineCache cache, VkPipelineCreationFeedback& outFeedback) const {
+    assert(device);
+    assert(cache);
+    assert(description.descriptorSetLayout);
+    assert(description.renderPass);
+
+    bool isTesselationEnabled = !description.tessCtrlShader.empty() && !description.tessEvalShader.empty();
 
     std::unique_ptr<PipeLine, decltype(&deletePipeLine)> pipeline(new Pipeliner::PipeLine(), deletePipeLine);
-    pipeline->vsModule = Utils::VulkanCreateShaderModule(device, vertShader);
-    pipeline->fsModule = Utils::VulkanCreateShaderModule(device, fragShader);
-    m_shaderStageCreateInfo[0].module = pipeline->vsModule;
-    m_shaderStageCreateInfo[1].module = pipeline->fsModule;
+    auto& shaderRegistry = ShaderRegistry::getInstance();
+    pipeline->vsModule = shaderRegistry.acquire(description.vertShader);
+    pipeline->fsModule = shaderRegistry.acquire(description.fragShader);
+
+    VkPipelineShaderStageCreateInfo shaderStageCreateInfo[4]{};
+    const VkShaderStageFlagBits stages[4] = {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT,
+                                             VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+                                             VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT};
+    for (uint32_t i = 0u; i < 4u; ++i) {
+        shaderStageCreateInfo[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStageCreateInfo[i].stage = stages[i];
+        shaderStageCreateInfo[i].pName = "main";
+    }
+    shaderStageCreateInfo[0].module = pipeline->vsModule;
+    shaderStageCreateInfo[1].module = pipeline->fsModule;
+
+    // one set of the constants is shared by the stages, each stage picks the ids it declares
+    std::vector<VkSpecializationMapEntry> specializationEntries(description.specializationConstants.size());
+    std::vector<uint32_t> specializationData(description.specializationConstants.size());
+    for (size_t i = 0u; i < description.specializationConstants.size(); ++i) {
+        specializationEntries[i].constantID = description.specializationConstants[i].constantId;
+        specializationEntries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+        specializationEntries[i].size = sizeof(uint32_t);
+        specializationData[i] = description.specializationConstants[i].value;
+    }
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+    specializationInfo.pMapEntries = specializationEntries.data();
+    specializationInfo.dataSize = specializationData.size() * sizeof(uint32_t);
+    specializationInfo.pData = specializationData.data();
+    if (!specializationEntries.empty()) {
+        for (auto& stageCreateInfo : shaderStageCreateInfo) {
+            stageCreateInfo.pSpecializationInfo = &specializationInfo;
+        }
+    }
 
     if (isTesselationEnabled) {
-        pipelineInfo.pTessellationState = &m_tessInfo;
-        pipeline->tsCtrlModule = Utils::VulkanCreateShaderModule(device, tessCtrlShader);
-        m_shaderStageCreateInfo[2].module = pipeline->tsCtrlModule;
-        pipeline->tsEvalModule = Utils::VulkanCreateShaderModule(device, tessEvalShader);
-        m_shaderStageCreateInfo[3].module = pipeline->tsEvalModule;
+        pipeline->tsCtrlModule = shaderRegistry.acquire(description.tessCtrlShader);
+        shaderStageCreateInfo[2].module = pipeline->tsCtrlModule;
+        pipeline->tsEvalModule = shaderRegistry.acquire(description.tessEvalShader);
+        shaderStageCreateInfo[3].module = pipeline->tsEvalModule;
     }
 
-    m_vp.width = (float)width;
-    m_vp.height = (float)height;
+    validateLayout(description, *pipeline);
+    validateSpecialization(description, *pipeline);
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(description.vertexBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = description.vertexBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(description.vertexAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = description.vertexAttributes.data();
+
+    // the values are set by Utils::VulkanSetViewport on recording, only the counts are static
+    VkPipelineViewportStateCreateInfo vpCreateInfo{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+    vpCreateInfo.viewportCount = 1;
+    vpCreateInfo.pViewports = nullptr;
+    vpCreateInfo.scissorCount = 1;
+    vpCreateInfo.pScissors = nullptr;
 
-    m_scissor.extent.width = width;
-    m_scissor.extent.height = height;
+    const std::array<VkDynamicState, 2> dynamicStates{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicStateInfo{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+    dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicStateInfo.pDynamicStates = dynamicStates.data();
+
+    assert(description.colorBlendInfo.attachmentCount <= MAX_COLOR_ATTACHMENTS);
+    VkPipelineColorBlendStateCreateInfo blendCreateInfo = description.colorBlendInfo;
+    blendCreateInfo.pAttachments = description.blendAttachments.data();
 
     VkPipelineLayoutCreateInfo layoutInfo = {};
     layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     layoutInfo.setLayoutCount = 1;
-    layoutInfo.pSetLayouts = &descriptorSetLayout;
-    if (pushConstantRange.size != 0u) {
+    layoutInfo.pSetLayouts = &description.descriptorSetLayout;
+    if (description.pushConstantRange.size != 0u) {
         layoutInfo.pushConstantRangeCount = 1;
-        layoutInfo.pPushConstantRanges = &pushConstantRange;
+        layoutInfo.pPushConstantRanges = &description.pushConstantRange;
     } else {
         layoutInfo.pushConstantRangeCount = 0;
         layoutInfo.pPushConstantRanges = nullptr;
@@ -278,32 +356,111 @@ Pipeliner::pipeline_ptr Pipeliner::createPipeLine(std::string_view vertShader, s
     VkResult res = vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipeline->pipelineLayout);
     CHECK_VULKAN_ERROR("vkCreatePipelineLayout error %d\n", res);
 
+    // tells whether the driver found the pipeline in the cache
+    outFeedback = {};
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo{VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO};
+    feedbackInfo.pPipelineCreationFeedback = &outFeedback;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = &feedbackInfo;
     pipelineInfo.stageCount = isTesselationEnabled ? 4u : 2u;
-    pipelineInfo.pStages = &m_shaderStageCreateInfo[0];
-    pipelineInfo.pVertexInputState = &m_vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &m_pipelineIACreateInfo;
-    pipelineInfo.pViewportState = &m_vpCreateInfo;
-    pipelineInfo.pRasterizationState = &m_rastCreateInfo;
-    pipelineInfo.pMultisampleState = &m_pipelineMSCreateInfo;
-    pipelineInfo.pColorBlendState = &m_blendCreateInfo;
+    pipelineInfo.pStages = &shaderStageCreateInfo[0];
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &description.inputAssemblyInfo;
+    pipelineInfo.pTessellationState = isTesselationEnabled ? &description.tessInfo : nullptr;
+    pipelineInfo.pViewportState = &vpCreateInfo;
+    pipelineInfo.pRasterizationState = &description.rasterizationInfo;
+    pipelineInfo.pMultisampleState = &description.multisampleInfo;
+    pipelineInfo.pColorBlendState = &blendCreateInfo;
+    pipelineInfo.pDynamicState = &dynamicStateInfo;
     pipelineInfo.layout = pipeline->pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.renderPass = description.renderPass;
     pipelineInfo.basePipelineIndex = -1;
-    pipelineInfo.pDepthStencilState = &m_depthStencil;
-    pipelineInfo.subpass = subpass;
+    pipelineInfo.pDepthStencilState = &description.depthStencilInfo;
+    pipelineInfo.subpass = description.subpass;
 
-    res = vkCreateGraphicsPipelines(device, m_pipeline_cache, 1, &pipelineInfo, nullptr, &pipeline->pipeline);
+    res = vkCreateGraphicsPipelines(device, cache, 1, &pipelineInfo, nullptr, &pipeline->pipeline);
     CHECK_VULKAN_ERROR("vkCreateGraphicsPipelines error %d\n", res);
 
-    /// restore default configuration
-    m_vertexInputInfo = _vertexInputInfo;
-    m_pipelineIACreateInfo = _pipelineIACreateInfo;
-    m_rastCreateInfo = _rastCreateInfo;
-    m_pipelineMSCreateInfo = _pipelineMSCreateInfo;
-    m_blendCreateInfo = _blendCreateInfo;
-    m_depthStencil = _depthStencil;
-    m_tessInfo = _tessInfo;
-
     return pipeline;
 }
+
+namespace {
+/// dynamic offsets are a property of the descriptor set, the shaders see plain buffers
+VkDescriptorType getStaticType(VkDescriptorType type) {
+    switch (type) {
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        default:
+            return type;
+    }
+}
+}  // namespace
+
+void Pipeliner::validateSpecialization(const Description& description, const PipeLine& pipeline) const {
+    auto& shaderRegistry = ShaderRegistry::getInstance();
+    for (const auto& constant : description.specializationConstants) {
+        bool is_declared = false;
+        for (VkShaderModule module : {pipeline.vsModule, pipeline.fsModule, pipeline.tsCtrlModule, pipeline.tsEvalModule}) {
+            if (module) {
+                const auto& ids = shaderRegistry.getReflection(module).specializationConstantIds;
+                is_declared |= std::find(ids.begin(), ids.end(), constant.constantId) != ids.end();
+            }
+        }
+        if (!is_declared) {
+            Utils::printLog(WARNING_PARAM, description.vertShader, ": specialization constant ", constant.constantId,
+                            " is not declared by the shaders, recompile them from shadersSRC");
+        }
+    }
+}
+
+void Pipeliner::validateLayout(const Description& description, const PipeLine& pipeline) const {
+    if (description.layoutBindings.empty()) {
+        return;  // the creator didn't provide the bindings
+    }
+
+    auto& shaderRegistry = ShaderRegistry::getInstance();
+    bool isPushConstantUsed = false;
+    for (VkShaderModule module : {pipeline.vsModule, pipeline.fsModule, pipeline.tsCtrlModule, pipeline.tsEvalModule}) {
+        if (!module) {
+            continue;
+        }
+
+        const auto& reflection = shaderRegistry.getReflection(module);
+        isPushConstantUsed |= reflection.is_pushConstantUsed;
+        const std::string_view shaderName = module == pipeline.vsModule   ? description.vertShader
+                                            : module == pipeline.fsModule ? description.fragShader
+                                            : module == pipeline.tsCtrlModule ? description.tessCtrlShader
+                                                                              : description.tessEvalShader;
+
+        for (const auto& binding : reflection.bindings) {
+            if (binding.set != 0u) {
+                Utils::printLog(WARNING_PARAM, shaderName, ": descriptor set ", binding.set, " is not bound by the pipeline");
+                continue;
+            }
+
+            auto layoutBinding = std::find_if(
+                description.layoutBindings.begin(), description.layoutBindings.end(),
+                [&binding](const VkDescriptorSetLayoutBinding& candidate) { return candidate.binding == binding.binding; });
+            if (layoutBinding == description.layoutBindings.end()) {
+                Utils::printLog(WARNING_PARAM, shaderName, ": binding ", binding.binding, " is missing in the layout");
+            } else if (getStaticType(layoutBinding->descriptorType) != binding.type) {
+                Utils::printLog(WARNING_PARAM, shaderName, ": binding ", binding.binding, " type ", binding.type,
+                                " differs from the layout type ", layoutBinding->descriptorType);
+            } else if (binding.count != 0u && layoutBinding->descriptorCount < binding.count) {
+                Utils::printLog(WARNING_PARAM, shaderName, ": binding ", binding.binding, " count ", binding.count,
+                                " exceeds the layout count ", layoutBinding->descriptorCount);
+            } else if (!(layoutBinding->stageFlags & reflection.stage)) {
+                Utils::printLog(WARNING_PARAM, shaderName, ": binding ", binding.binding,
+                                " is not visible to the stage in the layout");
+            }
+        }
+    }
+
+    if (isPushConstantUsed && description.pushConstantRange.size == 0u) {
+        Utils::printLog(WARNING_PARAM, description.vertShader, ": push constants are used but not declared by the pipeline");
+    }
+}
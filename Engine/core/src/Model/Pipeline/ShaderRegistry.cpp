@@ -0,0 +1,487 @@
+#include "ShaderRegistry.h"
+#include "Constants.h"
+#include "Utils.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+/// SPIR-V specification: the values used by the reflection
+constexpr uint32_t SPIRV_MAGIC = 0x07230203u;
+constexpr uint32_t SPIRV_HEADER_WORDS = 5u;
+
+constexpr uint32_t OP_ENTRY_POINT = 15u;
+constexpr uint32_t OP_TYPE_IMAGE = 25u;
+constexpr uint32_t OP_TYPE_SAMPLER = 26u;
+constexpr uint32_t OP_TYPE_SAMPLED_IMAGE = 27u;
+constexpr uint32_t OP_TYPE_ARRAY = 28u;
+constexpr uint32_t OP_TYPE_RUNTIME_ARRAY = 29u;
+constexpr uint32_t OP_TYPE_POINTER = 32u;
+constexpr uint32_t OP_CONSTANT = 43u;
+constexpr uint32_t OP_VARIABLE = 59u;
+constexpr uint32_t OP_DECORATE = 71u;
+
+constexpr uint32_t DECORATION_SPEC_ID = 1u;
+constexpr uint32_t DECORATION_BLOCK = 2u;
+constexpr uint32_t DECORATION_BUFFER_BLOCK = 3u;
+constexpr uint32_t DECORATION_BINDING = 33u;
+constexpr uint32_t DECORATION_DESCRIPTOR_SET = 34u;
+
+constexpr uint32_t STORAGE_CLASS_UNIFORM_CONSTANT = 0u;
+constexpr uint32_t STORAGE_CLASS_UNIFORM = 2u;
+constexpr uint32_t STORAGE_CLASS_PUSH_CONSTANT = 9u;
+constexpr uint32_t STORAGE_CLASS_STORAGE_BUFFER = 12u;
+
+constexpr uint32_t DIM_BUFFER = 5u;
+constexpr uint32_t DIM_SUBPASS_DATA = 6u;
+
+VkShaderStageFlagBits getStage(uint32_t executionModel) {
+    switch (executionModel) {
+        case 0u:
+            return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1u:
+            return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2u:
+            return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3u:
+            return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4u:
+            return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5u:
+            return VK_SHADER_STAGE_COMPUTE_BIT;
+        default:
+            return VK_SHADER_STAGE_ALL;
+    }
+}
+}  // namespace
+
+void ShaderRegistry::init(VkDevice device) {
+    assert(device);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_device = device;
+    m_archiveEntries.clear();
+    m_archivePath.clear();
+
+    const std::string archivePath = Utils::formPath(Constants::SHADERS_DIR, Constants::SHADERS_ARCHIVE);
+    std::ifstream file(archivePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    ArchiveHeader header;
+    const ArchiveHeader expectedHeader;
+    if (fileSize < sizeof(ArchiveHeader) || !file.read(reinterpret_cast<char*>(&header), sizeof(ArchiveHeader)) ||
+        memcmp(header.identifier, expectedHeader.identifier, sizeof(header.identifier)) != 0 ||
+        header.version != ARCHIVE_VERSION ||
+        fileSize < sizeof(ArchiveHeader) + uint64_t{header.entriesCount} * sizeof(ArchiveEntry)) {
+        Utils::printLog(WARNING_PARAM, "outdated shaders archive ", archivePath, ", the .spv files are used");
+        return;
+    }
+
+    std::vector<ArchiveEntry> entries(header.entriesCount);
+    file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(ArchiveEntry));
+    for (auto& entry : entries) {
+        entry.fileName[sizeof(entry.fileName) - 1u] = '\0';
+        if (entry.byteOffset + entry.byteLength > fileSize) {
+            Utils::printLog(WARNING_PARAM, "broken shaders archive ", archivePath, ", the .spv files are used");
+            m_archiveEntries.clear();
+            return;
+        }
+        m_archiveEntries[entry.fileName] = entry;
+    }
+
+    // the shaders recompiled after the packing are read from their files
+    std::error_code error;
+    const auto archiveTime = std::filesystem::last_write_time(archivePath, error);
+    uint32_t shadowedCount = 0u;
+    for (auto it = m_archiveEntries.begin(); !error && it != m_archiveEntries.end();) {
+        std::error_code fileError;
+        const auto fileTime = std::filesystem::last_write_time(Utils::formPath(Constants::SHADERS_DIR, it->first), fileError);
+        if (!fileError && fileTime > archiveTime) {
+            Utils::printLog(DEBUG_PARAM, it->first, " is newer than the shaders archive, the file is used");
+            it = m_archiveEntries.erase(it);
+            ++shadowedCount;
+        } else {
+            ++it;
+        }
+    }
+
+    m_archivePath = archivePath;
+    Utils::printLog(INFO_PARAM, "shaders archive ", archivePath, ": ", m_archiveEntries.size(), " shaders");
+    if (shadowedCount != 0u) {
+        Utils::printLog(INFO_PARAM, shadowedCount, " archived shaders are shadowed by newer .spv files, run --pack-shaders");
+    }
+}
+
+void ShaderRegistry::destroy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(m_modules.empty() && "shader modules are still used by pipelines");
+    for (auto& [hash, module] : m_modules) {
+        vkDestroyShaderModule(m_device, module.module, nullptr);
+    }
+    m_modules.clear();
+    m_moduleHashes.clear();
+    m_fileHashes.clear();
+    m_stats.modulesCount = 0u;
+    m_device = nullptr;
+}
+
+VkShaderModule ShaderRegistry::acquire(std::string_view fileName) {
+    const std::string name{fileName};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(m_device);
+        auto fileHash = m_fileHashes.find(name);
+        if (fileHash != m_fileHashes.end()) {
+            auto module = m_modules.find(fileHash->second);
+            if (module != m_modules.end()) {
+                ++module->second.refCount;
+                ++m_stats.reusedCount;
+                return module->second.module;
+            }
+        }
+    }
+
+    // reading and reflection don't need the lock, other workers go on meanwhile
+    std::vector<uint32_t> code;
+    if (!readCode(name, code)) {
+        Utils::printLog(ERROR_PARAM, "failed to read shader ", name);
+    }
+    const uint64_t hash = Utils::hashBytes(Utils::HASH_OFFSET_BASIS, code.data(), code.size() * sizeof(uint32_t));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.loadedCount;
+    m_fileHashes[name] = hash;
+
+    // another file with the same content or another worker with the same file
+    auto module = m_modules.find(hash);
+    if (module != m_modules.end()) {
+        ++module->second.refCount;
+        ++m_stats.reusedCount;
+        return module->second.module;
+    }
+
+    Module newModule;
+    if (!reflect(code.data(), code.size(), newModule.reflection)) {
+        Utils::printLog(ERROR_PARAM, "invalid SPIR-V ", name);
+    }
+
+    VkShaderModuleCreateInfo shaderCreateInfo = {};
+    shaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderCreateInfo.codeSize = code.size() * sizeof(uint32_t);
+    shaderCreateInfo.pCode = code.data();
+
+    VkResult res = vkCreateShaderModule(m_device, &shaderCreateInfo, nullptr, &newModule.module);
+    CHECK_VULKAN_ERROR("vkCreateShaderModule error %d\n", res);
+    Utils::printLog(DEBUG_PARAM, "Created shader ", name);
+
+    newModule.refCount = 1u;
+    m_moduleHashes[newModule.module] = hash;
+    m_stats.modulesCount = static_cast<uint32_t>(m_modules.size() + 1u);
+    return m_modules.emplace(hash, std::move(newModule)).first->second.module;
+}
+
+void ShaderRegistry::release(VkShaderModule module) {
+    if (!module) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto hash = m_moduleHashes.find(module);
+    assert(hash != m_moduleHashes.end());
+    auto registered = m_modules.find(hash->second);
+    assert(registered != m_modules.end() && registered->second.refCount > 0u);
+    if (--registered->second.refCount != 0u) {
+        return;
+    }
+
+    vkDestroyShaderModule(m_device, module, nullptr);
+    m_moduleHashes.erase(hash);
+    m_modules.erase(registered);
+    m_stats.modulesCount = static_cast<uint32_t>(m_modules.size());
+}
+
+const ShaderRegistry::Reflection& ShaderRegistry::getReflection(VkShaderModule module) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_modules.at(m_moduleHashes.at(module)).reflection;
+}
+
+ShaderRegistry::Stats ShaderRegistry::getStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool ShaderRegistry::isLoadable(std::string_view fileName, Reflection& outReflection) const {
+    std::vector<uint32_t> code;
+    return readCode(std::string{fileName}, code) && reflect(code.data(), code.size(), outReflection);
+}
+
+bool ShaderRegistry::readCode(const std::string& fileName, std::vector<uint32_t>& outCode) const {
+    auto entry = m_archiveEntries.find(fileName);
+    const bool isArchived = entry != m_archiveEntries.end();
+    std::ifstream file(isArchived ? m_archivePath : Utils::formPath(Constants::SHADERS_DIR, fileName),
+                       std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const uint64_t byteOffset = isArchived ? entry->second.byteOffset : 0u;
+    const uint64_t byteLength = isArchived ? entry->second.byteLength : static_cast<uint64_t>(file.tellg());
+    if (byteLength == 0u || byteLength % sizeof(uint32_t) != 0u) {
+        return false;
+    }
+
+    outCode.resize(static_cast<size_t>(byteLength / sizeof(uint32_t)));
+    file.seekg(static_cast<std::streamoff>(byteOffset));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(outCode.data()), byteLength));
+}
+
+bool ShaderRegistry::reflect(const uint32_t* code, size_t wordsCount, Reflection& outReflection) {
+    outReflection = {};
+    if (wordsCount < SPIRV_HEADER_WORDS || code[0] != SPIRV_MAGIC) {
+        return false;
+    }
+
+    struct Id {
+        uint32_t opcode{0u};
+        uint32_t storageClass{0u};  // pointers and variables
+        uint32_t typeId{0u};        // pointee, element or variable type
+        uint32_t value{0u};         // constant value, image dim
+        uint32_t sampled{0u};       // image
+        uint32_t set{UINT32_MAX};
+        uint32_t binding{UINT32_MAX};
+        bool is_block{false};
+        bool is_bufferBlock{false};
+    };
+
+    const uint32_t bound = code[3];
+    std::vector<Id> ids(bound);
+    std::vector<uint32_t> variables;
+
+    for (size_t offset = SPIRV_HEADER_WORDS; offset < wordsCount;) {
+        const uint32_t opcode = code[offset] & 0xFFFFu;
+        const uint32_t count = code[offset] >> 16u;
+        if (count == 0u || offset + count > wordsCount) {
+            return false;
+        }
+        const uint32_t* words = code + offset;
+        auto getId = [&ids, bound](uint32_t id) -> Id* { return id < bound ? &ids[id] : nullptr; };
+
+        switch (opcode) {
+            case OP_ENTRY_POINT:
+                if (count >= 2u) {
+                    outReflection.stage = getStage(words[1]);
+                }
+                break;
+            case OP_DECORATE:
+                if (Id* id = count >= 3u ? getId(words[1]) : nullptr) {
+                    if (words[2] == DECORATION_DESCRIPTOR_SET && count >= 4u) {
+                        id->set = words[3];
+                    } else if (words[2] == DECORATION_BINDING && count >= 4u) {
+                        id->binding = words[3];
+                    } else if (words[2] == DECORATION_BLOCK) {
+                        id->is_block = true;
+                    } else if (words[2] == DECORATION_BUFFER_BLOCK) {
+                        id->is_bufferBlock = true;
+                    } else if (words[2] == DECORATION_SPEC_ID && count >= 4u) {
+                        outReflection.specializationConstantIds.push_back(words[3]);
+                    }
+                }
+                break;
+            case OP_TYPE_IMAGE:
+                if (Id* id = count >= 8u ? getId(words[1]) : nullptr) {
+                    id->opcode = opcode;
+                    id->value = words[3];
+                    id->sampled = words[7];
+                }
+                break;
+            case OP_TYPE_SAMPLER:
+            case OP_TYPE_SAMPLED_IMAGE:
+            case OP_TYPE_RUNTIME_ARRAY:
+                if (Id* id = count >= 2u ? getId(words[1]) : nullptr) {
+                    id->opcode = opcode;
+                    id->typeId = count >= 3u ? words[2] : 0u;
+                }
+                break;
+            case OP_TYPE_ARRAY:
+                if (Id* id = count >= 4u ? getId(words[1]) : nullptr) {
+                    id->opcode = opcode;
+                    id->typeId = words[2];
+                    id->value = words[3];  // length constant id, resolved below
+                }
+                break;
+            case OP_TYPE_POINTER:
+                if (Id* id = count >= 4u ? getId(words[1]) : nullptr) {
+                    id->opcode = opcode;
+                    id->storageClass = words[2];
+                    id->typeId = words[3];
+                }
+                break;
+            case OP_CONSTANT:
+                if (Id* id = count >= 4u ? getId(words[2]) : nullptr) {
+                    id->opcode = opcode;
+                    id->value = words[3];
+                }
+                break;
+            case OP_VARIABLE:
+                if (Id* id = count >= 4u ? getId(words[2]) : nullptr) {
+                    id->opcode = opcode;
+                    id->typeId = words[1];
+                    id->storageClass = words[3];
+                    variables.push_back(words[2]);
+                }
+                break;
+            default:
+                break;
+        }
+
+        offset += count;
+    }
+
+    for (uint32_t variableId : variables) {
+        const Id& variable = ids[variableId];
+        if (variable.storageClass == STORAGE_CLASS_PUSH_CONSTANT) {
+            outReflection.is_pushConstantUsed = true;
+            continue;
+        }
+        if (variable.storageClass != STORAGE_CLASS_UNIFORM_CONSTANT && variable.storageClass != STORAGE_CLASS_UNIFORM &&
+            variable.storageClass != STORAGE_CLASS_STORAGE_BUFFER) {
+            continue;
+        }
+        if (variable.typeId >= bound || ids[variable.typeId].typeId >= bound) {
+            return false;
+        }
+
+        Binding binding;
+        binding.set = variable.set == UINT32_MAX ? 0u : variable.set;
+        binding.binding = variable.binding == UINT32_MAX ? 0u : variable.binding;
+
+        // pointer -> (array ->) resource type
+        const Id* type = &ids[ids[variable.typeId].typeId];
+        if (type->opcode == OP_TYPE_ARRAY || type->opcode == OP_TYPE_RUNTIME_ARRAY) {
+            binding.count = 0u;
+            if (type->opcode == OP_TYPE_ARRAY && type->value < bound && ids[type->value].opcode == OP_CONSTANT) {
+                binding.count = ids[type->value].value;
+            }
+            if (type->typeId >= bound) {
+                return false;
+            }
+            type = &ids[type->typeId];
+        }
+
+        switch (type->opcode) {
+            case OP_TYPE_SAMPLED_IMAGE:
+                binding.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                if (type->typeId < bound && ids[type->typeId].value == DIM_BUFFER) {
+                    binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                }
+                break;
+            case OP_TYPE_SAMPLER:
+                binding.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+                break;
+            case OP_TYPE_IMAGE:
+                if (type->value == DIM_SUBPASS_DATA) {
+                    binding.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                } else if (type->value == DIM_BUFFER) {
+                    binding.type = type->sampled == 2u ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+                                                       : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                } else {
+                    binding.type = type->sampled == 2u ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                }
+                break;
+            default:
+                if (variable.storageClass == STORAGE_CLASS_STORAGE_BUFFER || type->is_bufferBlock) {
+                    binding.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                } else if (variable.storageClass == STORAGE_CLASS_UNIFORM && type->is_block) {
+                    binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                } else {
+                    continue;  // e.g. acceleration structures, not used by the engine
+                }
+                break;
+        }
+
+        outReflection.bindings.push_back(binding);
+    }
+
+    std::sort(outReflection.bindings.begin(), outReflection.bindings.end(), [](const Binding& a, const Binding& b) {
+        return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+    });
+
+    return true;
+}
+
+bool ShaderRegistry::packArchive(std::string_view shadersDir, const std::string& archivePath) {
+    std::error_code error;
+    std::vector<std::filesystem::path> shaderPaths;
+    for (const auto& entry : std::filesystem::directory_iterator(shadersDir, error)) {
+        if (entry.is_regular_file(error) && entry.path().extension() == ".spv") {
+            shaderPaths.push_back(entry.path());
+        }
+    }
+    std::sort(shaderPaths.begin(), shaderPaths.end());
+
+    ArchiveHeader header;
+    header.entriesCount = static_cast<uint32_t>(shaderPaths.size());
+    std::vector<ArchiveEntry> entries(shaderPaths.size());
+    std::vector<std::vector<char>> blobs(shaderPaths.size());
+    uint64_t byteOffset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    for (size_t i = 0u; i < shaderPaths.size(); ++i) {
+        const std::string fileName = shaderPaths[i].filename().string();
+        if (fileName.size() >= sizeof(ArchiveEntry::fileName)) {
+            Utils::printLog(INFO_PARAM, "shader name is too long for the archive ", fileName);
+            return false;
+        }
+
+        std::ifstream file(shaderPaths[i], std::ios::ate | std::ios::binary);
+        if (!file.is_open()) {
+            Utils::printLog(INFO_PARAM, "failed to read shader ", shaderPaths[i].string());
+            return false;
+        }
+        blobs[i].resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(blobs[i].data(), blobs[i].size());
+
+        memcpy(entries[i].fileName, fileName.c_str(), fileName.size());
+        entries[i].byteOffset = byteOffset;
+        entries[i].byteLength = blobs[i].size();
+        byteOffset += blobs[i].size();
+    }
+
+    // rename publishes the complete file only
+    const std::string tempPath = archivePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open()) {
+            Utils::printLog(INFO_PARAM, "shaders archive is not writable: ", tempPath);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(ArchiveHeader));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ArchiveEntry));
+        for (const auto& blob : blobs) {
+            file.write(blob.data(), blob.size());
+        }
+
+        if (!file) {
+            Utils::printLog(INFO_PARAM, "failed to write shaders archive ", tempPath);
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, archivePath, error);
+    if (error) {
+        Utils::printLog(INFO_PARAM, "failed to store shaders archive ", archivePath, ": ", error.message());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    Utils::printLog(INFO_PARAM, "shaders archive ", archivePath, ": ", entries.size(), " shaders packed");
+    return true;
+}
@@ -0,0 +1,399 @@
+#include "RenderGraph.h"
+
+#include "GpuProfiler.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <queue>
+
+namespace {
+const char* layoutName(VkImageLayout layout) {
+    switch (layout) {
+        case VK_IMAGE_LAYOUT_UNDEFINED:
+            return "UNDEFINED";
+        case VK_IMAGE_LAYOUT_GENERAL:
+            return "GENERAL";
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+            return "COLOR_ATTACHMENT";
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+            return "DEPTH_STENCIL_ATTACHMENT";
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+            return "DEPTH_STENCIL_READ_ONLY";
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            return "SHADER_READ_ONLY";
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            return "TRANSFER_SRC";
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+            return "TRANSFER_DST";
+        case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
+            return "DEPTH_ATTACHMENT";
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+            return "PRESENT_SRC";
+        default:
+            return "OTHER";
+    }
+}
+}  // namespace
+
+void RenderGraph::reset() {
+    m_resources.clear();
+    m_passes.clear();
+    m_passInfos.clear();
+    m_schedule.clear();
+    m_exportBarriers.clear();
+}
+
+RenderGraph::ResourceHandle RenderGraph::importImage(std::string_view name, VkImage image, VkImageAspectFlags aspectMask,
+                                                     VkImageLayout layout, VkImageLayout exportLayout, bool is_output) {
+    Resource resource{};
+    resource.name = name;
+    resource.image = image;
+    resource.aspectMask = aspectMask;
+    resource.initialLayout = layout;
+    resource.exportLayout = exportLayout;
+    resource.is_output = is_output;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceHandle>(m_resources.size() - 1u);
+}
+
+RenderGraph::ResourceHandle RenderGraph::importBuffer(std::string_view name, VkBuffer buffer, bool is_output) {
+    assert(buffer);
+    Resource resource{};
+    resource.name = name;
+    resource.buffer = buffer;
+    resource.is_output = is_output;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceHandle>(m_resources.size() - 1u);
+}
+
+void RenderGraph::addPass(std::string_view name, std::vector<ResourceAccess> accesses, RecordFunc recordFunc, bool is_enabled,
+                          bool has_side_effects) {
+    for ([[maybe_unused]] const auto& access : accesses) {
+        assert(access.resource < m_resources.size());
+    }
+
+    Pass pass{};
+    pass.accesses = std::move(accesses);
+    pass.recordFunc = std::move(recordFunc);
+    pass.is_enabled = is_enabled;
+    pass.has_side_effects = has_side_effects;
+    m_passes.push_back(std::move(pass));
+
+    PassInfo passInfo{};
+    passInfo.name = name;
+    m_passInfos.push_back(std::move(passInfo));
+}
+
+void RenderGraph::compile() {
+    for ([[maybe_unused]] const auto& resource : m_resources) {
+        assert(resource.image || resource.buffer);
+    }
+    const uint32_t passesCount = static_cast<uint32_t>(m_passes.size());
+
+    /// dependencies: a read (or a write which loads the content) needs the last write, a write is ordered after the
+    /// last write and the reads of it. Only the data dependencies keep a producer alive
+    std::vector<std::vector<uint32_t>> dataDependencies(passesCount);
+    std::vector<uint32_t> lastWriters(m_resources.size(), UINT32_MAX);
+    std::vector<std::vector<uint32_t>> readers(m_resources.size());
+    for (uint32_t passIndex = 0u; passIndex < passesCount; ++passIndex) {
+        auto& pass = m_passes[passIndex];
+        pass.dependencies.clear();
+        pass.barriers.clear();
+        if (!pass.is_enabled) {
+            continue;
+        }
+
+        for (const auto& access : pass.accesses) {
+            const uint32_t lastWriter = lastWriters[access.resource];
+            const bool is_loading = !access.is_write || access.layout != VK_IMAGE_LAYOUT_UNDEFINED ||
+                                    m_resources[access.resource].buffer;
+            if (is_loading && lastWriter != UINT32_MAX && lastWriter != passIndex) {
+                dataDependencies[passIndex].push_back(lastWriter);
+            }
+
+            if (access.is_write) {
+                if (lastWriter != UINT32_MAX && lastWriter != passIndex) {
+                    pass.dependencies.push_back(lastWriter);
+                }
+                for (const uint32_t reader : readers[access.resource]) {
+                    if (reader != passIndex) {
+                        pass.dependencies.push_back(reader);
+                    }
+                }
+                lastWriters[access.resource] = passIndex;
+                readers[access.resource].clear();
+            } else {
+                readers[access.resource].push_back(passIndex);
+            }
+        }
+    }
+
+    /// culling: live passes write an output or have side effects, the producers of their inputs are live too
+    std::vector<bool> isLive(passesCount, false);
+    std::vector<uint32_t> stack;
+    for (uint32_t passIndex = 0u; passIndex < passesCount; ++passIndex) {
+        const auto& pass = m_passes[passIndex];
+        if (!pass.is_enabled) {
+            continue;
+        }
+        const bool is_writing_output = std::any_of(pass.accesses.begin(), pass.accesses.end(), [this](const auto& access) {
+            return access.is_write && m_resources[access.resource].is_output;
+        });
+        if (pass.has_side_effects || is_writing_output) {
+            isLive[passIndex] = true;
+            stack.push_back(passIndex);
+        }
+    }
+    while (!stack.empty()) {
+        const uint32_t passIndex = stack.back();
+        stack.pop_back();
+        for (const uint32_t producer : dataDependencies[passIndex]) {
+            if (!isLive[producer]) {
+                isLive[producer] = true;
+                stack.push_back(producer);
+            }
+        }
+    }
+
+    /// scheduling: topological order of the live passes, the earliest declared one first
+    std::vector<uint32_t> pendingCount(passesCount, 0u);
+    std::vector<std::vector<uint32_t>> dependents(passesCount);
+    for (uint32_t passIndex = 0u; passIndex < passesCount; ++passIndex) {
+        auto& dependencies = m_passes[passIndex].dependencies;
+        dependencies.insert(dependencies.end(), dataDependencies[passIndex].begin(), dataDependencies[passIndex].end());
+        std::sort(dependencies.begin(), dependencies.end());
+        dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+        if (!isLive[passIndex]) {
+            continue;
+        }
+        for (const uint32_t dependency : dependencies) {
+            if (isLive[dependency]) {
+                dependents[dependency].push_back(passIndex);
+                ++pendingCount[passIndex];
+            }
+        }
+    }
+
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> readyPasses;
+    for (uint32_t passIndex = 0u; passIndex < passesCount; ++passIndex) {
+        m_passInfos[passIndex].is_culled = !isLive[passIndex];
+        m_passInfos[passIndex].barriersCount = 0u;
+        if (isLive[passIndex] && pendingCount[passIndex] == 0u) {
+            readyPasses.push(passIndex);
+        }
+    }
+
+    m_schedule.clear();
+    while (!readyPasses.empty()) {
+        const uint32_t passIndex = readyPasses.top();
+        readyPasses.pop();
+        m_schedule.push_back(passIndex);
+        for (const uint32_t dependent : dependents[passIndex]) {
+            if (--pendingCount[dependent] == 0u) {
+                readyPasses.push(dependent);
+            }
+        }
+    }
+    assert(m_schedule.size() == static_cast<size_t>(std::count(isLive.begin(), isLive.end(), true)));
+
+    /// barriers: the state of every resource is tracked along the schedule
+    std::vector<ResourceState> states(m_resources.size());
+    for (size_t i = 0u; i < m_resources.size(); ++i) {
+        states[i].layout = m_resources[i].initialLayout;
+    }
+
+    for (const uint32_t passIndex : m_schedule) {
+        auto& pass = m_passes[passIndex];
+        for (const auto& access : pass.accesses) {
+            const auto& resource = m_resources[access.resource];
+            auto& state = states[access.resource];
+
+            const bool is_transition = resource.image && access.layout != VK_IMAGE_LAYOUT_UNDEFINED &&
+                                       access.layout != state.layout;
+            // the render pass dependencies cover the hazards of the attachments
+            const bool is_hazard = !access.is_synchronized &&
+                                   (access.is_write ? (state.writeStages | state.readStages) != 0u : state.writeStages != 0u);
+
+            if (is_transition || is_hazard) {
+                const VkPipelineStageFlags srcStageMask = state.writeStages | state.readStages;
+                const VkImageLayout newLayout = is_transition ? access.layout : state.layout;
+                addBarrier(pass.barriers, resource, state.layout, newLayout,
+                           srcStageMask ? srcStageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, state.writeAccess, access.stageMask,
+                           access.accessMask);
+                ++m_passInfos[passIndex].barriersCount;
+            }
+
+            if (access.is_write) {
+                state.writeStages = access.stageMask;
+                state.writeAccess = access.accessMask;
+                state.readStages = 0u;
+                state.readAccess = 0u;
+            } else {
+                state.readStages |= access.stageMask;
+                state.readAccess |= access.accessMask;
+            }
+
+            if (access.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+                state.layout = access.finalLayout;
+            } else if (access.layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+                state.layout = access.layout;
+            }
+        }
+    }
+
+    /// the layouts the next frame expects
+    m_exportBarriers.clear();
+    for (size_t i = 0u; i < m_resources.size(); ++i) {
+        const auto& resource = m_resources[i];
+        const auto& state = states[i];
+        if (resource.image && resource.exportLayout != VK_IMAGE_LAYOUT_UNDEFINED && resource.exportLayout != state.layout) {
+            const VkPipelineStageFlags srcStageMask = state.writeStages | state.readStages;
+            addBarrier(m_exportBarriers, resource, state.layout, resource.exportLayout,
+                       srcStageMask ? srcStageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, state.writeAccess,
+                       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0u);
+        }
+    }
+}
+
+void RenderGraph::execute(VkCommandBuffer cmdBuf, GpuProfiler* profiler) {
+    for (const uint32_t passIndex : m_schedule) {
+        const auto startTime = std::chrono::steady_clock::now();
+
+        const auto& pass = m_passes[passIndex];
+        const auto scope = profiler ? profiler->beginScope(cmdBuf, m_passInfos[passIndex].name) : GpuProfiler::INVALID_SCOPE;
+        recordBarriers(cmdBuf, pass.barriers);
+        pass.recordFunc(cmdBuf);
+        if (profiler) {
+            profiler->endScope(cmdBuf, scope);
+        }
+
+        m_passInfos[passIndex].recordTimeMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+    recordBarriers(cmdBuf, m_exportBarriers);
+}
+
+bool RenderGraph::getPassRange(std::string_view resourceName, uint32_t& outFirstPass, uint32_t& outLastPass) const {
+    outFirstPass = UINT32_MAX;
+    outLastPass = 0u;
+    for (uint32_t passIndex = 0u; passIndex < m_passes.size(); ++passIndex) {
+        for (const auto& access : m_passes[passIndex].accesses) {
+            if (m_resources[access.resource].name == resourceName) {
+                outFirstPass = std::min(outFirstPass, passIndex);
+                outLastPass = passIndex;
+            }
+        }
+    }
+    return outFirstPass != UINT32_MAX;
+}
+
+std::string RenderGraph::dump() const {
+    std::string result = "Render graph: " + std::to_string(m_schedule.size()) + " of " + std::to_string(m_passes.size()) +
+                         " passes scheduled\n";
+    char line[256];
+
+    const auto dumpBarriers = [this, &result, &line](const std::vector<BarrierBatch>& batches) {
+        for (const auto& batch : batches) {
+            std::snprintf(line, sizeof(line), "    barrier 0x%x -> 0x%x:", batch.srcStageMask, batch.dstStageMask);
+            result += line;
+            for (const auto& imageBarrier : batch.imageBarriers) {
+                const auto it = std::find_if(m_resources.begin(), m_resources.end(),
+                                             [&imageBarrier](const auto& resource) { return resource.image == imageBarrier.image; });
+                result += " " + (it != m_resources.end() ? it->name : std::string("?")) + " " +
+                          layoutName(imageBarrier.oldLayout) + " -> " + layoutName(imageBarrier.newLayout);
+            }
+            for (const auto& bufferBarrier : batch.bufferBarriers) {
+                const auto it = std::find_if(m_resources.begin(), m_resources.end(), [&bufferBarrier](const auto& resource) {
+                    return resource.buffer == bufferBarrier.buffer;
+                });
+                result += " " + (it != m_resources.end() ? it->name : std::string("?"));
+            }
+            result += "\n";
+        }
+    };
+
+    for (const uint32_t passIndex : m_schedule) {
+        const auto& pass = m_passes[passIndex];
+        const auto& passInfo = m_passInfos[passIndex];
+        std::snprintf(line, sizeof(line), "  %s: barriers %u, recording %.3f ms\n", passInfo.name.c_str(), passInfo.barriersCount,
+                      passInfo.recordTimeMs);
+        result += line;
+
+        for (const auto& access : pass.accesses) {
+            const auto& resource = m_resources[access.resource];
+            std::snprintf(line, sizeof(line), "    %s %s", access.is_write ? "write" : "read ", resource.name.c_str());
+            result += line;
+            if (resource.image) {
+                result += std::string(" ") + layoutName(access.layout);
+                if (access.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+                    result += std::string(" -> ") + layoutName(access.finalLayout);
+                }
+            }
+            result += "\n";
+        }
+
+        dumpBarriers(pass.barriers);
+    }
+
+    if (!m_exportBarriers.empty()) {
+        result += "  export:\n";
+        dumpBarriers(m_exportBarriers);
+    }
+
+    for (size_t passIndex = 0u; passIndex < m_passInfos.size(); ++passIndex) {
+        if (m_passInfos[passIndex].is_culled) {
+            result += "  culled " + m_passInfos[passIndex].name + (m_passes[passIndex].is_enabled ? "\n" : " (disabled)\n");
+        }
+    }
+
+    return result;
+}
+
+void RenderGraph::addBarrier(std::vector<BarrierBatch>& batches, const Resource& resource, VkImageLayout oldLayout,
+                             VkImageLayout newLayout, VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+                             VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) {
+    auto it = std::find_if(batches.begin(), batches.end(), [srcStageMask, dstStageMask](const auto& batch) {
+        return batch.srcStageMask == srcStageMask && batch.dstStageMask == dstStageMask;
+    });
+    if (it == batches.end()) {
+        BarrierBatch batch{};
+        batch.srcStageMask = srcStageMask;
+        batch.dstStageMask = dstStageMask;
+        it = batches.insert(batches.end(), std::move(batch));
+    }
+
+    if (resource.image) {
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = resource.image;
+        barrier.subresourceRange = {resource.aspectMask, 0u, VK_REMAINING_MIP_LEVELS, 0u, VK_REMAINING_ARRAY_LAYERS};
+        it->imageBarriers.push_back(barrier);
+    } else {
+        VkBufferMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = resource.buffer;
+        barrier.offset = 0u;
+        barrier.size = VK_WHOLE_SIZE;
+        it->bufferBarriers.push_back(barrier);
+    }
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer cmdBuf, const std::vector<BarrierBatch>& batches) const {
+    for (const auto& batch : batches) {
+        vkCmdPipelineBarrier(cmdBuf, batch.srcStageMask, batch.dstStageMask, 0, 0u, nullptr,
+                             static_cast<uint32_t>(batch.bufferBarriers.size()), batch.bufferBarriers.data(),
+                             static_cast<uint32_t>(batch.imageBarriers.size()), batch.imageBarriers.data());
+    }
+}
@@ -0,0 +1,71 @@
+#include "StressScene.h"
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <utility>
+
+namespace {
+std::string_view trim(std::string_view text) {
+    const auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    const auto last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1u);
+}
+}  // namespace
+
+bool StressScene::parse(std::string_view assignment) {
+    const auto separator = assignment.find('=');
+    if (separator == std::string_view::npos) {
+        Utils::printLog(WARNING_PARAM, "stress scene: '", assignment, "' is not a key=value assignment");
+        return false;
+    }
+    const std::string_view key = trim(assignment.substr(0u, separator));
+    const std::string_view value = trim(assignment.substr(separator + 1u));
+
+    const std::array<std::pair<std::string_view, uint32_t*>, 9u> fields{{{"trees", &treesCount},
+                                                                        {"crowns", &crownsCount},
+                                                                        {"largeBushes", &largeBushesCount},
+                                                                        {"smallBushes", &smallBushesCount},
+                                                                        {"mediumBushes", &mediumBushesCount},
+                                                                        {"smokeEmitters", &smokeEmittersCount},
+                                                                        {"smokeParticles", &smokeParticlesCount},
+                                                                        {"physicsBodies", &physicsBodiesCount},
+                                                                        {"seed", &seed}}};
+    const auto field = std::find_if(fields.begin(), fields.end(), [key](const auto& field) { return field.first == key; });
+    if (field == fields.end()) {
+        Utils::printLog(WARNING_PARAM, "stress scene: unknown key '", key, "'");
+        return false;
+    }
+
+    uint32_t number = 0u;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (error != std::errc{} || end != value.data() + value.size()) {
+        Utils::printLog(WARNING_PARAM, "stress scene: '", value, "' of '", key, "' is not a number");
+        return false;
+    }
+    *field->second = field->second == &seed ? number : std::min(number, MAX_COUNT);
+    return true;
+}
+
+bool StressScene::loadFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file) {
+        Utils::printLog(WARNING_PARAM, "stress scene: failed to open ", filePath);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        const std::string_view assignment = trim(std::string_view(line).substr(0u, line.find('#')));
+        if (!assignment.empty() && !parse(assignment)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,337 @@
+#include "TextureCache.h"
+#include "BlockCompressor.h"
+#include "Utils.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <stb_image.h>
+
+namespace {
+bool readFile(const std::string& filePath, std::vector<char>& outData) {
+    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    outData.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(outData.data(), outData.size());
+
+    return static_cast<bool>(file);
+}
+
+BlockCompressor::Format getBlockFormat(TextureCache::Compression compression) {
+    switch (compression) {
+        case TextureCache::Compression::BC1:
+            return BlockCompressor::Format::BC1;
+        case TextureCache::Compression::BC3:
+            return BlockCompressor::Format::BC3;
+        case TextureCache::Compression::BC5:
+            return BlockCompressor::Format::BC5;
+        default:
+            assert(compression == TextureCache::Compression::BC7);
+            return BlockCompressor::Format::BC7;
+    }
+}
+
+const std::array<float, 256>& getSRGBToLinearTable() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> values;
+        for (uint32_t i = 0u; i < values.size(); ++i) {
+            const float srgb = static_cast<float>(i) / 255.0f;
+            values[i] = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+    }();
+
+    return table;
+}
+
+uint8_t linearToSRGB(float value) {
+    value = std::clamp(value, 0.0f, 1.0f);
+    const float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(std::lround(srgb * 255.0f));
+}
+
+/// 2x2 box filter, odd sized levels repeat their last column/row
+/// Note: sRGB color is averaged in linear space otherwise the smaller mip levels get darker, alpha is linear anyway
+std::vector<uint8_t> downsample(const std::vector<uint8_t>& src, uint32_t width, uint32_t height, bool is_sRGB) {
+    const uint32_t dstWidth = std::max(width / 2u, 1u);
+    const uint32_t dstHeight = std::max(height / 2u, 1u);
+    const auto& toLinear = getSRGBToLinearTable();
+
+    std::vector<uint8_t> dst(static_cast<size_t>(dstWidth) * dstHeight * 4u);
+    for (uint32_t y = 0u; y < dstHeight; ++y) {
+        const size_t row0 = static_cast<size_t>(std::min(2u * y, height - 1u)) * width;
+        const size_t row1 = static_cast<size_t>(std::min(2u * y + 1u, height - 1u)) * width;
+        for (uint32_t x = 0u; x < dstWidth; ++x) {
+            const size_t col0 = std::min(2u * x, width - 1u);
+            const size_t col1 = std::min(2u * x + 1u, width - 1u);
+            const uint8_t* texels[4] = {&src[(row0 + col0) * 4u], &src[(row0 + col1) * 4u], &src[(row1 + col0) * 4u],
+                                        &src[(row1 + col1) * 4u]};
+            uint8_t* out = &dst[(static_cast<size_t>(y) * dstWidth + x) * 4u];
+
+            for (uint32_t c = 0u; c < 4u; ++c) {
+                if (is_sRGB && c < 3u) {
+                    const float sum = toLinear[texels[0][c]] + toLinear[texels[1][c]] + toLinear[texels[2][c]] +
+                                      toLinear[texels[3][c]];
+                    out[c] = linearToSRGB(0.25f * sum);
+                } else {
+                    out[c] = static_cast<uint8_t>((texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c] + 2u) / 4u);
+                }
+            }
+        }
+    }
+
+    return dst;
+}
+}  // namespace
+
+bool TextureCache::load(const std::vector<std::string>& filePaths, const Settings& settings, Image& outImage,
+                        uint32_t firstLevel) const {
+    assert(!filePaths.empty());
+
+    std::vector<std::vector<char>> sources(filePaths.size());
+    uint64_t key = Utils::HASH_OFFSET_BASIS;
+    for (size_t i = 0u; i < filePaths.size(); ++i) {
+        if (!readFile(filePaths[i], sources[i])) {
+            Utils::printLog(WARNING_PARAM, "failed to read texture ", filePaths[i]);
+            return false;
+        }
+        key = Utils::hashBytes(key, sources[i].data(), sources[i].size());
+    }
+    const uint8_t settingsData[] = {static_cast<uint8_t>(FORMAT_VERSION), settings.is_miplevelsEnabling,
+                                    settings.is_flippingVertically, static_cast<uint8_t>(settings.compression)};
+    key = Utils::hashBytes(key, settingsData, sizeof(settingsData));
+
+    const std::string cachePath = getCachePath(key);
+    if (read(cachePath, key, firstLevel, outImage)) {
+        return true;
+    }
+
+    Utils::printLog(INFO_PARAM, "building texture cache ", cachePath, " for ", filePaths[0]);
+    if (!build(sources, settings, outImage)) {
+        Utils::printLog(WARNING_PARAM, "failed to decode texture ", filePaths[0]);
+        return false;
+    }
+    outImage.key = key;
+    write(cachePath, key, outImage);
+
+    // the cache file keeps the full chain, the caller gets the requested levels only
+    outImage.firstLevel = std::min(firstLevel, outImage.levelsCount - 1u);
+    outImage.levels.erase(outImage.levels.begin(), outImage.levels.begin() + outImage.firstLevel);
+
+    return true;
+}
+
+bool TextureCache::load(uint64_t key, uint32_t firstLevel, Image& outImage) const {
+    return read(getCachePath(key), key, firstLevel, outImage);
+}
+
+VkFormat TextureCache::getFormat(Compression compression) {
+    switch (compression) {
+        case Compression::BC1:
+            return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+        case Compression::BC3:
+            return VK_FORMAT_BC3_SRGB_BLOCK;
+        case Compression::BC5:
+            return VK_FORMAT_BC5_UNORM_BLOCK;  // non-color data, there is no sRGB variant
+        case Compression::BC7:
+            return VK_FORMAT_BC7_SRGB_BLOCK;
+        default:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+    }
+}
+
+uint64_t TextureCache::getLevelSize(Compression compression, uint32_t width, uint32_t height) {
+    if (compression == Compression::NONE) {
+        return static_cast<uint64_t>(width) * height * 4u;
+    }
+
+    return BlockCompressor::getCompressedSize(getBlockFormat(compression), width, height);
+}
+
+uint32_t TextureCache::getMipLevels(uint32_t width, uint32_t height) {
+    /// Note: calculating the number of levels in the mip chain:
+    ///       std::log2 - how many times that dimension can be divided by 2
+    ///       std::floor function handles cases where the largest dimension is not a power of 2
+    ///       1 is added so that the original image has a mip level
+    return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height))) + 1.0);
+}
+
+void TextureCache::compressBlock(Compression compression, const uint8_t* block, uint8_t* out) {
+    BlockCompressor::compressBlock(getBlockFormat(compression), block, out);
+}
+
+std::string TextureCache::getCachePath(uint64_t key) const {
+    char fileName[32];
+    snprintf(fileName, sizeof(fileName), "%016llx.tex", static_cast<unsigned long long>(key));
+    return Utils::formPath(m_cacheDir, fileName);
+}
+
+bool TextureCache::read(const std::string& filePath, uint64_t key, uint32_t firstLevel, Image& outImage) const {
+    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    FileHeader header;
+    const FileHeader expectedHeader;
+    if (fileSize < sizeof(FileHeader) || !file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader)) ||
+        memcmp(header.identifier, expectedHeader.identifier, sizeof(header.identifier)) != 0 ||
+        header.version != FORMAT_VERSION || header.key != key || header.levelsCount == 0u || header.layersCount == 0u ||
+        fileSize < sizeof(FileHeader) + header.levelsCount * sizeof(LevelIndex)) {
+        Utils::printLog(INFO_PARAM, "outdated texture cache ", filePath);
+        return false;
+    }
+
+    std::vector<LevelIndex> indices(header.levelsCount);
+    file.read(reinterpret_cast<char*>(indices.data()), indices.size() * sizeof(LevelIndex));
+
+    outImage.format = static_cast<VkFormat>(header.format);
+    outImage.width = header.width;
+    outImage.height = header.height;
+    outImage.layersCount = header.layersCount;
+    outImage.levelsCount = header.levelsCount;
+    outImage.firstLevel = std::min(firstLevel, header.levelsCount - 1u);
+    outImage.key = key;
+    outImage.levels.resize(header.levelsCount - outImage.firstLevel);
+    /// Note: only the requested levels are read, the biggest ones are skipped by seeking
+    for (uint32_t i = outImage.firstLevel; i < header.levelsCount; ++i) {
+        const LevelIndex& index = indices[i];
+        if (index.byteLength == 0u || index.byteOffset + index.byteLength > fileSize) {
+            Utils::printLog(WARNING_PARAM, "broken texture cache ", filePath);
+            return false;
+        }
+        auto& level = outImage.levels[i - outImage.firstLevel];
+        level.resize(static_cast<size_t>(index.byteLength));
+        file.seekg(static_cast<std::streamoff>(index.byteOffset));
+        if (!file.read(reinterpret_cast<char*>(level.data()), level.size())) {
+            Utils::printLog(WARNING_PARAM, "broken texture cache ", filePath);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void TextureCache::write(const std::string& filePath, uint64_t key, const Image& image) const {
+    assert(image.firstLevel == 0u);
+    std::error_code error;
+    std::filesystem::create_directories(m_cacheDir, error);
+
+    // unique temporary file keeps concurrent writers of the same key apart, rename publishes the complete file only
+    std::stringstream tempPath;
+    tempPath << filePath << '.' << std::this_thread::get_id() << ".tmp";
+    {
+        std::ofstream file(tempPath.str(), std::ios::binary);
+        if (!file.is_open()) {
+            Utils::printLog(WARNING_PARAM, "texture cache is not writable: ", tempPath.str());
+            return;
+        }
+
+        FileHeader header;
+        header.format = static_cast<uint32_t>(image.format);
+        header.width = image.width;
+        header.height = image.height;
+        header.layersCount = image.layersCount;
+        header.levelsCount = static_cast<uint32_t>(image.levels.size());
+        header.key = key;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+
+        LevelIndex index;
+        index.byteOffset = sizeof(FileHeader) + image.levels.size() * sizeof(LevelIndex);
+        for (const auto& level : image.levels) {
+            index.byteLength = level.size();
+            file.write(reinterpret_cast<const char*>(&index), sizeof(LevelIndex));
+            index.byteOffset += index.byteLength;
+        }
+        for (const auto& level : image.levels) {
+            file.write(reinterpret_cast<const char*>(level.data()), level.size());
+        }
+
+        if (!file) {
+            Utils::printLog(WARNING_PARAM, "failed to write texture cache ", tempPath.str());
+            file.close();
+            std::filesystem::remove(tempPath.str(), error);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath.str(), filePath, error);
+    if (error) {
+        Utils::printLog(WARNING_PARAM, "failed to store texture cache ", filePath, ": ", error.message());
+        std::filesystem::remove(tempPath.str(), error);
+    }
+}
+
+bool TextureCache::build(const std::vector<std::vector<char>>& sources, const Settings& settings, Image& outImage) {
+    /// Note: the global flag of stb_image is not thread safe, the thread local one overrides it
+    stbi_set_flip_vertically_on_load_thread(settings.is_flippingVertically);
+
+    std::vector<std::vector<uint8_t>> layers;
+    layers.reserve(sources.size());
+    uint32_t width = 0u;
+    uint32_t height = 0u;
+    for (const auto& source : sources) {
+        int texWidth, texHeight, texChannels;
+        /// STBI_rgb_alpha coerces to have ALPHA chanel for consistency with alphaless images
+        stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(source.data()), static_cast<int>(source.size()),
+                                                &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+        if (!pixels || (!layers.empty() && (width != static_cast<uint32_t>(texWidth) ||
+                                            height != static_cast<uint32_t>(texHeight)))) {
+            stbi_image_free(pixels);
+            return false;
+        }
+        width = static_cast<uint32_t>(texWidth);
+        height = static_cast<uint32_t>(texHeight);
+        layers.emplace_back(pixels, pixels + static_cast<size_t>(width) * height * 4u);
+        stbi_image_free(pixels);
+    }
+
+    const uint32_t layersCount = static_cast<uint32_t>(layers.size());
+    const uint32_t levelsCount = settings.is_miplevelsEnabling ? getMipLevels(width, height) : 1u;
+    const bool is_sRGB = settings.compression != Compression::BC5;
+
+    outImage.format = getFormat(settings.compression);
+    outImage.width = width;
+    outImage.height = height;
+    outImage.layersCount = layersCount;
+    outImage.levelsCount = levelsCount;
+    outImage.firstLevel = 0u;
+    outImage.levels.assign(levelsCount, {});
+
+    for (uint32_t level = 0u; level < levelsCount; ++level) {
+        const uint32_t levelWidth = std::max(width >> level, 1u);
+        const uint32_t levelHeight = std::max(height >> level, 1u);
+        const uint64_t layerSize = getLevelSize(settings.compression, levelWidth, levelHeight);
+        outImage.levels[level].resize(layerSize * layersCount);
+
+        for (uint32_t layer = 0u; layer < layersCount; ++layer) {
+            if (level > 0u) {
+                layers[layer] = downsample(layers[layer], std::max(width >> (level - 1u), 1u),
+                                           std::max(height >> (level - 1u), 1u), is_sRGB);
+            }
+
+            uint8_t* dst = outImage.levels[level].data() + layerSize * layer;
+            if (settings.compression == Compression::NONE) {
+                memcpy(dst, layers[layer].data(), layerSize);
+            } else {
+                BlockCompressor::compressImage(getBlockFormat(settings.compression), layers[layer].data(), levelWidth,
+                                               levelHeight, dst);
+            }
+        }
+    }
+
+    return true;
+}
@@ -1,31 +1,52 @@
 #include "TextureFactory.h"
 #include "Constants.h"
+#include "MemoryAllocator.h"
 #include "Utils.h"
 
 #include <assert.h>
-#include <optional>
+#include <algorithm>
+#include <cmath>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#include "BlockCompressor.h"
 
-static constexpr VkFormat IMAGE_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+/// Note: transparent to keep alpha tested and blended geometry invisible until the real image is resident
+static constexpr uint8_t PLACEHOLDER_TEXEL[4]{128u, 128u, 128u, 0u};
 
 TextureFactory::TextureFactory(const VulkanState& vulkanState) noexcept(true) : m_vkState(vulkanState) {
     mTextureDeleter = [this](TextureFactory::Texture* p) {
         auto p_devide = m_vkState._core.getDevice();
         assert(p_devide);
-        Utils::printLog(INFO_PARAM, "texture resources removal");
+        Utils::printLog(DEBUG_PARAM, "texture resources removal");
         vkDestroyImageView(p_devide, p->m_textureImageView, nullptr);
-        vkDestroyImage(p_devide, p->m_textureImage, nullptr);
-        vkFreeMemory(p_devide, p->m_textureImageMemory, nullptr);
+        Utils::VulkanDestroyImage(p_devide, p->m_textureImage, p->m_textureImageMemory);
         delete p;
     };
 }
 
 TextureFactory::~TextureFactory() {
+    {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        m_is_decodeStopped = true;
+    }
+    m_decodeCondition.notify_all();
+    for (auto& decodeThread : m_decodeThreads) {
+        decodeThread.join();
+    }
+
+    // the upload batch may still reference the textures
+    if (UploadManager::getInstance().isInitialized()) {
+        UploadManager::getInstance().waitIdle();
+    }
     // Wait until no actions being run on device before destroying
     std::ignore = vkDeviceWaitIdle(m_vkState._core.getDevice());
+    releaseRetiredImages(true);
+    for (auto& pending : m_pendingImages) {
+        vkDestroyImageView(m_vkState._core.getDevice(), pending.imageView, nullptr);
+        Utils::VulkanDestroyImage(m_vkState._core.getDevice(), pending.image, pending.imageMemory);
+    }
     for (const auto& [key, value] : m_samplers) {
-        Utils::printLog(INFO_PARAM, "sampler removal with miplevels: ", key);
+        Utils::printLog(DEBUG_PARAM, "sampler removal with miplevels: ", key);
         vkDestroySampler(m_vkState._core.getDevice(), value, nullptr);
     }
 }
@@ -33,100 +54,495 @@ TextureFactory::~TextureFactory() {
 void TextureFactory::init() {
     vkGetPhysicalDeviceProperties(m_vkState._core.getPhysDevice(), &m_properties);
     Utils::printLog(INFO_PARAM, "maxSamplerAnisotrop: ", m_properties.limits.maxSamplerAnisotropy);
+
+    // texture cache reading/building, a core is left for the render thread (hardware_concurrency may return 0)
+    const uint32_t threadsCount = std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+    for (uint32_t i = 0u; i < threadsCount; ++i) {
+        m_decodeThreads.emplace_back(&TextureFactory::decodeWorker, this);
+    }
 }
 
 std::weak_ptr<TextureFactory::Texture> TextureFactory::createCubeTexture(const std::array<std::string_view, 6>& textureFileNames,
                                                                          bool is_flippingVertically) {
+    return createTexture(std::string{textureFileNames[0]}, {textureFileNames.begin(), textureFileNames.end()},
+                         VK_IMAGE_VIEW_TYPE_CUBE, false, is_flippingVertically, true, false);
+}
+
+std::weak_ptr<TextureFactory::Texture> TextureFactory::create2DArrayTexture(std::vector<std::string>&& textureFileNames,
+                                                                            bool is_miplevelsEnabling,
+                                                                            bool is_flippingVertically,
+                                                                            bool is_compressionEnabling) {
     auto id = std::string{textureFileNames[0]};
+    VkImageViewType viewType = (textureFileNames.size() > 1) ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+    return createTexture(std::move(id), std::move(textureFileNames), viewType, is_miplevelsEnabling, is_flippingVertically,
+                         is_compressionEnabling, false);
+}
 
-    if (m_textures.find(id) == m_textures.end()) {
-        std::shared_ptr<TextureFactory::Texture> texture(new TextureFactory::Texture(), mTextureDeleter);
+std::weak_ptr<TextureFactory::Texture> TextureFactory::create2DTexture(std::string_view pTextureFileName,
+                                                                       bool is_miplevelsEnabling, bool is_flippingVertically,
+                                                                       bool is_compressionEnabling) {
+    return createTexture(std::string{pTextureFileName}, {std::string{pTextureFileName}}, VK_IMAGE_VIEW_TYPE_2D,
+                         is_miplevelsEnabling, is_flippingVertically, is_compressionEnabling, false);
+}
 
-        std::vector<std::string> texturePaths{Utils::formPath(Constants::TEXTURES_DIR, textureFileNames[0]),
-                                              Utils::formPath(Constants::TEXTURES_DIR, textureFileNames[1]),
-                                              Utils::formPath(Constants::TEXTURES_DIR, textureFileNames[2]),
-                                              Utils::formPath(Constants::TEXTURES_DIR, textureFileNames[3]),
-                                              Utils::formPath(Constants::TEXTURES_DIR, textureFileNames[4]),
-                                              Utils::formPath(Constants::TEXTURES_DIR, textureFileNames[5])};
+std::weak_ptr<TextureFactory::Texture> TextureFactory::createCubeTextureAsync(
+    const std::array<std::string_view, 6>& textureFileNames, bool is_flippingVertically) {
+    return createTexture(std::string{textureFileNames[0]}, {textureFileNames.begin(), textureFileNames.end()},
+                         VK_IMAGE_VIEW_TYPE_CUBE, false, is_flippingVertically, true, true);
+}
 
-        if (loadImages(*texture, texturePaths, m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), m_vkState._queue,
-                       m_vkState._cmdBufPool, false, is_flippingVertically) != VK_SUCCESS) {
-            Utils::printLog(ERROR_PARAM, "failed to create cubic texture image ");
-        }
-        if (Utils::VulkanCreateImageView(m_vkState._core.getDevice(), texture->m_textureImage, IMAGE_FORMAT,
-                                         VK_IMAGE_ASPECT_COLOR_BIT, texture->m_textureImageView, 1U, VK_IMAGE_VIEW_TYPE_CUBE,
-                                         textureFileNames.size()) != VK_SUCCESS) {
-            Utils::printLog(ERROR_PARAM, "failed to create cubic texture imageView ");
+std::weak_ptr<TextureFactory::Texture> TextureFactory::create2DArrayTextureAsync(std::vector<std::string>&& textureFileNames,
+                                                                                 bool is_miplevelsEnabling,
+                                                                                 bool is_flippingVertically,
+                                                                                 bool is_compressionEnabling) {
+    auto id = std::string{textureFileNames[0]};
+    VkImageViewType viewType = (textureFileNames.size() > 1) ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+    return createTexture(std::move(id), std::move(textureFileNames), viewType, is_miplevelsEnabling, is_flippingVertically,
+                         is_compressionEnabling, true);
+}
+
+std::weak_ptr<TextureFactory::Texture> TextureFactory::create2DTextureAsync(std::string_view pTextureFileName,
+                                                                            bool is_miplevelsEnabling,
+                                                                            bool is_flippingVertically,
+                                                                            bool is_compressionEnabling) {
+    return createTexture(std::string{pTextureFileName}, {std::string{pTextureFileName}}, VK_IMAGE_VIEW_TYPE_2D,
+                         is_miplevelsEnabling, is_flippingVertically, is_compressionEnabling, true);
+}
+
+std::weak_ptr<TextureFactory::Texture> TextureFactory::createTexture(std::string&& id, std::vector<std::string>&& filePaths,
+                                                                     VkImageViewType viewType, bool is_miplevelsEnabling,
+                                                                     bool is_flippingVertically, bool is_compressionEnabling,
+                                                                     bool is_async) {
+    if (auto it = m_textures.find(id); it != m_textures.end()) {
+        return it->second;
+    }
+
+    std::shared_ptr<TextureFactory::Texture> texture(new TextureFactory::Texture(), mTextureDeleter);
+
+    for (auto& filePath : filePaths) {
+        filePath = Utils::formPath(Constants::TEXTURES_DIR, filePath);
+    }
+
+    uint32_t width = 0u, height = 0u;
+    const auto settings = getCacheSettings(filePaths, is_miplevelsEnabling, is_flippingVertically, is_compressionEnabling,
+                                           width, height);
+    const uint32_t layersCount = static_cast<uint32_t>(filePaths.size());
+    const uint32_t mipLevels = settings.is_miplevelsEnabling ? TextureCache::getMipLevels(width, height) : 1u;
+
+    /// Note: only the mip tail is loaded at creation, the bigger levels are streamed once the draws request them
+    ///       (cube maps are not streamed)
+    uint32_t tailMip = 0u;
+    if (viewType != VK_IMAGE_VIEW_TYPE_CUBE) {
+        while (tailMip + 1u < mipLevels && std::max(width >> tailMip, height >> tailMip) > STREAMING_TAIL_EXTENT) {
+            ++tailMip;
         }
+    }
 
-        /// Note: creation of sampler in advance
-        getTextureSampler(texture->mipLevels);
-        m_textures.try_emplace(id, texture);
+    texture->layersCount = layersCount;
+    uint64_t cacheKey = 0u;
+    if (is_async) {
+        createPlaceholder(*texture, layersCount, settings, width, height, tailMip);
+    } else if (loadImages(*texture, filePaths, m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), settings, tailMip,
+                          cacheKey) != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to create texture image ", id);
+    }
 
-        return texture;
-    } else {
-        return m_textures[id];
+    if (Utils::VulkanCreateImageView(m_vkState._core.getDevice(), texture->m_textureImage, texture->format,
+                                     VK_IMAGE_ASPECT_COLOR_BIT, texture->m_textureImageView,
+                                     texture->mipLevels - texture->residentMip, viewType, layersCount) != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to create texture imageView ", id);
     }
+
+    /// Note: creation of sampler in advance
+    getTextureSampler(texture->mipLevels);
+    m_textures.try_emplace(std::move(id), texture);
+
+    if (texture->residentMip > 0u) {
+        StreamedTexture streamed;
+        streamed.texture = texture;
+        streamed.filePaths = filePaths;
+        streamed.settings = settings;
+        streamed.viewType = viewType;
+        streamed.cacheKey = cacheKey;
+        streamed.tailMip = texture->residentMip;
+        streamed.wantedMip = texture->residentMip;
+        streamed.targetMip = texture->residentMip;
+        streamed.lastUsedFrame = m_frameIndex;
+        streamed.levelsSize.assign(texture->mipLevels + 1u, 0u);
+        for (uint32_t level = texture->mipLevels; level-- > 0u;) {
+            const uint64_t layerSize = TextureCache::getLevelSize(settings.compression, std::max(texture->width >> level, 1u),
+                                                                  std::max(texture->height >> level, 1u));
+            streamed.levelsSize[level] = streamed.levelsSize[level + 1u] + layerSize * layersCount;
+        }
+        m_streamedTextures.try_emplace(texture.get(), std::move(streamed));
+    }
+
+    if (is_async) {
+        assert(!m_decodeThreads.empty());
+        texture->is_decoded = false;
+        {
+            std::lock_guard<std::mutex> lock(m_decodeMutex);
+            m_decodeJobs.push_back(DecodeJob{texture, std::move(filePaths), settings, {}, false, tailMip});
+        }
+        m_decodeCondition.notify_one();
+    }
+
+    return texture;
 }
 
-std::weak_ptr<TextureFactory::Texture> TextureFactory::create2DArrayTexture(std::vector<std::string>&& textureFileNames,
-                                                                            bool is_miplevelsEnabling,
-                                                                            bool is_flippingVertically) {
-    std::vector<std::string> filePaths = std::move(textureFileNames);
-    auto id = std::string{filePaths[0]};
+void TextureFactory::update(uint32_t descriptorSetsIndex) {
+    ++m_frameIndex;
+    uploadDecodedImages();
+    swapStreamedImages();
+    updateDescriptors(descriptorSetsIndex);
+    releaseRetiredImages(false);
+    updateStreaming();
+}
 
-    if (m_textures.find(id) == m_textures.end()) {
-        std::shared_ptr<TextureFactory::Texture> texture(new TextureFactory::Texture(), mTextureDeleter);
+void TextureFactory::uploadDecodedImages() {
+    std::vector<DecodeJob> decodedJobs;
+    {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        VkDeviceSize uploadBytes = 0u;
+        while (!m_decodedJobs.empty() && uploadBytes < UPLOAD_BYTES_PER_FRAME) {
+            auto& job = m_decodedJobs.front();
+            for (const auto& level : job.image.levels) {
+                uploadBytes += level.size();
+            }
+            decodedJobs.push_back(std::move(job));
+            m_decodedJobs.pop_front();
+        }
+    }
 
-        for (auto& filePath : filePaths) {
-            filePath = Utils::formPath(Constants::TEXTURES_DIR, filePath);
+    for (auto& job : decodedJobs) {
+        auto texture = job.texture.lock();
+        if (!texture) {
+            continue;
         }
 
-        if (loadImages(*texture, filePaths, m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), m_vkState._queue,
-                       m_vkState._cmdBufPool, is_miplevelsEnabling, is_flippingVertically) != VK_SUCCESS) {
-            Utils::printLog(ERROR_PARAM, "failed to create cubic texture image ");
+        const auto streamedIt = m_streamedTextures.find(texture.get());
+        const auto& image = job.image;
+        if (!job.is_loaded || image.format != texture->format || image.width != texture->width ||
+            image.height != texture->height || image.levelsCount != texture->mipLevels || image.firstLevel != job.firstLevel ||
+            image.layersCount != texture->layersCount) {
+            /// Note: the texture keeps the placeholder and is never resident, the streamed one keeps its current levels
+            Utils::printLog(WARNING_PARAM, "failed to load texture ", job.filePaths[0]);
+            if (job.is_streaming && streamedIt != m_streamedTextures.end()) {
+                streamedIt->second.targetMip = texture->residentMip;
+                streamedIt->second.finestMip = std::max(streamedIt->second.finestMip, texture->residentMip);
+            }
+            continue;
         }
-        VkImageViewType viewType = (filePaths.size() > 1) ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
-        if (Utils::VulkanCreateImageView(m_vkState._core.getDevice(), texture->m_textureImage, IMAGE_FORMAT,
-                                         VK_IMAGE_ASPECT_COLOR_BIT, texture->m_textureImageView, texture->mipLevels,
-                                         viewType, filePaths.size()) != VK_SUCCESS) {
-            Utils::printLog(ERROR_PARAM, "failed to create 2DArray texture imageView ");
+
+        std::vector<std::pair<const void*, VkDeviceSize>> levels;
+        levels.reserve(image.levels.size());
+        for (const auto& level : image.levels) {
+            levels.emplace_back(level.data(), level.size());
+        }
+        const uint32_t levelWidth = std::max(image.width >> image.firstLevel, 1u);
+        const uint32_t levelHeight = std::max(image.height >> image.firstLevel, 1u);
+        if (streamedIt != m_streamedTextures.end()) {
+            streamedIt->second.cacheKey = image.key;
         }
 
-        /// Note: creation of sampler in advance
-        getTextureSampler(texture->mipLevels);
-        m_textures.try_emplace(id, texture);
+        if (!job.is_streaming) {
+            // the placeholder may be sampled by the frames in flight
+            texture->uploadToken = UploadManager::getInstance().uploadImageLevels(
+                texture->m_textureImage, image.format, levelWidth, levelHeight, image.layersCount, levels,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            texture->is_decoded = true;
+            continue;
+        }
 
-        return texture;
-    } else {
-        return m_textures[id];
+        if (streamedIt == m_streamedTextures.end()) {
+            continue;
+        }
+
+        // streamed levels go to a new image, the current one is sampled until the upload is complete
+        PendingImage pending;
+        pending.texture = texture;
+        pending.residentMip = image.firstLevel;
+        const uint32_t levelsCount = image.levelsCount - image.firstLevel;
+        if (Utils::VulkanCreateImage(m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), levelWidth, levelHeight,
+                                     image.format, VK_IMAGE_TILING_OPTIMAL,
+                                     VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pending.image, pending.imageMemory, levelsCount,
+                                     image.layersCount) != VK_SUCCESS) {
+            Utils::printLog(WARNING_PARAM, "out of memory for streamed texture ", job.filePaths[0]);
+            streamedIt->second.targetMip = texture->residentMip;
+            continue;
+        }
+        if (Utils::VulkanCreateImageView(m_vkState._core.getDevice(), pending.image, image.format, VK_IMAGE_ASPECT_COLOR_BIT,
+                                         pending.imageView, levelsCount, streamedIt->second.viewType,
+                                         image.layersCount) != VK_SUCCESS) {
+            Utils::printLog(ERROR_PARAM, "failed to create streamed texture imageView ", job.filePaths[0]);
+        }
+        pending.uploadToken = UploadManager::getInstance().uploadImageLevels(pending.image, image.format, levelWidth, levelHeight,
+                                                                             image.layersCount, levels);
+        m_pendingImages.push_back(pending);
     }
 }
 
-std::weak_ptr<TextureFactory::Texture> TextureFactory::create2DTexture(std::string_view pTextureFileName,
-                                                                       bool is_miplevelsEnabling, bool is_flippingVertically) {
-    if (m_textures.find(pTextureFileName.data()) == m_textures.end()) {
-        std::shared_ptr<TextureFactory::Texture> texture(new TextureFactory::Texture(), mTextureDeleter);
+void TextureFactory::swapStreamedImages() {
+    for (auto it = m_pendingImages.begin(); it != m_pendingImages.end();) {
+        if (!UploadManager::getInstance().isComplete(it->uploadToken)) {
+            ++it;
+            continue;
+        }
+
+        RetiredImage retired{it->image, it->imageMemory, it->imageView, m_frameIndex};
+        if (auto texture = it->texture.lock()) {
+            std::swap(retired.image, texture->m_textureImage);
+            std::swap(retired.imageMemory, texture->m_textureImageMemory);
+            std::swap(retired.imageView, texture->m_textureImageView);
+            texture->residentMip = it->residentMip;
+            texture->uploadToken = it->uploadToken;
+            ++texture->viewGeneration;
+        }
+        m_retiredImages.push_back(retired);
+        it = m_pendingImages.erase(it);
+    }
+}
+
+void TextureFactory::updateDescriptors(uint32_t descriptorSetsIndex) {
+    for (auto& [texturePtr, streamed] : m_streamedTextures) {
+        auto texture = streamed.texture.lock();
+        if (!texture) {
+            continue;
+        }
 
-        std::string texturePath = Utils::formPath(Constants::TEXTURES_DIR, pTextureFileName);
+        for (auto& binding : texture->descriptorBindings) {
+            if (binding.descriptorSetsIndex != descriptorSetsIndex || binding.viewGeneration == texture->viewGeneration) {
+                continue;
+            }
+
+            VkDescriptorImageInfo imageInfo{};
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfo.imageView = texture->m_textureImageView;
+            imageInfo.sampler = binding.sampler;
+
+            VkWriteDescriptorSet textureSetWrite = {};
+            textureSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            textureSetWrite.dstSet = binding.descriptorSet;
+            textureSetWrite.dstBinding = binding.binding;
+            textureSetWrite.dstArrayElement = binding.arrayElement;
+            textureSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            textureSetWrite.descriptorCount = 1;
+            textureSetWrite.pImageInfo = &imageInfo;
+
+            vkUpdateDescriptorSets(m_vkState._core.getDevice(), 1u, &textureSetWrite, 0u, nullptr);
+            binding.viewGeneration = texture->viewGeneration;
+        }
+    }
+}
 
-        if (loadImages(*texture, {texturePath}, m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), m_vkState._queue,
-                       m_vkState._cmdBufPool, is_miplevelsEnabling, is_flippingVertically) != VK_SUCCESS) {
-            Utils::printLog(ERROR_PARAM, "failed to create texture image ");
+void TextureFactory::releaseRetiredImages(bool is_forced) {
+    /// Note: the frames recorded after the swap sample the new view, the older ones are complete after a round of
+    ///       the frames in flight, the sets of the swapchain images which are not acquired since then are rewritten before use
+    const uint64_t framesInFlight = m_vkState._swapchainImageCount;
+    std::erase_if(m_retiredImages, [this, is_forced, framesInFlight](RetiredImage& retired) {
+        if (!is_forced && m_frameIndex < retired.frameIndex + framesInFlight) {
+            return false;
         }
-        if (Utils::VulkanCreateImageView(m_vkState._core.getDevice(), texture->m_textureImage, IMAGE_FORMAT,
-                                         VK_IMAGE_ASPECT_COLOR_BIT, texture->m_textureImageView,
-                                         texture->mipLevels) != VK_SUCCESS) {
-            Utils::printLog(ERROR_PARAM, "failed to create texture imageView ");
+        vkDestroyImageView(m_vkState._core.getDevice(), retired.imageView, nullptr);
+        Utils::VulkanDestroyImage(m_vkState._core.getDevice(), retired.image, retired.imageMemory);
+        return true;
+    });
+}
+
+void TextureFactory::updateStreaming() {
+    struct Candidate {
+        StreamedTexture* streamed;
+        uint32_t residentMip;
+    };
+
+    StreamingStats stats;
+    VkDeviceSize committedBytes = 0u;  // resident levels or the streamed ones which replace them
+    std::vector<Candidate> candidates;
+    for (auto it = m_streamedTextures.begin(); it != m_streamedTextures.end();) {
+        auto texture = it->second.texture.lock();
+        if (!texture) {
+            it = m_streamedTextures.erase(it);
+            continue;
         }
 
-        /// Note: creation of sampler in advance
-        getTextureSampler(texture->mipLevels);
-        m_textures.try_emplace(std::string{pTextureFileName}, texture);
+        StreamedTexture& streamed = it->second;
+        if (texture->requestedMip != Texture::NOT_REQUESTED_MIP) {
+            streamed.wantedMip = std::clamp(texture->requestedMip, streamed.finestMip, streamed.tailMip);
+            streamed.lastUsedFrame = m_frameIndex;
+            texture->requestedMip = Texture::NOT_REQUESTED_MIP;
+        } else if (m_frameIndex - streamed.lastUsedFrame > STREAMING_UNUSED_FRAMES) {
+            streamed.wantedMip = streamed.tailMip;
+        }
 
-        return texture;
-    } else {
-        return m_textures[std::string{pTextureFileName}];
+        stats.residentBytes += streamed.levelsSize[texture->residentMip];
+        stats.requestedBytes += streamed.levelsSize[streamed.wantedMip];
+        committedBytes += std::max(streamed.levelsSize[texture->residentMip], streamed.levelsSize[streamed.targetMip]);
+        ++stats.texturesCount;
+
+        if (streamed.targetMip != texture->residentMip || !isResident(*texture)) {
+            ++stats.streamingCount;
+        } else if (streamed.wantedMip < texture->residentMip) {
+            candidates.push_back({&streamed, texture->residentMip});
+        }
+        ++it;
+    }
+    stats.budgetBytes = getStreamingBudget(stats.residentBytes);
+
+    // the budget may shrink along with the heap budget
+    while (committedBytes > stats.budgetBytes) {
+        const VkDeviceSize releasedBytes = evictLeastRecentlyUsed(nullptr);
+        if (releasedBytes == 0u) {
+            break;
+        }
+        committedBytes -= releasedBytes;
+        ++stats.streamingCount;
+    }
+
+    // the most blurred textures first
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.residentMip - a.streamed->wantedMip > b.residentMip - b.streamed->wantedMip;
+    });
+    for (const auto& candidate : candidates) {
+        StreamedTexture& streamed = *candidate.streamed;
+        if (stats.streamingCount >= STREAMING_JOBS_MAX) {
+            break;
+        }
+        if (streamed.targetMip != candidate.residentMip) {
+            continue;  // evicted meanwhile
+        }
+
+        /// Note: the wanted level if there is a room for it (the least recently used textures make it), a coarser one otherwise
+        for (uint32_t mip = streamed.wantedMip; mip < candidate.residentMip; ++mip) {
+            const VkDeviceSize extraBytes = streamed.levelsSize[mip] - streamed.levelsSize[candidate.residentMip];
+            while (committedBytes + extraBytes > stats.budgetBytes) {
+                const VkDeviceSize releasedBytes = evictLeastRecentlyUsed(&streamed);
+                if (releasedBytes == 0u) {
+                    break;
+                }
+                committedBytes -= releasedBytes;
+                ++stats.streamingCount;
+            }
+            if (committedBytes + extraBytes <= stats.budgetBytes) {
+                streamLevels(streamed, mip);
+                committedBytes += extraBytes;
+                ++stats.streamingCount;
+                break;
+            }
+        }
+    }
+
+    m_streamingStats = stats;
+}
+
+VkDeviceSize TextureFactory::evictLeastRecentlyUsed(const StreamedTexture* keptTexture) {
+    StreamedTexture* victim = nullptr;
+    for (auto& [texturePtr, streamed] : m_streamedTextures) {
+        const bool is_evictable = streamed.lastUsedFrame < m_frameIndex || streamed.wantedMip > streamed.targetMip;
+        if (&streamed == keptTexture || !is_evictable || streamed.targetMip >= streamed.tailMip ||
+            streamed.targetMip != texturePtr->residentMip || !isResident(*texturePtr)) {
+            continue;
+        }
+        if (!victim || streamed.lastUsedFrame < victim->lastUsedFrame) {
+            victim = &streamed;
+        }
+    }
+
+    if (!victim) {
+        return 0u;
+    }
+
+    const uint32_t residentMip = victim->targetMip;
+    const uint32_t mip = std::clamp(victim->wantedMip, residentMip + 1u, victim->tailMip);
+    streamLevels(*victim, mip);
+
+    return victim->levelsSize[residentMip] - victim->levelsSize[mip];
+}
+
+void TextureFactory::streamLevels(StreamedTexture& streamed, uint32_t firstLevel) {
+    streamed.targetMip = firstLevel;
+
+    DecodeJob job;
+    job.texture = streamed.texture;
+    job.filePaths = streamed.filePaths;
+    job.settings = streamed.settings;
+    job.firstLevel = firstLevel;
+    job.cacheKey = streamed.cacheKey;
+    job.is_streaming = true;
+    {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        m_decodeJobs.push_back(std::move(job));
+    }
+    m_decodeCondition.notify_one();
+}
+
+VkDeviceSize TextureFactory::getStreamingBudget(VkDeviceSize residentBytes) const {
+    VkDeviceSize heapBudget = 0u, heapUsage = 0u;
+    if (!MemoryAllocator::getInstance().getDeviceLocalBudget(heapBudget, heapUsage)) {
+        return m_streamingBudget;
+    }
+
+    // the streamed textures keep what they have and may take what is left in the heaps
+    const VkDeviceSize freeBytes =
+        heapBudget > heapUsage + MEMORY_BUDGET_HEADROOM ? heapBudget - heapUsage - MEMORY_BUDGET_HEADROOM : 0u;
+    return std::min(m_streamingBudget, residentBytes + freeBytes);
+}
+
+void TextureFactory::requestScreenSize(Texture& texture, float screenSize) const {
+    const float texels = static_cast<float>(std::max(texture.width, texture.height));
+    const float pixels = screenSize * static_cast<float>(m_viewportHeight);
+
+    // one texel per pixel
+    uint32_t mip = texture.mipLevels - 1u;
+    if (pixels >= texels) {
+        mip = 0u;
+    } else if (pixels > 1.0f) {
+        mip = std::min(static_cast<uint32_t>(std::log2(texels / pixels)), mip);
+    }
+    texture.requestedMip = std::min(texture.requestedMip, mip);
+}
+
+void TextureFactory::resetDescriptorBindings() {
+    for (auto& [id, texture] : m_textures) {
+        texture->descriptorBindings.clear();
+    }
+}
+
+bool TextureFactory::isResident(const Texture& texture) const {
+    return texture.is_decoded && UploadManager::getInstance().isComplete(texture.uploadToken);
+}
+
+uint32_t TextureFactory::pendingTexturesCount() const {
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    return static_cast<uint32_t>(m_decodeJobs.size() + m_decodedJobs.size()) + m_decodingJobsCount;
+}
+
+void TextureFactory::decodeWorker() {
+    for (;;) {
+        DecodeJob job;
+        {
+            std::unique_lock<std::mutex> lock(m_decodeMutex);
+            m_decodeCondition.wait(lock, [this] { return m_is_decodeStopped || !m_decodeJobs.empty(); });
+            if (m_is_decodeStopped) {
+                return;
+            }
+            job = std::move(m_decodeJobs.front());
+            m_decodeJobs.pop_front();
+            ++m_decodingJobsCount;
+        }
+
+        if (job.cacheKey != 0u) {
+            job.is_loaded = m_textureCache.load(job.cacheKey, job.firstLevel, job.image);
+        }
+        if (!job.is_loaded) {
+            job.is_loaded = m_textureCache.load(job.filePaths, job.settings, job.image, job.firstLevel);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_decodeMutex);
+            --m_decodingJobsCount;
+            m_decodedJobs.push_back(std::move(job));
+        }
     }
 }
 
@@ -163,87 +579,109 @@ VkSampler TextureFactory::getTextureSampler(uint32_t mipLevels) {
     }
 }
 
+TextureCache::Settings TextureFactory::getCacheSettings(const std::vector<std::string>& textureFileNames,
+                                                        bool is_miplevelsEnabling, bool is_flippingVertically,
+                                                        bool is_compressionEnabling, uint32_t& outWidth,
+                                                        uint32_t& outHeight) const {
+    int texWidth = 0, texHeight = 0, texChannels = 0;
+    bool is_alpha = false;
+    for (const auto& pStr : textureFileNames) {
+        if (!stbi_info(pStr.data(), &texWidth, &texHeight, &texChannels)) {
+            Utils::printLog(ERROR_PARAM, "failed to read texture header ", pStr);
+        }
+        is_alpha |= (texChannels == 2 || texChannels == 4);
+    }
+    outWidth = static_cast<uint32_t>(texWidth);
+    outHeight = static_cast<uint32_t>(texHeight);
+
+    TextureCache::Settings settings;
+    settings.is_miplevelsEnabling = is_miplevelsEnabling;
+    settings.is_flippingVertically = is_flippingVertically;
+    /// Note: the format is chosen by the headers only since asynchronous images are created before decoding:
+    ///       opaque images take BC1 (8:1), images with alpha take BC7 (4:1)
+    if (is_compressionEnabling && m_vkState._core.isTextureCompressionBCSupported()) {
+        settings.compression = is_alpha ? TextureCache::Compression::BC7 : TextureCache::Compression::BC1;
+    }
+
+    return settings;
+}
+
 VkResult TextureFactory::loadImages(TextureFactory::Texture& outTexture, const std::vector<std::string>& textureFileNames,
-                                    VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool cmdBufPool,
-                                    bool is_miplevelsEnabling, bool is_flippingVertically) {
+                                    VkDevice device, VkPhysicalDevice physicalDevice, const TextureCache::Settings& settings,
+                                    uint32_t firstLevel, uint64_t& outCacheKey) {
     using namespace Utils;
-    const auto texturesAmount = textureFileNames.size();
-    VkResult res;
-
-    stbi_set_flip_vertically_on_load(is_flippingVertically);
-
-    int texWidth, texHeight, texChannels;
-    VkDeviceSize imageSizeTotal = 0u;
-    using datat_ptr = std::unique_ptr<stbi_uc, decltype(&stbi_image_free)>;
-    std::vector<datat_ptr> textureData;
-    textureData.reserve(texturesAmount);
-
-    for (auto pStr : textureFileNames) {
-        assert(pStr.data());
-        /// STBI_rgb_alpha coerces to have ALPHA chanel for consistency with alphaless images
-        stbi_uc* pixels = stbi_load(pStr.data(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        assert(pixels);
-        textureData.emplace_back(pixels, stbi_image_free);
-        imageSizeTotal += static_cast<VkDeviceSize>(texWidth * texHeight * 4LL);
-    }
-
-    outTexture.width = texWidth;
-    outTexture.height = texHeight;
-    /// Note: calculating the number of levels in the mip chain:
-    ///       std::log2 - how many times that dimension can be divided by 2
-    ///       std::floor function handles cases where the largest dimension is not a power of 2
-    ///       1 is added so that the original image has a mip level
-    const uint32_t mipLevels =
-        is_miplevelsEnabling ? static_cast<uint32_t>(std::floor(std::log2(MAX(texWidth, texHeight))) + 1.0) : 1U;
-    outTexture.mipLevels = mipLevels;
-
-    const VkDeviceSize layerSize = imageSizeTotal / texturesAmount;  // This is just the size of each layer.
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    VulkanCreateBuffer(device, physicalDevice, imageSizeTotal, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-                       stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, imageSizeTotal, 0, &data);
-    for (std::size_t i = 0; i < texturesAmount; ++i) {
-        memcpy((char*)data + (layerSize * i), textureData[i].get(), static_cast<size_t>(layerSize));
-    }
-    vkUnmapMemory(device, stagingBufferMemory);
-
-    res = VulkanCreateImage(device, physicalDevice, texWidth, texHeight, IMAGE_FORMAT, VK_IMAGE_TILING_OPTIMAL,
-                            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outTexture.m_textureImage, outTexture.m_textureImageMemory,
-                            mipLevels, texturesAmount);
-
-    VulkanTransitionImageLayout(device, queue, cmdBufPool, outTexture.m_textureImage, IMAGE_FORMAT, VK_IMAGE_LAYOUT_UNDEFINED,
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, texturesAmount);
-    VulkanCopyBufferToImage(device, queue, cmdBufPool, stagingBuffer, outTexture.m_textureImage, static_cast<uint32_t>(texWidth),
-                            static_cast<uint32_t>(texHeight), texturesAmount);
-
-    // Check if image format supports linear blitting
-    static std::optional<VkFormatProperties> formatProperties;
-    if (!formatProperties) {
-        formatProperties = VkFormatProperties{};
-        vkGetPhysicalDeviceFormatProperties(physicalDevice, IMAGE_FORMAT, &formatProperties.value());
-    }
-
-    if (!(formatProperties.value().optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
-        Utils::printLog(ERROR_PARAM, "texture image format does not support linear blitting!");
-    }
-
-    if (!is_miplevelsEnabling) {
-        VulkanTransitionImageLayout(device, queue, cmdBufPool, outTexture.m_textureImage, IMAGE_FORMAT,
-                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                    VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, texturesAmount);
-    } else {
-        VulkanGenerateMipmaps(device, queue, cmdBufPool, outTexture.m_textureImage, IMAGE_FORMAT, texWidth, texHeight, mipLevels,
-                              texturesAmount);
+
+    TextureCache::Image image;
+    if (!m_textureCache.load(textureFileNames, settings, image, firstLevel)) {
+        return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    outTexture.format = image.format;
+    outTexture.width = image.width;
+    outTexture.height = image.height;
+    outTexture.mipLevels = image.levelsCount;
+    outTexture.residentMip = image.firstLevel;
+    outCacheKey = image.key;
+
+    /// Note: the mip chain comes from the cache, no blits so the image is not a transfer source
+    const uint32_t levelWidth = std::max(image.width >> image.firstLevel, 1u);
+    const uint32_t levelHeight = std::max(image.height >> image.firstLevel, 1u);
+    VkResult res = VulkanCreateImage(device, physicalDevice, levelWidth, levelHeight, image.format, VK_IMAGE_TILING_OPTIMAL,
+                                     VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outTexture.m_textureImage,
+                                     outTexture.m_textureImageMemory, static_cast<uint32_t>(image.levels.size()),
+                                     image.layersCount);
+
+    /// Note: levels are copied into the staging ring right away, the copies run with the next upload batch
+    std::vector<std::pair<const void*, VkDeviceSize>> levels;
+    levels.reserve(image.levels.size());
+    for (const auto& level : image.levels) {
+        levels.emplace_back(level.data(), level.size());
+    }
+    outTexture.uploadToken = UploadManager::getInstance().uploadImageLevels(outTexture.m_textureImage, image.format, levelWidth,
+                                                                            levelHeight, image.layersCount, levels);
 
     return res;
 }
+
+void TextureFactory::createPlaceholder(TextureFactory::Texture& outTexture, uint32_t layersCount,
+                                       const TextureCache::Settings& settings, uint32_t width, uint32_t height,
+                                       uint32_t firstLevel) {
+    using namespace Utils;
+
+    outTexture.format = TextureCache::getFormat(settings.compression);
+    outTexture.width = width;
+    outTexture.height = height;
+    outTexture.mipLevels = settings.is_miplevelsEnabling ? TextureCache::getMipLevels(width, height) : 1U;
+    outTexture.residentMip = std::min(firstLevel, outTexture.mipLevels - 1u);
+
+    const uint32_t levelWidth = std::max(width >> outTexture.residentMip, 1u);
+    const uint32_t levelHeight = std::max(height >> outTexture.residentMip, 1u);
+    const uint32_t levelsCount = outTexture.mipLevels - outTexture.residentMip;
+    if (VulkanCreateImage(m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), levelWidth, levelHeight,
+                          outTexture.format, VK_IMAGE_TILING_OPTIMAL,
+                          VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                          outTexture.m_textureImage, outTexture.m_textureImageMemory, levelsCount, layersCount) != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to create texture image");
+    }
+
+    if (settings.compression == TextureCache::Compression::NONE) {
+        outTexture.uploadToken = UploadManager::getInstance().fillImage(outTexture.m_textureImage, outTexture.format,
+                                                                        levelWidth, levelHeight, PLACEHOLDER_TEXEL,
+                                                                        sizeof(PLACEHOLDER_TEXEL), 1u, levelsCount, layersCount);
+        return;
+    }
+
+    // one compressed 4x4 block of the placeholder color
+    uint8_t texels[BlockCompressor::BLOCK_EXTENT * BlockCompressor::BLOCK_EXTENT * 4u];
+    for (uint32_t i = 0u; i < sizeof(texels); i += 4u) {
+        std::copy(std::begin(PLACEHOLDER_TEXEL), std::end(PLACEHOLDER_TEXEL), texels + i);
+    }
+    const uint32_t blockSize = static_cast<uint32_t>(TextureCache::getLevelSize(settings.compression, 1u, 1u));
+    uint8_t block[16];
+    assert(blockSize <= sizeof(block));
+    TextureCache::compressBlock(settings.compression, texels, block);
+    outTexture.uploadToken = UploadManager::getInstance().fillImage(outTexture.m_textureImage, outTexture.format, levelWidth,
+                                                                    levelHeight, block, blockSize, BlockCompressor::BLOCK_EXTENT,
+                                                                    levelsCount, layersCount);
+}
@@ -0,0 +1,195 @@
+#include "TransientAttachmentAllocator.h"
+
+#include "RenderGraph.h"
+#include "Utils.h"
+
+#include <assert.h>
+#include <algorithm>
+
+namespace {
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1u) & ~(alignment - 1u);
+}
+}  // namespace
+
+void TransientAttachmentAllocator::init(VkDevice device, VkPhysicalDevice physicalDevice) {
+    assert(device && physicalDevice);
+    destroy();
+    m_device = device;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memProperties);
+}
+
+void TransientAttachmentAllocator::destroy() {
+    for (auto& attachment : m_attachments) {
+        vkDestroyImage(m_device, attachment.image, nullptr);
+    }
+    for (auto& memory : m_memories) {
+        MemoryAllocator::getInstance().unregisterMemory(memory);
+        vkFreeMemory(m_device, memory, nullptr);
+    }
+    m_attachments.clear();
+    m_memories.clear();
+    m_allocatedCount = 0u;
+    m_stats = Stats{};
+}
+
+TransientAttachmentAllocator::Handle TransientAttachmentAllocator::addAttachment(const AttachmentInfo& info) {
+    assert(m_device);
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = info.width;
+    imageInfo.extent.height = info.height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = info.format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = info.usage;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    Attachment attachment{};
+    attachment.name = info.name;
+    attachment.usage = info.usage;
+    attachment.group = info.group;
+
+    VkResult res = vkCreateImage(m_device, &imageInfo, nullptr, &attachment.image);
+    CHECK_VULKAN_ERROR("vkCreateImage error %d\n", res);
+    vkGetImageMemoryRequirements(m_device, attachment.image, &attachment.memRequirements);
+
+    m_attachments.push_back(std::move(attachment));
+    return static_cast<Handle>(m_attachments.size() - 1u);
+}
+
+void TransientAttachmentAllocator::allocate(const RenderGraph& frameGraph) {
+    // memory regions shared by the attachments with disjoint lifetimes
+    struct Slot {
+        VkDeviceSize size{0u};
+        VkDeviceSize alignment{1u};
+        VkDeviceSize offset{0u};
+        std::vector<uint32_t> attachments;
+    };
+
+    // pending attachments of a group with the same memory requirements bits are placed into one memory
+    struct Block {
+        uint32_t group{0u};
+        uint32_t memoryTypeBits{0u};
+        std::vector<Slot> slots;
+    };
+    std::vector<Block> blocks;
+
+    std::vector<uint32_t> pending(m_attachments.size() - m_allocatedCount);
+    for (uint32_t i = 0u; i < pending.size(); ++i) {
+        pending[i] = m_allocatedCount + i;
+    }
+    // the biggest attachments take the slots first, the smaller ones fill the gaps of their lifetimes
+    std::stable_sort(pending.begin(), pending.end(), [this](uint32_t a, uint32_t b) {
+        return m_attachments[a].memRequirements.size > m_attachments[b].memRequirements.size;
+    });
+
+    for (const uint32_t index : pending) {
+        auto& attachment = m_attachments[index];
+        if (!frameGraph.getPassRange(attachment.name, attachment.firstPass, attachment.lastPass)) {
+            Utils::printLog(ERROR_PARAM, "transient attachment ", attachment.name, " is not accessed by the frame graph");
+        }
+        const auto& requirements = attachment.memRequirements;
+        m_stats.requestedBytes += requirements.size;
+        ++m_stats.attachmentsCount;
+
+        if (attachment.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) {
+            const uint32_t lazyTypeIndex = findMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+            if (lazyTypeIndex != UINT32_MAX) {
+                VkMemoryAllocateInfo allocInfo{};
+                allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+                allocInfo.allocationSize = requirements.size;
+                allocInfo.memoryTypeIndex = lazyTypeIndex;
+                VkResult res = vkAllocateMemory(m_device, &allocInfo, nullptr, &attachment.memory);
+                CHECK_VULKAN_ERROR("vkAllocateMemory error %d\n", res);
+                res = vkBindImageMemory(m_device, attachment.image, attachment.memory, 0u);
+                CHECK_VULKAN_ERROR("vkBindImageMemory error %d\n", res);
+                m_memories.push_back(attachment.memory);
+                MemoryAllocator::getInstance().registerMemory(attachment.memory, requirements.size, lazyTypeIndex,
+                                                              MemoryAllocator::Category::ATTACHMENT);
+                m_stats.lazyBytes += requirements.size;
+                ++m_stats.lazyCount;
+                continue;
+            }
+        }
+
+        auto block = std::find_if(blocks.begin(), blocks.end(), [&](const auto& b) {
+            return b.group == attachment.group && b.memoryTypeBits == requirements.memoryTypeBits;
+        });
+        if (block == blocks.end()) {
+            block = blocks.insert(blocks.end(), Block{attachment.group, requirements.memoryTypeBits, {}});
+        }
+
+        auto slot = std::find_if(block->slots.begin(), block->slots.end(), [&](const Slot& s) {
+            return std::none_of(s.attachments.begin(), s.attachments.end(), [&](uint32_t other) {
+                return m_attachments[other].firstPass <= attachment.lastPass &&
+                       attachment.firstPass <= m_attachments[other].lastPass;
+            });
+        });
+        if (slot == block->slots.end()) {
+            slot = block->slots.insert(block->slots.end(), Slot{});
+        } else {
+            ++m_stats.aliasedCount;
+        }
+        slot->size = std::max(slot->size, requirements.size);
+        slot->alignment = std::max(slot->alignment, requirements.alignment);
+        slot->attachments.push_back(index);
+    }
+
+    for (auto& block : blocks) {
+        VkDeviceSize blockSize = 0u;
+        for (auto& slot : block.slots) {
+            slot.offset = alignUp(blockSize, slot.alignment);
+            blockSize = slot.offset + slot.size;
+        }
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = blockSize;
+        allocInfo.memoryTypeIndex = findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (allocInfo.memoryTypeIndex == UINT32_MAX) {
+            Utils::printLog(ERROR_PARAM, "failed to find device local memory for transient attachments");
+        }
+
+        VkDeviceMemory memory = nullptr;
+        VkResult res = vkAllocateMemory(m_device, &allocInfo, nullptr, &memory);
+        CHECK_VULKAN_ERROR("vkAllocateMemory error %d\n", res);
+        m_memories.push_back(memory);
+        MemoryAllocator::getInstance().registerMemory(memory, blockSize, allocInfo.memoryTypeIndex,
+                                                      MemoryAllocator::Category::ATTACHMENT);
+        m_stats.allocatedBytes += blockSize;
+
+        for (const auto& slot : block.slots) {
+            for (const uint32_t index : slot.attachments) {
+                auto& attachment = m_attachments[index];
+                attachment.memory = memory;
+                res = vkBindImageMemory(m_device, attachment.image, memory, slot.offset);
+                CHECK_VULKAN_ERROR("vkBindImageMemory error %d\n", res);
+            }
+        }
+    }
+
+    m_allocatedCount = static_cast<uint32_t>(m_attachments.size());
+
+    constexpr float BYTES_IN_MIB = 1024.0f * 1024.0f;
+    Utils::printLog(INFO_PARAM, "transient attachments: ", m_stats.attachmentsCount, " requested ",
+                    static_cast<float>(m_stats.requestedBytes) / BYTES_IN_MIB, " MiB, allocated ",
+                    static_cast<float>(m_stats.allocatedBytes) / BYTES_IN_MIB, " MiB, aliased ", m_stats.aliasedCount,
+                    ", lazily allocated ", m_stats.lazyCount, " (", static_cast<float>(m_stats.lazyBytes) / BYTES_IN_MIB,
+                    " MiB)");
+}
+
+uint32_t TransientAttachmentAllocator::findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0u; i < m_memProperties.memoryTypeCount; ++i) {
+        if ((memoryTypeBits & (1u << i)) && (m_memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
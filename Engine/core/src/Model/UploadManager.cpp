@@ -0,0 +1,585 @@
+#include "UploadManager.h"
+#include "FrameTelemetry.h"
+#include "Utils.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return alignment > 1u ? (value + alignment - 1u) / alignment * alignment : value;
+}
+
+VkSemaphore createTimelineSemaphore(VkDevice device) {
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0u;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    VkSemaphore semaphore = nullptr;
+    if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to create timeline semaphore!");
+    }
+
+    return semaphore;
+}
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t queueFamily) {
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    VkCommandPool cmdPool = nullptr;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &cmdPool) != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to create upload command pool!");
+    }
+
+    return cmdPool;
+}
+}  // namespace
+
+void UploadManager::init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t graphicsFamily, VkQueue graphicsQueue,
+                         uint32_t transferFamily, VkQueue transferQueue) {
+    assert(device);
+    assert(graphicsQueue);
+    assert(!isInitialized());
+
+    m_device = device;
+    m_physicalDevice = physicalDevice;
+    m_graphicsQueue = graphicsQueue;
+    m_graphicsFamily = graphicsFamily;
+    m_transferQueue = (transferQueue && transferFamily != graphicsFamily) ? transferQueue : nullptr;
+    m_transferFamily = hasTransferQueue() ? transferFamily : graphicsFamily;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    /// Note: buffer offset of image copies must be a multiple of the texel size (up to 16 bytes for uncompressed formats)
+    m_copyAlignment = std::max<VkDeviceSize>(16u, properties.limits.optimalBufferCopyOffsetAlignment);
+
+    m_graphicsCmdPool = createCommandPool(device, m_graphicsFamily);
+    m_timeline = createTimelineSemaphore(device);
+    if (hasTransferQueue()) {
+        m_transferCmdPool = createCommandPool(device, m_transferFamily);
+        m_transferTimeline = createTimelineSemaphore(device);
+    }
+
+    Utils::VulkanCreateBuffer(device, physicalDevice, STAGING_RING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_ringBuffer,
+                              m_ringMemory, MemoryAllocator::Usage::DEDICATED);
+    m_ringData = static_cast<char*>(MemoryAllocator::getInstance().getMappedData(m_ringBuffer));
+
+    INFO_FORMAT("Uploads use %s queue family %d\n", hasTransferQueue() ? "transfer" : "graphics", m_transferFamily);
+}
+
+void UploadManager::destroy() {
+    if (!isInitialized()) {
+        return;
+    }
+
+    if (m_openBatch) {
+        releaseBatch(*m_openBatch);
+        m_openBatch.reset();
+    }
+    waitIdle();
+
+    Utils::VulkanDestroyBuffer(m_device, m_ringBuffer, m_ringMemory);
+
+    vkDestroySemaphore(m_device, m_timeline, nullptr);
+    vkDestroyCommandPool(m_device, m_graphicsCmdPool, nullptr);
+    if (hasTransferQueue()) {
+        vkDestroySemaphore(m_device, m_transferTimeline, nullptr);
+        vkDestroyCommandPool(m_device, m_transferCmdPool, nullptr);
+    }
+
+    m_timeline = nullptr;
+    m_transferTimeline = nullptr;
+    m_graphicsCmdPool = nullptr;
+    m_transferCmdPool = nullptr;
+    m_graphicsQueue = nullptr;
+    m_transferQueue = nullptr;
+    m_ringData = nullptr;
+    m_ringHead = 0u;
+    m_ringTail = 0u;
+    m_nextToken = 1u;
+    m_submittedToken = 0u;
+    m_physicalDevice = nullptr;
+    m_device = nullptr;
+}
+
+UploadManager::Token UploadManager::uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size,
+                                                 VkDeviceSize dstOffset) {
+    assert(isInitialized());
+    assert(dstBuffer);
+    if (size == 0u) {
+        return getCurrentToken();
+    }
+
+    assert(data);
+    auto staging = allocateStaging(size, m_copyAlignment);
+    memcpy(staging.data, data, static_cast<size_t>(size));
+
+    VkCommandBuffer transferCmd = getTransferCommandBuffer();
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = staging.offset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(transferCmd, staging.buffer, dstBuffer, 1, &copyRegion);
+
+    if (hasTransferQueue()) {
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = m_transferFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        barrier.buffer = dstBuffer;
+        barrier.offset = dstOffset;
+        barrier.size = size;
+
+        // release by the transfer queue
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0u;
+        vkCmdPipelineBarrier(transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1,
+                             &barrier, 0, nullptr);
+
+        // acquire by the graphics queue, its second scope covers the commands submitted after the batch as well
+        barrier.srcAccessMask = 0u;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(openBatch().graphicsCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    return openBatch().token;
+}
+
+UploadManager::Token UploadManager::uploadImage(VkImage image, VkFormat format, uint32_t width, uint32_t height,
+                                                const std::vector<const void*>& layers, VkDeviceSize layerSize,
+                                                uint32_t mipLevels, VkImageLayout oldLayout) {
+    assert(isInitialized());
+    assert(image);
+    assert(!layers.empty());
+    const uint32_t layersCount = static_cast<uint32_t>(layers.size());
+
+    auto staging = allocateStaging(layerSize * layersCount, m_copyAlignment);
+    for (uint32_t i = 0u; i < layersCount; ++i) {
+        memcpy(staging.data + layerSize * i, layers[i], static_cast<size_t>(layerSize));
+    }
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = staging.offset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = layersCount;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+    recordImageCopy(image, format, staging.buffer, {region}, mipLevels, layersCount, oldLayout);
+
+    if (mipLevels > 1u) {
+        Utils::VulkanGenerateMipmaps(image, format, width, height, mipLevels, layersCount);
+    } else {
+        Utils::VulkanTransitionImageLayout(image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels,
+                                           layersCount);
+    }
+
+    return openBatch().token;
+}
+
+UploadManager::Token UploadManager::uploadImageLevels(VkImage image, VkFormat format, uint32_t width, uint32_t height,
+                                                      uint32_t layersCount,
+                                                      const std::vector<std::pair<const void*, VkDeviceSize>>& levels,
+                                                      VkImageLayout oldLayout) {
+    assert(isInitialized());
+    assert(image);
+    assert(!levels.empty());
+    const uint32_t mipLevels = static_cast<uint32_t>(levels.size());
+
+    // every level starts at an offset aligned for the copy (a multiple of the texel block size as well)
+    VkDeviceSize stagingSize = 0u;
+    for (const auto& level : levels) {
+        stagingSize = alignUp(stagingSize, m_copyAlignment) + level.second;
+    }
+    auto staging = allocateStaging(stagingSize, m_copyAlignment);
+
+    std::vector<VkBufferImageCopy> regions(mipLevels);
+    VkDeviceSize levelOffset = 0u;
+    for (uint32_t i = 0u; i < mipLevels; ++i) {
+        levelOffset = alignUp(levelOffset, m_copyAlignment);
+        memcpy(staging.data + levelOffset, levels[i].first, static_cast<size_t>(levels[i].second));
+
+        auto& region = regions[i];
+        region.bufferOffset = staging.offset + levelOffset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = i;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = layersCount;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {std::max(width >> i, 1u), std::max(height >> i, 1u), 1};
+
+        levelOffset += levels[i].second;
+    }
+    recordImageCopy(image, format, staging.buffer, regions, mipLevels, layersCount, oldLayout);
+
+    Utils::VulkanTransitionImageLayout(image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels,
+                                       layersCount);
+
+    return openBatch().token;
+}
+
+UploadManager::Token UploadManager::fillImage(VkImage image, VkFormat format, uint32_t width, uint32_t height,
+                                              const void* block, uint32_t blockSize, uint32_t blockExtent,
+                                              uint32_t mipLevels, uint32_t layersCount) {
+    assert(isInitialized());
+    assert(image);
+    assert(block && blockSize > 0u && blockExtent > 0u);
+
+    // several rows of blocks of the widest level per layer, every level is copied from them by bands of these rows
+    constexpr uint32_t MAX_BAND_ROWS = 64u;
+    const uint32_t rowBlocks = (width + blockExtent - 1u) / blockExtent;
+    const uint32_t bandRows = std::min((height + blockExtent - 1u) / blockExtent, MAX_BAND_ROWS);
+    const VkDeviceSize bandSize = static_cast<VkDeviceSize>(rowBlocks) * bandRows * blockSize;
+    auto staging = allocateStaging(bandSize * layersCount, m_copyAlignment);
+    for (VkDeviceSize offset = 0u; offset < bandSize * layersCount; offset += blockSize) {
+        memcpy(staging.data + offset, block, blockSize);
+    }
+
+    std::vector<VkBufferImageCopy> regions;
+    for (uint32_t i = 0u; i < mipLevels; ++i) {
+        const uint32_t levelWidth = std::max(width >> i, 1u);
+        const uint32_t levelHeight = std::max(height >> i, 1u);
+        for (uint32_t row = 0u; row < levelHeight; row += bandRows * blockExtent) {
+            VkBufferImageCopy region{};
+            region.bufferOffset = staging.offset;
+            region.bufferRowLength = rowBlocks * blockExtent;
+            region.bufferImageHeight = bandRows * blockExtent;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = i;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = layersCount;
+            region.imageOffset = {0, static_cast<int32_t>(row), 0};
+            region.imageExtent = {levelWidth, std::min(bandRows * blockExtent, levelHeight - row), 1};
+            regions.push_back(region);
+        }
+    }
+
+    /// Note: recorded on the graphics queue, the staged data is small
+    VkCommandBuffer graphicsCmd = openBatch().graphicsCmd;
+    Utils::VulkanImageMemoryBarrier(graphicsCmd, image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                    VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, layersCount, 0u, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    vkCmdCopyBufferToImage(graphicsCmd, staging.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+    Utils::VulkanTransitionImageLayout(image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels,
+                                       layersCount);
+
+    return openBatch().token;
+}
+
+void UploadManager::recordImageCopy(VkImage image, VkFormat format, VkBuffer stagingBuffer,
+                                    const std::vector<VkBufferImageCopy>& regions, uint32_t mipLevels, uint32_t layersCount,
+                                    VkImageLayout oldLayout) {
+    // an image in use belongs to the graphics queue family already, no ownership transfer for it
+    const bool is_inUse = oldLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+    const bool is_ownershipTransfer = hasTransferQueue() && !is_inUse;
+
+    VkCommandBuffer transferCmd = is_ownershipTransfer ? getTransferCommandBuffer() : openBatch().graphicsCmd;
+    /// Note: write-after-read of the previous content needs an execution dependency only
+    Utils::VulkanImageMemoryBarrier(transferCmd, image, format, oldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                    VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, layersCount, 0u, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                    is_inUse ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    vkCmdCopyBufferToImage(transferCmd, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+
+    if (is_ownershipTransfer) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = m_transferFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = layersCount;
+
+        // release by the transfer queue
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0u;
+        vkCmdPipelineBarrier(transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0,
+                             nullptr, 1, &barrier);
+
+        // acquire by the graphics queue which generates mip levels and makes the final transition
+        barrier.srcAccessMask = 0u;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(openBatch().graphicsCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                             nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+VkCommandBuffer UploadManager::getCommandBuffer() {
+    assert(isInitialized());
+    return openBatch().graphicsCmd;
+}
+
+UploadManager::Token UploadManager::getCurrentToken() const {
+    return m_openBatch ? m_openBatch->token : m_submittedToken;
+}
+
+UploadManager::Token UploadManager::flush() {
+    if (!m_openBatch) {
+        retireCompleted();
+        return getCurrentToken();
+    }
+
+    Batch& batch = *m_openBatch;
+    batch.ringEnd = m_ringHead;
+
+    /// Note: global barrier makes all the uploaded data visible for everything submitted to the graphics queue afterwards
+    ///       (layout transitions of the batch are chained by ALL_COMMANDS source stage)
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    vkCmdPipelineBarrier(batch.graphicsCmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1,
+                         &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    if (vkEndCommandBuffer(batch.graphicsCmd) != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to end upload command buffer!");
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &batch.token;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.graphicsCmd;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_timeline;
+
+    VkResult res;
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    if (batch.transferCmd) {
+        if (vkEndCommandBuffer(batch.transferCmd) != VK_SUCCESS) {
+            Utils::printLog(ERROR_PARAM, "failed to end upload command buffer!");
+        }
+
+        VkTimelineSemaphoreSubmitInfo transferTimelineInfo{};
+        transferTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        transferTimelineInfo.signalSemaphoreValueCount = 1;
+        transferTimelineInfo.pSignalSemaphoreValues = &batch.token;
+
+        VkSubmitInfo transferSubmitInfo{};
+        transferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        transferSubmitInfo.pNext = &transferTimelineInfo;
+        transferSubmitInfo.commandBufferCount = 1;
+        transferSubmitInfo.pCommandBuffers = &batch.transferCmd;
+        transferSubmitInfo.signalSemaphoreCount = 1;
+        transferSubmitInfo.pSignalSemaphores = &m_transferTimeline;
+
+        res = vkQueueSubmit(m_transferQueue, 1, &transferSubmitInfo, VK_NULL_HANDLE);
+        CHECK_VULKAN_ERROR("vkQueueSubmit error %d\n", res);
+        FrameTelemetry::count(FrameTelemetry::QUEUE_SUBMITS);
+
+        // graphics part (ownership acquire, blits, transitions) starts once the copies are done
+        timelineInfo.waitSemaphoreValueCount = 1;
+        timelineInfo.pWaitSemaphoreValues = &batch.token;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &m_transferTimeline;
+        submitInfo.pWaitDstStageMask = &waitStage;
+    }
+
+    res = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    CHECK_VULKAN_ERROR("vkQueueSubmit error %d\n", res);
+    FrameTelemetry::count(FrameTelemetry::QUEUE_SUBMITS);
+
+    m_submittedToken = batch.token;
+    m_inFlight.push_back(std::move(batch));
+    m_openBatch.reset();
+
+    retireCompleted();
+
+    return m_submittedToken;
+}
+
+bool UploadManager::isComplete(Token token) const {
+    if (m_openBatch && token >= m_openBatch->token) {
+        return false;
+    }
+
+    uint64_t value = 0u;
+    vkGetSemaphoreCounterValue(m_device, m_timeline, &value);
+    return value >= token;
+}
+
+void UploadManager::wait(Token token) {
+    if (m_openBatch && token >= m_openBatch->token) {
+        flush();
+    }
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_timeline;
+    waitInfo.pValues = &token;
+    if (vkWaitSemaphores(m_device, &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to wait for upload batch ", token);
+    }
+
+    retireCompleted();
+}
+
+void UploadManager::waitIdle() {
+    wait(flush());
+}
+
+UploadManager::Batch& UploadManager::openBatch() {
+    if (!m_openBatch) {
+        m_openBatch = std::make_unique<Batch>();
+        m_openBatch->token = m_nextToken++;
+        m_openBatch->graphicsCmd = beginCommandBuffer(m_graphicsCmdPool);
+    }
+
+    return *m_openBatch;
+}
+
+VkCommandBuffer UploadManager::getTransferCommandBuffer() {
+    Batch& batch = openBatch();
+    if (!hasTransferQueue()) {
+        return batch.graphicsCmd;
+    }
+
+    if (!batch.transferCmd) {
+        batch.transferCmd = beginCommandBuffer(m_transferCmdPool);
+    }
+
+    return batch.transferCmd;
+}
+
+VkCommandBuffer UploadManager::beginCommandBuffer(VkCommandPool cmdPool) {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = cmdPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer = nullptr;
+    if (vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        Utils::printLog(ERROR_PARAM, "failed to allocate upload command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    return commandBuffer;
+}
+
+UploadManager::StagingRegion UploadManager::allocateDedicatedStaging(VkDeviceSize size) {
+    // own staging buffer released together with the batch
+    StagingRegion region;
+    VkDeviceMemory memory = nullptr;
+    Utils::VulkanCreateBuffer(m_device, m_physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, region.buffer, memory,
+                              MemoryAllocator::Usage::DEDICATED);
+    region.data = static_cast<char*>(MemoryAllocator::getInstance().getMappedData(region.buffer));
+    openBatch().oversizedStaging.emplace_back(region.buffer, memory);
+
+    return region;
+}
+
+UploadManager::StagingRegion UploadManager::allocateStaging(VkDeviceSize size, VkDeviceSize alignment) {
+    StagingRegion region;
+    FrameTelemetry::count(FrameTelemetry::UPLOADED_BYTES, size);
+
+    if (size > STAGING_RING_SIZE) {
+        // rare huge upload
+        return allocateDedicatedStaging(size);
+    }
+
+    VkDeviceSize offset = 0u;
+    bool is_ringReset = false;
+    for (;;) {
+        if (m_ringHead == m_ringTail && m_inFlight.empty()) {
+            m_ringHead = m_ringTail = 0u;
+        }
+
+        offset = alignUp(m_ringHead, alignment);
+        if (offset % STAGING_RING_SIZE + size > STAGING_RING_SIZE) {
+            offset = alignUp(offset, STAGING_RING_SIZE);  // a region never wraps around
+        }
+        if (offset + size - m_ringTail <= STAGING_RING_SIZE) {
+            break;
+        }
+
+        // the ring is full: submit what is recorded so far and wait for the oldest batch
+        flush();
+        if (m_inFlight.empty()) {
+            // the submitted batches are already complete, the whole ring is free
+            if (is_ringReset) {
+                return allocateDedicatedStaging(size);
+            }
+            m_ringHead = m_ringTail = 0u;
+            is_ringReset = true;
+            continue;
+        }
+        wait(m_inFlight.front().token);
+    }
+
+    m_ringHead = offset + size;
+    region.buffer = m_ringBuffer;
+    region.offset = offset % STAGING_RING_SIZE;
+    region.data = m_ringData + region.offset;
+
+    return region;
+}
+
+void UploadManager::retireCompleted() {
+    if (m_inFlight.empty()) {
+        return;
+    }
+
+    uint64_t value = 0u;
+    vkGetSemaphoreCounterValue(m_device, m_timeline, &value);
+    // batches are signaled in submission order
+    while (!m_inFlight.empty() && m_inFlight.front().token <= value) {
+        m_ringTail = m_inFlight.front().ringEnd;
+        releaseBatch(m_inFlight.front());
+        m_inFlight.pop_front();
+    }
+}
+
+void UploadManager::releaseBatch(Batch& batch) {
+    if (batch.graphicsCmd) {
+        vkFreeCommandBuffers(m_device, m_graphicsCmdPool, 1, &batch.graphicsCmd);
+        batch.graphicsCmd = nullptr;
+    }
+    if (batch.transferCmd) {
+        vkFreeCommandBuffers(m_device, m_transferCmdPool, 1, &batch.transferCmd);
+        batch.transferCmd = nullptr;
+    }
+    for (auto& staging : batch.oversizedStaging) {
+        Utils::VulkanDestroyBuffer(m_device, staging.first, staging.second);
+    }
+    batch.oversizedStaging.clear();
+}
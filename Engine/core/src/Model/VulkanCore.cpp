@@ -3,6 +3,8 @@
 #include <cstring>
 #include <cwchar>
 #include <vector>
+#include "Pipeliner.h"
+#include "ShaderRegistry.h"
 #include "Utils.h"
 
 #if defined(USE_DLSS) && USE_DLSS
@@ -58,8 +60,14 @@ VulkanCore::~VulkanCore() {
     }
 #endif
 
+    // all resources are released by now, give the memory blocks back before the device goes away
+    UploadManager::getInstance().destroy();
+    MemoryAllocator::getInstance().destroy();
+    ShaderRegistry::getInstance().destroy();
     vkDestroyDevice(m_device, nullptr);
-    vkDestroySurfaceKHR(m_inst, m_surface, nullptr);
+    if (m_surface) {
+        vkDestroySurfaceKHR(m_inst, m_surface, nullptr);
+    }
     vkDestroyInstance(m_inst, nullptr);
 
 #if defined(USE_DLSS) && USE_DLSS
@@ -106,14 +114,24 @@ void VulkanCore::init() {
 
     createInstance();
 
-    m_surface = createSurface(m_inst);
-    assert(m_surface);
+    // the headless mode renders offscreen, the surface properties are replaced by defaults (see VulkanGetPhysicalDevices)
+    if (!isHeadless()) {
+        m_surface = createSurface(m_inst);
+        assert(m_surface);
 
-    Utils::printLog(INFO_PARAM, "Surface created");
+        Utils::printLog(INFO_PARAM, "Surface created");
+    }
 
     VulkanGetPhysicalDevices(m_inst, m_surface, m_physDevices);
     selectPhysicalDevice();
     createLogicalDevice();
+    MemoryAllocator::getInstance().init(m_device, getPhysDevice(), m_isMemoryBudgetSupported);
+    ShaderRegistry::getInstance().init(m_device);
+    Pipeliner::getInstance().init(m_device, getPhysDevice());
+    const auto& gfxQueue = m_queues.at(Queue_family::GFX_QUEUE_FAMILY);
+    const auto& transferQueue = m_queues.at(Queue_family::TRANSFER_QUEUE_FAMILY);
+    UploadManager::getInstance().init(m_device, getPhysDevice(), gfxQueue.familyIndex, gfxQueue.queue,
+                                      transferQueue.familyIndex, transferQueue.queue);
 
 #if defined(USE_DLSS) && USE_DLSS
     if (m_slGetFeatureFunctionFn && !m_slDLSSSetOptionsFn) {
@@ -182,8 +200,10 @@ const VkSurfaceCapabilitiesKHR& VulkanCore::getSurfaceCaps() const {
     // TODO refresh it only when needed
     /// Note: must be refreshed for example when resizing
     ///       otherwise programm will use cached previous surface size causing the crash
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
-        getPhysDevice(), m_surface, const_cast<VkSurfaceCapabilitiesKHR*>(&(m_physDevices.m_surfaceCaps[m_gfxDevIndex])));
+    if (m_surface) {
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
+            getPhysDevice(), m_surface, const_cast<VkSurfaceCapabilitiesKHR*>(&(m_physDevices.m_surfaceCaps[m_gfxDevIndex])));
+    }
 
     return m_physDevices.m_surfaceCaps[m_gfxDevIndex];
 }
@@ -229,6 +249,20 @@ void VulkanCore::selectPhysicalDevice() {
         --(*pQueueFamilyCount);  // reduce queue count by one since we will use one queue for main thread
     }
 
+    // dedicated transfer queue family (without graphics and compute) for asynchronous uploads, see UploadManager
+    for (size_t j = 0; j < m_physDevices.m_qFamilyProps[m_gfxDevIndex].size(); ++j) {
+        VkQueueFamilyProperties& QFamilyProp = m_physDevices.m_qFamilyProps[m_gfxDevIndex][j];
+        VkQueueFlags flags = QFamilyProp.queueFlags;
+
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && !(flags & VK_QUEUE_COMPUTE_BIT) &&
+            QFamilyProp.queueCount > 0u) {
+            m_queues.at(Queue_family::TRANSFER_QUEUE_FAMILY).familyIndex = j;
+            --QFamilyProp.queueCount;
+            INFO_FORMAT("Transfer uses queue family %d\n", m_queues.at(Queue_family::TRANSFER_QUEUE_FAMILY).familyIndex);
+            break;
+        }
+    }
+
 #if defined(USE_DLSS) && USE_DLSS
     // Now we can check whether it's NVIDIA GPU
     // if not, we can skip Streamline abstracted functions and avoid calling them
@@ -483,12 +517,16 @@ void VulkanCore::createInstance() {
 #if defined(_DEBUG)
     finalInstanceExtensions.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 #endif
-    finalInstanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+    if (!isHeadless()) {
+        finalInstanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+    }
 #if defined(_WIN32) && defined(USE_CUDA) && USE_CUDA
     finalInstanceExtensions.push_back(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
     finalInstanceExtensions.push_back(VK_KHR_EXTERNAL_SEMAPHORE_CAPABILITIES_EXTENSION_NAME);
 #endif
-    finalInstanceExtensions.push_back(m_winController->getVulkanWindowSurfaceExtension().data());
+    if (!isHeadless()) {
+        finalInstanceExtensions.push_back(m_winController->getVulkanWindowSurfaceExtension().data());
+    }
 
 #if defined(USE_DLSS) && USE_DLSS
     // Inject Instance Extensions required by Streamline DLSS
@@ -579,13 +617,55 @@ void VulkanCore::createLogicalDevice() {
     // Base extensions
     finalExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
+    // heap budgets for the texture streaming, optional
+    uint32_t extensionsCount = 0u;
+    vkEnumerateDeviceExtensionProperties(getPhysDevice(), nullptr, &extensionsCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionsCount);
+    vkEnumerateDeviceExtensionProperties(getPhysDevice(), nullptr, &extensionsCount, extensions.data());
+    for (const auto& extension : extensions) {
+        if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+            m_isMemoryBudgetSupported = true;
+            finalExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            break;
+        }
+    }
+
     // Declare feature structures for Vulkan 1.2 and 1.3
     VkPhysicalDeviceVulkan12Features deviceFeatures12{};
     deviceFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    deviceFeatures12.timelineSemaphore = VK_TRUE;  // completion tokens of UploadManager
 
     VkPhysicalDeviceVulkan13Features deviceFeatures13{};
     deviceFeatures13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
 
+    // descriptor indexing (core in 1.2) for the bindless materials, optional: the per material descriptor sets otherwise
+    {
+        VkPhysicalDeviceVulkan12Features supportedFeatures12{};
+        supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 supportedFeatures2{};
+        supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures2.pNext = &supportedFeatures12;
+        vkGetPhysicalDeviceFeatures2(getPhysDevice(), &supportedFeatures2);
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(getPhysDevice(), &properties);
+        const auto& limits = properties.limits;
+
+        m_isDescriptorIndexingSupported =
+            supportedFeatures12.descriptorIndexing == VK_TRUE && supportedFeatures12.runtimeDescriptorArray == VK_TRUE &&
+            supportedFeatures12.descriptorBindingPartiallyBound == VK_TRUE &&
+            limits.maxPerStageDescriptorSampledImages >= MAX_BINDLESS_TEXTURES &&
+            limits.maxPerStageDescriptorSamplers >= MAX_BINDLESS_TEXTURES &&
+            limits.maxDescriptorSetSampledImages >= MAX_BINDLESS_TEXTURES &&
+            limits.maxDescriptorSetSamplers >= MAX_BINDLESS_TEXTURES;
+        if (m_isDescriptorIndexingSupported) {
+            deviceFeatures12.descriptorIndexing = VK_TRUE;
+            deviceFeatures12.runtimeDescriptorArray = VK_TRUE;
+            deviceFeatures12.descriptorBindingPartiallyBound = VK_TRUE;
+        }
+        Utils::printLog(INFO_PARAM, "descriptor indexing ", m_isDescriptorIndexingSupported ? "supported" : "not supported");
+    }
+
 #if defined(_WIN32) && defined(USE_CUDA) && USE_CUDA
     finalExtensions.push_back(VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME);
     finalExtensions.push_back(VK_KHR_EXTERNAL_SEMAPHORE_WIN32_EXTENSION_NAME);
@@ -660,6 +740,18 @@ void VulkanCore::createLogicalDevice() {
     deviceFeatures.dualSrcBlend = VK_TRUE;      // for VK_BLEND_FACTOR_SRC1_ALPHA
     deviceFeatures.independentBlend = VK_TRUE;  // allow different blend state for motion-vector attachment
 
+    // block compressed textures of TextureCache
+    VkPhysicalDeviceFeatures supportedFeatures{};
+    vkGetPhysicalDeviceFeatures(getPhysDevice(), &supportedFeatures);
+    m_isTextureCompressionBCSupported = supportedFeatures.textureCompressionBC == VK_TRUE;
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+
+    // per-pass statistics of GpuProfiler, the passes execute secondary command buffers
+    m_isPipelineStatisticsQuerySupported =
+        supportedFeatures.pipelineStatisticsQuery == VK_TRUE && supportedFeatures.inheritedQueries == VK_TRUE;
+    deviceFeatures.pipelineStatisticsQuery = m_isPipelineStatisticsQuerySupported ? VK_TRUE : VK_FALSE;
+    deviceFeatures.inheritedQueries = m_isPipelineStatisticsQuerySupported ? VK_TRUE : VK_FALSE;
+
     devInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
     devInfo.enabledExtensionCount = static_cast<uint32_t>(finalExtensions.size());
@@ -1,16 +1,27 @@
 #include "VulkanState.h"
 
-VulkanState::VulkanState(std::string_view appName, uint16_t windowWidth, uint16_t windowHeight, uint16_t offscreenWidth, uint16_t offscreenHeight)
-    : _windowWidth(windowWidth),
-      _windowHeight(windowHeight),
-      _offscreenWidth(offscreenWidth == 0 ? windowWidth : offscreenWidth),
-      _offscreenHeight(offscreenHeight == 0 ? windowHeight : offscreenHeight),
+namespace {
+std::unique_ptr<IControl> createWinController(std::string_view appName, uint16_t width, uint16_t height,
+                                              uint32_t headlessFramesCount, const InputRecording* inputReplay) {
+    if (headlessFramesCount != 0u || inputReplay) {
+        return std::make_unique<HeadlessControl>(appName, width, height, headlessFramesCount, inputReplay);
+    }
 #ifdef _WIN32
-      _core(std::make_unique<Win32Control>(appName, _windowWidth, _windowHeight))
+    return std::make_unique<Win32Control>(appName, width, height);
 #elif __linux__
-      _core(std::make_unique<XCBControl>(appName, _windowWidth, _windowHeight))
+    return std::make_unique<XCBControl>(appName, width, height);
 #else
 /// other OS
 #endif
+}
+}  // namespace
+
+VulkanState::VulkanState(std::string_view appName, uint16_t windowWidth, uint16_t windowHeight, uint16_t offscreenWidth,
+                         uint16_t offscreenHeight, uint32_t headlessFramesCount, const InputRecording* inputReplay)
+    : _windowWidth(windowWidth),
+      _windowHeight(windowHeight),
+      _offscreenWidth(offscreenWidth == 0 ? windowWidth : offscreenWidth),
+      _offscreenHeight(offscreenHeight == 0 ? windowHeight : offscreenHeight),
+      _core(createWinController(appName, _windowWidth, _windowHeight, headlessFramesCount, inputReplay))
 {
 }
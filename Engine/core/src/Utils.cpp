@@ -87,7 +87,8 @@ void printErrorF(const char* pFileName, size_t line, const char* pFuncName, cons
     vsnprintf(msg, sizeof(msg), format, args);
     va_end(args);
 
-    printLog(true, "\nin file: ", pFileName, " at line: ", line, " from function: ", pFuncName, " \n ", msg);
+    printLog(Logger::LevelTag<Logger::Level::CRITICAL>{}, "\nin file: ", pFileName, " at line: ", line, " from function: ",
+             pFuncName, " \n ", msg);
 }
 
 void printInfoF(const char* pFileName, size_t line, const char* pFuncName, const char* format, ...) {
@@ -97,7 +98,8 @@ void printInfoF(const char* pFileName, size_t line, const char* pFuncName, const
     vsnprintf(msg, sizeof(msg), format, args);
     va_end(args);
 
-    printLog(false, "\nin file: ", pFileName, " at line: ", line, " from function: ", pFuncName, " \n ", msg);
+    printLog(Logger::LevelTag<Logger::Level::INFO>{}, "\nin file: ", pFileName, " at line: ", line, " from function: ", pFuncName,
+             " \n ", msg);
 }
 
 void VulkanEnumExtProps(std::vector<VkExtensionProperties>& ExtProps) {
@@ -105,7 +107,7 @@ void VulkanEnumExtProps(std::vector<VkExtensionProperties>& ExtProps) {
     VkResult res = vkEnumerateInstanceExtensionProperties(nullptr, &NumExt, nullptr);
     CHECK_VULKAN_ERROR("vkEnumerateInstanceExtensionProperties error %d\n", res);
 
-    printf("Found %d extensions\n", NumExt);
+    printLog(INFO_PARAM, "Found ", NumExt, " extensions");
 
     ExtProps.resize(NumExt);
 
@@ -119,31 +121,31 @@ void VulkanEnumExtProps(std::vector<VkExtensionProperties>& ExtProps) {
 
 void VulkanPrintImageUsageFlags(const VkImageUsageFlags& flags) {
     if (flags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
-        printf("Image usage transfer src is supported\n");
+        printLog(INFO_PARAM, "Image usage transfer src is supported");
     }
 
     if (flags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) {
-        printf("Image usage transfer dest is supported\n");
+        printLog(INFO_PARAM, "Image usage transfer dest is supported");
     }
 
     if (flags & VK_IMAGE_USAGE_SAMPLED_BIT) {
-        printf("Image usage sampled is supported\n");
+        printLog(INFO_PARAM, "Image usage sampled is supported");
     }
 
     if (flags & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT) {
-        printf("Image usage color attachment is supported\n");
+        printLog(INFO_PARAM, "Image usage color attachment is supported");
     }
 
     if (flags & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) {
-        printf("Image usage depth stencil attachment is supported\n");
+        printLog(INFO_PARAM, "Image usage depth stencil attachment is supported");
     }
 
     if (flags & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) {
-        printf("Image usage transient attachment is supported\n");
+        printLog(INFO_PARAM, "Image usage transient attachment is supported");
     }
 
     if (flags & VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT) {
-        printf("Image usage input attachment is supported\n");
+        printLog(INFO_PARAM, "Image usage input attachment is supported");
     }
 }
 
@@ -153,7 +155,7 @@ void VulkanGetPhysicalDevices(VkInstance inst, VkSurfaceKHR Surface, VulkanPhysi
     VkResult res = vkEnumeratePhysicalDevices(inst, &NumDevices, nullptr);
     CHECK_VULKAN_ERROR("vkEnumeratePhysicalDevices error %d\n", res);
 
-    printf("Num physical devices %d\n", NumDevices);
+    printLog(INFO_PARAM, "Num physical devices ", NumDevices);
 
     PhysDevices.m_devices.resize(NumDevices);
     PhysDevices.m_devProps.resize(NumDevices);
@@ -170,20 +172,30 @@ void VulkanGetPhysicalDevices(VkInstance inst, VkSurfaceKHR Surface, VulkanPhysi
         const VkPhysicalDevice& PhysDev = PhysDevices.m_devices[i];
         vkGetPhysicalDeviceProperties(PhysDev, &PhysDevices.m_devProps[i]);
 
-        printf("Device name: %s\n", PhysDevices.m_devProps[i].deviceName);
+        printLog(INFO_PARAM, "Device name: ", PhysDevices.m_devProps[i].deviceName);
         uint32_t apiVer = PhysDevices.m_devProps[i].apiVersion;
-        printf("    API version: %d.%d.%d\n", VK_VERSION_MAJOR(apiVer), VK_VERSION_MINOR(apiVer), VK_VERSION_PATCH(apiVer));
+        printLog(INFO_PARAM, "    API version: ", VK_VERSION_MAJOR(apiVer), ".", VK_VERSION_MINOR(apiVer), ".",
+                 VK_VERSION_PATCH(apiVer));
         uint32_t NumQFamily = 0;
 
         vkGetPhysicalDeviceQueueFamilyProperties(PhysDev, &NumQFamily, nullptr);
 
-        printf("    Num of family queues: %d\n", NumQFamily);
+        printLog(INFO_PARAM, "    Num of family queues: ", NumQFamily);
 
         PhysDevices.m_qFamilyProps[i].resize(NumQFamily);
         PhysDevices.m_qSupportsPresent[i].resize(NumQFamily);
 
         vkGetPhysicalDeviceQueueFamilyProperties(PhysDev, &NumQFamily, &(PhysDevices.m_qFamilyProps[i][0]));
 
+        // headless: nothing is presented, the offscreen images take the default format
+        if (Surface == VK_NULL_HANDLE) {
+            PhysDevices.m_qSupportsPresent[i].assign(NumQFamily, VK_TRUE);
+            PhysDevices.m_surfaceFormats[i] = {{VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}};
+            PhysDevices.m_surfaceCaps[i] = VkSurfaceCapabilitiesKHR{};
+            PhysDevices.m_presentModes[i] = {VK_PRESENT_MODE_FIFO_KHR};
+            continue;
+        }
+
         for (size_t q = 0; q < NumQFamily; q++) {
             res = vkGetPhysicalDeviceSurfaceSupportKHR(PhysDev, q, Surface, &(PhysDevices.m_qSupportsPresent[i][q]));
             CHECK_VULKAN_ERROR("vkGetPhysicalDeviceSurfaceSupportKHR error %d\n", res);
@@ -200,7 +212,7 @@ void VulkanGetPhysicalDevices(VkInstance inst, VkSurfaceKHR Surface, VulkanPhysi
 
         for (size_t j = 0; j < NumFormats; j++) {
             const VkSurfaceFormatKHR& SurfaceFormat = PhysDevices.m_surfaceFormats[i][j];
-            printf("    Format %d color space %d\n", SurfaceFormat.format, SurfaceFormat.colorSpace);
+            printLog(INFO_PARAM, "    Format ", SurfaceFormat.format, " color space ", SurfaceFormat.colorSpace);
         }
 
         res = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(PhysDev, Surface, &(PhysDevices.m_surfaceCaps[i]));
@@ -215,7 +227,7 @@ void VulkanGetPhysicalDevices(VkInstance inst, VkSurfaceKHR Surface, VulkanPhysi
 
         assert(NumPresentModes != 0);
 
-        printf("Number of presentation modes %d\n", NumPresentModes);
+        printLog(INFO_PARAM, "Number of presentation modes ", NumPresentModes);
         PhysDevices.m_presentModes[i].resize(NumPresentModes);
         res = vkGetPhysicalDeviceSurfacePresentModesKHR(PhysDev, Surface, &NumPresentModes, &(PhysDevices.m_presentModes[i][0]));
     }
@@ -281,6 +293,9 @@ void VulkanCreateExternalBuffer(VkDevice device, VkPhysicalDevice physicalDevice
     if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
         Utils::printLog(ERROR_PARAM, "failed to allocate external buffer memory!");
     }
+    // the exported memory can't be sub-allocated, it is only accounted
+    MemoryAllocator::getInstance().registerMemory(bufferMemory, memRequirements.size, allocInfo.memoryTypeIndex,
+                                                  MemoryAllocator::getBufferCategory(usage, properties));
 
     vkBindBufferMemory(device, buffer, bufferMemory, 0);
 }
@@ -293,7 +308,8 @@ void VulkanCreateExternalBuffer(VkDevice device, VkPhysicalDevice physicalDevice
 #endif  // _WIN32
 
 void VulkanCreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage,
-                        VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+                        VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+                        MemoryAllocator::Usage memoryUsage, MemoryAllocator::Category category) {
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
@@ -304,69 +320,38 @@ void VulkanCreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDevi
         Utils::printLog(ERROR_PARAM, "failed to create buffer!");
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = Utils::VulkanFindMemoryType(physicalDevice, memRequirements, properties);
-
-    auto status = vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory);
+    /// memory is sub-allocated and bound by the allocator
+    MemoryAllocator::Allocation allocation;
+    auto status = MemoryAllocator::getInstance().allocateBuffer(buffer, usage, properties, memoryUsage, category, allocation);
     if (status != VK_SUCCESS) {
         Utils::printLog(ERROR_PARAM, "failed to allocate buffer memory! ", status);
     }
 
-    vkBindBufferMemory(device, buffer, bufferMemory, 0);
+    bufferMemory = allocation.memory;
 }
 
-VkCommandBuffer VulkanBeginSingleTimeCommands(VkDevice device, VkCommandPool cmdBufPool)  /// TO FIX  in one command buffer
-{
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = cmdBufPool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
-        Utils::printLog(ERROR_PARAM, "failed to allocate command buffer!");
+void VulkanDestroyBuffer(VkDevice device, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+    /** Note: the allocation is released before the handle is destroyed, otherwise the driver may hand out the same
+              handle to another thread and its allocation would be released instead.
+              The memory of external buffers is not owned by the allocator.
+    */
+    if (!MemoryAllocator::getInstance().freeBuffer(buffer) && bufferMemory != VK_NULL_HANDLE) {
+        MemoryAllocator::getInstance().unregisterMemory(bufferMemory);
+        vkFreeMemory(device, bufferMemory, nullptr);
     }
-
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-    return commandBuffer;
-}
-
-void VulkanEndSingleTimeCommands(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkCommandBuffer* commandBuffer) {
-    if (commandBuffer != nullptr && vkEndCommandBuffer(*commandBuffer) != VK_SUCCESS) {
-        Utils::printLog(ERROR_PARAM, "failed to end one-off command buffer!");
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buffer, nullptr);
     }
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = commandBuffer;
-
-    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(queue);
-
-    vkFreeCommandBuffers(device, cmdBufPool, 1, commandBuffer);
+    buffer = VK_NULL_HANDLE;
+    bufferMemory = VK_NULL_HANDLE;
 }
 
-void VulkanCopyBuffer(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkBuffer srcBuffer, VkBuffer dstBuffer,
-                      VkDeviceSize size) {
-    VkCommandBuffer commandBuffer = VulkanBeginSingleTimeCommands(device, cmdBufPool);
+void VulkanCopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+    VkCommandBuffer commandBuffer = UploadManager::getInstance().getCommandBuffer();
 
     VkBufferCopy copyRegion{};
     copyRegion.size = size;
     vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-    VulkanEndSingleTimeCommands(device, queue, cmdBufPool, &commandBuffer);
 }
 
 std::string formPath(std::string_view dir, std::string_view fileName) {
@@ -379,32 +364,15 @@ std::string formPath(std::string_view dir, std::string_view fileName) {
     return resultPath;
 }
 
-VkShaderModule VulkanCreateShaderModule(VkDevice device, std::string_view fileName) {
-    std::string shaderPath = formPath(Constants::SHADERS_DIR, fileName);
-
-    assert(shaderPath.c_str());
-    std::ifstream file(shaderPath.c_str(), std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        Utils::printLog(ERROR_PARAM, shaderPath.c_str());
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    constexpr uint64_t HASH_PRIME = 1099511628211ull;
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0u; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= HASH_PRIME;
     }
-    size_t codeSize = (size_t)file.tellg();
-    assert(codeSize);
-
-    std::vector<char> buffer(codeSize);
-    file.seekg(0);
-    file.read(buffer.data(), codeSize);
-    file.close();
-
-    VkShaderModuleCreateInfo shaderCreateInfo = {};
-    shaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    shaderCreateInfo.codeSize = codeSize;
-    shaderCreateInfo.pCode = reinterpret_cast<const uint32_t*>(buffer.data());
-
-    VkShaderModule shaderModule;
-    VkResult res = vkCreateShaderModule(device, &shaderCreateInfo, nullptr, &shaderModule);
-    CHECK_VULKAN_ERROR("vkCreateShaderModule error %d\n", res);
-    Utils::printLog(INFO_PARAM, "Created shader ", shaderPath.c_str());
-    return shaderModule;
+
+    return hash;
 }
 
 void VulkanCheckValidationLayerSupport() {
@@ -421,7 +389,8 @@ void VulkanCheckValidationLayerSupport() {
 
 VkResult VulkanCreateImage(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t width, uint32_t height, VkFormat format,
                            VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image,
-                           VkDeviceMemory& imageMemory, uint32_t mipLevels, uint32_t arrayLayers) {
+                           VkDeviceMemory& imageMemory, uint32_t mipLevels, uint32_t arrayLayers,
+                           MemoryAllocator::Usage memoryUsage, MemoryAllocator::Category category) {
     VkResult res;
 
     VkImageCreateInfo imageInfo{};
@@ -448,25 +417,46 @@ VkResult VulkanCreateImage(VkDevice device, VkPhysicalDevice physicalDevice, uin
         return res;
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetImageMemoryRequirements(device, image, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = VulkanFindMemoryType(physicalDevice, memRequirements, properties);
-
-    res = vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory);
+    /// memory is sub-allocated and bound by the allocator
+    MemoryAllocator::Allocation allocation;
+    res = MemoryAllocator::getInstance().allocateImage(image, tiling, usage, properties, memoryUsage, category, allocation);
     if (res != VK_SUCCESS) {
         Utils::printLog(ERROR_PARAM, "failed to allocate image memory: ", res);
         return res;
     }
 
-    res = vkBindImageMemory(device, image, imageMemory, 0);
+    imageMemory = allocation.memory;
 
     return res;
 }
 
+void VulkanDestroyImage(VkDevice device, VkImage& image, VkDeviceMemory& imageMemory) {
+    // see VulkanDestroyBuffer regarding the order
+    if (!MemoryAllocator::getInstance().freeImage(image) && imageMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, imageMemory, nullptr);
+    }
+    if (image != VK_NULL_HANDLE) {
+        vkDestroyImage(device, image, nullptr);
+    }
+    image = VK_NULL_HANDLE;
+    imageMemory = VK_NULL_HANDLE;
+}
+
+void VulkanSetViewport(VkCommandBuffer commandBuffer, const VkExtent2D& extent) {
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.extent = extent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
 void VulkanImageMemoryBarrier(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout,
                               VkImageLayout newLayout, VkImageAspectFlags aspectMask, uint32_t mipLevels, uint32_t layersCount,
                               VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags sourceStage,
@@ -490,10 +480,9 @@ void VulkanImageMemoryBarrier(VkCommandBuffer commandBuffer, VkImage image, VkFo
     vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 }
 
-void VulkanTransitionImageLayout(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkImage image, VkFormat format,
-                                 VkImageLayout oldLayout, VkImageLayout newLayout, VkImageAspectFlags aspectMask,
-                                 uint32_t mipLevels, uint32_t layersCount) {
-    VkCommandBuffer commandBuffer = VulkanBeginSingleTimeCommands(device, cmdBufPool);
+void VulkanTransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                 VkImageAspectFlags aspectMask, uint32_t mipLevels, uint32_t layersCount) {
+    VkCommandBuffer commandBuffer = UploadManager::getInstance().getCommandBuffer();
 
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -580,18 +569,14 @@ void VulkanTransitionImageLayout(VkDevice device, VkQueue queue, VkCommandPool c
         destinationStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
     } else {
         Utils::printLog(ERROR_PARAM, "unsupported layout transition!");
-        VulkanEndSingleTimeCommands(device, queue, cmdBufPool, &commandBuffer);
         return;
     }
 
     vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-    VulkanEndSingleTimeCommands(device, queue, cmdBufPool, &commandBuffer);
 }
 
-void VulkanCopyBufferToImage(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkBuffer buffer, VkImage image,
-                             uint32_t width, uint32_t height, uint32_t layersCount) {
-    VkCommandBuffer commandBuffer = VulkanBeginSingleTimeCommands(device, cmdBufPool);
+void VulkanCopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layersCount) {
+    VkCommandBuffer commandBuffer = UploadManager::getInstance().getCommandBuffer();
 
     VkBufferImageCopy region{};
     region.bufferOffset = 0;
@@ -605,13 +590,11 @@ void VulkanCopyBufferToImage(VkDevice device, VkQueue queue, VkCommandPool cmdBu
     region.imageExtent = {width, height, 1};
 
     vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-    VulkanEndSingleTimeCommands(device, queue, cmdBufPool, &commandBuffer);
 }
 
-void VulkanGenerateMipmaps(VkDevice device, VkQueue queue, VkCommandPool cmdBufPool, VkImage image, VkFormat imageFormat,
-                           int16_t texWidth, int16_t texHeight, uint8_t mipLevels, uint8_t layersAmount) {
-    VkCommandBuffer commandBuffer = VulkanBeginSingleTimeCommands(device, cmdBufPool);
+void VulkanGenerateMipmaps(VkImage image, VkFormat imageFormat, int16_t texWidth, int16_t texHeight, uint8_t mipLevels,
+                           uint8_t layersAmount) {
+    VkCommandBuffer commandBuffer = UploadManager::getInstance().getCommandBuffer();
 
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -675,8 +658,6 @@ void VulkanGenerateMipmaps(VkDevice device, VkQueue queue, VkCommandPool cmdBufP
 
     vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0,
                          nullptr, 1, &barrier);
-
-    VulkanEndSingleTimeCommands(device, queue, cmdBufPool, &commandBuffer);
 }
 
 VkResult VulkanCreateImageView(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectMask,
@@ -721,9 +702,9 @@ bool VulkanFindSupportedFormat(VkPhysicalDevice physicalDevice, const std::vecto
 }
 
 template <class T>
-void createGeneralBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool cmdBufPool, VkQueue queue,
-                         const std::vector<uint32_t>& indices, const std::vector<T>& vertices, VkDeviceSize& verticesBufferOffset,
-                         VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory) {
+UploadManager::Token createGeneralBuffer(VkDevice device, VkPhysicalDevice physicalDevice, const std::vector<uint32_t>& indices,
+                                         const std::vector<T>& vertices, VkDeviceSize& verticesBufferOffset,
+                                         VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory) {
     /** Note: general buffer keeping both geometry data,
               index buffer is placed first and next to index buffer the vertex buffer placed
     */
@@ -732,34 +713,22 @@ void createGeneralBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCom
     const VkDeviceSize verticesSize = sizeof(vertices[0]) * vertices.size();
     const VkDeviceSize bufferSize = indicesSize + verticesSize;
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    Utils::VulkanCreateBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-                              stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), (size_t)indicesSize);
-    memcpy((char*)data + verticesBufferOffset, vertices.data(), verticesSize);
-    vkUnmapMemory(device, stagingBufferMemory);
-
     Utils::VulkanCreateBuffer(
         device, physicalDevice, bufferSize,
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, generalBuffer, generalBufferMemory);
 
-    Utils::VulkanCopyBuffer(device, queue, cmdBufPool, stagingBuffer, generalBuffer, bufferSize);
-
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    auto& uploadManager = UploadManager::getInstance();
+    uploadManager.uploadBuffer(generalBuffer, indices.data(), indicesSize);
+    return uploadManager.uploadBuffer(generalBuffer, vertices.data(), verticesSize, verticesBufferOffset);
 }
 
 template <class T>
-void createGeneral3in1Buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool cmdBufPool, VkQueue queue,
-                         const std::vector<uint32_t>& indices, const std::vector<T>& vertices,
-                         const std::vector<Instance>& instances, VkDeviceSize& verticesBufferOffset,
-                         VkDeviceSize& instancesBufferOffset, VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory) {
+UploadManager::Token createGeneral3in1Buffer(VkDevice device, VkPhysicalDevice physicalDevice,
+                                             const std::vector<uint32_t>& indices, const std::vector<T>& vertices,
+                                             const std::vector<Instance>& instances, VkDeviceSize& verticesBufferOffset,
+                                             VkDeviceSize& instancesBufferOffset, VkBuffer& generalBuffer,
+                                             VkDeviceMemory& generalBufferMemory) {
     /** Note: general buffer keeping both geometry data,
               index buffer is placed first and next to index buffer the vertex buffer placed
     */
@@ -770,50 +739,36 @@ void createGeneral3in1Buffer(VkDevice device, VkPhysicalDevice physicalDevice, V
     instancesBufferOffset = indicesSize + verticesSize;
     const VkDeviceSize bufferSize = indicesSize + verticesSize + instancesSize;
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    Utils::VulkanCreateBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-                              stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), (size_t)indicesSize);
-    memcpy((char*)data + verticesBufferOffset, (char*)vertices.data(), verticesSize);
-    memcpy((char*)data + instancesBufferOffset, (char*)instances.data(), instancesSize);
-    vkUnmapMemory(device, stagingBufferMemory);
-
     Utils::VulkanCreateBuffer(
         device, physicalDevice, bufferSize,
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, generalBuffer, generalBufferMemory);
 
-    Utils::VulkanCopyBuffer(device, queue, cmdBufPool, stagingBuffer, generalBuffer, bufferSize);
-
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    auto& uploadManager = UploadManager::getInstance();
+    uploadManager.uploadBuffer(generalBuffer, indices.data(), indicesSize);
+    uploadManager.uploadBuffer(generalBuffer, vertices.data(), verticesSize, verticesBufferOffset);
+    return uploadManager.uploadBuffer(generalBuffer, instances.data(), instancesSize, instancesBufferOffset);
 }
 
 // Explicit template instantiation
-template void createGeneralBuffer<I3DModel::Vertex>(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool cmdBufPool,
-                                                    VkQueue queue, const std::vector<uint32_t>& indices,
-                                                    const std::vector<I3DModel::Vertex>& vertices,
-                                                    VkDeviceSize& verticesBufferOffset, VkBuffer& generalBuffer,
-                                                    VkDeviceMemory& generalBufferMemory);
-template void createGeneral3in1Buffer<I3DModel::Vertex>(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool cmdBufPool,
-                                                    VkQueue queue, const std::vector<uint32_t>& indices,
-                                                    const std::vector<I3DModel::Vertex>& vertices,
-                                                    const std::vector<Instance>& instances, VkDeviceSize& verticesBufferOffset,
-                                                    VkDeviceSize& instancesBufferOffset, VkBuffer& generalBuffer,
-                                                    VkDeviceMemory& generalBufferMemory);
-template void createGeneral3in1Buffer<Skybox::Vertex>(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool cmdBufPool,
-                                                    VkQueue queue, const std::vector<uint32_t>& indices, const std::vector<Skybox::Vertex>& vertices,
-                                                    const std::vector<Instance>& instances, VkDeviceSize& verticesBufferOffset,
-                                                    VkDeviceSize& instancesBufferOffset, VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory);
-template void createGeneralBuffer<Particle::Instance>(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool cmdBufPool,
-                                                      VkQueue queue, const std::vector<uint32_t>& indices,
-                                                      const std::vector<Particle::Instance>& vertices,
-                                                      VkDeviceSize& verticesBufferOffset, VkBuffer& generalBuffer,
-                                                      VkDeviceMemory& generalBufferMemory);
+template UploadManager::Token createGeneralBuffer<I3DModel::Vertex>(VkDevice device, VkPhysicalDevice physicalDevice,
+                                                                    const std::vector<uint32_t>& indices,
+                                                                    const std::vector<I3DModel::Vertex>& vertices,
+                                                                    VkDeviceSize& verticesBufferOffset, VkBuffer& generalBuffer,
+                                                                    VkDeviceMemory& generalBufferMemory);
+template UploadManager::Token createGeneral3in1Buffer<I3DModel::Vertex>(
+    VkDevice device, VkPhysicalDevice physicalDevice, const std::vector<uint32_t>& indices,
+    const std::vector<I3DModel::Vertex>& vertices, const std::vector<Instance>& instances, VkDeviceSize& verticesBufferOffset,
+    VkDeviceSize& instancesBufferOffset, VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory);
+template UploadManager::Token createGeneral3in1Buffer<Skybox::Vertex>(
+    VkDevice device, VkPhysicalDevice physicalDevice, const std::vector<uint32_t>& indices,
+    const std::vector<Skybox::Vertex>& vertices, const std::vector<Instance>& instances, VkDeviceSize& verticesBufferOffset,
+    VkDeviceSize& instancesBufferOffset, VkBuffer& generalBuffer, VkDeviceMemory& generalBufferMemory);
+template UploadManager::Token createGeneralBuffer<Particle::Instance>(VkDevice device, VkPhysicalDevice physicalDevice,
+                                                                      const std::vector<uint32_t>& indices,
+                                                                      const std::vector<Particle::Instance>& vertices,
+                                                                      VkDeviceSize& verticesBufferOffset,
+                                                                      VkBuffer& generalBuffer,
+                                                                      VkDeviceMemory& generalBufferMemory);
 
 }  // namespace Utils
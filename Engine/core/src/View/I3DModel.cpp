@@ -1,8 +1,11 @@
 #include "I3DModel.h"
+#include "CpuProfiler.h"
 #include "PipelineCreatorFootprint.h"
 #include "PipelineCreatorTextured.h"
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 #include <ranges>
 #include <future>
 
@@ -56,6 +59,7 @@ I3DModel::I3DModel(const VulkanState& vulkanState, TextureFactory& textureFactor
 }
 
 void I3DModel::sortInstances(uint32_t currentImage, const glm::mat4& viewProj, const glm::vec3& camPos, float z_far) {
+    PROFILE_FUNCTION();
     assert(currentImage < m_vkState._swapchainImageCount);
     if (m_instances.size() <= 1u) {
         // nothing to update
@@ -78,8 +82,8 @@ void I3DModel::sortInstances(uint32_t currentImage, const glm::mat4& viewProj, c
         indexFrom = workerThreadIndex * chunkOffset;
         indexTo = workerThreadIndexPlusOne >= workerThreads.size() ? m_instances.size() : workerThreadIndexPlusOne * chunkOffset;
         workerThreads[workerThreadIndex] =
-            std::async(std::launch::async, &I3DModel::filterInstances, this, indexFrom, indexTo, biasValue, 
-                std::cref(viewProj), z_far,  std::cref(camPos), 
+            std::async(std::launch::async, &I3DModel::filterInstances, std::cref(m_instances), indexFrom, indexTo, biasValue,
+                std::cref(viewProj), z_far,  std::cref(camPos), m_lowPolyMesh != nullptr,
                 std::ref(m_activeInstancesTemp[workerThreadIndex]),
                        m_lowPolyMesh ? std::ref(m_activeInstancesLowPolyTemp[workerThreadIndex])
                                      : std::ref(m_activeInstancesTemp[workerThreadIndex]));
@@ -102,10 +106,65 @@ void I3DModel::sortInstances(uint32_t currentImage, const glm::mat4& viewProj, c
     }
 }
 
-void I3DModel::filterInstances(std::size_t indexFrom, std::size_t indexTo, float biasValue, const glm::mat4& viewProj,
-                               float z_far, const glm::vec3& camPos, std::vector<Instance>& activeInstances,
+void I3DModel::reserveInstancesBuffer(uint32_t currentImage, std::size_t instancesCount) {
+    assert(currentImage < m_instancesBuffer.size());
+    m_instancesBufferCapacity.resize(m_instancesBuffer.size(), 0u);
+    std::size_t& capacity = m_instancesBufferCapacity[currentImage];
+    if (m_instancesBuffer[currentImage] != VK_NULL_HANDLE && instancesCount <= capacity) {
+        return;
+    }
+
+    auto p_device = m_vkState._core.getDevice();
+    assert(p_device);
+    Utils::VulkanDestroyBuffer(p_device, m_instancesBuffer[currentImage], m_instancesBufferMemory[currentImage]);
+    capacity = std::max({instancesCount, capacity + capacity / 2u, std::size_t{1u}});
+    Utils::VulkanCreateBuffer(p_device, m_vkState._core.getPhysDevice(), sizeof(Instance) * capacity,
+                              VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              m_instancesBuffer[currentImage], m_instancesBufferMemory[currentImage]);
+}
+
+void I3DModel::requestTextureLevels(const glm::mat4& viewProj, const glm::vec3& camPos) {
+    if (m_lowPolyMesh) {
+        m_lowPolyMesh->requestTextureLevels(viewProj, camPos);
+    }
+    if (m_textures.empty()) {
+        return;
+    }
+
+    // models which don't sort their instances have the only one
+    const auto& instances = m_activeInstances.empty() && m_instances.size() == 1u ? m_instances : m_activeInstances;
+    if (instances.empty()) {
+        return;  // nothing is visible
+    }
+
+    float screenSize = std::numeric_limits<float>::max();
+    if (m_radius > 0.0f) {
+        // projection scale (1 / tan(fovY / 2)) is the length of the second row of viewProj for a rigid view matrix
+        const float projScale = glm::length(glm::vec3(viewProj[0][1], viewProj[1][1], viewProj[2][1]));
+        float minDistanceByRadius = std::numeric_limits<float>::max();
+        for (const auto& instance : instances) {
+            const float radius = m_radius * instance.scale;
+            const float distance = glm::length(instance.posShift - camPos);
+            minDistanceByRadius = std::min(minDistanceByRadius, std::max(distance - radius, 0.0f) / radius);
+        }
+        // bounding sphere height on the screen in viewport heights, the camera is inside of it if the distance is 0
+        screenSize = minDistanceByRadius > 0.0f ? projScale / minDistanceByRadius : std::numeric_limits<float>::max();
+    }
+
+    for (const auto& texture : m_textures) {
+        if (auto sharedPtrTexture = texture.lock()) {
+            m_textureFactory.requestScreenSize(*sharedPtrTexture, screenSize);
+        }
+    }
+}
+
+void I3DModel::filterInstances(const std::vector<Instance>& instances, std::size_t indexFrom, std::size_t indexTo,
+                               float biasValue, const glm::mat4& viewProj, float z_far, const glm::vec3& camPos,
+                               bool has_lowPolyMesh, std::vector<Instance>& activeInstances,
                                std::vector<Instance>& activeInstancesLowPoly) {
-    assert(indexFrom < m_instances.size() && indexTo <= m_instances.size());
+    PROFILE_FUNCTION();
+    assert(indexFrom < instances.size() && indexTo <= instances.size());
 
     activeInstances.clear();
     activeInstancesLowPoly.clear();
@@ -132,7 +191,7 @@ void I3DModel::filterInstances(std::size_t indexFrom, std::size_t indexTo, float
 
     // check whether sphere (instance) is inside the frustum
     for (std::size_t i = indexFrom; i < indexTo; i++) {
-        const Instance& instance = m_instances[i];
+        const Instance& instance = instances[i];
         const glm::vec3& center = instance.posShift;
         const float scaledRadius = biasValue * instance.scale;
 
@@ -152,7 +211,7 @@ void I3DModel::filterInstances(std::size_t indexFrom, std::size_t indexTo, float
             // instead of sqrt we can compare squared distances since sqrt is heavy operation
             if (distSq < lodThresholdSq) {
                 activeInstances.push_back(instance);
-            } else if (m_lowPolyMesh) {
+            } else if (has_lowPolyMesh) {
                 activeInstancesLowPoly.push_back(instance);
             }
         }
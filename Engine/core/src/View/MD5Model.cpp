@@ -4,6 +4,8 @@
 #include <fstream>
 #include <future>
 #include "Constants.h"
+#include "CpuProfiler.h"
+#include "FrameTelemetry.h"
 #include "PipelineCreatorTextured.h"
 #include "Utils.h"
 
@@ -40,13 +42,13 @@ void MD5Model::init() {
                                       VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                                       m_CUDAandCPUaccessibleBufs[AnimationType::ANIMATION_TYPE_CPU],
-                                      m_CUDAandCPUaccessibleMems[AnimationType::ANIMATION_TYPE_CPU]);
-            void* data;
-            vkMapMemory(p_device, m_CUDAandCPUaccessibleMems[AnimationType::ANIMATION_TYPE_CPU], 0, m_bufferSize, 0, &data);
+                                      m_CUDAandCPUaccessibleMems[AnimationType::ANIMATION_TYPE_CPU],
+                                      MemoryAllocator::Usage::AUTO, MemoryAllocator::Category::MESH);
+            void* data =
+                MemoryAllocator::getInstance().getMappedData(m_CUDAandCPUaccessibleBufs[AnimationType::ANIMATION_TYPE_CPU]);
             memcpy(data, indices.data(), (size_t)indicesSize);
             memcpy((char*)data + m_verticesBufferOffset, vertices.data(), verticesSize);
             memcpy((char*)data + m_instancesBufferOffset, m_instances.data(), instancesSize);
-            vkUnmapMemory(p_device, m_CUDAandCPUaccessibleMems[AnimationType::ANIMATION_TYPE_CPU]);
 
             m_generalBufferMemory = m_CUDAandCPUaccessibleMems[AnimationType::ANIMATION_TYPE_CPU];
             m_generalBuffer = m_CUDAandCPUaccessibleBufs[AnimationType::ANIMATION_TYPE_CPU];
@@ -58,15 +60,9 @@ void MD5Model::init() {
             m_instancesBufferMemory.assign(m_vkState._swapchainImageCount, VK_NULL_HANDLE);
 
             const VkDeviceSize instancesSize = sizeof(m_instances[0]) * m_instances.size();
-            for (size_t i = 0u; i < m_vkState._swapchainImageCount; i++) {
-                Utils::VulkanCreateBuffer(p_device, m_vkState._core.getPhysDevice(), instancesSize,
-                                          VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                          m_instancesBuffer[i], m_instancesBufferMemory[i]);
-                void* data;
-                vkMapMemory(p_device, m_instancesBufferMemory[i], 0, instancesSize, 0, &data);
-                memcpy((char*)data, m_instances.data(), instancesSize);
-                vkUnmapMemory(p_device, m_instancesBufferMemory[i]);
+            for (uint32_t i = 0u; i < m_vkState._swapchainImageCount; i++) {
+                reserveInstancesBuffer(i, m_instances.size());
+                memcpy(MemoryAllocator::getInstance().getMappedData(m_instancesBuffer[i]), m_instances.data(), instancesSize);
             }
         }
 
@@ -182,239 +178,245 @@ bool MD5Model::loadMD5Anim() {
     std::string absPath = Utils::formPath(Constants::MODEL_DIR, m_md5AnimFileName);
 
     std::ifstream fileIn(absPath.c_str());
-    ModelAnimation tempAnim;
+    if (!fileIn) {
+        Utils::printLog(ERROR_PARAM, "Couldn't load animation file", m_md5AnimFileName);
+        return false;
+    }
 
+    ModelAnimation animation;
+    if (!parseAnimation(fileIn, m_MD5Model, animation)) {
+        return false;
+    }
+    m_MD5Model.animations.push_back(std::move(animation));  // Push back the animation into our model object
+    return true;
+}
+
+bool MD5Model::parseAnimation(std::istream& fileIn, const Model3D& model, ModelAnimation& outAnimation) {
     std::string checkString;  // Stores the next string from our file
 
-    if (fileIn) {
-        while (fileIn)  // Loop until the end of the file is reached
-        {
-            fileIn >> checkString;  // Get next string from file
+    while (fileIn)  // Loop until the end of the file is reached
+    {
+        fileIn >> checkString;  // Get next string from file
 
-            if (checkString == "MD5Version")  // Get MD5 version (this function supports version 10)
+        if (checkString == "MD5Version")  // Get MD5 version (this function supports version 10)
+        {
+            fileIn >> checkString;
+        } else if (checkString == "commandline") {
+            std::getline(fileIn, checkString);  // Ignore the rest of this line
+        } else if (checkString == "numFrames") {
+            fileIn >> outAnimation.numFrames;  // Store number of frames in this animation
+        } else if (checkString == "numJoints") {
+            fileIn >> outAnimation.numJoints;  // Store number of joints (must match .md5mesh)
+        } else if (checkString == "frameRate") {
+            fileIn >> outAnimation.frameRate;  // Store animation's frame rate (frames per second)
+        } else if (checkString == "numAnimatedComponents") {
+            fileIn >> outAnimation.numAnimatedComponents;  // Number of components in each frame section
+        } else if (checkString == "hierarchy") {
+            fileIn >> checkString;  // Skip opening bracket "{"
+
+            for (int i = 0; i < outAnimation.numJoints; i++)  // Load in each joint
             {
-                fileIn >> checkString;
-            } else if (checkString == "commandline") {
-                std::getline(fileIn, checkString);  // Ignore the rest of this line
-            } else if (checkString == "numFrames") {
-                fileIn >> tempAnim.numFrames;  // Store number of frames in this animation
-            } else if (checkString == "numJoints") {
-                fileIn >> tempAnim.numJoints;  // Store number of joints (must match .md5mesh)
-            } else if (checkString == "frameRate") {
-                fileIn >> tempAnim.frameRate;  // Store animation's frame rate (frames per second)
-            } else if (checkString == "numAnimatedComponents") {
-                fileIn >> tempAnim.numAnimatedComponents;  // Number of components in each frame section
-            } else if (checkString == "hierarchy") {
-                fileIn >> checkString;  // Skip opening bracket "{"
-
-                for (int i = 0; i < tempAnim.numJoints; i++)  // Load in each joint
-                {
-                    AnimJointInfo tempJoint;
+                AnimJointInfo tempJoint;
 
-                    fileIn >> tempJoint.name;  // Get joints name
-                    // Sometimes the names might contain spaces. If that is the case, we need to continue
-                    // to read the name until we get to the closing " (quotation marks)
-                    if (tempJoint.name[tempJoint.name.size() - 1] != '"') {
-                        char checkChar;
-                        bool jointNameFound = false;
-                        while (!jointNameFound) {
-                            checkChar = fileIn.get();
+                fileIn >> tempJoint.name;  // Get joints name
+                // Sometimes the names might contain spaces. If that is the case, we need to continue
+                // to read the name until we get to the closing " (quotation marks)
+                if (tempJoint.name[tempJoint.name.size() - 1] != '"') {
+                    char checkChar;
+                    bool jointNameFound = false;
+                    while (!jointNameFound) {
+                        checkChar = fileIn.get();
 
-                            if (checkChar == '"')
-                                jointNameFound = true;
+                        if (checkChar == '"')
+                            jointNameFound = true;
 
-                            tempJoint.name += checkChar;
-                        }
+                        tempJoint.name += checkChar;
                     }
+                }
 
-                    // Remove the quotation marks from joints name
-                    tempJoint.name.erase(0, 1);
-                    tempJoint.name.erase(tempJoint.name.size() - 1, 1);
-
-                    fileIn >> tempJoint.parentID;    // Get joints parent ID
-                    fileIn >> tempJoint.flags;       // Get flags
-                    fileIn >> tempJoint.startIndex;  // Get joints start index
-
-                    // Make sure the joint exists in the model, and the parent ID's match up
-                    // because the bind pose (md5mesh) joint hierarchy and the animations (md5anim)
-                    // joint hierarchy must match up
-                    bool jointMatchFound = false;
-                    tempAnim.jointInfo.reserve(m_MD5Model.numJoints);
-                    for (int k = 0; k < m_MD5Model.numJoints; k++) {
-                        if (m_MD5Model.joints[k].name == tempJoint.name) {
-                            if (m_MD5Model.joints[k].parentID == tempJoint.parentID) {
-                                jointMatchFound = true;
-                                tempAnim.jointInfo.push_back(tempJoint);
-                            }
+                // Remove the quotation marks from joints name
+                tempJoint.name.erase(0, 1);
+                tempJoint.name.erase(tempJoint.name.size() - 1, 1);
+
+                fileIn >> tempJoint.parentID;    // Get joints parent ID
+                fileIn >> tempJoint.flags;       // Get flags
+                fileIn >> tempJoint.startIndex;  // Get joints start index
+
+                // Make sure the joint exists in the model, and the parent ID's match up
+                // because the bind pose (md5mesh) joint hierarchy and the animations (md5anim)
+                // joint hierarchy must match up
+                bool jointMatchFound = false;
+                outAnimation.jointInfo.reserve(model.numJoints);
+                for (int k = 0; k < model.numJoints; k++) {
+                    if (model.joints[k].name == tempJoint.name) {
+                        if (model.joints[k].parentID == tempJoint.parentID) {
+                            jointMatchFound = true;
+                            outAnimation.jointInfo.push_back(tempJoint);
                         }
                     }
-                    if (!jointMatchFound)  // If the skeleton system does not match up, return false
-                        return false;      // You might want to add an error message here
-
-                    std::getline(fileIn, checkString);  // Skip rest of this line
                 }
-            } else if (checkString == "bounds")  // Load in the AABB for each animation
-            {
-                fileIn >> checkString;  // Skip opening bracket "{"
+                if (!jointMatchFound)  // If the skeleton system does not match up, return false
+                    return false;
 
-                tempAnim.frameBounds.reserve(tempAnim.numFrames);
-                for (int i = 0; i < tempAnim.numFrames; i++) {
-                    BoundingBox tempBB;
+                std::getline(fileIn, checkString);  // Skip rest of this line
+            }
+        } else if (checkString == "bounds")  // Load in the AABB for each animation
+        {
+            fileIn >> checkString;  // Skip opening bracket "{"
 
-                    fileIn >> checkString;  // Skip "("
-                    fileIn >> tempBB.min.x >> tempBB.min.y >> tempBB.min.z;
-                    fileIn >> checkString >> checkString;  // Skip ") ("
-                    fileIn >> tempBB.max.x >> tempBB.max.y >> tempBB.max.z;
-                    fileIn >> checkString;  // Skip ")"
+            outAnimation.frameBounds.reserve(outAnimation.numFrames);
+            for (int i = 0; i < outAnimation.numFrames; i++) {
+                BoundingBox tempBB;
 
-                    tempAnim.frameBounds.push_back(tempBB);
-                }
-            } else if (checkString == "baseframe")  // This is the default position for the animation
-            {                                       // All frames will build their skeletons off this
-                fileIn >> checkString;              // Skip opening bracket "{"
+                fileIn >> checkString;  // Skip "("
+                fileIn >> tempBB.min.x >> tempBB.min.y >> tempBB.min.z;
+                fileIn >> checkString >> checkString;  // Skip ") ("
+                fileIn >> tempBB.max.x >> tempBB.max.y >> tempBB.max.z;
+                fileIn >> checkString;  // Skip ")"
 
-                tempAnim.baseFrameJoints.reserve(tempAnim.numJoints);
-                for (int i = 0; i < tempAnim.numJoints; i++) {
-                    Joint tempBFJ;
+                outAnimation.frameBounds.push_back(tempBB);
+            }
+        } else if (checkString == "baseframe")  // This is the default position for the animation
+        {                                       // All frames will build their skeletons off this
+            fileIn >> checkString;              // Skip opening bracket "{"
 
-                    fileIn >> checkString;  // Skip "("
-                    fileIn >> tempBFJ.pos.x >> tempBFJ.pos.y >> tempBFJ.pos.z;
-                    fileIn >> checkString >> checkString;  // Skip ") ("
-                    fileIn >> tempBFJ.orientation.x >> tempBFJ.orientation.y >> tempBFJ.orientation.z;
-                    fileIn >> checkString;  // Skip ")"
+            outAnimation.baseFrameJoints.reserve(outAnimation.numJoints);
+            for (int i = 0; i < outAnimation.numJoints; i++) {
+                Joint tempBFJ;
 
-                    tempAnim.baseFrameJoints.push_back(tempBFJ);
-                }
-            } else if (checkString ==
-                       "frame")  // Load in each frames skeleton (the parts of each joint that changed from the base frame)
-            {
-                FrameData tempFrame;
+                fileIn >> checkString;  // Skip "("
+                fileIn >> tempBFJ.pos.x >> tempBFJ.pos.y >> tempBFJ.pos.z;
+                fileIn >> checkString >> checkString;  // Skip ") ("
+                fileIn >> tempBFJ.orientation.x >> tempBFJ.orientation.y >> tempBFJ.orientation.z;
+                fileIn >> checkString;  // Skip ")"
 
-                fileIn >> tempFrame.frameID;  // Get the frame ID
+                outAnimation.baseFrameJoints.push_back(tempBFJ);
+            }
+        } else if (checkString ==
+                   "frame")  // Load in each frames skeleton (the parts of each joint that changed from the base frame)
+        {
+            FrameData tempFrame;
 
-                fileIn >> checkString;  // Skip opening bracket "{"
+            fileIn >> tempFrame.frameID;  // Get the frame ID
 
-                tempFrame.frameData.reserve(tempAnim.numAnimatedComponents);
-                for (int i = 0; i < tempAnim.numAnimatedComponents; i++) {
-                    float tempData;
-                    fileIn >> tempData;  // Get the data
+            fileIn >> checkString;  // Skip opening bracket "{"
 
-                    tempFrame.frameData.push_back(tempData);
-                }
+            tempFrame.frameData.reserve(outAnimation.numAnimatedComponents);
+            for (int i = 0; i < outAnimation.numAnimatedComponents; i++) {
+                float tempData;
+                fileIn >> tempData;  // Get the data
 
-                tempAnim.frameData.push_back(tempFrame);
+                tempFrame.frameData.push_back(tempData);
+            }
 
-                ///*** build the frame skeleton ***///
-                std::vector<Joint> tempSkeleton;
+            outAnimation.frameData.push_back(tempFrame);
 
-                tempSkeleton.reserve(tempAnim.jointInfo.size());
-                for (int i = 0; i < tempAnim.jointInfo.size(); i++) {
-                    int k = 0;  // Keep track of position in frameData array
+            ///*** build the frame skeleton ***///
+            std::vector<Joint> tempSkeleton;
 
-                    // Start the frames joint with the base frame's joint
-                    Joint tempFrameJoint = tempAnim.baseFrameJoints[i];
+            tempSkeleton.reserve(outAnimation.jointInfo.size());
+            for (int i = 0; i < outAnimation.jointInfo.size(); i++) {
+                int k = 0;  // Keep track of position in frameData array
 
-                    tempFrameJoint.parentID = tempAnim.jointInfo[i].parentID;
+                // Start the frames joint with the base frame's joint
+                Joint tempFrameJoint = outAnimation.baseFrameJoints[i];
 
-                    // Notice
-                    // If you have problems with loading some models, it's possible
-                    // the model was created in a left hand coordinate system. in that case, just reflip all the
-                    // y and z axes in our md5 mesh and anim loader.
-                    if (tempAnim.jointInfo[i].flags & 1)  // pos.x	( 000001 )
-                        tempFrameJoint.pos.x = tempFrame.frameData[tempAnim.jointInfo[i].startIndex + k++];
+                tempFrameJoint.parentID = outAnimation.jointInfo[i].parentID;
 
-                    if (tempAnim.jointInfo[i].flags & 2)  // pos.y	( 000010 )
-                        tempFrameJoint.pos.y = tempFrame.frameData[tempAnim.jointInfo[i].startIndex + k++];
+                // Notice
+                // If you have problems with loading some models, it's possible
+                // the model was created in a left hand coordinate system. in that case, just reflip all the
+                // y and z axes in our md5 mesh and anim loader.
+                if (outAnimation.jointInfo[i].flags & 1)  // pos.x	( 000001 )
+                    tempFrameJoint.pos.x = tempFrame.frameData[outAnimation.jointInfo[i].startIndex + k++];
 
-                    if (tempAnim.jointInfo[i].flags & 4)  // pos.z	( 000100 )
-                        tempFrameJoint.pos.z = tempFrame.frameData[tempAnim.jointInfo[i].startIndex + k++];
+                if (outAnimation.jointInfo[i].flags & 2)  // pos.y	( 000010 )
+                    tempFrameJoint.pos.y = tempFrame.frameData[outAnimation.jointInfo[i].startIndex + k++];
 
-                    if (tempAnim.jointInfo[i].flags & 8)  // orientation.x	( 001000 )
-                        tempFrameJoint.orientation.x = tempFrame.frameData[tempAnim.jointInfo[i].startIndex + k++];
+                if (outAnimation.jointInfo[i].flags & 4)  // pos.z	( 000100 )
+                    tempFrameJoint.pos.z = tempFrame.frameData[outAnimation.jointInfo[i].startIndex + k++];
 
-                    if (tempAnim.jointInfo[i].flags & 16)  // orientation.y	( 010000 )
-                        tempFrameJoint.orientation.y = tempFrame.frameData[tempAnim.jointInfo[i].startIndex + k++];
+                if (outAnimation.jointInfo[i].flags & 8)  // orientation.x	( 001000 )
+                    tempFrameJoint.orientation.x = tempFrame.frameData[outAnimation.jointInfo[i].startIndex + k++];
 
-                    if (tempAnim.jointInfo[i].flags & 32)  // orientation.z	( 100000 )
-                        tempFrameJoint.orientation.z = tempFrame.frameData[tempAnim.jointInfo[i].startIndex + k++];
+                if (outAnimation.jointInfo[i].flags & 16)  // orientation.y	( 010000 )
+                    tempFrameJoint.orientation.y = tempFrame.frameData[outAnimation.jointInfo[i].startIndex + k++];
 
-                    // vector to quat converssion
-                    // Compute the quaternions w
-                    float t = 1.0f - (tempFrameJoint.orientation.x * tempFrameJoint.orientation.x) -
-                              (tempFrameJoint.orientation.y * tempFrameJoint.orientation.y) -
-                              (tempFrameJoint.orientation.z * tempFrameJoint.orientation.z);
-                    if (t < 0.0f) {
-                        tempFrameJoint.orientation.w = 0.0f;
-                    } else {
-                        tempFrameJoint.orientation.w = -sqrtf(t);
-                    }
+                if (outAnimation.jointInfo[i].flags & 32)  // orientation.z	( 100000 )
+                    tempFrameJoint.orientation.z = tempFrame.frameData[outAnimation.jointInfo[i].startIndex + k++];
 
-                    // Now, if the upper arm of your skeleton moves, you need to also move the lower part of your arm, and then
-                    // the hands, and then finally the fingers (possibly weapon or tool too) This is where joint hierarchy comes
-                    // in. We start at the top of the hierarchy, and move down to each joints child, rotating and translating them
-                    // based on their parents rotation and translation. We can assume that by the time we get to the child, the
-                    // parent has already been rotated and transformed based of it's parent. We can assume this because the child
-                    // should never come before the parent in the files we loaded in.
-                    if (tempFrameJoint.parentID >= 0) {
-                        Joint parentJoint = tempSkeleton[tempFrameJoint.parentID];
+                // vector to quat converssion
+                // Compute the quaternions w
+                float t = 1.0f - (tempFrameJoint.orientation.x * tempFrameJoint.orientation.x) -
+                          (tempFrameJoint.orientation.y * tempFrameJoint.orientation.y) -
+                          (tempFrameJoint.orientation.z * tempFrameJoint.orientation.z);
+                if (t < 0.0f) {
+                    tempFrameJoint.orientation.w = 0.0f;
+                } else {
+                    tempFrameJoint.orientation.w = -sqrtf(t);
+                }
 
-                        glm::vec3 rotatedPoint = parentJoint.orientation * tempFrameJoint.pos;
+                // Now, if the upper arm of your skeleton moves, you need to also move the lower part of your arm, and then
+                // the hands, and then finally the fingers (possibly weapon or tool too) This is where joint hierarchy comes
+                // in. We start at the top of the hierarchy, and move down to each joints child, rotating and translating them
+                // based on their parents rotation and translation. We can assume that by the time we get to the child, the
+                // parent has already been rotated and transformed based of it's parent. We can assume this because the child
+                // should never come before the parent in the files we loaded in.
+                if (tempFrameJoint.parentID >= 0) {
+                    Joint parentJoint = tempSkeleton[tempFrameJoint.parentID];
 
-                        // Translate the joint to model space by adding the parent joint's pos to it
-                        tempFrameJoint.pos = rotatedPoint + parentJoint.pos;
+                    glm::vec3 rotatedPoint = parentJoint.orientation * tempFrameJoint.pos;
 
-                        // Currently the joint is oriented in its parent joints space, we now need to orient it in
-                        // model space by multiplying the two orientations together (parentOrientation * childOrientation) <- In
-                        // that order
+                    // Translate the joint to model space by adding the parent joint's pos to it
+                    tempFrameJoint.pos = rotatedPoint + parentJoint.pos;
 
-                        tempFrameJoint.orientation = glm::normalize(parentJoint.orientation * tempFrameJoint.orientation);
-                    }
+                    // Currently the joint is oriented in its parent joints space, we now need to orient it in
+                    // model space by multiplying the two orientations together (parentOrientation * childOrientation) <- In
+                    // that order
 
-                    // Store the joint into our temporary frame skeleton
-                    tempSkeleton.push_back(tempFrameJoint);
+                    tempFrameJoint.orientation = glm::normalize(parentJoint.orientation * tempFrameJoint.orientation);
                 }
 
-                // Push back our newly created frame skeleton into the animation's frameSkeleton array
-                tempAnim.frameSkeleton.push_back(tempSkeleton);
-
-                fileIn >> checkString;  // Skip closing bracket "}"
+                // Store the joint into our temporary frame skeleton
+                tempSkeleton.push_back(tempFrameJoint);
             }
-        }
 
-        // Calculate and store some usefull animation data
-        tempAnim.frameTime = 1.0f / tempAnim.frameRate;                    // Set the time per frame
-        tempAnim.totalAnimTime = tempAnim.numFrames * tempAnim.frameTime;  // Set the total time the animation takes
-        tempAnim.currAnimTime = 0.0f;                                      // Set the current time to zero
+            // Push back our newly created frame skeleton into the animation's frameSkeleton array
+            outAnimation.frameSkeleton.push_back(tempSkeleton);
 
-        m_MD5Model.animations.push_back(tempAnim);  // Push back the animation into our model object
-    } else                                          // If the file was not loaded
-    {
-        Utils::printLog(ERROR_PARAM, "Couldn't load animation file", m_md5AnimFileName);
-        return false;
+            fileIn >> checkString;  // Skip closing bracket "}"
+        }
     }
+
+    // Calculate and store some usefull animation data
+    outAnimation.frameTime = 1.0f / outAnimation.frameRate;                        // Set the time per frame
+    outAnimation.totalAnimTime = outAnimation.numFrames * outAnimation.frameTime;  // Set the total time the animation takes
+    outAnimation.currAnimTime = 0.0f;                                              // Set the current time to zero
     return true;
 }
 
 void MD5Model::updateAnimationOnGPU(float deltaTimeMS, std::size_t animationID, uint32_t currentImage, const glm::mat4& viewProj,
                                     float z_far, const glm::vec3& camPos) {
+    PROFILE_SCOPE("skinningGPU");
 #if defined(USE_CUDA) && USE_CUDA
     assert(m_MD5Model.animations.size() > animationID && m_MD5Model.animations[animationID].numFrames > 1);
     if (mCudaAnimator) {
         mWaitCudaSignalValue = currentImage;
         mActiveInstancesAmount = mCudaAnimator->update(deltaTimeMS, mWaitCudaSignalValue, animationID, m_verticesBufferOffset,
                                                        SORT_INSTANCES_ON_CUDA, viewProj, z_far);
+        for (const auto& subset : m_MD5Model.subsets) {
+            FrameTelemetry::count(FrameTelemetry::SKINNED_VERTICES, subset.vertices.size());
+        }
 
         if (SORT_INSTANCES_ON_CUDA == 0) {
-            auto p_device = m_vkState._core.getDevice();
-            assert(p_device);
             sortInstances(currentImage, viewProj,  camPos, z_far);
 
             const VkDeviceSize instancesSize = sizeof(m_activeInstances[0]) * m_activeInstances.size();
+            reserveInstancesBuffer(currentImage, m_activeInstances.size());
 
-            void* data;
-            vkMapMemory(p_device, m_instancesBufferMemory[currentImage], 0, instancesSize, 0, &data);
-            memcpy((char*)data, m_activeInstances.data(), instancesSize);
-            vkUnmapMemory(p_device, m_instancesBufferMemory[currentImage]);
+            memcpy(MemoryAllocator::getInstance().getMappedData(m_instancesBuffer[currentImage]), m_activeInstances.data(),
+                   instancesSize);
+            FrameTelemetry::count(FrameTelemetry::UPLOADED_BYTES, instancesSize);
 
             mActiveInstancesAmount = m_activeInstances.size();
         }
@@ -428,14 +430,11 @@ void MD5Model::updateAnimationOnGPU(float deltaTimeMS, std::size_t animationID,
 
 void MD5Model::updateAnimationOnCPU(float deltaTimeMS, std::size_t animationID, uint32_t currentImage, const glm::mat4& viewProj,
                                     float z_far, const glm::vec3& camPos) {
+    PROFILE_SCOPE("skinning");
     assert(m_MD5Model.animations.size() > animationID && m_MD5Model.animations[animationID].numFrames > 1);
 
     // Update the subsets vertex buffer in worker_threads
-    auto p_device = m_vkState._core.getDevice();
-    assert(p_device);
-    void* data;
-
-    vkMapMemory(p_device, m_generalBufferMemory, 0u, m_bufferSize, 0, &data);
+    void* data = MemoryAllocator::getInstance().getMappedData(m_generalBuffer);
 
     float currentFrame{0.0f};
     std::size_t frame0{0u};
@@ -520,20 +519,21 @@ void MD5Model::updateAnimationOnCPU(float deltaTimeMS, std::size_t animationID,
         // we don't need to copy the indices all the time, they are not changing
         // memcpy((char*)data + subset.indexOffset * indexBytes, subset.indices.data(), indicesSize);
         memcpy((char*)data + m_verticesBufferOffset + subset.vertOffset * vertBytes, subset.gpuVertices.data(), verticesSize);
+        FrameTelemetry::count(FrameTelemetry::SKINNED_VERTICES, subset.vertices.size());
+        FrameTelemetry::count(FrameTelemetry::UPLOADED_BYTES, verticesSize);
     }
 
-    vkUnmapMemory(p_device, m_generalBufferMemory);
-
     // Update the instances buffer
     {
         sortInstances(currentImage, viewProj, camPos, z_far);
 
         const VkDeviceSize instancesSize = sizeof(m_activeInstances[0]) * m_activeInstances.size();
+        // instances may be added after init, the buffer grows with them
+        reserveInstancesBuffer(currentImage, m_activeInstances.size());
 
-        void* data;
-        vkMapMemory(p_device, m_instancesBufferMemory[currentImage], 0, instancesSize, 0, &data);
-        memcpy((char*)data, m_activeInstances.data(), instancesSize);
-        vkUnmapMemory(p_device, m_instancesBufferMemory[currentImage]);
+        memcpy(MemoryAllocator::getInstance().getMappedData(m_instancesBuffer[currentImage]), m_activeInstances.data(),
+               instancesSize);
+        FrameTelemetry::count(FrameTelemetry::UPLOADED_BYTES, instancesSize);
 
         mActiveInstancesAmount = m_activeInstances.size();
     }
@@ -562,13 +562,25 @@ void MD5Model::update(float deltaTimeMS, int animationID, bool onGPU, uint32_t c
 
 void MD5Model::calculateInterpolatedSkeleton(std::size_t animationID, std::size_t frame0, std::size_t frame1, float interpolation,
                                              std::size_t indexFrom, std::size_t indexTo) {
-    ModelAnimation& animation = m_MD5Model.animations[animationID];
-    assert(indexFrom < animation.numJoints && indexTo <= animation.numJoints && indexTo <= mInterpolatedSkeleton.size() &&
+    PROFILE_FUNCTION();
+    interpolateSkeleton(m_MD5Model.animations[animationID], frame0, frame1, interpolation, indexFrom, indexTo,
+                        mInterpolatedSkeleton);
+}
+
+void MD5Model::updateAnimationChunk(std::size_t subsetId, std::size_t indexFrom, std::size_t indexTo) {
+    PROFILE_FUNCTION();
+    skinVertices(m_MD5Model.subsets[subsetId], mInterpolatedSkeleton, m_vertexMagnitudeMultiplier, m_isSwapYZNeeded, indexFrom,
+                 indexTo);
+}
+
+void MD5Model::interpolateSkeleton(const ModelAnimation& animation, std::size_t frame0, std::size_t frame1, float interpolation,
+                                   std::size_t indexFrom, std::size_t indexTo, std::vector<Joint>& outSkeleton) {
+    assert(indexFrom < animation.numJoints && indexTo <= animation.numJoints && indexTo <= outSkeleton.size() &&
            animation.frameSkeleton.size() > frame0 && animation.frameSkeleton.size() > frame1);
     Joint joint0;
     Joint joint1;
     for (std::size_t i = indexFrom; i < indexTo; i++) {
-        Joint& tempJoint = mInterpolatedSkeleton[i];
+        Joint& tempJoint = outSkeleton[i];
         joint0 = animation.frameSkeleton[frame0][i];  // Get the i'th joint of frame0's skeleton
         joint1 = animation.frameSkeleton[frame1][i];  // Get the i'th joint of frame1's skeleton
 
@@ -584,8 +596,8 @@ void MD5Model::calculateInterpolatedSkeleton(std::size_t animationID, std::size_
     }
 }
 
-void MD5Model::updateAnimationChunk(std::size_t subsetId, std::size_t indexFrom, std::size_t indexTo) {
-    ModelSubset& subset = m_MD5Model.subsets[subsetId];
+void MD5Model::skinVertices(ModelSubset& subset, const std::vector<Joint>& skeleton, float vertexMagnitudeMultiplier,
+                            bool is_swapYZNeeded, std::size_t indexFrom, std::size_t indexTo) {
     assert(indexFrom < subset.vertices.size() && indexTo <= subset.vertices.size());
 
     glm::vec3 rotatedPoint = glm::vec3(.0f, .0f, .0f);
@@ -598,7 +610,7 @@ void MD5Model::updateAnimationChunk(std::size_t subsetId, std::size_t indexFrom,
         // Sum up the joints and weights information to get vertex's position and normal
         for (std::size_t j = 0; j < tempVert.weightCount; ++j) {
             const Weight& tempWeight = subset.weights[tempVert.startWeight + j];
-            const Joint& tempJoint = mInterpolatedSkeleton[tempWeight.jointID];
+            const Joint& tempJoint = skeleton[tempWeight.jointID];
 
             // Calculate vertex position (in joint space, eg. rotate the point around (0,0,0)) for this weight using the joint
             // orientation quaternion and its conjugate We can rotate a point using a quaternion with the equation
@@ -619,11 +631,11 @@ void MD5Model::updateAnimationChunk(std::size_t subsetId, std::size_t indexFrom,
             gpuVertex.normal = gpuVertex.normal + (rotatedPoint * tempWeight.bias);
         }
 
-        gpuVertex.pos *= m_vertexMagnitudeMultiplier;
+        gpuVertex.pos *= vertexMagnitudeMultiplier;
 
         gpuVertex.normal = glm::normalize(gpuVertex.normal);
 
-        if (m_isSwapYZNeeded) {
+        if (is_swapYZNeeded) {
             swapYandZ(gpuVertex.pos);
             swapYandZ(gpuVertex.normal);
         }
@@ -642,356 +654,370 @@ bool MD5Model::loadMD5Model(std::vector<VertexData>& vertices, std::vector<uint3
     std::string absPath = Utils::formPath(Constants::MODEL_DIR, m_md5ModelFileName);
 
     std::ifstream fileIn(absPath.c_str());
+    if (!fileIn) {
+        Utils::printLog(ERROR_PARAM, "Couldn't load animation file", absPath);
+        return false;
+    }
 
-    std::string checkString;  // Stores the next string from our file
+    std::vector<std::string> textureNames;
+    parseModel(fileIn, m_vertexMagnitudeMultiplier, m_MD5Model, textureNames, m_radius);
 
-    if (fileIn)  // Check if the file was opened
-    {
-        while (fileIn)  // Loop until the end of the file is reached
-        {
-            fileIn >> checkString;  // Get next string from file
+    for (std::size_t k = 0u; k < m_MD5Model.subsets.size(); ++k) {
+        if (textureNames[k].empty()) {
+            continue;
+        }
+        auto texture = m_textureFactory.create2DArrayTextureAsync(std::vector<std::string>{textureNames[k]});
+        if (!texture.expired()) {
+            m_textures.push_back(texture);
+            m_MD5Model.subsets[k].realMaterialId = m_pipelineCreatorTextured->createDescriptor(
+                texture, m_textureFactory.getTextureSampler(texture.lock()->mipLevels));
+        } else {
+            Utils::printLog(ERROR_PARAM, "couldn't create texture", textureNames[k]);
+        }
+    }
 
-            if (checkString == "MD5Version")  // Get MD5 version (this function supports version 10)
-            {
-            } else if (checkString == "commandline") {
-                std::getline(fileIn, checkString);  // Ignore the rest of this line
-            } else if (checkString == "numJoints") {
-                fileIn >> m_MD5Model.numJoints;  // Store number of joints
-                m_MD5Model.joints.reserve(m_MD5Model.numJoints);
-            } else if (checkString == "numMeshes") {
-                fileIn >> m_MD5Model.numSubsets;  // Store number of meshes or subsets which we will call them
-                m_MD5Model.subsets.reserve(m_MD5Model.numSubsets);
-            } else if (checkString == "joints") {
-                Joint tempJoint;
-
-                fileIn >> checkString;  // Skip the "{"
-
-                for (int i = 0; i < m_MD5Model.numJoints; i++) {
-                    fileIn >> tempJoint.name;  // Store joints name
-                    // Sometimes the names might contain spaces. If that is the case, we need to continue
-                    // to read the name until we get to the closing " (quotation marks)
-                    if (tempJoint.name[tempJoint.name.size() - 1] != '"') {
-                        char checkChar;
-                        bool jointNameFound = false;
-                        while (!jointNameFound) {
-                            checkChar = fileIn.get();
+    /// packing subsets verts & indices into general containers
+    std::size_t commonVertsAmount = 0u;
+    std::size_t commonIndicesAmount = 0u;
+    for (auto& subset : m_MD5Model.subsets) {
+        commonVertsAmount += subset.gpuVertices.size();
+        commonIndicesAmount += subset.indices.size();
 
-                            if (checkChar == '"')
-                                jointNameFound = true;
+        // normilize the vertices
+        for (auto& gpuVert : subset.gpuVertices) {
+            gpuVert.pos = gpuVert.pos / m_radius;
+        }
+    }
 
-                            tempJoint.name += checkChar;
-                        }
-                    }
+    // modify our radius according to multiplier
+    m_radius = m_vertexMagnitudeMultiplier;
 
-                    fileIn >> tempJoint.parentID;  // Store Parent joint's ID
+    vertices.resize(commonVertsAmount);
+    indices.resize(commonIndicesAmount);
 
-                    fileIn >> checkString;  // Skip the "("
+    uint32_t lastVertsSize = 0u;
+    uint32_t lastIndicesSize = 0u;
+    for (auto& subset : m_MD5Model.subsets) {
+        static const std::size_t indexBytes = sizeof(subset.indices[0]);
+        static const std::size_t vertBytes = sizeof(subset.gpuVertices[0]);
+        const std::size_t verticesSize = subset.gpuVertices.size();
+        const std::size_t indicesSize = subset.indices.size();
 
-                    // Store position of this joint (swap y and z axis if model was made in RH Coord Sys)
-                    fileIn >> tempJoint.pos.x >> tempJoint.pos.y >> tempJoint.pos.z;
+        // eventually we'll have one single buffer containing: mesh1.indexBuf + meshN.indexBuf + ... + mesh1.vertBuf +
+        // meshN.vertBuf we need to keep the offset to understand which part of buffer to update
+        subset.indexOffset = lastIndicesSize;
+        subset.vertOffset = lastVertsSize;
 
-                    fileIn >> checkString >> checkString;  // Skip the ")" and "("
+        memcpy((char*)indices.data() + lastIndicesSize * indexBytes, subset.indices.data(), indicesSize * indexBytes);
+        memcpy((char*)vertices.data() + lastVertsSize * vertBytes, subset.gpuVertices.data(), verticesSize * vertBytes);
 
-                    // Store orientation of this joint
-                    fileIn >> tempJoint.orientation.x >> tempJoint.orientation.y >> tempJoint.orientation.z;
+        lastVertsSize += verticesSize;
+        lastIndicesSize += indicesSize;
+    }
 
-                    // Remove the quotation marks from joints name
-                    tempJoint.name.erase(0, 1);
-                    tempJoint.name.erase(tempJoint.name.size() - 1, 1);
+    return true;
+}
 
-                    // Compute the w axis of the quaternion (The MD5 model uses a 3D vector to describe the
-                    // direction the bone is facing. However, we need to turn this into a quaternion, and the way
-                    // quaternions work, is the xyz values describe the axis of rotation, while the w is a value
-                    // between 0 and 1 which describes the angle of rotation)
-                    float t = 1.0f - (tempJoint.orientation.x * tempJoint.orientation.x) -
-                              (tempJoint.orientation.y * tempJoint.orientation.y) -
-                              (tempJoint.orientation.z * tempJoint.orientation.z);
-                    if (t < 0.0f) {
-                        tempJoint.orientation.w = 0.0f;
-                    } else {
-                        tempJoint.orientation.w = -sqrtf(t);
-                    }
+void MD5Model::parseModel(std::istream& fileIn, float vertexMagnitudeMultiplier, Model3D& outModel,
+                          std::vector<std::string>& outTextureNames, float& outRadius) {
+    outRadius = 0.0f;
+    std::string checkString;  // Stores the next string from our file
 
-                    std::getline(fileIn, checkString);  // Skip rest of this line
+    while (fileIn)  // Loop until the end of the file is reached
+    {
+        fileIn >> checkString;  // Get next string from file
 
-                    m_MD5Model.joints.push_back(tempJoint);  // Store the joint into this models joint vector
+        if (checkString == "MD5Version")  // Get MD5 version (this function supports version 10)
+        {
+        } else if (checkString == "commandline") {
+            std::getline(fileIn, checkString);  // Ignore the rest of this line
+        } else if (checkString == "numJoints") {
+            fileIn >> outModel.numJoints;  // Store number of joints
+            outModel.joints.reserve(outModel.numJoints);
+        } else if (checkString == "numMeshes") {
+            fileIn >> outModel.numSubsets;  // Store number of meshes or subsets which we will call them
+            outModel.subsets.reserve(outModel.numSubsets);
+        } else if (checkString == "joints") {
+            Joint tempJoint;
+
+            fileIn >> checkString;  // Skip the "{"
+
+            for (int i = 0; i < outModel.numJoints; i++) {
+                fileIn >> tempJoint.name;  // Store joints name
+                // Sometimes the names might contain spaces. If that is the case, we need to continue
+                // to read the name until we get to the closing " (quotation marks)
+                if (tempJoint.name[tempJoint.name.size() - 1] != '"') {
+                    char checkChar;
+                    bool jointNameFound = false;
+                    while (!jointNameFound) {
+                        checkChar = fileIn.get();
+
+                        if (checkChar == '"')
+                            jointNameFound = true;
+
+                        tempJoint.name += checkChar;
+                    }
                 }
 
-                fileIn >> checkString;  // Skip the "}"
-            } else if (checkString == "mesh") {
-                m_MD5Model.subsets.emplace_back();
-                ModelSubset& subset = m_MD5Model.subsets.back();
-                int numVerts, numTris, numWeights;
+                fileIn >> tempJoint.parentID;  // Store Parent joint's ID
 
-                fileIn >> checkString;  // Skip the "{"
+                fileIn >> checkString;  // Skip the "("
 
-                fileIn >> checkString;
-                while (checkString != "}")  // Read until '}'
-                {
-                    if (checkString == "shader")  // Load the texture
-                    {
-                        std::string diffuse_texname;
-                        fileIn >> diffuse_texname;  // Get texture's filename
+                // Store position of this joint (swap y and z axis if model was made in RH Coord Sys)
+                fileIn >> tempJoint.pos.x >> tempJoint.pos.y >> tempJoint.pos.z;
 
-                        // Take spaces into account if filename or material name has a space in it
-                        if (diffuse_texname[diffuse_texname.size() - 1] != '"') {
-                            char checkChar;
-                            bool fileNameFound = false;
-                            while (!fileNameFound) {
-                                checkChar = fileIn.get();
+                fileIn >> checkString >> checkString;  // Skip the ")" and "("
 
-                                if (checkChar == '"')
-                                    fileNameFound = true;
+                // Store orientation of this joint
+                fileIn >> tempJoint.orientation.x >> tempJoint.orientation.y >> tempJoint.orientation.z;
 
-                                diffuse_texname += checkChar;
-                            }
-                        }
+                // Remove the quotation marks from joints name
+                tempJoint.name.erase(0, 1);
+                tempJoint.name.erase(tempJoint.name.size() - 1, 1);
 
-                        // Remove the quotation marks from texture path
-                        diffuse_texname.erase(0, 1);
-                        diffuse_texname.erase(diffuse_texname.size() - 1, 1);
+                // Compute the w axis of the quaternion (The MD5 model uses a 3D vector to describe the
+                // direction the bone is facing. However, we need to turn this into a quaternion, and the way
+                // quaternions work, is the xyz values describe the axis of rotation, while the w is a value
+                // between 0 and 1 which describes the angle of rotation)
+                float t = 1.0f - (tempJoint.orientation.x * tempJoint.orientation.x) -
+                          (tempJoint.orientation.y * tempJoint.orientation.y) -
+                          (tempJoint.orientation.z * tempJoint.orientation.z);
+                if (t < 0.0f) {
+                    tempJoint.orientation.w = 0.0f;
+                } else {
+                    tempJoint.orientation.w = -sqrtf(t);
+                }
 
-                        auto texture = m_textureFactory.create2DArrayTexture(std::vector<std::string>{diffuse_texname});
-                        if (!texture.expired()) {
-                            subset.realMaterialId = m_pipelineCreatorTextured->createDescriptor(
-                                texture, m_textureFactory.getTextureSampler(texture.lock()->mipLevels));
-                        } else {
-                            Utils::printLog(ERROR_PARAM, "couldn't create texture", diffuse_texname);
-                        }
+                std::getline(fileIn, checkString);  // Skip rest of this line
 
-                        std::getline(fileIn, checkString);  // Skip rest of this line
-                    } else if (checkString == "numverts") {
-                        fileIn >> numVerts;  // Store number of vertices
+                outModel.joints.push_back(tempJoint);  // Store the joint into this models joint vector
+            }
 
-                        std::getline(fileIn, checkString);  // Skip rest of this line
+            fileIn >> checkString;  // Skip the "}"
+        } else if (checkString == "mesh") {
+            outModel.subsets.emplace_back();
+            outTextureNames.emplace_back();
+            ModelSubset& subset = outModel.subsets.back();
+            int numVerts, numTris, numWeights;
 
-                        subset.vertices.reserve(numVerts);
-                        subset.gpuVertices.reserve(numVerts);
-                        for (int i = 0; i < numVerts; i++) {
-                            subset.gpuVertices.emplace_back();
-                            VertexData& gpuVert = subset.gpuVertices.back();
-                            MD5Vertex tempVert;
-                            tempVert.gpuVertexIndex = i;
+            fileIn >> checkString;  // Skip the "{"
 
-                            fileIn >> checkString  // Skip "vert # ("
-                                >> checkString >> checkString;
+            fileIn >> checkString;
+            while (checkString != "}")  // Read until '}'
+            {
+                if (checkString == "shader")  // Load the texture
+                {
+                    std::string diffuse_texname;
+                    fileIn >> diffuse_texname;  // Get texture's filename
 
-                            fileIn >> gpuVert.texCoord.x  // Store tex coords
-                                >> gpuVert.texCoord.y;
+                    // Take spaces into account if filename or material name has a space in it
+                    if (diffuse_texname[diffuse_texname.size() - 1] != '"') {
+                        char checkChar;
+                        bool fileNameFound = false;
+                        while (!fileNameFound) {
+                            checkChar = fileIn.get();
 
-                            gpuVert.texCoord.y = 1.0f - gpuVert.texCoord.y;
+                            if (checkChar == '"')
+                                fileNameFound = true;
 
-                            fileIn >> checkString;  // Skip ")"
+                            diffuse_texname += checkChar;
+                        }
+                    }
 
-                            fileIn >> tempVert.startWeight;  // Index of first weight this vert will be weighted to
+                    // Remove the quotation marks from texture path
+                    diffuse_texname.erase(0, 1);
+                    diffuse_texname.erase(diffuse_texname.size() - 1, 1);
 
-                            fileIn >> tempVert.weightCount;  // Number of weights for this vertex
+                    outTextureNames.back() = std::move(diffuse_texname);
 
-                            std::getline(fileIn, checkString);  // Skip rest of this line
+                    std::getline(fileIn, checkString);  // Skip rest of this line
+                } else if (checkString == "numverts") {
+                    fileIn >> numVerts;  // Store number of vertices
 
-                            subset.vertices.push_back(tempVert);  // Push back this vertex into subsets vertex vector
-                        }
-                    } else if (checkString == "numtris") {
-                        fileIn >> numTris;
-                        subset.numTriangles = numTris;
+                    std::getline(fileIn, checkString);  // Skip rest of this line
 
-                        std::getline(fileIn, checkString);  // Skip rest of this line
+                    subset.vertices.reserve(numVerts);
+                    subset.gpuVertices.reserve(numVerts);
+                    for (int i = 0; i < numVerts; i++) {
+                        subset.gpuVertices.emplace_back();
+                        VertexData& gpuVert = subset.gpuVertices.back();
+                        MD5Vertex tempVert;
+                        tempVert.gpuVertexIndex = i;
 
-                        subset.indices.reserve(numTris * 3u);
-                        for (int i = 0; i < numTris; i++)  // Loop through each triangle
-                        {
-                            uint32_t tempIndex[3];
-                            fileIn >> checkString;  // Skip "tri"
-                            fileIn >> checkString;  // Skip tri counter
-
-                            for (int k = 0; k < 3; k++)  // Store the 3 indices
-                            {
-                                fileIn >> tempIndex[k];
-                            }
-                            // adding indices in backward order since our front face winding order is
-                            // VK_FRONT_FACE_COUNTER_CLOCKWISE unlike DirectX
-                            for (int k = 2; k >= 0; --k) {
-                                subset.indices.push_back(tempIndex[k]);
-                            }
-
-                            std::getline(fileIn, checkString);  // Skip rest of this line
-                        }
-                    } else if (checkString == "numweights") {
-                        fileIn >> numWeights;
+                        fileIn >> checkString  // Skip "vert # ("
+                            >> checkString >> checkString;
 
-                        std::getline(fileIn, checkString);  // Skip rest of this line
+                        fileIn >> gpuVert.texCoord.x  // Store tex coords
+                            >> gpuVert.texCoord.y;
 
-                        subset.weights.reserve(numWeights);
-                        for (int i = 0; i < numWeights; i++) {
-                            Weight tempWeight;
-                            fileIn >> checkString >> checkString;  // Skip "weight #"
+                        gpuVert.texCoord.y = 1.0f - gpuVert.texCoord.y;
 
-                            fileIn >> tempWeight.jointID;  // Store weight's joint ID
+                        fileIn >> checkString;  // Skip ")"
 
-                            fileIn >> tempWeight.bias;  // Store weight's influence over a vertex
+                        fileIn >> tempVert.startWeight;  // Index of first weight this vert will be weighted to
 
-                            fileIn >> checkString;  // Skip "("
+                        fileIn >> tempVert.weightCount;  // Number of weights for this vertex
 
-                            fileIn >> tempWeight.pos.x  // Store weight's pos in joint's local space
-                                >> tempWeight.pos.y >> tempWeight.pos.z;
+                        std::getline(fileIn, checkString);  // Skip rest of this line
 
-                            std::getline(fileIn, checkString);  // Skip rest of this line
+                        subset.vertices.push_back(tempVert);  // Push back this vertex into subsets vertex vector
+                    }
+                } else if (checkString == "numtris") {
+                    fileIn >> numTris;
+                    subset.numTriangles = numTris;
 
-                            subset.weights.push_back(tempWeight);  // Push back tempWeight into subsets Weight array
-                        }
+                    std::getline(fileIn, checkString);  // Skip rest of this line
 
-                    } else
-                        std::getline(fileIn, checkString);  // Skip anything else
+                    subset.indices.reserve(numTris * 3u);
+                    for (int i = 0; i < numTris; i++)  // Loop through each triangle
+                    {
+                        uint32_t tempIndex[3];
+                        fileIn >> checkString;  // Skip "tri"
+                        fileIn >> checkString;  // Skip tri counter
 
-                    fileIn >> checkString;  // Skip "}"
-                }
+                        for (int k = 0; k < 3; k++)  // Store the 3 indices
+                        {
+                            fileIn >> tempIndex[k];
+                        }
+                        // adding indices in backward order since our front face winding order is
+                        // VK_FRONT_FACE_COUNTER_CLOCKWISE unlike DirectX
+                        for (int k = 2; k >= 0; --k) {
+                            subset.indices.push_back(tempIndex[k]);
+                        }
 
-                //*** find each vertex's position using the joints and weights ***//
-                glm::vec3 rotatedPoint = glm::vec3{0.0f, 0.0f, 0.0f};
-                float radius{0.0f};
-                for (int i = 0; i < subset.vertices.size(); ++i) {
-                    MD5Vertex& tempVert = subset.vertices[i];
-                    auto& gpuVertex = subset.gpuVertices[tempVert.gpuVertexIndex];
-                    gpuVertex.pos = glm::vec3{0.0f, 0.0f, 0.0f};  // Make sure the vertex's pos is cleared first
-
-                    // Sum up the joints and weights information to get vertex's position
-                    for (int j = 0; j < tempVert.weightCount; ++j) {
-                        const Weight& tempWeight = subset.weights[tempVert.startWeight + j];
-                        const Joint& tempJoint = m_MD5Model.joints[tempWeight.jointID];
-
-                        // Calculate vertex position (in joint space, eg. rotate the point using joint orientation quaternion)
-                        rotatedPoint = tempJoint.orientation * tempWeight.pos;
-
-                        // Now move the verices position from joint space (0,0,0) to the joints position in world space, taking
-                        // the weights bias into account The weight bias is used because multiple weights might have an effect on
-                        // the vertices final position. Each weight is attached to one joint.
-                        gpuVertex.pos += (tempJoint.pos + rotatedPoint) * tempWeight.bias;
-
-                        // Basically what has happened above, is we have taken the weights position relative to the joints
-                        // position we then rotate the weights position (so that the weight is actually being rotated around (0,
-                        // 0, 0) in world space) using the quaternion describing the joints rotation. We have stored this rotated
-                        // point in rotatedPoint, which we then add to the joints position (because we rotated the weight's
-                        // position around (0,0,0) in world space, and now need to translate it so that it appears to have been
-                        // rotated around the joints position). Finally we multiply the answer with the weights bias, or how much
-                        // control the weight has over the final vertices position. All weight's bias effecting a single vertex's
-                        // position must add up to 1.
+                        std::getline(fileIn, checkString);  // Skip rest of this line
                     }
+                } else if (checkString == "numweights") {
+                    fileIn >> numWeights;
 
-                    radius = glm::length(gpuVertex.pos);
-                    if (m_radius < radius) {
-                        m_radius = radius;
-                    }
+                    std::getline(fileIn, checkString);  // Skip rest of this line
 
-                    gpuVertex.pos *= m_vertexMagnitudeMultiplier;
-                }
+                    subset.weights.reserve(numWeights);
+                    for (int i = 0; i < numWeights; i++) {
+                        Weight tempWeight;
+                        fileIn >> checkString >> checkString;  // Skip "weight #"
+
+                        fileIn >> tempWeight.jointID;  // Store weight's joint ID
+
+                        fileIn >> tempWeight.bias;  // Store weight's influence over a vertex
 
-                //*** Calculate vertex normals using normal averaging ***///
-                std::vector<glm::vec3> tempNormal;
+                        fileIn >> checkString;  // Skip "("
 
-                glm::vec3 unnormalized{0.0f, 0.0f, 0.0f};
+                        fileIn >> tempWeight.pos.x  // Store weight's pos in joint's local space
+                            >> tempWeight.pos.y >> tempWeight.pos.z;
 
-                // Compute face normals
-                for (int i = 0; i < subset.numTriangles; ++i) {
-                    // Get the vector describing one edge of our triangle (edge 2,0)
-                    auto& gpuVertex = subset.gpuVertices[subset.vertices[i].gpuVertexIndex];
-                    glm::vec3 edge1 = subset.gpuVertices[subset.vertices[subset.indices[(i * 3) + 2]].gpuVertexIndex].pos -
-                                      subset.gpuVertices[subset.vertices[subset.indices[(i * 3)]].gpuVertexIndex].pos;  // Create our first edge
+                        std::getline(fileIn, checkString);  // Skip rest of this line
+
+                        subset.weights.push_back(tempWeight);  // Push back tempWeight into subsets Weight array
+                    }
 
-                    // Get the vector describing another edge of our triangle (edge 1,0)
-                    glm::vec3 edge2 = subset.gpuVertices[subset.vertices[subset.indices[(i * 3) + 1]].gpuVertexIndex].pos -
-                                      subset.gpuVertices[subset.vertices[subset.indices[(i * 3)]].gpuVertexIndex].pos;  // Create our second edge
+                } else
+                    std::getline(fileIn, checkString);  // Skip anything else
 
-                    // Cross multiply the two edge vectors to get the un-normalized face normal
-                    unnormalized = glm::cross(edge1, edge2);
+                fileIn >> checkString;  // Skip "}"
+            }
 
-                    tempNormal.push_back(unnormalized);
+            //*** find each vertex's position using the joints and weights ***//
+            glm::vec3 rotatedPoint = glm::vec3{0.0f, 0.0f, 0.0f};
+            float radius{0.0f};
+            for (int i = 0; i < subset.vertices.size(); ++i) {
+                MD5Vertex& tempVert = subset.vertices[i];
+                auto& gpuVertex = subset.gpuVertices[tempVert.gpuVertexIndex];
+                gpuVertex.pos = glm::vec3{0.0f, 0.0f, 0.0f};  // Make sure the vertex's pos is cleared first
+
+                // Sum up the joints and weights information to get vertex's position
+                for (int j = 0; j < tempVert.weightCount; ++j) {
+                    const Weight& tempWeight = subset.weights[tempVert.startWeight + j];
+                    const Joint& tempJoint = outModel.joints[tempWeight.jointID];
+
+                    // Calculate vertex position (in joint space, eg. rotate the point using joint orientation quaternion)
+                    rotatedPoint = tempJoint.orientation * tempWeight.pos;
+
+                    // Now move the verices position from joint space (0,0,0) to the joints position in world space, taking
+                    // the weights bias into account The weight bias is used because multiple weights might have an effect on
+                    // the vertices final position. Each weight is attached to one joint.
+                    gpuVertex.pos += (tempJoint.pos + rotatedPoint) * tempWeight.bias;
+
+                    // Basically what has happened above, is we have taken the weights position relative to the joints
+                    // position we then rotate the weights position (so that the weight is actually being rotated around (0,
+                    // 0, 0) in world space) using the quaternion describing the joints rotation. We have stored this rotated
+                    // point in rotatedPoint, which we then add to the joints position (because we rotated the weight's
+                    // position around (0,0,0) in world space, and now need to translate it so that it appears to have been
+                    // rotated around the joints position). Finally we multiply the answer with the weights bias, or how much
+                    // control the weight has over the final vertices position. All weight's bias effecting a single vertex's
+                    // position must add up to 1.
                 }
 
-                // Compute vertex normals (normal Averaging)
-                glm::vec3 normalSum{0.0f, 0.0f, 0.0f};
+                radius = glm::length(gpuVertex.pos);
+                if (outRadius < radius) {
+                    outRadius = radius;
+                }
 
-                // Go through each vertex
-                for (int i = 0; i < subset.vertices.size(); ++i) {
-                    // Check which triangles use this vertex
-                    for (int j = 0; j < subset.numTriangles; ++j) {
-                        if (subset.indices[j * 3] == i || subset.indices[(j * 3) + 1] == i || subset.indices[(j * 3) + 2] == i) {
-                            // If a face is using the vertex, add the unormalized face normal to the normalSum
-                            normalSum = normalSum + tempNormal[j];
-                        }
-                    }
+                gpuVertex.pos *= vertexMagnitudeMultiplier;
+            }
 
-                    // Normalize the normalSum vector
-                    normalSum = glm::normalize(normalSum);
+            //*** Calculate vertex normals using normal averaging ***///
+            std::vector<glm::vec3> tempNormal;
 
-                    // Store the normal in our current vertex
-                    auto& gpuVertex = subset.gpuVertices[subset.vertices[i].gpuVertexIndex];
-                    gpuVertex.normal = normalSum;
+            glm::vec3 unnormalized{0.0f, 0.0f, 0.0f};
 
-                    // Create the joint space normal for easy normal calculations in animation
-                    const MD5Vertex& tempVert = subset.vertices[i];  // Get the current vertex
-                    glm::vec3 normal{0.0f, 0.0f, 0.0f};
+            // Compute face normals
+            for (int i = 0; i < subset.numTriangles; ++i) {
+                // Get the vector describing one edge of our triangle (edge 2,0)
+                auto& gpuVertex = subset.gpuVertices[subset.vertices[i].gpuVertexIndex];
+                glm::vec3 edge1 = subset.gpuVertices[subset.vertices[subset.indices[(i * 3) + 2]].gpuVertexIndex].pos -
+                                  subset.gpuVertices[subset.vertices[subset.indices[(i * 3)]].gpuVertexIndex].pos;  // Create our first edge
 
-                    for (int k = 0; k < tempVert.weightCount; k++)  // Loop through each of the vertices weights
-                    {
-                        // Get the joints orientation
-                        Joint& tempJoint = m_MD5Model.joints[subset.weights[tempVert.startWeight + k].jointID];
+                // Get the vector describing another edge of our triangle (edge 1,0)
+                glm::vec3 edge2 = subset.gpuVertices[subset.vertices[subset.indices[(i * 3) + 1]].gpuVertexIndex].pos -
+                                  subset.gpuVertices[subset.vertices[subset.indices[(i * 3)]].gpuVertexIndex].pos;  // Create our second edge
 
-                        // Calculate normal based off joints orientation (turn into joint space)
-                        normal = tempJoint.orientation * normalSum;
+                // Cross multiply the two edge vectors to get the un-normalized face normal
+                unnormalized = glm::cross(edge1, edge2);
 
-                        // Store the normalized quaternion into our weights normal
-                        subset.weights[tempVert.startWeight + k].normal = glm::normalize(normal);
-                    }
-                    // Clear normalSum, facesUsing for next vertex
-                    normalSum = glm::vec3(0.0f, 0.0f, 0.0f);
-                }
+                tempNormal.push_back(unnormalized);
             }
-        }
-    } else {
-        Utils::printLog(ERROR_PARAM, "Couldn't load animation file", absPath);
-        return false;
-    }
 
-    /// packing subsets verts & indices into general containers
-    std::size_t commonVertsAmount = 0u;
-    std::size_t commonIndicesAmount = 0u;
-    for (auto& subset : m_MD5Model.subsets) {
-        commonVertsAmount += subset.gpuVertices.size();
-        commonIndicesAmount += subset.indices.size();
+            // Compute vertex normals (normal Averaging)
+            glm::vec3 normalSum{0.0f, 0.0f, 0.0f};
 
-        // normilize the vertices
-        for (auto& gpuVert : subset.gpuVertices) {
-            gpuVert.pos = gpuVert.pos / m_radius;
-        }
-    }
+            // Go through each vertex
+            for (int i = 0; i < subset.vertices.size(); ++i) {
+                // Check which triangles use this vertex
+                for (int j = 0; j < subset.numTriangles; ++j) {
+                    if (subset.indices[j * 3] == i || subset.indices[(j * 3) + 1] == i || subset.indices[(j * 3) + 2] == i) {
+                        // If a face is using the vertex, add the unormalized face normal to the normalSum
+                        normalSum = normalSum + tempNormal[j];
+                    }
+                }
 
-    // modify our radius according to multiplier
-    m_radius = m_vertexMagnitudeMultiplier;
+                // Normalize the normalSum vector
+                normalSum = glm::normalize(normalSum);
 
-    vertices.resize(commonVertsAmount);
-    indices.resize(commonIndicesAmount);
+                // Store the normal in our current vertex
+                auto& gpuVertex = subset.gpuVertices[subset.vertices[i].gpuVertexIndex];
+                gpuVertex.normal = normalSum;
 
-    uint32_t lastVertsSize = 0u;
-    uint32_t lastIndicesSize = 0u;
-    for (auto& subset : m_MD5Model.subsets) {
-        static const std::size_t indexBytes = sizeof(subset.indices[0]);
-        static const std::size_t vertBytes = sizeof(subset.gpuVertices[0]);
-        const std::size_t verticesSize = subset.gpuVertices.size();
-        const std::size_t indicesSize = subset.indices.size();
+                // Create the joint space normal for easy normal calculations in animation
+                const MD5Vertex& tempVert = subset.vertices[i];  // Get the current vertex
+                glm::vec3 normal{0.0f, 0.0f, 0.0f};
 
-        // eventually we'll have one single buffer containing: mesh1.indexBuf + meshN.indexBuf + ... + mesh1.vertBuf +
-        // meshN.vertBuf we need to keep the offset to understand which part of buffer to update
-        subset.indexOffset = lastIndicesSize;
-        subset.vertOffset = lastVertsSize;
+                for (int k = 0; k < tempVert.weightCount; k++)  // Loop through each of the vertices weights
+                {
+                    // Get the joints orientation
+                    Joint& tempJoint = outModel.joints[subset.weights[tempVert.startWeight + k].jointID];
 
-        memcpy((char*)indices.data() + lastIndicesSize * indexBytes, subset.indices.data(), indicesSize * indexBytes);
-        memcpy((char*)vertices.data() + lastVertsSize * vertBytes, subset.gpuVertices.data(), verticesSize * vertBytes);
+                    // Calculate normal based off joints orientation (turn into joint space)
+                    normal = tempJoint.orientation * normalSum;
 
-        lastVertsSize += verticesSize;
-        lastIndicesSize += indicesSize;
+                    // Store the normalized quaternion into our weights normal
+                    subset.weights[tempVert.startWeight + k].normal = glm::normalize(normal);
+                }
+                // Clear normalSum, facesUsing for next vertex
+                normalSum = glm::vec3(0.0f, 0.0f, 0.0f);
+            }
+        }
     }
-
-    return true;
 }
 
 void MD5Model::waitForCudaSignal(uint32_t descriptorSetIndex) const {
@@ -999,9 +1025,9 @@ void MD5Model::waitForCudaSignal(uint32_t descriptorSetIndex) const {
         auto p_device = m_vkState._core.getDevice();
         assert(p_device);
 
-        static uint32_t lastDescriptorSetIndex = -1;
-
-        if (lastDescriptorSetIndex != descriptorSetIndex) {
+        // the passes of a frame are recorded by several threads, the first one waits
+        std::lock_guard<std::mutex> lock(mCudaSignalMutex);
+        if (mLastWaitedDescriptorSetIndex != descriptorSetIndex) {
             VkSemaphoreWaitInfo semaphoreWaitInfo = {};
             semaphoreWaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
             semaphoreWaitInfo.pSemaphores = &mVkCudaSyncObject;
@@ -1009,7 +1035,7 @@ void MD5Model::waitForCudaSignal(uint32_t descriptorSetIndex) const {
             semaphoreWaitInfo.pValues = &mWaitCudaSignalValue;
             vkWaitSemaphores(p_device, &semaphoreWaitInfo, UINT64_MAX);
 
-            lastDescriptorSetIndex = descriptorSetIndex;
+            mLastWaitedDescriptorSetIndex = descriptorSetIndex;
         }
     }
 }
@@ -1029,6 +1055,7 @@ void MD5Model::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex = 0U, ui
     }
 
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorTextured->getPipeline().get()->pipeline);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
 
     vkCmdBindIndexBuffer(cmdBuf, m_generalBuffer, 0, VK_INDEX_TYPE_UINT32);
 
@@ -1046,8 +1073,10 @@ void MD5Model::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex = 0U, ui
         vkCmdBindDescriptorSets(
             cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorTextured->getPipeline().get()->pipelineLayout, 0, 1,
             m_pipelineCreatorTextured->getDescriptorSet(descriptorSetIndex, subset.realMaterialId), 1, &dynamicOffset);
+        FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
         vkCmdDrawIndexed(cmdBuf, static_cast<uint32_t>(subset.indices.size()), mActiveInstancesAmount, subset.indexOffset,
                          subset.vertOffset, 0);
+        FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
     }
 }
 
@@ -1066,6 +1095,7 @@ void MD5Model::drawWithCustomPipeline(PipelineCreatorBase* pipelineCreator, VkCo
     }
 
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline().get()->pipeline);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
 
     vkCmdBindIndexBuffer(cmdBuf, m_generalBuffer, 0, VK_INDEX_TYPE_UINT32);
     if (SORT_INSTANCES_ON_CUDA && mCudaAnimator && mIsCudaCalculationRequested) {
@@ -1082,8 +1112,10 @@ void MD5Model::drawWithCustomPipeline(PipelineCreatorBase* pipelineCreator, VkCo
         vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline().get()->pipelineLayout, 0,
                                 1, pipelineCreator->getDescriptorSet(descriptorSetIndex, subset.realMaterialId), 1,
                                 &dynamicOffset);
+        FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
         vkCmdDrawIndexed(cmdBuf, static_cast<uint32_t>(subset.indices.size()), mActiveInstancesAmount, subset.indexOffset,
                          subset.vertOffset, 0);
+        FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
     }
 }
 
@@ -1,6 +1,7 @@
 
 #include "ObjModel.h"
 #include "Constants.h"
+#include "FrameTelemetry.h"
 #include "PipelineCreatorFootprint.h"
 #include "PipelineCreatorTextured.h"
 #include "Utils.h"
@@ -31,8 +32,8 @@ void ObjModel::init() {
     // modify our radius according to multiplier
     m_radius = m_vertexMagnitudeMultiplier;
 
-    Utils::createGeneralBuffer(p_device, m_vkState._core.getPhysDevice(), m_vkState._cmdBufPool, m_vkState._queue, indices,
-                               vertices, m_verticesBufferOffset, m_generalBuffer, m_generalBufferMemory);
+    Utils::createGeneralBuffer(p_device, m_vkState._core.getPhysDevice(), indices, vertices, m_verticesBufferOffset,
+                               m_generalBuffer, m_generalBufferMemory);
     {
         assert(m_vkState._swapchainImageCount > 0u);
         m_instancesBuffer.assign(m_vkState._swapchainImageCount, VK_NULL_HANDLE);
@@ -40,16 +41,10 @@ void ObjModel::init() {
 
         m_instancesBufferOffset = 0u;  // separete buffer for instances instead common buffer
         const VkDeviceSize instancesSize = sizeof(m_instances[0]) * m_instances.size();
-        const VkDeviceSize bufferSize = m_instancesBufferOffset + instancesSize;
-        for (size_t i = 0u; i < m_vkState._swapchainImageCount; i++) {
-            Utils::VulkanCreateBuffer(p_device, m_vkState._core.getPhysDevice(), bufferSize,
-                                      VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                      m_instancesBuffer[i], m_instancesBufferMemory[i]);
-            void* data;
-            vkMapMemory(p_device, m_instancesBufferMemory[i], 0, bufferSize, 0, &data);
+        for (uint32_t i = 0u; i < m_vkState._swapchainImageCount; i++) {
+            reserveInstancesBuffer(i, m_instances.size());
+            void* data = MemoryAllocator::getInstance().getMappedData(m_instancesBuffer[i]);
             memcpy((char*)data + m_instancesBufferOffset, m_instances.data(), instancesSize);
-            vkUnmapMemory(p_device, m_instancesBufferMemory[i]);
         }
     }
 
@@ -65,15 +60,13 @@ void ObjModel::update(float deltaTimeMS, int animationID, bool onGPU, uint32_t c
 }
 
 void ObjModel::updateBuffers(uint32_t currentImage) {
-    auto p_device = m_vkState._core.getDevice();
-    assert(p_device);
     const VkDeviceSize instancesSize = sizeof(m_activeInstances[0]) * m_activeInstances.size();
-    const VkDeviceSize bufferSize = m_instancesBufferOffset + instancesSize;
+    // instances may be added after init, the buffer grows with them
+    reserveInstancesBuffer(currentImage, m_activeInstances.size());
 
-    void* data;
-    vkMapMemory(p_device, m_instancesBufferMemory[currentImage], 0, bufferSize, 0, &data);
+    void* data = MemoryAllocator::getInstance().getMappedData(m_instancesBuffer[currentImage]);
     memcpy((char*)data + m_instancesBufferOffset, m_activeInstances.data(), instancesSize);
-    vkUnmapMemory(p_device, m_instancesBufferMemory[currentImage]);
+    FrameTelemetry::count(FrameTelemetry::UPLOADED_BYTES, instancesSize);
 
     if (m_lowPolyMesh) {
         static_cast<ObjModel*>(m_lowPolyMesh.get())->updateBuffers(currentImage);
@@ -102,10 +95,6 @@ void ObjModel::load(std::vector<Vertex>& vertices, std::vector<uint32_t>& indice
     }
 
     std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-    Vertex vertex{};
-
-    glm::vec3 edge1{0.0f}, edge2{0.0f}, tangent{0.0f}, bitangent{0.0f};
-    glm::vec2 deltaUV1{0.0f}, deltaUV2{0.0f};
     bool isBumpMappingValid{false};
 
     std::size_t indexAmount = 0u;
@@ -128,11 +117,12 @@ void ObjModel::load(std::vector<Vertex>& vertices, std::vector<uint32_t>& indice
         isBumpMappingValid = materials[materialId].bump_texname.empty() ? false : true;
 
         if (materialsMap.find(materialId) == materialsMap.end()) {
-            auto texture = m_textureFactory.create2DArrayTexture(
+            auto texture = m_textureFactory.create2DArrayTextureAsync(
                 isBumpMappingValid
                     ? std::vector<std::string>{materials[materialId].diffuse_texname, materials[materialId].bump_texname}
                     : std::vector<std::string>{materials[materialId].diffuse_texname});
             if (!texture.expired()) {
+                m_textures.push_back(texture);
                 realMaterialId = m_pipelineCreatorTextured->createDescriptor(
                     texture, m_textureFactory.getTextureSampler(texture.lock()->mipLevels));
                 materialsMap.try_emplace(materialId, realMaterialId);
@@ -143,59 +133,7 @@ void ObjModel::load(std::vector<Vertex>& vertices, std::vector<uint32_t>& indice
             realMaterialId = materialsMap[materialId];
         }
 
-        for (std::size_t i = 0u; i < shape.mesh.indices.size(); ++i) {
-            const auto& index = shape.mesh.indices[i];
-            vertex.pos = {attrib.vertices[3 * index.vertex_index + 0],
-                          attrib.vertices[3 * index.vertex_index + 1],
-                          attrib.vertices[3 * index.vertex_index + 2]};
-
-            vertex.texCoord = {attrib.texcoords[2 * index.texcoord_index + 0], attrib.texcoords[2 * index.texcoord_index + 1]};
-
-            vertex.normal = {attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1],
-                             attrib.normals[3 * index.normal_index + 2]};
-
-            /// Note: Obj format doesn't care about vertices reusing, let's take it on ourself
-            if (uniqueVertices.find(vertex) == uniqueVertices.end()) {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                float radius = glm::length(vertex.pos);
-                if (radius > m_radius) {
-                    m_radius = radius;
-                }
-                vertices.push_back(vertex);
-            }
-
-            indices.push_back(uniqueVertices[vertex]);
-
-            if ((isBumpMappingValid) && ((i + 1u) % 3u == 0u)) {
-                assert((static_cast<int>(indices.size()) - 3) >= 0);
-                vertex.tangent.w = 1.0f;  // enabling bump-mapping
-                auto& vert3 = vertices[indices[indices.size() - 1u]];
-                auto& vert2 = vertices[indices[indices.size() - 2u]];
-                auto& vert1 = vertices[indices[indices.size() - 3u]];
-                edge1 = vert2.pos - vert1.pos;
-                edge2 = vert3.pos - vert1.pos;
-                deltaUV1 = vert2.texCoord - vert1.texCoord;
-                deltaUV2 = vert3.texCoord - vert1.texCoord;
-
-                float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
-
-                tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-                tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-                tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
-                tangent = glm::normalize(tangent);
-                vert1.tangent = glm::vec4(glm::normalize(glm::vec3(vert1.tangent) + tangent), 1.0f);
-                vert2.tangent = glm::vec4(glm::normalize(glm::vec3(vert2.tangent) + tangent), 1.0f);
-                vert3.tangent = glm::vec4(glm::normalize(glm::vec3(vert3.tangent) + tangent), 1.0f);
-
-                bitangent.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
-                bitangent.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
-                bitangent.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
-                bitangent = glm::normalize(bitangent);
-                vert1.bitangent = glm::normalize(vert1.bitangent + bitangent);
-                vert2.bitangent = glm::normalize(vert2.bitangent + bitangent);
-                vert3.bitangent = glm::normalize(vert3.bitangent + bitangent);
-            }
-        }
+        appendShape(attrib, shape, isBumpMappingValid, uniqueVertices, vertices, indices, m_radius);
 
         /// Note: each subobject keeps index offset
         SubObject subObject{realMaterialId, indecesOffset, (indices.size() - indecesOffset), UINT32_MAX};
@@ -208,10 +146,11 @@ void ObjModel::load(std::vector<Vertex>& vertices, std::vector<uint32_t>& indice
         std::transform(shapeName.begin(), shapeName.end(), shapeName.begin(), ::tolower);
         if (m_pipelineCreatorFootprint && shapeName.find("track") != std::string::npos) {
             if (m_Tracks.empty()) {
-                auto texture = m_textureFactory.create2DTexture(!materials[materialId].alpha_texname.empty()
-                                                                    ? materials[materialId].alpha_texname
-                                                                    : materials[materialId].diffuse_texname);
+                auto texture = m_textureFactory.create2DTextureAsync(!materials[materialId].alpha_texname.empty()
+                                                                         ? materials[materialId].alpha_texname
+                                                                         : materials[materialId].diffuse_texname);
                 if (!texture.expired()) {
+                    m_textures.push_back(texture);
                     subObject.realMaterialFootprintId = m_pipelineCreatorFootprint->createDescriptor(
                         texture, m_textureFactory.getTextureSampler(texture.lock()->mipLevels));
                 }
@@ -238,32 +177,115 @@ void ObjModel::load(std::vector<Vertex>& vertices, std::vector<uint32_t>& indice
     }
 }
 
+void ObjModel::appendShape(const tinyobj::attrib_t& attrib, const tinyobj::shape_t& shape, bool is_bumpMappingValid,
+                           std::unordered_map<Vertex, uint32_t>& uniqueVertices, std::vector<Vertex>& vertices,
+                           std::vector<uint32_t>& indices, float& outRadius) {
+    Vertex vertex{};
+
+    glm::vec3 edge1{0.0f}, edge2{0.0f}, tangent{0.0f}, bitangent{0.0f};
+    glm::vec2 deltaUV1{0.0f}, deltaUV2{0.0f};
+
+    for (std::size_t i = 0u; i < shape.mesh.indices.size(); ++i) {
+        const auto& index = shape.mesh.indices[i];
+        vertex.pos = {attrib.vertices[3 * index.vertex_index + 0],
+                      attrib.vertices[3 * index.vertex_index + 1],
+                      attrib.vertices[3 * index.vertex_index + 2]};
+
+        vertex.texCoord = {attrib.texcoords[2 * index.texcoord_index + 0], attrib.texcoords[2 * index.texcoord_index + 1]};
+
+        vertex.normal = {attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1],
+                         attrib.normals[3 * index.normal_index + 2]};
+
+        /// Note: Obj format doesn't care about vertices reusing, let's take it on ourself
+        if (uniqueVertices.find(vertex) == uniqueVertices.end()) {
+            uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+            float radius = glm::length(vertex.pos);
+            if (radius > outRadius) {
+                outRadius = radius;
+            }
+            vertices.push_back(vertex);
+        }
+
+        indices.push_back(uniqueVertices[vertex]);
+
+        if ((is_bumpMappingValid) && ((i + 1u) % 3u == 0u)) {
+            assert((static_cast<int>(indices.size()) - 3) >= 0);
+            vertex.tangent.w = 1.0f;  // enabling bump-mapping
+            auto& vert3 = vertices[indices[indices.size() - 1u]];
+            auto& vert2 = vertices[indices[indices.size() - 2u]];
+            auto& vert1 = vertices[indices[indices.size() - 3u]];
+            edge1 = vert2.pos - vert1.pos;
+            edge2 = vert3.pos - vert1.pos;
+            deltaUV1 = vert2.texCoord - vert1.texCoord;
+            deltaUV2 = vert3.texCoord - vert1.texCoord;
+
+            float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
+
+            tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
+            tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
+            tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+            tangent = glm::normalize(tangent);
+            vert1.tangent = glm::vec4(glm::normalize(glm::vec3(vert1.tangent) + tangent), 1.0f);
+            vert2.tangent = glm::vec4(glm::normalize(glm::vec3(vert2.tangent) + tangent), 1.0f);
+            vert3.tangent = glm::vec4(glm::normalize(glm::vec3(vert3.tangent) + tangent), 1.0f);
+
+            bitangent.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
+            bitangent.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
+            bitangent.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
+            bitangent = glm::normalize(bitangent);
+            vert1.bitangent = glm::normalize(vert1.bitangent + bitangent);
+            vert2.bitangent = glm::normalize(vert2.bitangent + bitangent);
+            vert3.bitangent = glm::normalize(vert3.bitangent + bitangent);
+        }
+    }
+}
+
 void ObjModel::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, uint32_t dynamicOffset) const {
     assert(m_generalBuffer);
     assert(m_pipelineCreatorTextured);
     assert(m_pipelineCreatorTextured->getPipeline().get());
 
-    if (m_pipelineCreatorTextured->isPushContantActive()) {
+    // bindless: the push constant is the material index
+    const bool isBindless = m_pipelineCreatorTextured->isBindless();
+    if (!isBindless && m_pipelineCreatorTextured->isPushContantActive()) {
         vkCmdPushConstants(cmdBuf, m_pipelineCreatorTextured->getPipeline()->pipelineLayout,
                            VulkanState::PUSH_CONSTANT_STAGE_FLAGS, 0, sizeof(VulkanState::PushConstant),
                            &m_vkState._pushConstant);
     }
 
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorTextured->getPipeline().get()->pipeline);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
 
     VkBuffer vertexBuffers[] = {m_generalBuffer, m_instancesBuffer[descriptorSetIndex]};
     VkDeviceSize offsets[] = {m_verticesBufferOffset, m_instancesBufferOffset};
     vkCmdBindVertexBuffers(cmdBuf, 0, 2, vertexBuffers, offsets);
     vkCmdBindIndexBuffer(cmdBuf, m_generalBuffer, 0, VK_INDEX_TYPE_UINT32);
 
+    if (isBindless) {
+        // one set for all the materials of the frame
+        vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                m_pipelineCreatorTextured->getPipeline().get()->pipelineLayout, 0, 1,
+                                m_pipelineCreatorTextured->getDescriptorSet(descriptorSetIndex), 1, &dynamicOffset);
+        FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
+    }
+
     for (const auto& subObjects : m_SubObjects) {
         if (subObjects.size()) {
-            vkCmdBindDescriptorSets(
-                cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorTextured->getPipeline().get()->pipelineLayout, 0, 1,
-                m_pipelineCreatorTextured->getDescriptorSet(descriptorSetIndex, subObjects[0].realMaterialId), 1, &dynamicOffset);
+            if (isBindless) {
+                vkCmdPushConstants(cmdBuf, m_pipelineCreatorTextured->getPipeline()->pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
+                                   0, sizeof(uint32_t), &subObjects[0].realMaterialId);
+            } else {
+                vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                        m_pipelineCreatorTextured->getPipeline().get()->pipelineLayout, 0, 1,
+                                        m_pipelineCreatorTextured->getDescriptorSet(descriptorSetIndex,
+                                                                                    subObjects[0].realMaterialId),
+                                        1, &dynamicOffset);
+                FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
+            }
             for (const auto& subObject : subObjects) {
                 vkCmdDrawIndexed(cmdBuf, static_cast<uint32_t>(subObject.indexAmount), m_activeInstances.size(),
                                  static_cast<uint32_t>(subObject.indexOffset), 0, 0);
+                FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
             }
         }
     }
@@ -286,6 +308,7 @@ void ObjModel::drawWithCustomPipeline(PipelineCreatorBase* pipelineCreator, VkCo
     }
 
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline().get()->pipeline);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
 
     VkBuffer vertexBuffers[] = {m_generalBuffer, m_instancesBuffer[descriptorSetIndex]};
     VkDeviceSize offsets[] = {m_verticesBufferOffset, m_instancesBufferOffset};
@@ -296,9 +319,11 @@ void ObjModel::drawWithCustomPipeline(PipelineCreatorBase* pipelineCreator, VkCo
         if (subObjects.size()) {
             vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline().get()->pipelineLayout,
                                     0, 1, pipelineCreator->getDescriptorSet(descriptorSetIndex), 1, &dynamicOffset);
+            FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
             for (const auto& subObject : subObjects) {
                 vkCmdDrawIndexed(cmdBuf, static_cast<uint32_t>(subObject.indexAmount), m_activeInstances.size(),
                                  static_cast<uint32_t>(subObject.indexOffset), 0, 0);
+                FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
             }
         }
     }
@@ -322,6 +347,7 @@ void ObjModel::drawFootprints(VkCommandBuffer cmdBuf, uint32_t descriptorSetInde
     }
 
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorFootprint->getPipeline().get()->pipeline);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
 
     VkBuffer vertexBuffers[] = {m_generalBuffer, m_instancesBuffer[descriptorSetIndex]};
     VkDeviceSize offsets[] = {m_verticesBufferOffset, m_instancesBufferOffset};
@@ -331,10 +357,12 @@ void ObjModel::drawFootprints(VkCommandBuffer cmdBuf, uint32_t descriptorSetInde
     vkCmdBindDescriptorSets(
         cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorFootprint->getPipeline().get()->pipelineLayout, 0, 1,
         m_pipelineCreatorFootprint->getDescriptorSet(descriptorSetIndex, m_Tracks[0].realMaterialFootprintId), 1, &dynamicOffset);
+    FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
 
     for (const auto& subObject : m_Tracks) {
         vkCmdDrawIndexed(cmdBuf, static_cast<uint32_t>(subObject.indexAmount), m_activeInstances.size(),
                          static_cast<uint32_t>(subObject.indexOffset), 0, 0);
+        FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
     }
 
     if (m_lowPolyMesh) {
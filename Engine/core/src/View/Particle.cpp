@@ -2,26 +2,20 @@
 #include <assert.h>
 #include <glm/gtx/transform.hpp>
 #include <random>
+#include "FrameTelemetry.h"
 #include "I3DModel.h"
 #include "PipelineCreatorParticle.h"
 #include "Utils.h"
 
 Particle::~Particle() {
     for (size_t i = 0u; i < m_uboParticle.buffers.size(); ++i) {
-        if (m_uboParticle.buffers[i] != VK_NULL_HANDLE) {
-            vkDestroyBuffer(m_vkState._core.getDevice(), m_uboParticle.buffers[i], nullptr);
-        }
-    }
-    for (size_t i = 0u; i < m_uboParticle.buffersMemory.size(); ++i) {
-        if (m_uboParticle.buffersMemory[i] != VK_NULL_HANDLE) {
-            vkFreeMemory(m_vkState._core.getDevice(), m_uboParticle.buffersMemory[i], nullptr);
-        }
+        Utils::VulkanDestroyBuffer(m_vkState._core.getDevice(), m_uboParticle.buffers[i], m_uboParticle.buffersMemory[i]);
     }
 }
 
 Particle::Particle(const VulkanState& vulkanState, TextureFactory& textureFactory, std::string_view textureFileName,
                    PipelineCreatorParticle* pipelineCreatorTextured, uint32_t instancesAmount, float zFar,
-                   const glm::vec3& scale) noexcept(true)
+                   const glm::vec3& scale, uint32_t seed) noexcept(true)
     : I3DModel(vulkanState, textureFactory, pipelineCreatorTextured),
       m_textureFileName(textureFileName),
       m_pipelineCreatorTextured(pipelineCreatorTextured),
@@ -34,14 +28,13 @@ Particle::Particle(const VulkanState& vulkanState, TextureFactory& textureFactor
     pipelineCreatorTextured->increaseUsageCounter();
     m_instances.resize(m_instanceCount, Particle::Instance{});
 
-    m_verticesPreparedFuture = std::async(std::launch::async, [this] {
+    m_verticesPreparedFuture = std::async(std::launch::async, [this, seed] {
         for (auto& vertex : m_vertices) {
             vertex.scaleMax = m_maxScale;
             vertex.scaleMin = m_maxScale;
         }
 
-        std::random_device rd;
-        std::mt19937 gen(rd());  // seed the generator
+        std::mt19937 gen(seed);
         int32_t limit = static_cast<int32_t>(m_zFar);
         std::uniform_int_distribution<> distr(-limit, limit);  // define the range
         for (std::size_t i = 0u; i < m_instances.size(); ++i) {
@@ -57,7 +50,7 @@ Particle::Particle(const VulkanState& vulkanState, TextureFactory& textureFactor
 Particle::Particle(const VulkanState& vulkanState, TextureFactory& textureFactory, std::string_view particleTextureFileName,
                    std::string_view particleGradientTextureFileName, PipelineCreatorParticle* pipelineCreatorTextured,
                    uint32_t instancesAmount, const glm::vec3& positionOrigin, const glm::vec3& velocity,
-                   const glm::vec3& minScale, const glm::vec3& maxScale) noexcept(true)
+                   const glm::vec3& minScale, const glm::vec3& maxScale, uint32_t seed) noexcept(true)
     : I3DModel(vulkanState, textureFactory, pipelineCreatorTextured),
       m_textureFileName(particleTextureFileName),
       m_textureGradientFileName(particleGradientTextureFileName),
@@ -69,7 +62,7 @@ Particle::Particle(const VulkanState& vulkanState, TextureFactory& textureFactor
     pipelineCreatorTextured->increaseUsageCounter();
     m_instances.resize(m_instanceCount, Particle::Instance{});
     m_uboParticle.params.velocity = glm::vec4(velocity, 1.0f);
-    m_verticesPreparedFuture = std::async(std::launch::async, [this, positionOrigin, vel = glm::normalize(velocity)] {
+    m_verticesPreparedFuture = std::async(std::launch::async, [this, positionOrigin, seed, vel = glm::normalize(velocity)] {
         for (auto& vertex : m_vertices) {
             vertex.scaleMax = m_maxScale;
             vertex.scaleMin = m_minScale;
@@ -77,8 +70,7 @@ Particle::Particle(const VulkanState& vulkanState, TextureFactory& textureFactor
         }
 
         glm::vec3 up{0.0f, 1.0f, 0.0f};
-        std::random_device rd;
-        std::mt19937 gen(rd());                                 // seed the generator
+        std::mt19937 gen(seed);
         std::uniform_real_distribution<float> distr(0.1, 1.0);  // define the range
         for (std::size_t i = 0u; i < m_instances.size(); ++i) {
             auto& instance = m_instances[i];
@@ -105,22 +97,20 @@ void Particle::init() {
     m_uboParticle.buffers.assign(m_vkState._swapchainImageCount, VK_NULL_HANDLE);
     m_uboParticle.buffersMemory.assign(m_vkState._swapchainImageCount, VK_NULL_HANDLE);
     VkDeviceSize uboBufSize = sizeof(UBOParticle::Params);
-    void* data;
     for (size_t i = 0u; i < m_vkState._swapchainImageCount; ++i) {
         Utils::VulkanCreateBuffer(m_vkState._core.getDevice(), m_vkState._core.getPhysDevice(), uboBufSize,
                                   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                                   m_uboParticle.buffers[i], m_uboParticle.buffersMemory[i]);
 
-        vkMapMemory(m_vkState._core.getDevice(), m_uboParticle.buffersMemory[i], 0, uboBufSize, 0, &data);
-        memcpy(data, &m_uboParticle.params, uboBufSize);
-        vkUnmapMemory(m_vkState._core.getDevice(), m_uboParticle.buffersMemory[i]);
+        memcpy(MemoryAllocator::getInstance().getMappedData(m_uboParticle.buffers[i]), &m_uboParticle.params, uboBufSize);
     }
 
-    auto texture = m_textureFactory.create2DTexture(m_textureFileName).lock();
+    auto texture = m_textureFactory.create2DTextureAsync(m_textureFileName).lock();
+    m_textures.push_back(texture);
     if (m_mode == ParticleMode::DEFAULT) {
         auto textureGradient =
-            m_textureFactory.create2DTexture(m_textureGradientFileName, false, true).lock();  // without mip levels
+            m_textureFactory.create2DTextureAsync(m_textureGradientFileName, false, true).lock();  // without mip levels
         mMaterialId = m_pipelineCreatorTextured->createDescriptor(
             texture, m_textureFactory.getTextureSampler(texture->mipLevels), textureGradient,
             m_textureFactory.getTextureSampler(textureGradient->mipLevels), &m_uboParticle);
@@ -136,38 +126,23 @@ void Particle::init() {
         const VkDeviceSize instancesSize = sizeof(m_instances[0]) * m_instances.size();
         const VkDeviceSize bufferSize = instancesSize + vertexAtributesSize;
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        Utils::VulkanCreateBuffer(p_devide, m_vkState._core.getPhysDevice(), bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-                                  stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(p_devide, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, m_vertices.data(), (size_t)vertexAtributesSize);
-        memcpy(static_cast<char*>(data) + m_verticesBufferOffset, m_instances.data(), instancesSize);
-        vkUnmapMemory(p_devide, stagingBufferMemory);
-
         Utils::VulkanCreateBuffer(
             p_devide, m_vkState._core.getPhysDevice(), bufferSize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_generalBuffer, m_generalBufferMemory);
 
-        Utils::VulkanCopyBuffer(p_devide, m_vkState._queue, m_vkState._cmdBufPool, stagingBuffer, m_generalBuffer, bufferSize);
-
-        vkDestroyBuffer(p_devide, stagingBuffer, nullptr);
-        vkFreeMemory(p_devide, stagingBufferMemory, nullptr);
+        auto& uploadManager = UploadManager::getInstance();
+        uploadManager.uploadBuffer(m_generalBuffer, m_vertices.data(), vertexAtributesSize);
+        uploadManager.uploadBuffer(m_generalBuffer, m_instances.data(), instancesSize, m_verticesBufferOffset);
     }
 }
 
 void Particle::update(uint32_t currentImage, float deltaMS, const glm::vec4& offsetPosition, const glm::vec4& velocity) {
     static VkDeviceSize uboBufSize = sizeof(UBOParticle::Params);
-    void* data;
     m_uboParticle.params.dynamicPos = offsetPosition;
     m_uboParticle.params.velocity = velocity;
-    vkMapMemory(m_vkState._core.getDevice(), m_uboParticle.buffersMemory[currentImage], 0, uboBufSize, 0, &data);
-    memcpy(data, &m_uboParticle.params, uboBufSize);
-    vkUnmapMemory(m_vkState._core.getDevice(), m_uboParticle.buffersMemory[currentImage]);
+    memcpy(MemoryAllocator::getInstance().getMappedData(m_uboParticle.buffers[currentImage]), &m_uboParticle.params,
+           uboBufSize);
 }
 
 void Particle::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, [[maybe_unused]] uint32_t dynamicOffset) const {
@@ -176,6 +151,7 @@ void Particle::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, [[maybe
     assert(m_pipelineCreatorTextured->getPipeline().get());
 
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorTextured->getPipeline().get()->pipeline);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
 
     VkBuffer vertexBuffers[] = {m_generalBuffer};
     static VkDeviceSize offsetsVertexAttributes[] = {0u};
@@ -186,6 +162,8 @@ void Particle::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, [[maybe
     vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
                             m_pipelineCreatorTextured->getPipeline().get()->pipelineLayout, 0, 1,
                             m_pipelineCreatorTextured->getDescriptorSet(descriptorSetIndex, mMaterialId), 0, VK_NULL_HANDLE);
+    FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
     /// Note: designed for VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP
     vkCmdDraw(cmdBuf, 4, m_instanceCount, 0, 0);
+    FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
 }
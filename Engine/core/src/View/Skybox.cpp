@@ -1,4 +1,5 @@
 #include "Skybox.h"
+#include "FrameTelemetry.h"
 #include "I3DModel.h"
 #include "Utils.h"
 #include "PipelineCreatorTextured.h"
@@ -39,15 +40,14 @@ void Skybox::init() {
 	assert(!m_textureFileNames.empty());
     assert(!m_instances.empty());
 
-	auto texture = m_textureFactory.createCubeTexture(m_textureFileNames);
+	auto texture = m_textureFactory.createCubeTextureAsync(m_textureFileNames);
 	if (!texture.expired()) {
 		m_realMaterialId =
             m_pipelineCreatorTextured->createDescriptor(texture, m_textureFactory.getTextureSampler(texture.lock()->mipLevels));
 	}
 
-	Utils::createGeneral3in1Buffer(p_devide, m_vkState._core.getPhysDevice(), m_vkState._cmdBufPool, m_vkState._queue, _indices,
-                                   _vertices, m_instances, m_verticesBufferOffset, m_instancesBufferOffset, m_generalBuffer,
-                                   m_generalBufferMemory);
+	Utils::createGeneral3in1Buffer(p_devide, m_vkState._core.getPhysDevice(), _indices, _vertices, m_instances,
+                                   m_verticesBufferOffset, m_instancesBufferOffset, m_generalBuffer, m_generalBufferMemory);
 }
 
 void Skybox::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, uint32_t dynamicOffset) const {
@@ -59,6 +59,7 @@ void Skybox::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, uint32_t
                        0, sizeof(VulkanState::PushConstant), &m_vkState._pushConstant);
 
 	vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorTextured->getPipeline().get()->pipeline);
+	FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
 
     VkBuffer vertexBuffers[] = {m_generalBuffer, m_generalBuffer};
     VkDeviceSize offsets[] = {m_verticesBufferOffset, m_instancesBufferOffset};
@@ -68,5 +69,7 @@ void Skybox::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, uint32_t
 	vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
 							m_pipelineCreatorTextured->getPipeline().get()->pipelineLayout, 0, 1,
                             m_pipelineCreatorTextured->getDescriptorSet(descriptorSetIndex, m_realMaterialId), 1, &dynamicOffset);
+	FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
 	vkCmdDrawIndexed(cmdBuf, static_cast<uint32_t>(_indices.size()), 1U, 0U, 0, 0U);
+	FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
 }
@@ -1,5 +1,6 @@
 #include "Terrain.h"
 #include <assert.h>
+#include "FrameTelemetry.h"
 #include "I3DModel.h"
 #include "PipelineCreatorTextured.h"
 #include "Utils.h"
@@ -23,8 +24,9 @@ void Terrain::init() {
     assert(!m_textureFileName1.empty() && !m_textureFileName2.empty() && !m_noiseTextureFileName.empty());
     assert(!m_instances.empty());
 
-    auto texture = m_textureFactory.create2DArrayTexture({m_noiseTextureFileName.data(), m_textureFileName1.data(), 
-                                                          m_textureFileName2.data()}).lock();
+    // the noise layer displaces the terrain, block compression would quantize heights into steps
+    auto texture = m_textureFactory.create2DArrayTextureAsync({m_noiseTextureFileName.data(), m_textureFileName1.data(), 
+                                                          m_textureFileName2.data()}, true, true, false).lock();
 
     uint32_t ACTUAL_TERRAIN_TILES = TERRAIN_TILES + 1u; // includes the first point as well: TERRAIN_TILES = 2 => 0.0 <-> 0.5 <-> 1.0
     m_vertices.reserve(ACTUAL_TERRAIN_TILES * ACTUAL_TERRAIN_TILES);
@@ -60,6 +62,7 @@ void Terrain::init() {
     }
 
     if (texture) {
+        m_textures.push_back(texture);
         m_realMaterialId = m_pipelineCreatorTextured->createDescriptor(texture, m_textureFactory.getTextureSampler(texture->mipLevels));
 
         float factor = static_cast<float>(m_vertexMagnitudeMultiplier);
@@ -70,9 +73,8 @@ void Terrain::init() {
         }
     }
 
-    Utils::createGeneral3in1Buffer(p_devide, m_vkState._core.getPhysDevice(), m_vkState._cmdBufPool, m_vkState._queue, m_indices,
-                                   m_vertices, m_instances, m_verticesBufferOffset, m_instancesBufferOffset, m_generalBuffer,
-                                   m_generalBufferMemory);
+    Utils::createGeneral3in1Buffer(p_devide, m_vkState._core.getPhysDevice(), m_indices, m_vertices, m_instances,
+                                   m_verticesBufferOffset, m_instancesBufferOffset, m_generalBuffer, m_generalBufferMemory);
 }
 
 void Terrain::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, uint32_t dynamicOffset) const {
@@ -87,6 +89,7 @@ void Terrain::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, uint32_t
     }
 
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCreatorTextured->getPipeline().get()->pipeline);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
 
     VkBuffer vertexBuffers[] = {m_generalBuffer, m_generalBuffer};
     VkDeviceSize offsets[] = {m_verticesBufferOffset, m_instancesBufferOffset};
@@ -96,7 +99,9 @@ void Terrain::draw(VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex, uint32_t
     vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
                             m_pipelineCreatorTextured->getPipeline().get()->pipelineLayout, 0, 1,
                             m_pipelineCreatorTextured->getDescriptorSet(descriptorSetIndex, m_realMaterialId), 1, &dynamicOffset);
+    FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
     vkCmdDrawIndexed(cmdBuf, static_cast<uint32_t>(m_indices.size()), 1U, 0U, 0, 0U);
+    FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
 }
 
 void Terrain::drawWithCustomPipeline(PipelineCreatorBase* pipelineCreator, VkCommandBuffer cmdBuf, uint32_t descriptorSetIndex,
@@ -112,6 +117,7 @@ void Terrain::drawWithCustomPipeline(PipelineCreatorBase* pipelineCreator, VkCom
     }
     
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline().get()->pipeline);
+    FrameTelemetry::count(FrameTelemetry::PIPELINE_BINDS);
     
     VkBuffer vertexBuffers[] = {m_generalBuffer, m_generalBuffer};
     VkDeviceSize offsets[] = {m_verticesBufferOffset, m_instancesBufferOffset};
@@ -120,5 +126,7 @@ void Terrain::drawWithCustomPipeline(PipelineCreatorBase* pipelineCreator, VkCom
     
     vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCreator->getPipeline().get()->pipelineLayout, 0, 1,
                             pipelineCreator->getDescriptorSet(descriptorSetIndex, m_realMaterialId), 1, &dynamicOffset);
+    FrameTelemetry::count(FrameTelemetry::DESCRIPTOR_BINDS);
     vkCmdDrawIndexed(cmdBuf, static_cast<uint32_t>(m_indices.size()), 1U, 0U, 0, 0U);
+    FrameTelemetry::count(FrameTelemetry::DRAW_CALLS);
 }
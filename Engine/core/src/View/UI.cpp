@@ -1,6 +1,22 @@
 #include "UI.h"
 #include <imgui/imgui.h>
 
+#include <cfloat>
+#include <cstdio>
+
+namespace {
+// counters of millions of primitives stay readable in a narrow column
+void textCount(uint64_t count) {
+    if (count >= 1000000u) {
+        ImGui::Text("%.2fM", static_cast<double>(count) / 1000000.0);
+    } else if (count >= 1000u) {
+        ImGui::Text("%.1fK", static_cast<double>(count) / 1000.0);
+    } else {
+        ImGui::Text("%u", static_cast<uint32_t>(count));
+    }
+}
+}  // namespace
+
 const UI::States& UI::updateAndDraw() {
     ImGui::SetNextWindowBgAlpha(0.5f);
     ImGui::Begin(
@@ -14,8 +30,8 @@ const UI::States& UI::updateAndDraw() {
 
     ImGui::BeginChild("First", ImVec2(300, 200));
     ImGui::Text(mStates.gpuAnimationEnabled.first);
-    ImGui::Text(mStates.placeHolder1.first);
-    ImGui::Text(mStates.placeHolder2.first);
+    ImGui::Text(mStates.bloomEnabled.first);
+    ImGui::Text(mStates.pipelineStatisticsEnabled.first);
     ImGui::Separator();
     ImGui::Text("Screen Resolution");
     ImGui::EndChild();
@@ -29,13 +45,13 @@ const UI::States& UI::updateAndDraw() {
     }
     ImGui::PopID();
     ImGui::PushID(101);
-    if (ImGui::Button(mStates.placeHolder1.second ? on : off)) {
-        mStates.placeHolder1.second = !mStates.placeHolder1.second;    
+    if (ImGui::Button(mStates.bloomEnabled.second ? on : off)) {
+        mStates.bloomEnabled.second = !mStates.bloomEnabled.second;
     }
     ImGui::PopID();
     ImGui::PushID(102);
-    if (ImGui::Button(mStates.placeHolder2.second ? on : off)) {
-        mStates.placeHolder2.second = !mStates.placeHolder2.second;    
+    if (ImGui::Button(mStates.pipelineStatisticsEnabled.second ? on : off)) {
+        mStates.pipelineStatisticsEnabled.second = !mStates.pipelineStatisticsEnabled.second;
     }
     ImGui::PopID();
 
@@ -57,6 +73,164 @@ const UI::States& UI::updateAndDraw() {
     }
 
     ImGui::EndChild();
+
+    constexpr float BYTES_IN_MIB = 1024.0f * 1024.0f;
+    ImGui::Separator();
+    ImGui::Text("Textures: resident %.1f MiB, requested %.1f MiB, budget %.1f MiB, streaming %u",
+                static_cast<float>(mStats.textureResidentBytes) / BYTES_IN_MIB,
+                static_cast<float>(mStats.textureRequestedBytes) / BYTES_IN_MIB,
+                static_cast<float>(mStats.textureBudgetBytes) / BYTES_IN_MIB, mStats.streamingTexturesCount);
+    ImGui::Text("Command recording: %.2f ms, threads %u", mStats.recordingTimeMs, mStats.recordingThreadsCount);
+    ImGui::Text("Cached passes: reused %u, recorded %u", mStats.reusedPassesCount, mStats.recordedPassesCount);
+    mStates.renderGraphDumpRequested = ImGui::Button("Dump render graph");
+    ImGui::SameLine();
+    mStates.telemetryExportRequested = ImGui::Button("Export telemetry");
+#if defined(USE_PROFILING) && USE_PROFILING
+    ImGui::SameLine();
+    mStates.cpuTraceCaptureRequested = ImGui::Button("Capture CPU trace");
+#endif
+
+    mStates.gpuTimingsExportRequested = false;
+    ImGui::Separator();
+    if (!mStats.is_gpuTimingSupported) {
+        ImGui::Text("GPU timings: timestamp queries are not supported");
+    } else if (mStats.gpuScopesCount != 0u) {
+        char overlay[32];
+        snprintf(overlay, sizeof(overlay), "GPU frame %.2f ms", mStats.gpuScopes[0].lastMs);
+        ImGui::PlotLines("##gpuFrame", mStats.gpuFrameHistoryMs.data(), static_cast<int>(mStats.gpuFrameHistoryCount), 0,
+                         overlay, 0.0f, FLT_MAX, ImVec2(500, 60));
+
+        if (ImGui::BeginTable("gpuTimings", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("pass");
+            ImGui::TableSetupColumn("last, ms");
+            ImGui::TableSetupColumn("avg, ms");
+            ImGui::TableSetupColumn("max, ms");
+            ImGui::TableHeadersRow();
+            for (uint32_t i = 0u; i < mStats.gpuScopesCount; ++i) {
+                const auto& scope = mStats.gpuScopes[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%*s%s", static_cast<int>(scope.level) * 2, "", scope.name);
+                ImGui::TableNextColumn();
+                if (scope.lastMs < 0.0f) {
+                    ImGui::Text("-");
+                } else {
+                    ImGui::Text("%.3f", scope.lastMs);
+                }
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", scope.averageMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", scope.maxMs);
+            }
+            ImGui::EndTable();
+        }
+        mStates.gpuTimingsExportRequested = ImGui::Button("Export GPU timings");
+
+        if (!mStats.is_pipelineStatisticsSupported) {
+            ImGui::Text("Pipeline statistics: not supported");
+        } else if (mStates.pipelineStatisticsEnabled.second &&
+                   ImGui::BeginTable("pipelineStatistics", 11, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("pass");
+            ImGui::TableSetupColumn("vertices");
+            ImGui::TableSetupColumn("prims");
+            ImGui::TableSetupColumn("VS");
+            ImGui::TableSetupColumn("TCS patches");
+            ImGui::TableSetupColumn("TES");
+            ImGui::TableSetupColumn("clipped");
+            ImGui::TableSetupColumn("FS");
+            ImGui::TableSetupColumn("overdraw");
+            ImGui::TableSetupColumn("ACMR");
+            ImGui::TableSetupColumn("reuse");
+            ImGui::TableHeadersRow();
+            for (uint32_t i = 0u; i < mStats.gpuScopesCount; ++i) {
+                const auto& scope = mStats.gpuScopes[i];
+                if (!scope.has_statistics) {
+                    continue;
+                }
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", scope.name);
+                ImGui::TableNextColumn();
+                textCount(scope.inputVertices);
+                ImGui::TableNextColumn();
+                textCount(scope.inputPrimitives);
+                ImGui::TableNextColumn();
+                textCount(scope.vertexInvocations);
+                ImGui::TableNextColumn();
+                textCount(scope.tessControlPatches);
+                ImGui::TableNextColumn();
+                textCount(scope.tessEvaluationInvocations);
+                ImGui::TableNextColumn();
+                textCount(scope.clippingPrimitives);
+                ImGui::TableNextColumn();
+                textCount(scope.fragmentInvocations);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", scope.overdraw);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", scope.acmr);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f%%", scope.vertexReuse * 100.0f);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    if (mStats.memoryHeapsCount != 0u) {
+        ImGui::Separator();
+        ImGui::Text("Memory, MiB (live / peak)");
+        const int columnsCount = 3 + static_cast<int>(mStats.memoryCategoriesCount);
+        if (ImGui::BeginTable("memory", columnsCount, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("heap");
+            ImGui::TableSetupColumn("total");
+            ImGui::TableSetupColumn("usage / budget");
+            for (uint32_t i = 0u; i < mStats.memoryCategoriesCount; ++i) {
+                ImGui::TableSetupColumn(mStats.memoryCategoryNames[i]);
+            }
+            ImGui::TableHeadersRow();
+            for (uint32_t i = 0u; i < mStats.memoryHeapsCount; ++i) {
+                const auto& heap = mStats.memoryHeaps[i];
+                if (heap.peakBytes == 0u) {
+                    continue;
+                }
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%u%s", i, heap.is_deviceLocal ? " device" : " host");
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f / %.1f", static_cast<float>(heap.liveBytes) / BYTES_IN_MIB,
+                            static_cast<float>(heap.peakBytes) / BYTES_IN_MIB);
+                ImGui::TableNextColumn();
+                const ImVec4 usageColor = heap.is_overBudget ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+                ImGui::TextColored(usageColor, "%.1f / %.1f", static_cast<float>(heap.usageBytes) / BYTES_IN_MIB,
+                                   static_cast<float>(heap.budgetBytes) / BYTES_IN_MIB);
+                for (uint32_t category = 0u; category < mStats.memoryCategoriesCount; ++category) {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f / %.1f", static_cast<float>(heap.categoryLiveBytes[category]) / BYTES_IN_MIB,
+                                static_cast<float>(heap.categoryPeakBytes[category]) / BYTES_IN_MIB);
+                }
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    mStates.qualityChanged = false;
+    if (mStats.qualityParametersCount != 0u) {
+        ImGui::Separator();
+        ImGui::Text("Quality");
+    }
+    char valueFormat[32];
+    for (uint32_t i = 0u; i < mStats.qualityParametersCount; ++i) {
+        const auto& parameter = mStats.qualityParameters[i];
+        int level = static_cast<int>(parameter.level);
+        snprintf(valueFormat, sizeof(valueFormat), parameter.is_compiling ? "%u (compiling)" : "%u", parameter.value);
+        ImGui::PushID(200 + static_cast<int>(i));
+        if (ImGui::SliderInt(parameter.name, &level, 0, static_cast<int>(parameter.levelsCount) - 1, valueFormat) &&
+            !mStates.qualityChanged) {
+            mStates.qualityIndex = i;
+            mStates.qualityLevel = static_cast<uint32_t>(level);
+            mStates.qualityChanged = true;
+        }
+        ImGui::PopID();
+    }
     ImGui::End();
     ImGui::Render();
 